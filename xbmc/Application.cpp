@@ -206,6 +206,7 @@
 #include "music/dialogs/GUIDialogMusicOverlay.h"
 #include "video/dialogs/GUIDialogVideoOverlay.h"
 #include "video/VideoInfoScanner.h"
+#include "video/ThumbExtractionService.h"
 #include "video/PlayerController.h"
 
 // Dialog includes
@@ -3542,6 +3543,7 @@ void CApplication::Stop(int exitCode)
 
     // cancel any jobs from the jobmanager
     CJobManager::GetInstance().CancelJobs();
+    CThumbExtractionService::Get().Stop();
 
     // stop scanning before we kill the network and so on
     if (m_musicInfoScanner->IsScanning())
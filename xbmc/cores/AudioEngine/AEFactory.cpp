@@ -393,3 +393,11 @@ void CAEFactory::DeviceChange()
   if (AE)
     AE->DeviceChange();
 }
+
+const CAETelemetry *CAEFactory::GetTelemetry()
+{
+  if (AE)
+    return AE->GetTelemetry();
+
+  return NULL;
+}
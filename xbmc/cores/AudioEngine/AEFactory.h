@@ -77,6 +77,7 @@ public:
   static bool IsSettingVisible(const std::string &condition, const std::string &value, const std::string &settingId);
   static void KeepConfiguration(unsigned int millis);
   static void DeviceChange();
+  static const CAETelemetry *GetTelemetry();
 
   static void RegisterAudioCallback(IAudioCallback* pCallback);
   static void UnregisterAudioCallback();
@@ -95,6 +95,8 @@ IAESink *CAESinkFactory::TrySink(std::string &driver, std::string &device, AEAud
 
   if (driver == "NULL")
     sink = new CAESinkNULL();
+  else if (driver == "PROFILER")
+    sink = new CAESinkProfiler();
 
 #if defined(TARGET_WINDOWS)
   else if (driver == "WASAPI")
@@ -24,15 +24,21 @@ using namespace ActiveAE;
 #include "ActiveAESound.h"
 #include "ActiveAEStream.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
+#include "cores/AudioEngine/Utils/AEMix.h"
 #include "cores/AudioEngine/Encoders/AEEncoderFFmpeg.h"
 
 #include "settings/Settings.h"
 #include "settings/AdvancedSettings.h"
 #include "windowing/WindowingFactory.h"
+#include "utils/CPUInfo.h"
+#include "utils/TimeUtils.h"
 
 #define MAX_CACHE_LEVEL 0.5   // total cache time of stream in seconds
 #define MAX_WATER_LEVEL 0.25  // buffered time after stream stages in seconds
 #define MAX_BUFFER_TIME 0.1   // max time of a buffer in seconds
+#define MAX_CACHED_SLABS 8    // sample memory of deleted buffer pools kept for reuse
+#define AE_SAMPLE_ALIGN 64    // alignment of packets and planes in buffer pools
+#define TELEMETRY_LOG_INTERVAL 60000 // ms between telemetry dumps with audio debug logging
 
 void CEngineStats::Reset(unsigned int sampleRate)
 {
@@ -42,6 +48,8 @@ void CEngineStats::Reset(unsigned int sampleRate)
   m_sinkSampleRate = sampleRate;
   m_bufferedSamples = 0;
   m_suspended = false;
+  for (int i = 0; i < AE_STAGE_MAX; i++)
+    m_stageAverage[i] = m_stagePeak[i] = 0.0f;
 }
 
 void CEngineStats::UpdateSinkDelay(double delay, int samples)
@@ -138,6 +146,23 @@ bool CEngineStats::IsSuspended()
   return m_suspended;
 }
 
+void CEngineStats::SetStageTimes(float *average, float *peak)
+{
+  CSingleLock lock(m_lock);
+  for (int i = 0; i < AE_STAGE_MAX; i++)
+  {
+    m_stageAverage[i] = average[i];
+    m_stagePeak[i] = peak[i];
+  }
+}
+
+void CEngineStats::GetStageTime(AEEngineStage stage, float &average, float &peak)
+{
+  CSingleLock lock(m_lock);
+  average = m_stageAverage[stage];
+  peak = m_stagePeak[stage];
+}
+
 CActiveAE::CActiveAE() :
   CThread("ActiveAE"),
   m_controlPort("OutputControlPort", &m_inMsgEvent, &m_outMsgEvent),
@@ -159,6 +184,10 @@ CActiveAE::CActiveAE() :
   m_audioCallback = NULL;
   m_vizInitialized = false;
   m_sinkHasVolume = false;
+  m_stageCycles = 0;
+  for (int i = 0; i < AE_STAGE_MAX; i++)
+    m_stageTicks[i] = m_stagePeak[i] = 0;
+  m_telemetryEvents = 0;
 }
 
 CActiveAE::~CActiveAE()
@@ -175,9 +204,11 @@ void CActiveAE::Dispose()
   m_bStop = true;
   m_outMsgEvent.Set();
   StopThread();
+  m_workers.Stop();
   m_controlPort.Purge();
   m_dataPort.Purge();
   m_sink.Dispose();
+  ClearSlabCache();
 
   m_dllAvFormat.Unload();
   m_dllAvCodec.Unload();
@@ -551,9 +582,11 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
           stream = CreateStream(streamMsg);
           if(stream)
           {
-            msg->Reply(CActiveAEDataProtocol::ACC, &stream, sizeof(CActiveAEStream*));
+            // the stream's queues are sized in Configure, so it is only
+            // handed out afterwards and can't touch them before
             LoadSettings();
             Configure();
+            msg->Reply(CActiveAEDataProtocol::ACC, &stream, sizeof(CActiveAEStream*));
             if (!m_extError)
             {
               m_state = AE_TOP_CONFIGURED_PLAY;
@@ -569,20 +602,14 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
             msg->Reply(CActiveAEDataProtocol::ERR);
           return;
         case CActiveAEDataProtocol::STREAMSAMPLE:
-          MsgStreamSample *msgData;
-          CSampleBuffer *samples;
-          msgData = (MsgStreamSample*)msg->data;
-          samples = msgData->stream->m_processingSamples.front();
-          msgData->stream->m_processingSamples.pop_front();
-          if (samples != msgData->buffer)
-            CLog::Log(LOGERROR, "CActiveAE - inconsistency in stream sample message");
-          if (msgData->buffer->pkt->nb_samples == 0)
-            msgData->buffer->Return();
-          else
-            msgData->stream->m_resampleBuffers->m_inputSamples.push_back(msgData->buffer);
+        {
+          std::list<CActiveAEStream*>::iterator it;
+          for (it = m_streams.begin(); it != m_streams.end(); ++it)
+            ReceiveStreamSamples(*it);
           m_extTimeout = 0;
           m_state = AE_TOP_CONFIGURED_PLAY;
           return;
+        }
         case CActiveAEDataProtocol::FREESTREAM:
           stream = *(CActiveAEStream**)msg->data;
           DiscardStream(stream);
@@ -862,6 +889,17 @@ void CActiveAE::Process()
           }
         }
       }
+
+      // samples are queued by the streams without a message, they are
+      // only picked up once the engine is configured
+      if (!gotMsg && HasStreamSamples() &&
+          (m_state == AE_TOP_CONFIGURED_IDLE || m_state == AE_TOP_CONFIGURED_PLAY))
+      {
+        msg = m_dataPort.GetMessage();
+        msg->signal = CActiveAEDataProtocol::STREAMSAMPLE;
+        gotMsg = true;
+        port = &m_dataPort;
+      }
     }
 
     if (gotMsg)
@@ -1113,6 +1151,9 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         // create buffer pool
         (*it)->m_inputBuffers = new CActiveAEBufferPool((*it)->m_format);
         (*it)->m_inputBuffers->Create(MAX_CACHE_LEVEL*1000);
+        // the stream did not get a buffer yet, its queues are still empty
+        (*it)->m_freeQueue.Reserve((*it)->m_inputBuffers->m_allSamples.size());
+        (*it)->m_sampleQueue.Reserve((*it)->m_inputBuffers->m_allSamples.size());
         (*it)->m_streamSpace = (*it)->m_format.m_frameSize * (*it)->m_format.m_frames;
 
         // if input format does not follow ffmpeg channel mask, we may need to remap channels
@@ -1226,6 +1267,7 @@ CActiveAEStream* CActiveAE::CreateStream(MsgStreamNew *streamMsg)
   stream = new CActiveAEStream(&streamMsg->format);
   stream->m_streamPort = new CActiveAEDataProtocol("stream",
                              &stream->m_inMsgEvent, &m_outMsgEvent);
+  stream->m_outMsgEvent = &m_outMsgEvent;
 
   // create buffer pool
   stream->m_inputBuffers = NULL; // create in Configure when we know the sink format
@@ -1280,6 +1322,9 @@ void CActiveAE::SFlushStream(CActiveAEStream *stream)
   }
   stream->m_resampleBuffers->Flush();
   stream->m_streamPort->Purge();
+  // stream is blocked in FlushStream, all queued buffers were returned above
+  stream->m_freeQueue.Clear();
+  stream->m_sampleQueue.Clear();
   stream->m_bufferedTime = 0.0;
   stream->m_paused = false;
 
@@ -1321,7 +1366,7 @@ void CActiveAE::FlushEngine()
 void CActiveAE::ClearDiscardedBuffers()
 {
   std::list<CActiveAEBufferPool*>::iterator it;
-  for (it=m_discardBufferPools.begin(); it!=m_discardBufferPools.end(); ++it)
+  for (it=m_discardBufferPools.begin(); it!=m_discardBufferPools.end(); )
   {
     CActiveAEBufferPoolResample *rbuf = dynamic_cast<CActiveAEBufferPoolResample*>(*it);
     if (rbuf)
@@ -1329,13 +1374,14 @@ void CActiveAE::ClearDiscardedBuffers()
       rbuf->Flush();
     }
     // if all buffers have returned, we can delete the buffer pool
-    if ((*it)->m_allSamples.size() == (*it)->m_freeSamples.size())
+    if ((*it)->AllFree())
     {
       delete (*it);
       CLog::Log(LOGDEBUG, "CActiveAE::ClearDiscardedBuffers - buffer pool deleted");
-      m_discardBufferPools.erase(it);
-      return;
+      it = m_discardBufferPools.erase(it);
     }
+    else
+      ++it;
   }
 }
 
@@ -1623,34 +1669,138 @@ void CActiveAE::UnconfigureSink()
 }
 
 
+bool CActiveAE::ReceiveStreamSamples(CActiveAEStream *stream)
+{
+  bool received = false;
+  CSampleBuffer *buffer;
+  while (stream->m_sampleQueue.Pop(buffer))
+  {
+    CSampleBuffer *samples = stream->m_processingSamples.front();
+    stream->m_processingSamples.pop_front();
+    if (samples != buffer)
+      CLog::Log(LOGERROR, "CActiveAE - inconsistency in stream sample queue");
+    if (buffer->pkt->nb_samples == 0 || !stream->m_resampleBuffers)
+      buffer->Return();
+    else
+      stream->m_resampleBuffers->m_inputSamples.push_back(buffer);
+    received = true;
+  }
+  return received;
+}
+
+bool CActiveAE::HasStreamSamples()
+{
+  std::list<CActiveAEStream*>::iterator it;
+  for (it = m_streams.begin(); it != m_streams.end(); ++it)
+  {
+    if (!(*it)->m_sampleQueue.Empty())
+      return true;
+  }
+  return false;
+}
+
+void CActiveAE::AddStageTime(AEEngineStage stage, int64_t &start)
+{
+  int64_t now = CurrentHostCounter();
+  int64_t ticks = now - start;
+  m_stageTicks[stage] += ticks;
+  if (ticks > m_stagePeak[stage])
+    m_stagePeak[stage] = ticks;
+  start = now;
+
+  if (stage != AE_STAGE_MAX - 1)
+    return;
+
+  m_stageCycles++;
+  if (!m_stageTimer.IsTimePast())
+    return;
+
+  float average[AE_STAGE_MAX], peak[AE_STAGE_MAX];
+  float msPerTick = 1000.0f / CurrentHostFrequency();
+  for (int i = 0; i < AE_STAGE_MAX; i++)
+  {
+    average[i] = (float)m_stageTicks[i] * msPerTick / m_stageCycles;
+    peak[i] = (float)m_stagePeak[i] * msPerTick;
+    m_stageTicks[i] = m_stagePeak[i] = 0;
+  }
+  m_stats.SetStageTimes(average, peak);
+
+  if (g_advancedSettings.m_extraLogLevels & LOGAUDIO)
+    CLog::Log(LOGDEBUG, "CActiveAE::%s - %u cycles, avg/peak ms streams: %.3f/%.3f mix: %.3f/%.3f sink: %.3f/%.3f",
+              __FUNCTION__, m_stageCycles,
+              average[AE_STAGE_STREAMS], peak[AE_STAGE_STREAMS],
+              average[AE_STAGE_MIX], peak[AE_STAGE_MIX],
+              average[AE_STAGE_SINK], peak[AE_STAGE_SINK]);
+
+  m_stageCycles = 0;
+  m_stageTimer.Set(1000);
+
+  // dump telemetry, right away if the sink ran dry since the last dump
+  AETelemetrySnapshot snapshot;
+  m_stats.Telemetry().GetSnapshot(snapshot);
+  unsigned int events = snapshot.counters[AE_TELEMETRY_UNDERRUNS] + snapshot.counters[AE_TELEMETRY_LATE];
+  if (events != m_telemetryEvents)
+    m_stats.Telemetry().Log(LOGNOTICE, "CActiveAE::Telemetry");
+  else if (m_telemetryTimer.IsTimePast() && (g_advancedSettings.m_extraLogLevels & LOGAUDIO))
+    m_stats.Telemetry().Log(LOGDEBUG, "CActiveAE::Telemetry");
+  else
+    return;
+  m_telemetryEvents = events;
+  m_telemetryTimer.Set(TELEMETRY_LOG_INTERVAL);
+}
+
 bool CActiveAE::RunStages()
 {
   bool busy = false;
+  int64_t start = CurrentHostCounter();
+  int64_t cycleStart = start;
 
-  // serve input streams
+  // collect streams for resampling, new resamplers are only created here
   std::list<CActiveAEStream*>::iterator it;
   for (it = m_streams.begin(); it != m_streams.end(); ++it)
   {
+    // pick up what the stream has queued since the last cycle
+    if (!m_extDeferData)
+      ReceiveStreamSamples(*it);
+
     if ((*it)->m_resampleBuffers && !(*it)->m_paused)
-      busy = (*it)->m_resampleBuffers->ResampleBuffers();
+    {
+      if ((*it)->m_resampleBuffers->m_changeResampler)
+        busy |= (*it)->m_resampleBuffers->ResampleBuffers();
+      else
+        m_resampleJobs.push_back((*it)->m_resampleBuffers);
+    }
     else if ((*it)->m_resampleBuffers && 
             ((*it)->m_resampleBuffers->m_inputSamples.size() > (*it)->m_resampleBuffers->m_allSamples.size() * 0.5))
     {
       CSingleLock lock((*it)->m_streamLock);
       (*it)->m_streamIsBuffering = false;
     }
+  }
+
+  // streams don't share buffers, resample them in parallel and join
+  if (m_workers.ResampleBuffers(m_resampleJobs))
+  {
+    m_stats.Telemetry().AddTicks(AE_TELEMETRY_RESAMPLE, CurrentHostCounter() - start);
+    busy = true;
+  }
+  m_resampleJobs.clear();
 
+  // serve input streams
+  for (it = m_streams.begin(); it != m_streams.end(); ++it)
+  {
     // provide buffers to stream
     float time = m_stats.GetCacheTime((*it));
     CSampleBuffer *buffer;
     if (!(*it)->m_drain)
     {
-      while (time < MAX_CACHE_LEVEL && !(*it)->m_inputBuffers->m_freeSamples.empty())
+      while (time < MAX_CACHE_LEVEL && (*it)->m_inputBuffers->HasFreeBuffers())
       {
         buffer = (*it)->m_inputBuffers->GetFreeBuffer();
         (*it)->m_processingSamples.push_back(buffer);
-        (*it)->m_streamPort->SendInMessage(CActiveAEDataProtocol::STREAMBUFFER, &buffer, sizeof(CSampleBuffer*));
         (*it)->IncFreeBuffers();
+        if ((*it)->m_freeQueue.Push(buffer) == 1)
+          (*it)->m_inMsgEvent.Set();
         time += (float)buffer->pkt->max_nb_samples / buffer->pkt->config.sample_rate;
       }
     }
@@ -1686,8 +1836,10 @@ bool CActiveAE::RunStages()
     }
   }
 
+  AddStageTime(AE_STAGE_STREAMS, start);
+
   if (m_stats.GetWaterLevel() < MAX_WATER_LEVEL &&
-     (m_mode != MODE_TRANSCODE || (m_encoderBuffers && !m_encoderBuffers->m_freeSamples.empty())))
+     (m_mode != MODE_TRANSCODE || (m_encoderBuffers && m_encoderBuffers->HasFreeBuffers())))
   {
     // mix streams and sounds sounds
     if (m_mode != MODE_RAW)
@@ -1695,7 +1847,7 @@ bool CActiveAE::RunStages()
       CSampleBuffer *out = NULL;
       if (!m_sounds_playing.empty() && m_streams.empty())
       {
-        if (m_silenceBuffers && !m_silenceBuffers->m_freeSamples.empty())
+        if (m_silenceBuffers && m_silenceBuffers->HasFreeBuffers())
         {
           out = m_silenceBuffers->GetFreeBuffer();
           for (int i=0; i<out->pkt->planes; i++)
@@ -1731,166 +1883,66 @@ bool CActiveAE::RunStages()
         {
           (*it)->m_started = true;
 
-          if (!out)
-          {
-            out = (*it)->m_resampleBuffers->m_outputSamples.front();
-            (*it)->m_resampleBuffers->m_outputSamples.pop_front();
-
-            int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
-            int nb_loops = 1;
-            float fadingStep = 0.0f;
-
-            // fading
-            if ((*it)->m_fadingSamples == -1)
-            {
-              (*it)->m_fadingSamples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
-              (*it)->m_volume = (*it)->m_fadingBase;
-            }
-            if ((*it)->m_fadingSamples > 0)
-            {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
-              float delta = (*it)->m_fadingTarget - (*it)->m_fadingBase;
-              int samples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
-              fadingStep = delta / samples;
-            }
-
-            // for stream amplification, 
-            // turned off downmix normalization,
-            // or if sink format is float (in order to prevent from clipping)
-            // we need to run on a per sample basis
-            if ((*it)->m_amplify != 1.0 || !(*it)->m_resampleBuffers->m_normalize || (m_sinkFormat.m_dataFormat == AE_FMT_FLOAT))
-            {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
-            }
-
-            for(int i=0; i<nb_loops; i++)
-            {
-              if ((*it)->m_fadingSamples > 0)
-              {
-                (*it)->m_volume += fadingStep;
-                (*it)->m_fadingSamples--;
-
-                if ((*it)->m_fadingSamples == 0)
-                {
-                  // set variables being polled via stream interface
-                  CSingleLock lock((*it)->m_streamLock);
-                  (*it)->m_streamFading = false;
-                }
-              }
+          CSampleBuffer *mix = (*it)->m_resampleBuffers->m_outputSamples.front();
+          (*it)->m_resampleBuffers->m_outputSamples.pop_front();
 
-              // volume for stream
-              float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)out->pkt->data, out->pkt->config.channels, i*nb_floats, out->pkt->planes > 1);
+          // the first stream is scaled in place and becomes the output buffer
+          bool accumulate = (out != NULL);
+          if (!out)
+            out = mix;
 
-              for(int j=0; j<out->pkt->planes; j++)
-              {
-#ifdef __SSE__
-                CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
-#else
-                float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  fbuffer[k] *= volume;
-                }
-#endif
-              }
-            }
-          }
-          else
+          // fading
+          if ((*it)->m_fadingSamples == -1)
           {
-            CSampleBuffer *mix = NULL;
-            mix = (*it)->m_resampleBuffers->m_outputSamples.front();
-            (*it)->m_resampleBuffers->m_outputSamples.pop_front();
-
-            int nb_floats = mix->pkt->nb_samples * mix->pkt->config.channels / mix->pkt->planes;
-            int nb_loops = 1;
-            float fadingStep = 0.0f;
-
-            // fading
-            if ((*it)->m_fadingSamples == -1)
-            {
-              (*it)->m_fadingSamples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
-              (*it)->m_volume = (*it)->m_fadingBase;
-            }
-            if ((*it)->m_fadingSamples > 0)
-            {
-              nb_floats = mix->pkt->config.channels / mix->pkt->planes;
-              nb_loops = mix->pkt->nb_samples;
-              float delta = (*it)->m_fadingTarget - (*it)->m_fadingBase;
-              int samples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
-              fadingStep = delta / samples;
-            }
-
-            // for streams amplification of turned off downmix normalization
-            // we need to run on a per sample basis
-            if ((*it)->m_amplify != 1.0 || !(*it)->m_resampleBuffers->m_normalize)
-            {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
-            }
+            (*it)->m_fadingSamples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
+            (*it)->m_volume = (*it)->m_fadingBase;
+          }
 
-            for(int i=0; i<nb_loops; i++)
-            {
-              if ((*it)->m_fadingSamples > 0)
-              {
-                (*it)->m_volume += fadingStep;
-                (*it)->m_fadingSamples--;
-
-                if ((*it)->m_fadingSamples == 0)
-                {
-                  // set variables being polled via stream interface
-                  CSingleLock lock((*it)->m_streamLock);
-                  (*it)->m_streamFading = false;
-                }
-              }
+          AEMixGain gain;
+          gain.volume = (*it)->m_volume;
+          gain.rgain = (*it)->m_rgain;
+          gain.fadingSamples = (*it)->m_fadingSamples;
+          gain.fadingStep = 0.0f;
+          gain.limiter = &(*it)->m_limiter;
+          if ((*it)->m_fadingSamples > 0)
+          {
+            float delta = (*it)->m_fadingTarget - (*it)->m_fadingBase;
+            int samples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
+            gain.fadingStep = delta / samples;
+          }
 
-              // volume for stream
-              float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)mix->pkt->data, mix->pkt->config.channels, i*nb_floats, mix->pkt->planes > 1);
+          // for stream amplification, turned off downmix normalization,
+          // or if sink format is float (in order to prevent from clipping)
+          // we need to run on a per sample basis
+          int frames = mix->pkt->nb_samples;
+          gain.perSample = (*it)->m_amplify != 1.0 || !(*it)->m_resampleBuffers->m_normalize;
+          if (gain.perSample && accumulate)
+            frames = out->pkt->nb_samples;
+          else if (!accumulate && m_sinkFormat.m_dataFormat == AE_FMT_FLOAT)
+            gain.perSample = true;
+
+          needClamp |= CAEMix::Mix((float**)out->pkt->data, (float**)mix->pkt->data,
+                                   std::min(out->pkt->planes, mix->pkt->planes), out->pkt->config.channels,
+                                   frames, accumulate, gain);
+
+          (*it)->m_volume = gain.volume;
+          if ((*it)->m_fadingSamples > 0 && gain.fadingSamples == 0)
+          {
+            // set variables being polled via stream interface
+            CSingleLock lock((*it)->m_streamLock);
+            (*it)->m_streamFading = false;
+          }
+          (*it)->m_fadingSamples = gain.fadingSamples;
 
-              for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
-              {
-                float *dst = (float*)out->pkt->data[j]+i*nb_floats;
-                float *src = (float*)mix->pkt->data[j]+i*nb_floats;
-#ifdef __SSE__
-                CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  if (fabs(dst[k]) > 1.0f)
-                  {
-                    needClamp = true;
-                    break;
-                  }
-                }
-#else
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  dst[k] += src[k] * volume;
-                  if (fabs(dst[k]) > 1.0f)
-                    needClamp = true;
-                }
-#endif
-              }
-            }
+          if (accumulate)
             mix->Return();
-          }
           busy = true;
         }
       }// for
 
       // finally clamp samples
       if(out && needClamp)
-      {
-        int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
-        for(int i=0; i<out->pkt->planes; i++)
-        {
-          CAEUtil::ClampArray((float*)out->pkt->data[i], nb_floats);
-        }
-      }
+        CAEMix::Clamp((float**)out->pkt->data, out->pkt->planes, out->pkt->config.channels, out->pkt->nb_samples);
 
       // process output buffer, gui sounds, encode, viz
       if (out)
@@ -1906,7 +1958,7 @@ bool CActiveAE::RunStages()
               m_vizInitialized = true;
             }
 
-            if (!m_vizBuffersInput->m_freeSamples.empty())
+            if (m_vizBuffersInput->HasFreeBuffers())
             {
               // copy the samples into the viz input buffer
               CSampleBuffer *viz = m_vizBuffersInput->GetFreeBuffer();
@@ -1948,11 +2000,15 @@ bool CActiveAE::RunStages()
         if (!m_sinkHasVolume || m_muted)
           Deamplify(*(out->pkt));
 
+        int64_t mixed = CurrentHostCounter();
+        m_stats.Telemetry().AddTicks(AE_TELEMETRY_MIX, mixed - start);
+
         if (m_mode == MODE_TRANSCODE && m_encoder)
         {
           CSampleBuffer *buf = m_encoderBuffers->GetFreeBuffer();
           m_encoder->Encode(out->pkt->data[0], out->pkt->planes*out->pkt->linesize,
                             buf->pkt->data[0], buf->pkt->planes*buf->pkt->linesize);
+          m_stats.Telemetry().AddTicks(AE_TELEMETRY_ENCODE, CurrentHostCounter() - mixed);
           buf->pkt->nb_samples = buf->pkt->max_nb_samples;
           out->Return();
           out = buf;
@@ -1985,6 +2041,8 @@ bool CActiveAE::RunStages()
     }
   }
 
+  AddStageTime(AE_STAGE_MIX, start);
+
   // serve sink buffers
   busy |= m_sinkBuffers->ResampleBuffers();
   while(!m_sinkBuffers->m_outputSamples.empty())
@@ -1997,6 +2055,11 @@ bool CActiveAE::RunStages()
     busy = true;
   }
 
+  AddStageTime(AE_STAGE_SINK, start);
+
+  if (busy)
+    m_stats.Telemetry().AddTicks(AE_TELEMETRY_CYCLE, start - cycleStart);
+
   return busy;
 }
 
@@ -2132,6 +2195,11 @@ bool CActiveAE::Initialize()
   }
   m_dllAvFormat.av_register_all();
 
+  // resampling of concurrent streams is spread over spare cores
+  m_workers.Start(std::min(std::max(g_cpuInfo.getCPUCount() - 1, 0), 3));
+  m_stageTimer.Set(1000);
+  m_telemetryTimer.Set(TELEMETRY_LOG_INTERVAL);
+
   Create();
   Message *reply;
   if (m_controlPort.SendOutMessageSync(CActiveAEControlProtocol::INIT,
@@ -2403,6 +2471,76 @@ void CActiveAE::FreeSoundSample(uint8_t **data)
   delete [] data;
 }
 
+unsigned int CActiveAE::GetSoundSampleSize(SampleConfig &config, int samples)
+{
+  int size = m_dllAvUtil.av_samples_get_buffer_size(NULL, config.channels, samples, config.fmt, AE_SAMPLE_ALIGN);
+  return (size + AE_SAMPLE_ALIGN - 1) & ~(AE_SAMPLE_ALIGN - 1);
+}
+
+uint8_t **CActiveAE::MapSoundSample(SampleConfig &config, uint8_t *memory, int samples, int &bytes_per_sample, int &planes, int &linesize)
+{
+  uint8_t **buffer;
+  planes = m_dllAvUtil.av_sample_fmt_is_planar(config.fmt) ? config.channels : 1;
+  buffer = new uint8_t*[planes];
+
+  m_dllAvUtil.av_samples_fill_arrays(buffer, &linesize, memory, config.channels,
+                                     samples, config.fmt, AE_SAMPLE_ALIGN);
+  bytes_per_sample = m_dllAvUtil.av_get_bytes_per_sample(config.fmt);
+  return buffer;
+}
+
+uint8_t *CActiveAE::AllocSlab(unsigned int size, unsigned int &capacity)
+{
+  {
+    CSingleLock lock(m_slabLock);
+
+    // smallest cached slab that fits without wasting more than half of it
+    std::list<SampleSlab>::iterator it, best = m_slabCache.end();
+    for (it = m_slabCache.begin(); it != m_slabCache.end(); ++it)
+    {
+      if (it->size >= size && it->size / 2 <= size &&
+          (best == m_slabCache.end() || it->size < best->size))
+        best = it;
+    }
+    if (best != m_slabCache.end())
+    {
+      uint8_t *slab = best->data;
+      capacity = best->size;
+      m_slabCache.erase(best);
+      return slab;
+    }
+  }
+
+  capacity = size;
+  return (uint8_t*)_aligned_malloc(size, AE_SAMPLE_ALIGN);
+}
+
+void CActiveAE::FreeSlab(uint8_t *slab, unsigned int capacity)
+{
+  CSingleLock lock(m_slabLock);
+
+  SampleSlab entry;
+  entry.data = slab;
+  entry.size = capacity;
+  m_slabCache.push_front(entry);
+
+  while (m_slabCache.size() > MAX_CACHED_SLABS)
+  {
+    _aligned_free(m_slabCache.back().data);
+    m_slabCache.pop_back();
+  }
+}
+
+void CActiveAE::ClearSlabCache()
+{
+  CSingleLock lock(m_slabLock);
+
+  std::list<SampleSlab>::iterator it;
+  for (it = m_slabCache.begin(); it != m_slabCache.end(); ++it)
+    _aligned_free(it->data);
+  m_slabCache.clear();
+}
+
 bool CActiveAE::CompareFormat(AEAudioFormat &lhs, AEAudioFormat &rhs)
 {
   if (lhs.m_channelLayout != rhs.m_channelLayout ||
@@ -24,6 +24,8 @@
 
 #include "ActiveAESink.h"
 #include "ActiveAEResample.h"
+#include "ActiveAEWorkers.h"
+#include "cores/AudioEngine/Utils/AETelemetry.h"
 #include "cores/AudioEngine/Interfaces/AEStream.h"
 #include "cores/AudioEngine/Interfaces/AESound.h"
 #include "cores/AudioEngine/AEFactory.h"
@@ -119,7 +121,6 @@ public:
   {
     ACC,
     ERR,
-    STREAMBUFFER,
     STREAMDRAINED,
   };
 };
@@ -130,12 +131,6 @@ struct MsgStreamNew
   unsigned int options;
 };
 
-struct MsgStreamSample
-{
-  CSampleBuffer *buffer;
-  CActiveAEStream *stream;
-};
-
 struct MsgStreamParameter
 {
   CActiveAEStream *stream;
@@ -154,6 +149,14 @@ struct MsgStreamFade
   unsigned int millis;
 };
 
+enum AEEngineStage
+{
+  AE_STAGE_STREAMS = 0,  // stream input and resampling
+  AE_STAGE_MIX,          // mix, gui sounds, viz and encoder
+  AE_STAGE_SINK,         // conversion to sink format
+  AE_STAGE_MAX
+};
+
 class CEngineStats
 {
 public:
@@ -169,6 +172,9 @@ public:
   void SetSinkCacheTotal(float time) { m_sinkCacheTotal = time; }
   void SetSinkLatency(float time) { m_sinkLatency = time; }
   bool IsSuspended();
+  void SetStageTimes(float *average, float *peak);
+  void GetStageTime(AEEngineStage stage, float &average, float &peak);
+  CAETelemetry &Telemetry() { return m_telemetry; }
   CCriticalSection *GetLock() { return &m_lock; }
 protected:
   float m_sinkDelay;
@@ -178,6 +184,9 @@ protected:
   unsigned int m_sinkSampleRate;
   unsigned int m_sinkUpdate;
   bool m_suspended;
+  float m_stageAverage[AE_STAGE_MAX]; // ms per cycle
+  float m_stagePeak[AE_STAGE_MAX];
+  CAETelemetry m_telemetry;           // written without m_lock by engine and sink
   CCriticalSection m_lock;
 };
 
@@ -192,6 +201,7 @@ protected:
   friend class CActiveAESound;
   friend class CActiveAEStream;
   friend class CSoundPacket;
+  friend class CActiveAEBufferPool;
   friend class CActiveAEBufferPoolResample;
   CActiveAE();
   virtual ~CActiveAE();
@@ -228,6 +238,7 @@ public:
   virtual bool IsSettingVisible(const std::string &settingId);
   virtual void KeepConfiguration(unsigned int millis);
   virtual void DeviceChange();
+  virtual const CAETelemetry *GetTelemetry() { return &m_stats.Telemetry(); }
 
   virtual void RegisterAudioCallback(IAudioCallback* pCallback);
   virtual void UnregisterAudioCallback();
@@ -240,6 +251,11 @@ protected:
   void PlaySound(CActiveAESound *sound);
   uint8_t **AllocSoundSample(SampleConfig &config, int &samples, int &bytes_per_sample, int &planes, int &linesize);
   void FreeSoundSample(uint8_t **data);
+  unsigned int GetSoundSampleSize(SampleConfig &config, int samples);
+  uint8_t **MapSoundSample(SampleConfig &config, uint8_t *memory, int samples, int &bytes_per_sample, int &planes, int &linesize);
+  uint8_t *AllocSlab(unsigned int size, unsigned int &capacity);
+  void FreeSlab(uint8_t *slab, unsigned int capacity);
+  void ClearSlabCache();
   float GetDelay(CActiveAEStream *stream) { return m_stats.GetDelay(stream); }
   float GetCacheTime(CActiveAEStream *stream) { return m_stats.GetCacheTime(stream); }
   float GetCacheTotal(CActiveAEStream *stream) { return m_stats.GetCacheTotal(stream); }
@@ -275,7 +291,10 @@ protected:
   void DiscardSound(CActiveAESound *sound);
   void ChangeResamplers();
 
+  bool ReceiveStreamSamples(CActiveAEStream *stream);
+  bool HasStreamSamples();
   bool RunStages();
+  void AddStageTime(AEEngineStage stage, int64_t &start);
   bool HasWork();
 
   void ResampleSounds();
@@ -328,6 +347,26 @@ protected:
   std::list<CActiveAEStream*> m_streams;
   std::list<CActiveAEBufferPool*> m_discardBufferPools;
 
+  // sample memory of deleted buffer pools, handed to the next pool of a
+  // compatible size so that reconfiguring does not allocate again
+  struct SampleSlab
+  {
+    uint8_t *data;
+    unsigned int size;
+  };
+  std::list<SampleSlab> m_slabCache;
+  CCriticalSection m_slabLock;
+  CActiveAEWorkers m_workers;
+  std::vector<CActiveAEBufferPoolResample*> m_resampleJobs;
+
+  // time spent in the stages of RunStages, published every second
+  int64_t m_stageTicks[AE_STAGE_MAX];
+  int64_t m_stagePeak[AE_STAGE_MAX];
+  unsigned int m_stageCycles;
+  XbmcThreads::EndTime m_stageTimer;
+  XbmcThreads::EndTime m_telemetryTimer;
+  unsigned int m_telemetryEvents;       // underruns and late buffers at the last dump
+
   // gui sounds
   struct SoundState
   {
@@ -23,6 +23,8 @@
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAE.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 
+#include <algorithm>
+
 using namespace ActiveAE;
 
 /* typecast AE to CActiveAE */
@@ -33,15 +35,26 @@ CSoundPacket::CSoundPacket(SampleConfig conf, int samples) : config(conf)
   data = AE.AllocSoundSample(config, samples, bytes_per_sample, planes, linesize);
   max_nb_samples = samples;
   nb_samples = 0;
+  external = false;
+}
+
+CSoundPacket::CSoundPacket(SampleConfig conf, int samples, uint8_t *memory) : config(conf)
+{
+  data = AE.MapSoundSample(config, memory, samples, bytes_per_sample, planes, linesize);
+  max_nb_samples = samples;
+  nb_samples = 0;
+  external = true;
 }
 
 CSoundPacket::~CSoundPacket()
 {
-  if (data)
+  if (data && external)
+    delete [] data;
+  else if (data)
     AE.FreeSoundSample(data);
 }
 
-CSampleBuffer::CSampleBuffer() : pkt(NULL), pool(NULL)
+CSampleBuffer::CSampleBuffer() : pkt(NULL), pool(NULL), next(NULL)
 {
   refCount = 0;
 }
@@ -69,27 +82,30 @@ CActiveAEBufferPool::CActiveAEBufferPool(AEAudioFormat format)
   m_format = format;
   if (AE_IS_RAW(m_format.m_dataFormat))
     m_format.m_dataFormat = AE_FMT_S16NE;
+  m_freeSamples = NULL;
+  m_freeCount = 0;
+  m_buffers = NULL;
+  m_slab = NULL;
+  m_slabSize = 0;
 }
 
 CActiveAEBufferPool::~CActiveAEBufferPool()
 {
-  CSampleBuffer *buffer;
-  while(!m_allSamples.empty())
-  {
-    buffer = m_allSamples.front();
-    m_allSamples.pop_front();
-    delete buffer;
-  }
+  // packets have to go before the memory they point into
+  delete [] m_buffers;
+  if (m_slab)
+    AE.FreeSlab(m_slab, m_slabSize);
 }
 
 CSampleBuffer* CActiveAEBufferPool::GetFreeBuffer()
 {
-  CSampleBuffer* buf = NULL;
+  CSampleBuffer* buf = m_freeSamples;
 
-  if (!m_freeSamples.empty())
+  if (buf)
   {
-    buf = m_freeSamples.front();
-    m_freeSamples.pop_front();
+    m_freeSamples = buf->next;
+    m_freeCount--;
+    buf->next = NULL;
     buf->refCount = 1;
   }
   return buf;
@@ -98,12 +114,13 @@ CSampleBuffer* CActiveAEBufferPool::GetFreeBuffer()
 void CActiveAEBufferPool::ReturnBuffer(CSampleBuffer *buffer)
 {
   buffer->pkt->nb_samples = 0;
-  m_freeSamples.push_back(buffer);
+  buffer->next = m_freeSamples;
+  m_freeSamples = buffer;
+  m_freeCount++;
 }
 
 bool CActiveAEBufferPool::Create(unsigned int totaltime)
 {
-  CSampleBuffer *buffer;
   SampleConfig config;
   config.fmt = CActiveAEResample::GetAVSampleFormat(m_format.m_dataFormat);
   config.bits_per_sample = CAEUtil::DataFormatToUsedBits(m_format.m_dataFormat);
@@ -111,21 +128,30 @@ bool CActiveAEBufferPool::Create(unsigned int totaltime)
   config.sample_rate = m_format.m_sampleRate;
   config.channel_layout = CActiveAEResample::GetAVChannelLayout(m_format.m_channelLayout);
 
-  unsigned int time = 0;
   unsigned int buffertime = (m_format.m_frames*1000) / m_format.m_sampleRate;
-  unsigned int n = 0;
-  while (time < totaltime || n < 5)
+  unsigned int n = 5;
+  if (buffertime)
+    n = std::max(n, (totaltime + buffertime - 1) / buffertime);
+
+  unsigned int packetSize = AE.GetSoundSampleSize(config, m_format.m_frames);
+  m_slab = AE.AllocSlab(n * packetSize, m_slabSize);
+  if (!m_slab)
+    return false;
+
+  m_buffers = new CSampleBuffer[n];
+  m_allSamples.reserve(n);
+  for (unsigned int i = 0; i < n; i++)
   {
-    buffer = new CSampleBuffer();
+    CSampleBuffer *buffer = &m_buffers[i];
     buffer->pool = this;
-    buffer->pkt = new CSoundPacket(config, m_format.m_frames);
-
+    buffer->pkt = new CSoundPacket(config, m_format.m_frames, m_slab + i * packetSize);
     m_allSamples.push_back(buffer);
-    m_freeSamples.push_back(buffer);
-    time += buffertime;
-    n++;
   }
 
+  // hand out the buffers in order of memory
+  for (unsigned int i = n; i > 0; i--)
+    ReturnBuffer(&m_buffers[i-1]);
+
   return true;
 }
 
@@ -234,7 +260,7 @@ bool CActiveAEBufferPoolResample::ResampleBuffers(unsigned int timestamp)
       busy = true;
     }
   }
-  else if (m_procSample || !m_freeSamples.empty())
+  else if (m_procSample || HasFreeBuffers())
   {
     // GetBufferedSamples is not accurate because of rounding errors
     int out_samples = m_resampler->GetBufferedSamples();
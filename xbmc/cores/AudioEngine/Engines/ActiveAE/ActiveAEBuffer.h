@@ -24,6 +24,7 @@
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
 #include "cores/AudioEngine/Interfaces/AE.h"
 #include <deque>
+#include <vector>
 
 namespace ActiveAE
 {
@@ -44,6 +45,7 @@ class CSoundPacket
 {
 public:
   CSoundPacket(SampleConfig conf, int samples);
+  CSoundPacket(SampleConfig conf, int samples, uint8_t *memory);
   ~CSoundPacket();
   uint8_t **data;                        // array with pointers to planes of data
   SampleConfig config;
@@ -53,6 +55,7 @@ public:
   int planes;                            // 1 for non planar formats, #channels for planar
   int nb_samples;                        // number of frames used
   int max_nb_samples;                    // max number of frames this packet can hold
+  bool external;                         // data points into memory owned by the pool
 };
 
 class CActiveAEBufferPool;
@@ -66,10 +69,16 @@ public:
   void Return();
   CSoundPacket *pkt;
   CActiveAEBufferPool *pool;
+  CSampleBuffer *next;                   // free list of the pool
   unsigned int timestamp;
   int refCount;
 };
 
+/**
+ * The samples of all packets of a pool live in a single slab, each packet
+ * starting on a cache line. Free buffers are kept in an intrusive list,
+ * last returned buffer first as it is most likely still in cache.
+ */
 class CActiveAEBufferPool
 {
 public:
@@ -78,9 +87,16 @@ public:
   virtual bool Create(unsigned int totaltime);
   CSampleBuffer *GetFreeBuffer();
   void ReturnBuffer(CSampleBuffer *buffer);
+  bool HasFreeBuffers() { return m_freeSamples != NULL; }
+  bool AllFree() { return m_freeCount == m_allSamples.size(); }
   AEAudioFormat m_format;
-  std::deque<CSampleBuffer*> m_allSamples;
-  std::deque<CSampleBuffer*> m_freeSamples;
+  std::vector<CSampleBuffer*> m_allSamples;
+protected:
+  CSampleBuffer *m_freeSamples;
+  unsigned int m_freeCount;
+  CSampleBuffer *m_buffers;
+  uint8_t *m_slab;
+  unsigned int m_slabSize;
 };
 
 class CActiveAEResample;
@@ -26,6 +26,7 @@
 #include "ActiveAE.h"
 
 #include "settings/Settings.h"
+#include "utils/TimeUtils.h"
 
 using namespace ActiveAE;
 
@@ -39,6 +40,9 @@ CActiveAESink::CActiveAESink(CEvent *inMsgEvent) :
   m_stats = NULL;
   m_convertBuffer = NULL;
   m_volume = 0.0;
+  m_lastWrite = 0;
+  m_lastDelay = 0.0;
+  m_sinkOpened = false;
 }
 
 void CActiveAESink::Start()
@@ -436,12 +440,16 @@ void CActiveAESink::StateMachine(int signal, Protocol *port, Message *msg)
         case CSinkControlProtocol::TIMEOUT:
           if (!m_extSilenceTimer.IsTimePast())
           {
+            // engine did not deliver in time, sink plays silence
+            if (m_extStreaming)
+              m_stats->Telemetry().Count(AE_TELEMETRY_UNDERRUNS);
             m_state = S_TOP_CONFIGURED_SILENCE;
             m_extTimeout = 0;
           }
           else
           {
             m_sink->Drain();
+            m_lastWrite = 0;
             m_state = S_TOP_CONFIGURED_IDLE;
             if (m_extAppFocused)
               m_extTimeout = 10000;
@@ -684,6 +692,11 @@ void CActiveAESink::OpenSink()
 
   CLog::Log(LOGINFO, "CActiveAESink::OpenSink - initialize sink");
 
+  if (m_sinkOpened)
+    m_stats->Telemetry().Count(AE_TELEMETRY_REOPENS);
+  m_sinkOpened = true;
+  m_lastWrite = 0;
+
   if (m_sink)
   {
     m_sink->Drain();
@@ -804,7 +817,14 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
   int retry = 0;
   unsigned int written = 0;
   double sinkDelay = 0.0;
+  int64_t start = CurrentHostCounter();
+
+  // the queue of the sink ran dry before this buffer arrived
+  if (samples->pool && m_lastWrite &&
+      (double)(start - m_lastWrite) / CurrentHostFrequency() > m_lastDelay)
+    m_stats->Telemetry().Count(AE_TELEMETRY_LATE);
 
+  bool swap = false;
   switch(m_convertState)
   {
   case SKIP_CONVERT:
@@ -814,19 +834,47 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
     buffer = Convert(samples);
     break;
   case NEED_BYTESWAP:
-    Endian_Swap16_buf((uint16_t *)buffer, (uint16_t *)buffer, frames * samples->pkt->config.channels);
+    swap = true;
     break;
   case CHECK_CONVERT:
     ConvertInit(samples);
     if (m_convertState == NEED_CONVERT)
       buffer = Convert(samples);
     else if (m_convertState == NEED_BYTESWAP)
-      Endian_Swap16_buf((uint16_t *)buffer, (uint16_t *)buffer, frames * samples->pkt->config.channels);
+      swap = true;
     break;
   default:
     break;
   }
 
+  // passthrough goes straight into the buffer of the sink if it lends one,
+  // the byte swap is done on the way
+  if (AE_IS_RAW(m_requestedFormat.m_dataFormat))
+  {
+    while(frames > 0)
+    {
+      unsigned int lent = frames;
+      uint8_t *dst = m_sink->LendBuffer(lent);
+      if (!dst)
+        break;
+      lent = std::min(lent, frames);
+      if (swap)
+        Endian_Swap16_buf((uint16_t *)dst, (uint16_t *)buffer, lent * samples->pkt->config.channels);
+      else
+        memcpy(dst, buffer, lent * m_sinkFormat.m_frameSize);
+      written = m_sink->CommitBuffer(lent);
+      if (written == 0)
+        break;
+      frames -= written;
+      buffer += written*m_sinkFormat.m_frameSize;
+      sinkDelay = m_sink->GetDelay();
+      m_stats->UpdateSinkDelay(sinkDelay, samples->pool ? written : 0);
+    }
+  }
+
+  if (swap && frames > 0)
+    Endian_Swap16_buf((uint16_t *)buffer, (uint16_t *)buffer, frames * samples->pkt->config.channels);
+
   while(frames > 0)
   {
     maxFrames = std::min(frames, m_sinkFormat.m_frames);
@@ -857,6 +905,15 @@ unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
     sinkDelay = m_sink->GetDelay();
     m_stats->UpdateSinkDelay(sinkDelay, samples->pool ? written : 0);
   }
+
+  m_lastWrite = CurrentHostCounter();
+  m_lastDelay = sinkDelay;
+  // one sample per buffer, whether it was lent and committed or added
+  if (samples->pool)
+  {
+    m_stats->Telemetry().AddTicks(AE_TELEMETRY_SINK_WRITE, m_lastWrite - start);
+    m_stats->Telemetry().AddTime(AE_TELEMETRY_SINK_DELAY, (int64_t)(sinkDelay * 1000000));
+  }
   return sinkDelay*1000;
 }
 
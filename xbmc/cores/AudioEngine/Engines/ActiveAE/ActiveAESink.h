@@ -148,6 +148,11 @@ protected:
   AEAudioFormat m_sinkFormat, m_requestedFormat;
   CEngineStats *m_stats;
   float m_volume;
+
+  // telemetry, set after each write to tell late buffers
+  int64_t m_lastWrite;
+  double m_lastDelay;
+  bool m_sinkOpened;
 };
 
 }
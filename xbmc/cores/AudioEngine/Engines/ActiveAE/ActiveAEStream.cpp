@@ -59,6 +59,7 @@ CActiveAEStream::CActiveAEStream(AEAudioFormat *format)
   m_remapper = NULL;
   m_remapBuffer = NULL;
   m_streamResampleRatio = 1.0;
+  m_outMsgEvent = NULL;
 }
 
 CActiveAEStream::~CActiveAEStream()
@@ -185,6 +186,16 @@ void CActiveAEStream::RemapBuffer()
   }
 }
 
+void CActiveAEStream::SendSample(CSampleBuffer *buffer)
+{
+  // only wake up the engine if it may have found the queue empty
+  long queued = m_sampleQueue.Push(buffer);
+  if (queued == 1)
+    m_outMsgEvent->Set();
+  else if (!queued)
+    CLog::Log(LOGERROR, "CActiveAEStream::%s - sample queue overrun", __FUNCTION__);
+}
+
 unsigned int CActiveAEStream::GetSpace()
 {
   CSingleLock lock(m_streamLock);
@@ -250,30 +261,22 @@ unsigned int CActiveAEStream::AddData(void *data, unsigned int size)
         copied += bytes;
       if (m_currentBuffer->pkt->nb_samples == m_currentBuffer->pkt->max_nb_samples)
       {
-        MsgStreamSample msgData;
-        msgData.buffer = m_currentBuffer;
-        msgData.stream = this;
         RemapBuffer();
-        m_streamPort->SendOutMessage(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
+        SendSample(m_currentBuffer);
         m_currentBuffer = NULL;
       }
       continue;
     }
+    else if (m_freeQueue.Pop(m_currentBuffer))
+    {
+      DecFreeBuffers();
+      continue;
+    }
     else if (m_streamPort->ReceiveInMessage(&msg))
     {
-      if (msg->signal == CActiveAEDataProtocol::STREAMBUFFER)
-      {
-        m_currentBuffer = *((CSampleBuffer**)msg->data);
-        msg->Release();
-        DecFreeBuffers();
-        continue;
-      }
-      else
-      {
-        CLog::Log(LOGERROR, "CActiveAEStream::AddData - unknown signal");
-        msg->Release();
-        break;
-      }
+      CLog::Log(LOGERROR, "CActiveAEStream::AddData - unknown signal");
+      msg->Release();
+      break;
     }
     if (!m_inMsgEvent.WaitMSec(200))
       break;
@@ -335,33 +338,30 @@ void CActiveAEStream::Drain(bool wait)
 
   if (m_currentBuffer)
   {
-    MsgStreamSample msgData;
-    msgData.buffer = m_currentBuffer;
-    msgData.stream = this;
     RemapBuffer();
-    m_streamPort->SendOutMessage(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
+    SendSample(m_currentBuffer);
     m_currentBuffer = NULL;
   }
 
   XbmcThreads::EndTime timer(2000);
   while (!timer.IsTimePast())
   {
-    if (m_streamPort->ReceiveInMessage(&msg))
+    CSampleBuffer *buffer;
+    if (m_freeQueue.Pop(buffer))
     {
-      if (msg->signal == CActiveAEDataProtocol::STREAMBUFFER)
-      {
-        MsgStreamSample msgData;
-        msgData.stream = this;
-        msgData.buffer = *((CSampleBuffer**)msg->data);
-        msg->Reply(CActiveAEDataProtocol::STREAMSAMPLE, &msgData, sizeof(MsgStreamSample));
-        DecFreeBuffers();
-        continue;
-      }
-      else if (msg->signal == CActiveAEDataProtocol::STREAMDRAINED)
+      // hand it back empty, the engine returns it to the pool
+      SendSample(buffer);
+      DecFreeBuffers();
+      continue;
+    }
+    else if (m_streamPort->ReceiveInMessage(&msg))
+    {
+      if (msg->signal == CActiveAEDataProtocol::STREAMDRAINED)
       {
         msg->Release();
         return;
       }
+      msg->Release();
     }
     else if (!wait)
       return;
@@ -23,6 +23,7 @@
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
 #include "cores/AudioEngine/Utils/AELimiter.h"
 #include "cores/AudioEngine/Utils/AEConvert.h"
+#include "threads/SPSCQueue.h"
 
 namespace ActiveAE
 {
@@ -40,6 +41,7 @@ protected:
   void ResetFreeBuffers();
   void InitRemapper();
   void RemapBuffer();
+  void SendSample(CSampleBuffer *buffer);
 
 public:
   virtual unsigned int GetSpace();
@@ -106,6 +108,10 @@ protected:
   std::deque<CSampleBuffer*> m_processingSamples;
   CActiveAEDataProtocol *m_streamPort;
   CEvent m_inMsgEvent;
+  CEvent *m_outMsgEvent;
+  // sample buffers bypass the port, it only carries control messages
+  XbmcThreads::SPSCQueue<CSampleBuffer*> m_freeQueue;   // engine -> stream
+  XbmcThreads::SPSCQueue<CSampleBuffer*> m_sampleQueue; // stream -> engine
   CCriticalSection *m_statsLock;
   bool m_drain;
   bool m_paused;
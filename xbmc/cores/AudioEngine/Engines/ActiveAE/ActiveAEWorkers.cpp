@@ -0,0 +1,136 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ActiveAEWorkers.h"
+#include "ActiveAEBuffer.h"
+#include "threads/Atomics.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+using namespace ActiveAE;
+
+CActiveAEWorker::CActiveAEWorker(CActiveAEWorkers *owner)
+  : CThread("AEWorker"),
+    m_owner(owner)
+{
+}
+
+void CActiveAEWorker::Process()
+{
+  while (!m_bStop)
+  {
+    if (AbortableWait(m_start) != WAIT_SIGNALED)
+      continue;
+
+    m_owner->RunJobs();
+    m_owner->Leave();
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CActiveAEWorkers::CActiveAEWorkers()
+{
+  m_jobs = NULL;
+  m_nextJob = 0;
+  m_active = 0;
+}
+
+CActiveAEWorkers::~CActiveAEWorkers()
+{
+  Stop();
+}
+
+void CActiveAEWorkers::Start(unsigned int workers)
+{
+  Stop();
+
+  for (unsigned int i = 0; i < workers; i++)
+  {
+    CActiveAEWorker *worker = new CActiveAEWorker(this);
+    worker->Create();
+    m_workers.push_back(worker);
+  }
+  if (workers)
+    CLog::Log(LOGDEBUG, "CActiveAEWorkers::%s - started %u resample workers", __FUNCTION__, workers);
+}
+
+void CActiveAEWorkers::Stop()
+{
+  std::vector<CActiveAEWorker*>::iterator it;
+  for (it = m_workers.begin(); it != m_workers.end(); ++it)
+  {
+    (*it)->StopThread(true);
+    delete (*it);
+  }
+  m_workers.clear();
+}
+
+bool CActiveAEWorkers::ResampleBuffers(std::vector<CActiveAEBufferPoolResample*> &pools)
+{
+  bool busy = false;
+
+  if (pools.size() < 2 || m_workers.empty())
+  {
+    std::vector<CActiveAEBufferPoolResample*>::iterator it;
+    for (it = pools.begin(); it != pools.end(); ++it)
+      busy |= (*it)->ResampleBuffers();
+    return busy;
+  }
+
+  unsigned int wake = std::min(pools.size() - 1, m_workers.size());
+
+  // nobody is in the job loop at this point
+  m_jobs = &pools;
+  m_busy.assign(pools.size(), 0);
+  m_nextJob = 0;
+  m_done.Reset();
+  AtomicAdd(&m_active, wake + 1);
+
+  for (unsigned int i = 0; i < wake; i++)
+    m_workers[i]->m_start.Set();
+
+  RunJobs();
+  Leave();
+
+  while (AtomicAdd(&m_active, 0) > 0)
+    m_done.Wait();
+
+  for (unsigned int i = 0; i < m_busy.size(); i++)
+    busy |= m_busy[i] != 0;
+
+  m_jobs = NULL;
+  return busy;
+}
+
+void CActiveAEWorkers::RunJobs()
+{
+  long jobs = m_jobs->size();
+  long job;
+  while ((job = AtomicIncrement(&m_nextJob) - 1) < jobs)
+    m_busy[job] = (*m_jobs)[job]->ResampleBuffers();
+}
+
+void CActiveAEWorkers::Leave()
+{
+  if (AtomicDecrement(&m_active) == 0)
+    m_done.Set();
+}
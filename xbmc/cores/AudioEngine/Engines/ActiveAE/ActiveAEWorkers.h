@@ -0,0 +1,70 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/Thread.h"
+#include "threads/Event.h"
+#include <vector>
+
+namespace ActiveAE
+{
+
+class CActiveAEBufferPoolResample;
+class CActiveAEWorkers;
+
+class CActiveAEWorker : public CThread
+{
+public:
+  CActiveAEWorker(CActiveAEWorkers *owner);
+  CEvent m_start;
+protected:
+  virtual void Process();
+  CActiveAEWorkers *m_owner;
+};
+
+/**
+ * Runs the resample stage of several streams in parallel. The calling
+ * thread takes jobs as well and does not return before every worker it
+ * woke up has left the job loop, so the mix stage never sees a buffer
+ * pool that is still being worked on.
+ */
+class CActiveAEWorkers
+{
+public:
+  CActiveAEWorkers();
+  ~CActiveAEWorkers();
+  void Start(unsigned int workers);
+  void Stop();
+  bool ResampleBuffers(std::vector<CActiveAEBufferPoolResample*> &pools);
+
+protected:
+  friend class CActiveAEWorker;
+  void RunJobs();
+  void Leave();
+
+  std::vector<CActiveAEWorker*> m_workers;
+  std::vector<CActiveAEBufferPoolResample*> *m_jobs;
+  std::vector<int> m_busy;
+  volatile long m_nextJob;
+  volatile long m_active;
+  CEvent m_done;
+};
+
+}
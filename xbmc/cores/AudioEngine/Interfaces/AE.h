@@ -35,6 +35,7 @@ class IAEStream;
 class IAESound;
 class IAEPacketizer;
 class IAudioCallback;
+class CAETelemetry;
 
 /* sound options */
 #define AE_SOUND_OFF    0 /* disable sounds */
@@ -240,6 +241,12 @@ public:
    */
   virtual void DeviceChange() {return; }
 
+  /**
+   * Timing histograms and underrun counters of engine and sink
+   * @return the telemetry block or NULL if the engine does not keep one
+   */
+  virtual const CAETelemetry *GetTelemetry() { return NULL; }
+
 protected:
   bool m_bAudio2;
   bool m_bDisabled;
@@ -66,6 +66,21 @@ public:
   */
   virtual unsigned int AddPackets(uint8_t *data, unsigned int frames, bool hasAudio, bool blocking = false) = 0;
 
+  /*
+    Lends a part of the output buffer so frames can be written in place
+    instead of being copied by AddPackets. On return frames holds how many
+    frames fit, this may be less than asked for. Sinks without a buffer to
+    lend, or that only lend while the device runs, return NULL and the
+    caller falls back to AddPackets.
+  */
+  virtual uint8_t *LendBuffer(unsigned int &frames) { return NULL; }
+
+  /*
+    Hands frames written to the buffer of LendBuffer to the device,
+    returns the frames taken.
+  */
+  virtual unsigned int CommitBuffer(unsigned int frames) { return 0; }
+
   /*
     Drain the sink
    */
@@ -81,6 +81,8 @@ CAESinkALSA::CAESinkALSA() :
   m_bufferSize(0),
   m_formatSampleRateMul(0.0),
   m_passthrough(false),
+  m_mmap(false),
+  m_lentOffset(0),
   m_pcm(NULL),
   m_timeout(0)
 {
@@ -290,7 +292,12 @@ bool CAESinkALSA::InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig
   memset(hw_params, 0, snd_pcm_hw_params_sizeof());
 
   snd_pcm_hw_params_any(m_pcm, hw_params);
-  snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+
+  /* passthrough frames are written straight into the ring buffer if the device allows it */
+  m_mmap = m_passthrough &&
+           snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+  if (!m_mmap)
+    snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
 
   unsigned int sampleRate   = inconfig.sampleRate;
   unsigned int channelCount = inconfig.channels;
@@ -466,7 +473,8 @@ bool CAESinkALSA::InitializeSW(const ALSAConfig &inconfig)
   memset(sw_params, 0, snd_pcm_sw_params_sizeof());
 
   snd_pcm_sw_params_current              (m_pcm, sw_params);
-  snd_pcm_sw_params_set_start_threshold  (m_pcm, sw_params, INT_MAX);
+  // a mmap pcm is started by alsa once a period is written, see LendBuffer
+  snd_pcm_sw_params_set_start_threshold  (m_pcm, sw_params, m_mmap ? inconfig.periodSize : INT_MAX);
   snd_pcm_sw_params_set_silence_threshold(m_pcm, sw_params, 0);
   snd_pcm_sw_params_get_boundary         (sw_params, &boundary);
   snd_pcm_sw_params_set_silence_size     (m_pcm, sw_params, boundary);
@@ -529,7 +537,7 @@ unsigned int CAESinkALSA::AddPackets(uint8_t *data, unsigned int frames, bool ha
     return INT_MAX;
   }
 
-  int ret = snd_pcm_writei(m_pcm, (void*)data, frames);
+  int ret = m_mmap ? snd_pcm_mmap_writei(m_pcm, (void*)data, frames) : snd_pcm_writei(m_pcm, (void*)data, frames);
   if (ret < 0)
   {
     CLog::Log(LOGERROR, "CAESinkALSA - snd_pcm_writei(%d) %s - trying to recover", ret, snd_strerror(ret));
@@ -537,7 +545,7 @@ unsigned int CAESinkALSA::AddPackets(uint8_t *data, unsigned int frames, bool ha
     if(ret < 0)
     {
       HandleError("snd_pcm_writei(1)", ret);
-      ret = snd_pcm_writei(m_pcm, (void*)data, frames);
+      ret = m_mmap ? snd_pcm_mmap_writei(m_pcm, (void*)data, frames) : snd_pcm_writei(m_pcm, (void*)data, frames);
       if (ret < 0)
       {
         HandleError("snd_pcm_writei(2)", ret);
@@ -546,12 +554,68 @@ unsigned int CAESinkALSA::AddPackets(uint8_t *data, unsigned int frames, bool ha
     }
   }
 
-  if ( ret > 0 && snd_pcm_state(m_pcm) == SND_PCM_STATE_PREPARED)
+  if (!m_mmap && ret > 0 && snd_pcm_state(m_pcm) == SND_PCM_STATE_PREPARED)
     snd_pcm_start(m_pcm);
 
   return ret;
 }
 
+uint8_t *CAESinkALSA::LendBuffer(unsigned int &frames)
+{
+  if (!m_pcm || !m_mmap)
+    return NULL;
+
+  // until the pcm runs the frames go through AddPackets, whose write
+  // starts it on the start threshold, committing does not start a pcm
+  if (snd_pcm_state(m_pcm) != SND_PCM_STATE_RUNNING)
+    return NULL;
+
+  snd_pcm_sframes_t avail = snd_pcm_avail_update(m_pcm);
+  if (avail == 0)
+  {
+    // block like snd_pcm_writei would until there is room
+    snd_pcm_wait(m_pcm, m_timeout);
+    avail = snd_pcm_avail_update(m_pcm);
+  }
+  if (avail < 0)
+  {
+    HandleError("snd_pcm_avail_update", avail);
+    return NULL;
+  }
+  if (avail == 0)
+    return NULL;
+
+  const snd_pcm_channel_area_t *areas;
+  snd_pcm_uframes_t offset;
+  snd_pcm_uframes_t count = std::min((snd_pcm_uframes_t)frames, (snd_pcm_uframes_t)avail);
+  int err = snd_pcm_mmap_begin(m_pcm, &areas, &offset, &count);
+  if (err < 0)
+  {
+    HandleError("snd_pcm_mmap_begin", err);
+    return NULL;
+  }
+
+  // interleaved access, all channels share the first area
+  m_lentOffset = offset;
+  frames = count;
+  return (uint8_t*)areas[0].addr + (areas[0].first >> 3) + offset * (areas[0].step >> 3);
+}
+
+unsigned int CAESinkALSA::CommitBuffer(unsigned int frames)
+{
+  if (!m_pcm || !m_mmap)
+    return 0;
+
+  snd_pcm_sframes_t ret = snd_pcm_mmap_commit(m_pcm, m_lentOffset, frames);
+  if (ret < 0)
+  {
+    HandleError("snd_pcm_mmap_commit", ret);
+    return 0;
+  }
+
+  return ret;
+}
+
 void CAESinkALSA::HandleError(const char* name, int err)
 {
   switch(err)
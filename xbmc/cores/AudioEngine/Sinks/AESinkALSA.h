@@ -46,6 +46,8 @@ public:
   virtual double       GetDelay        ();
   virtual double       GetCacheTotal   ();
   virtual unsigned int AddPackets      (uint8_t *data, unsigned int frames, bool hasAudio, bool blocking = false);
+  virtual uint8_t*     LendBuffer      (unsigned int &frames);
+  virtual unsigned int CommitBuffer    (unsigned int frames);
   virtual void         Drain           ();
 
   static void EnumerateDevicesEx(AEDeviceInfoList &list, bool force = false);
@@ -60,6 +62,8 @@ private:
   unsigned int      m_bufferSize;
   double            m_formatSampleRateMul;
   bool              m_passthrough;
+  bool              m_mmap;          // passthrough pcm opened for mmap access
+  snd_pcm_uframes_t m_lentOffset;
   std::string       m_device;
   snd_pcm_t        *m_pcm;
   int               m_timeout;
@@ -40,7 +40,8 @@ CAEBitstreamPacker::CAEBitstreamPacker() :
   m_eac3Size (0),
   m_eac3FramesCount(0),
   m_eac3FramesPerBurst(0),
-  m_dataSize (0)
+  m_dataSize (0),
+  m_dataBuffer(m_packedBuffer)
 {
 }
 
@@ -53,6 +54,7 @@ CAEBitstreamPacker::~CAEBitstreamPacker()
 
 void CAEBitstreamPacker::Pack(CAEStreamInfo &info, uint8_t* data, int size)
 {
+  m_dataBuffer = m_packedBuffer;
   switch (info.GetDataType())
   {
     case CAEStreamInfo::STREAM_TYPE_TRUEHD:
@@ -96,7 +98,7 @@ unsigned int CAEBitstreamPacker::GetSize()
 uint8_t* CAEBitstreamPacker::GetBuffer()
 {
   m_dataSize = 0;
-  return m_packedBuffer;
+  return m_dataBuffer;
 }
 
 /* we need to pack 24 TrueHD audio units into the unknown MAT format before packing into IEC61937 */
@@ -110,17 +112,20 @@ void CAEBitstreamPacker::PackTrueHD(CAEStreamInfo &info, uint8_t* data, int size
   /* create the buffer if it doesnt already exist */
   if (!m_trueHD)
   {
-    m_trueHD    = new uint8_t[MAT_FRAME_SIZE];
+    m_trueHD    = new uint8_t[MAX_IEC61937_PACKET];
     m_trueHDPos = 0;
   }
 
+  /* the MAT frame is built where the packet payload goes, so it is packed in place */
+  uint8_t *mat = m_trueHD + IEC61937_DATA_OFFSET;
+
   /* setup the frame for the data */
   if (m_trueHDPos == 0)
   {
-    memset(m_trueHD, 0, MAT_FRAME_SIZE);
-    memcpy(m_trueHD, mat_start_code, sizeof(mat_start_code));
-    memcpy(m_trueHD + (12 * TRUEHD_FRAME_OFFSET) - BURST_HEADER_SIZE + MAT_MIDDLE_CODE_OFFSET, mat_middle_code, sizeof(mat_middle_code));
-    memcpy(m_trueHD + MAT_FRAME_SIZE - sizeof(mat_end_code), mat_end_code, sizeof(mat_end_code));
+    memset(mat, 0, MAT_FRAME_SIZE);
+    memcpy(mat, mat_start_code, sizeof(mat_start_code));
+    memcpy(mat + (12 * TRUEHD_FRAME_OFFSET) - BURST_HEADER_SIZE + MAT_MIDDLE_CODE_OFFSET, mat_middle_code, sizeof(mat_middle_code));
+    memcpy(mat + MAT_FRAME_SIZE - sizeof(mat_end_code), mat_end_code, sizeof(mat_end_code));
   }
 
   size_t offset;
@@ -131,13 +136,14 @@ void CAEBitstreamPacker::PackTrueHD(CAEStreamInfo &info, uint8_t* data, int size
   else
     offset = (m_trueHDPos * TRUEHD_FRAME_OFFSET) - BURST_HEADER_SIZE;
 
-  memcpy(m_trueHD + offset, data, size);
+  memcpy(mat + offset, data, size);
 
   /* if we have a full frame */
   if (++m_trueHDPos == 24)
   {
-    m_trueHDPos = 0;
-    m_dataSize  = CAEPackIEC61937::PackTrueHD(m_trueHD, MAT_FRAME_SIZE, m_packedBuffer);
+    m_trueHDPos  = 0;
+    m_dataSize   = CAEPackIEC61937::PackTrueHD(NULL, MAT_FRAME_SIZE, m_trueHD);
+    m_dataBuffer = m_trueHD;
   }
 }
 
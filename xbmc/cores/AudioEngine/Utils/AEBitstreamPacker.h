@@ -41,7 +41,7 @@ private:
   void PackEAC3  (CAEStreamInfo &info, uint8_t* data, int size);
 
   /* we keep the trueHD and dtsHD buffers seperate so that we can handle a fast stream switch */
-  uint8_t      *m_trueHD;
+  uint8_t      *m_trueHD;     // a whole IEC61937 packet, the MAT frame is built in its payload
   unsigned int  m_trueHDPos;
 
   uint8_t      *m_dtsHD;
@@ -53,6 +53,7 @@ private:
   unsigned int  m_eac3FramesPerBurst;
 
   unsigned int  m_dataSize;
+  uint8_t      *m_dataBuffer;  // the buffer holding the last packet
   uint8_t       m_packedBuffer[MAX_IEC61937_PACKET];
 };
 
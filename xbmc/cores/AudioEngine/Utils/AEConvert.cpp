@@ -25,6 +25,7 @@
 #include "AEUtil.h"
 #include "utils/MathUtils.h"
 #include "utils/EndianSwap.h"
+#include "utils/CPUInfo.h"
 #include <stdint.h>
 
 #if defined(TARGET_WINDOWS)
@@ -62,6 +63,16 @@ static inline int safeRound(double f)
 
 CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
 {
+  /* prefer the widest kernel the cpu supports, fall back to the generic code */
+  AEConvertToFn fn = NULL;
+  const unsigned int features = g_cpuInfo.GetCPUFeatures();
+  if (features & CPU_FEATURE_AVX2)
+    fn = ToFloatAVX2(dataFormat);
+  if (!fn && (features & CPU_FEATURE_SSE4))
+    fn = ToFloatSSE4(dataFormat);
+  if (fn)
+    return fn;
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &U8_Float;
@@ -99,6 +110,15 @@ CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
 
 CAEConvert::AEConvertFrFn CAEConvert::FrFloat(enum AEDataFormat dataFormat)
 {
+  AEConvertFrFn fn = NULL;
+  const unsigned int features = g_cpuInfo.GetCPUFeatures();
+  if (features & CPU_FEATURE_AVX2)
+    fn = FrFloatAVX2(dataFormat);
+  if (!fn && (features & CPU_FEATURE_SSE4))
+    fn = FrFloatSSE4(dataFormat);
+  if (fn)
+    return fn;
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &Float_U8;
@@ -143,7 +163,7 @@ unsigned int CAEConvert::S8_Float(uint8_t *data, const unsigned int samples, flo
   const float mul = 1.0f / (INT8_MAX + 0.5f);
 
   for (unsigned int i = 0; i < samples; ++i)
-    *dest++ = *data++ * mul;
+    *dest++ = (int8_t)*data++ * mul;
 
   return samples;
 }
@@ -204,7 +224,7 @@ unsigned int CAEConvert::S16BE_Float(uint8_t* data, const unsigned int samples,
   }
 #else
   for (unsigned int i = 0; i < samples; ++i, data += 2)
-    *dest++ = Endian_SwapBE16(*(int16_t*)data) * mul;
+    *dest++ = (int16_t)Endian_SwapBE16(*(int16_t*)data) * mul;
 #endif
 
   return samples;
@@ -244,7 +264,7 @@ unsigned int CAEConvert::S24BE3_Float(uint8_t *data, const unsigned int samples,
 {
   for (unsigned int i = 0; i < samples; ++i, data += 3)
   {
-    int s = (data[1] << 24) | (data[2] << 16) | (data[3] << 8);
+    int s = (data[0] << 24) | (data[1] << 16) | (data[2] << 8);
     *dest++ = (float)s * INT32_SCALE;
   }
   return samples;
@@ -317,15 +337,15 @@ unsigned int CAEConvert::S32BE_Float(uint8_t *data, const unsigned int samples,
   /* do this in groups of 4 to give the compiler a better chance of optimizing this */
   for (float *end = dest + (samples & ~0x3); dest < end;)
   {
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
   }
 
   /* process any remaining samples */
   for (float *end = dest + (samples & 0x3); dest < end;)
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
 
   return samples;
 }
@@ -920,7 +940,11 @@ unsigned int CAEConvert::Float_S24NE3(float *data, const unsigned int samples, u
   _mm_empty();
   #else /* no SSE */
   for (uint32_t i = 0; i < samples; ++i, ++data, dest += 3)
-    *((uint32_t*)(dest)) = (safeRound(*data * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << leftShift;
+  {
+    /* only copy the three bytes we own, a 32bit store would clobber the next frame */
+    uint32_t val = (safeRound(*data * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << leftShift;
+    memcpy(dest, &val, 3);
+  }
   #endif
 
   return samples * 3;
@@ -57,6 +57,15 @@ public:
   typedef unsigned int (*AEConvertToFn)(uint8_t *data, const unsigned int samples, float   *dest);
   typedef unsigned int (*AEConvertFrFn)(float   *data, const unsigned int samples, uint8_t *dest);
 
+private:
+  /* x86 kernel tables, these return NULL if the kernel set was not compiled in */
+  static AEConvertToFn ToFloatSSE4(enum AEDataFormat dataFormat);
+  static AEConvertFrFn FrFloatSSE4(enum AEDataFormat dataFormat);
+  static AEConvertToFn ToFloatAVX2(enum AEDataFormat dataFormat);
+  static AEConvertFrFn FrFloatAVX2(enum AEDataFormat dataFormat);
+
+public:
+
   static AEConvertToFn ToFloat(enum AEDataFormat dataFormat);
   static AEConvertFrFn FrFloat(enum AEDataFormat dataFormat);
 };
@@ -0,0 +1,382 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __STDC_LIMIT_MACROS
+  #define __STDC_LIMIT_MACROS
+#endif
+
+/*
+  This file is built with AVX2 code generation enabled, nothing in here may
+  be called unless CCPUInfo reports CPU_FEATURE_AVX2. The build defines
+  HAS_AVX2_KERNELS where it can compile the intrinsics, Visual Studio only
+  has them from 2012 onwards.
+*/
+
+#include "AEConvert.h"
+#include "AEUtil.h"
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+
+#ifdef HAS_AVX2_KERNELS
+#include <immintrin.h>
+
+#ifndef INT24_MAX
+#define INT24_MAX (0x7FFFFF)
+#endif
+
+#define AE_MUL32 ((float)(INT32_MAX - 127))
+
+/*
+  Same layout as the SSE4 kernels, but every load produces eight samples.
+  Packed 24bit input is fetched as two overlapping 16 byte loads, one per
+  128bit lane, so the shuffle masks are identical for both lanes.
+*/
+struct AVX2_U8
+{
+  enum { Bytes = 1, Reach = 8 };
+  static inline float Scale () { return 2.0f / UINT8_MAX; }
+  static inline float Offset() { return -1.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+  }
+};
+
+struct AVX2_S8
+{
+  enum { Bytes = 1, Reach = 8 };
+  static inline float Scale () { return 1.0f / (INT8_MAX + 0.5f); }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    return _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)src));
+  }
+};
+
+struct AVX2_S16LE
+{
+  enum { Bytes = 2, Reach = 16 };
+  static inline float Scale () { return 1.0f / (INT16_MAX + 0.5f); }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)src));
+  }
+};
+
+struct AVX2_S16BE
+{
+  enum { Bytes = 2, Reach = 16 };
+  static inline float Scale () { return 1.0f / (INT16_MAX + 0.5f); }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    return _mm256_cvtepi16_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), swap));
+  }
+};
+
+struct AVX2_S24LE4
+{
+  enum { Bytes = 4, Reach = 32 };
+  static inline float Scale () { return -1.0f / INT_MIN; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    return _mm256_slli_epi32(_mm256_loadu_si256((const __m256i*)src), 8);
+  }
+};
+
+struct AVX2_S24BE4
+{
+  enum { Bytes = 4, Reach = 32 };
+  static inline float Scale () { return -1.0f / INT_MIN; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    const __m256i swap = _mm256_setr_epi8(-1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12,
+                                          -1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12);
+    return _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)src), swap);
+  }
+};
+
+static inline __m256i AVX2_Load24(const uint8_t *src)
+{
+  __m256i in = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src));
+  return _mm256_inserti128_si256(in, _mm_loadu_si128((const __m128i*)(src + 12)), 1);
+}
+
+struct AVX2_S24LE3
+{
+  enum { Bytes = 3, Reach = 28 };
+  static inline float Scale () { return -1.0f / INT_MIN; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    const __m256i swap = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                          -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    return _mm256_shuffle_epi8(AVX2_Load24(src), swap);
+  }
+};
+
+struct AVX2_S24BE3
+{
+  enum { Bytes = 3, Reach = 28 };
+  static inline float Scale () { return -1.0f / INT_MIN; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    const __m256i swap = _mm256_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9,
+                                          -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+    return _mm256_shuffle_epi8(AVX2_Load24(src), swap);
+  }
+};
+
+struct AVX2_S32LE
+{
+  enum { Bytes = 4, Reach = 32 };
+  static inline float Scale () { return 1.0f / (float)INT32_MAX; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    return _mm256_loadu_si256((const __m256i*)src);
+  }
+};
+
+struct AVX2_S32BE
+{
+  enum { Bytes = 4, Reach = 32 };
+  static inline float Scale () { return 1.0f / (float)INT32_MAX; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m256i Load(const uint8_t *src)
+  {
+    const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    return _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)src), swap);
+  }
+};
+
+template<class F>
+static inline __m256 AVX2_ToFloat8(const uint8_t *src, const __m256 mul, const __m256 add)
+{
+  __m256 out = _mm256_mul_ps(_mm256_cvtepi32_ps(F::Load(src)), mul);
+  if (F::Offset() != 0.0f)
+    out = _mm256_add_ps(out, add);
+  return out;
+}
+
+template<class F>
+static unsigned int AVX2_ToFloat(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m256 mul = _mm256_set1_ps(F::Scale());
+  const __m256 add = _mm256_set1_ps(F::Offset());
+  unsigned int i = 0;
+
+  for (; i + 8 <= samples && (samples - i) * F::Bytes >= (unsigned int)F::Reach; i += 8, data += 8 * F::Bytes)
+    _mm256_storeu_ps(dest + i, AVX2_ToFloat8<F>(data, mul, add));
+
+  /* the remaining samples go through a padded copy so we never read past the input */
+  while (i < samples)
+  {
+    const unsigned int count = std::min(samples - i, 8U);
+    MEMALIGN(32, uint8_t in [32]);
+    MEMALIGN(32, float   out[8 ]);
+    memset(in, 0, sizeof(in));
+    memcpy(in, data, count * F::Bytes);
+    _mm256_store_ps(out, AVX2_ToFloat8<F>(in, mul, add));
+    memcpy(dest + i, out, count * sizeof(float));
+    i    += count;
+    data += count * F::Bytes;
+  }
+
+  return samples;
+}
+
+/*
+  Narrowing is done per 128bit half as the AVX2 pack instructions do not cross
+  lanes, the float math is done on all eight samples at once.
+*/
+struct AVX2_FrU8
+{
+  enum { Bytes = 1 };
+  static inline void Store(uint8_t *dst, const __m256 in)
+  {
+    const __m256 mul = _mm256_set1_ps((float)INT8_MAX + .5f);
+    const __m256 add = _mm256_set1_ps(1.0f);
+    __m256i con = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(in, add), mul));
+    __m128i s16 = _mm_packs_epi32(_mm256_castsi256_si128(con), _mm256_extracti128_si256(con, 1));
+    _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(s16, s16));
+  }
+};
+
+struct AVX2_FrS8
+{
+  enum { Bytes = 1 };
+  static inline void Store(uint8_t *dst, const __m256 in)
+  {
+    const __m256 mul = _mm256_set1_ps((float)INT8_MAX + .5f);
+    __m256i con = _mm256_cvtps_epi32(_mm256_mul_ps(in, mul));
+    __m128i s16 = _mm_packs_epi32(_mm256_castsi256_si128(con), _mm256_extracti128_si256(con, 1));
+    _mm_storel_epi64((__m128i*)dst, _mm_packs_epi16(s16, s16));
+  }
+};
+
+template<bool swap>
+struct AVX2_FrS16
+{
+  enum { Bytes = 2 };
+  static inline void Store(uint8_t *dst, const __m256 in)
+  {
+    const __m256 mul = _mm256_set1_ps((float)INT16_MAX);
+    MEMALIGN(32, float rand[8]);
+
+    /* random round to dither */
+    CAEUtil::FloatRand4(-0.5f, 0.5f, rand);
+    CAEUtil::FloatRand4(-0.5f, 0.5f, rand + 4);
+    __m256i con = _mm256_cvtps_epi32(_mm256_mul_ps(in, _mm256_add_ps(mul, _mm256_load_ps(rand))));
+    __m128i s16 = _mm_packs_epi32(_mm256_castsi256_si128(con), _mm256_extracti128_si256(con, 1));
+    if (swap)
+      s16 = _mm_shuffle_epi8(s16, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+    _mm_storeu_si128((__m128i*)dst, s16);
+  }
+};
+
+struct AVX2_FrS24NE4
+{
+  enum { Bytes = 4 };
+  static inline void Store(uint8_t *dst, const __m256 in)
+  {
+    const __m256 mul = _mm256_set1_ps((float)INT24_MAX + .5f);
+    __m256i con = _mm256_cvtps_epi32(_mm256_mul_ps(in, mul));
+    _mm256_storeu_si256((__m256i*)dst, _mm256_slli_epi32(con, 8));
+  }
+};
+
+struct AVX2_FrS24NE3
+{
+  enum { Bytes = 3 };
+  static inline void Store(uint8_t *dst, const __m256 in)
+  {
+    const __m256 mul   = _mm256_set1_ps((float)INT24_MAX + .5f);
+    const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                          0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    __m256i con = _mm256_shuffle_epi8(_mm256_cvtps_epi32(_mm256_mul_ps(in, mul)), pack);
+    __m128i lo  = _mm256_castsi256_si128(con);
+    __m128i hi  = _mm256_extracti128_si256(con, 1);
+    int32_t tail[2] = { _mm_extract_epi32(lo, 2), _mm_extract_epi32(hi, 2) };
+    _mm_storel_epi64((__m128i*)(dst     ), lo);
+    memcpy(dst + 8, &tail[0], sizeof(int32_t));
+    _mm_storel_epi64((__m128i*)(dst + 12), hi);
+    memcpy(dst + 20, &tail[1], sizeof(int32_t));
+  }
+};
+
+template<bool swap>
+struct AVX2_FrS32
+{
+  enum { Bytes = 4 };
+  static inline void Store(uint8_t *dst, const __m256 in)
+  {
+    const __m256 mul = _mm256_set1_ps(AE_MUL32);
+    __m256i con = _mm256_cvtps_epi32(_mm256_mul_ps(in, mul));
+    if (swap)
+      con = _mm256_shuffle_epi8(con, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+    _mm256_storeu_si256((__m256i*)dst, con);
+  }
+};
+
+template<class F>
+static unsigned int AVX2_FrFloat(float *data, const unsigned int samples, uint8_t *dest)
+{
+  unsigned int i = 0;
+  for (; i + 8 <= samples; i += 8, dest += 8 * F::Bytes)
+    F::Store(dest, _mm256_loadu_ps(data + i));
+
+  if (i < samples)
+  {
+    const unsigned int count = samples - i;
+    MEMALIGN(32, float   in [8 ]);
+    MEMALIGN(32, uint8_t out[32]);
+    memset(in, 0, sizeof(in));
+    memcpy(in, data + i, count * sizeof(float));
+    F::Store(out, _mm256_load_ps(in));
+    memcpy(dest, out, count * F::Bytes);
+  }
+
+  return samples * F::Bytes;
+}
+
+CAEConvert::AEConvertToFn CAEConvert::ToFloatAVX2(enum AEDataFormat dataFormat)
+{
+  switch (dataFormat)
+  {
+    case AE_FMT_U8    : return &AVX2_ToFloat<AVX2_U8    >;
+    case AE_FMT_S8    : return &AVX2_ToFloat<AVX2_S8    >;
+    case AE_FMT_S16NE :
+    case AE_FMT_S16LE : return &AVX2_ToFloat<AVX2_S16LE >;
+    case AE_FMT_S16BE : return &AVX2_ToFloat<AVX2_S16BE >;
+    case AE_FMT_S24NE4:
+    case AE_FMT_S24LE4: return &AVX2_ToFloat<AVX2_S24LE4>;
+    case AE_FMT_S24BE4: return &AVX2_ToFloat<AVX2_S24BE4>;
+    case AE_FMT_S24NE3:
+    case AE_FMT_S24LE3: return &AVX2_ToFloat<AVX2_S24LE3>;
+    case AE_FMT_S24BE3: return &AVX2_ToFloat<AVX2_S24BE3>;
+    case AE_FMT_S32NE :
+    case AE_FMT_S32LE : return &AVX2_ToFloat<AVX2_S32LE >;
+    case AE_FMT_S32BE : return &AVX2_ToFloat<AVX2_S32BE >;
+    default:
+      return NULL;
+  }
+}
+
+CAEConvert::AEConvertFrFn CAEConvert::FrFloatAVX2(enum AEDataFormat dataFormat)
+{
+  switch (dataFormat)
+  {
+    case AE_FMT_U8    : return &AVX2_FrFloat<AVX2_FrU8        >;
+    case AE_FMT_S8    : return &AVX2_FrFloat<AVX2_FrS8        >;
+    case AE_FMT_S16NE :
+    case AE_FMT_S16LE : return &AVX2_FrFloat<AVX2_FrS16<false> >;
+    case AE_FMT_S16BE : return &AVX2_FrFloat<AVX2_FrS16<true > >;
+    case AE_FMT_S24NE4: return &AVX2_FrFloat<AVX2_FrS24NE4    >;
+    case AE_FMT_S24NE3: return &AVX2_FrFloat<AVX2_FrS24NE3    >;
+    case AE_FMT_S32NE :
+    case AE_FMT_S32LE : return &AVX2_FrFloat<AVX2_FrS32<false> >;
+    case AE_FMT_S32BE : return &AVX2_FrFloat<AVX2_FrS32<true > >;
+    default:
+      return NULL;
+  }
+}
+
+#else /* no AVX2 */
+
+CAEConvert::AEConvertToFn CAEConvert::ToFloatAVX2(enum AEDataFormat dataFormat)
+{
+  return NULL;
+}
+
+CAEConvert::AEConvertFrFn CAEConvert::FrFloatAVX2(enum AEDataFormat dataFormat)
+{
+  return NULL;
+}
+
+#endif
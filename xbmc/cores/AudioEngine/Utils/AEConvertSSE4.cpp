@@ -0,0 +1,373 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __STDC_LIMIT_MACROS
+  #define __STDC_LIMIT_MACROS
+#endif
+
+/*
+  This file is built with SSE4.1 code generation enabled, nothing in here may
+  be called unless CCPUInfo reports CPU_FEATURE_SSE4. The build defines
+  HAS_SSE4_KERNELS where it can compile the intrinsics.
+*/
+
+#include "AEConvert.h"
+#include "AEUtil.h"
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+
+#ifdef HAS_SSE4_KERNELS
+#include <smmintrin.h>
+
+#ifndef INT24_MAX
+#define INT24_MAX (0x7FFFFF)
+#endif
+
+#define AE_MUL32 ((float)(INT32_MAX - 127))
+
+/*
+  Every input format is described by a loader that sign extends four samples
+  into the upper bits of a 32bit lane and the scale that maps this to -1..1.
+  Reach is the number of bytes a single load touches, for packed 24bit data
+  this is more than the four samples occupy.
+*/
+struct SSE4_U8
+{
+  enum { Bytes = 1, Reach = 4 };
+  static inline float Scale () { return 2.0f / UINT8_MAX; }
+  static inline float Offset() { return -1.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    int32_t in;
+    memcpy(&in, src, sizeof(in));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(in));
+  }
+};
+
+struct SSE4_S8
+{
+  enum { Bytes = 1, Reach = 4 };
+  static inline float Scale () { return 1.0f / (INT8_MAX + 0.5f); }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    int32_t in;
+    memcpy(&in, src, sizeof(in));
+    return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(in));
+  }
+};
+
+struct SSE4_S16LE
+{
+  enum { Bytes = 2, Reach = 8 };
+  static inline float Scale () { return 1.0f / (INT16_MAX + 0.5f); }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    return _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)src));
+  }
+};
+
+struct SSE4_S16BE
+{
+  enum { Bytes = 2, Reach = 8 };
+  static inline float Scale () { return 1.0f / (INT16_MAX + 0.5f); }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1);
+    return _mm_cvtepi16_epi32(_mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)src), swap));
+  }
+};
+
+struct SSE4_S24LE4
+{
+  enum { Bytes = 4, Reach = 16 };
+  static inline float Scale () { return -1.0f / INT_MIN; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    return _mm_slli_epi32(_mm_loadu_si128((const __m128i*)src), 8);
+  }
+};
+
+struct SSE4_S24BE4
+{
+  enum { Bytes = 4, Reach = 16 };
+  static inline float Scale () { return -1.0f / INT_MIN; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    const __m128i swap = _mm_setr_epi8(-1, 2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), swap);
+  }
+};
+
+struct SSE4_S24LE3
+{
+  enum { Bytes = 3, Reach = 16 };
+  static inline float Scale () { return -1.0f / INT_MIN; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    const __m128i swap = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), swap);
+  }
+};
+
+struct SSE4_S24BE3
+{
+  enum { Bytes = 3, Reach = 16 };
+  static inline float Scale () { return -1.0f / INT_MIN; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    const __m128i swap = _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), swap);
+  }
+};
+
+struct SSE4_S32LE
+{
+  enum { Bytes = 4, Reach = 16 };
+  static inline float Scale () { return 1.0f / (float)INT32_MAX; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    return _mm_loadu_si128((const __m128i*)src);
+  }
+};
+
+struct SSE4_S32BE
+{
+  enum { Bytes = 4, Reach = 16 };
+  static inline float Scale () { return 1.0f / (float)INT32_MAX; }
+  static inline float Offset() { return 0.0f; }
+  static inline __m128i Load(const uint8_t *src)
+  {
+    const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), swap);
+  }
+};
+
+template<class F>
+static inline __m128 SSE4_ToFloat4(const uint8_t *src, const __m128 mul, const __m128 add)
+{
+  __m128 out = _mm_mul_ps(_mm_cvtepi32_ps(F::Load(src)), mul);
+  if (F::Offset() != 0.0f)
+    out = _mm_add_ps(out, add);
+  return out;
+}
+
+template<class F>
+static unsigned int SSE4_ToFloat(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set_ps1(F::Scale());
+  const __m128 add = _mm_set_ps1(F::Offset());
+  unsigned int i = 0;
+
+  for (; i + 4 <= samples && (samples - i) * F::Bytes >= (unsigned int)F::Reach; i += 4, data += 4 * F::Bytes)
+    _mm_storeu_ps(dest + i, SSE4_ToFloat4<F>(data, mul, add));
+
+  /* the remaining samples go through a padded copy so we never read past the input */
+  while (i < samples)
+  {
+    const unsigned int count = std::min(samples - i, 4U);
+    MEMALIGN(16, uint8_t in [16]);
+    MEMALIGN(16, float   out[4 ]);
+    memset(in, 0, sizeof(in));
+    memcpy(in, data, count * F::Bytes);
+    _mm_store_ps(out, SSE4_ToFloat4<F>(in, mul, add));
+    memcpy(dest + i, out, count * sizeof(float));
+    i    += count;
+    data += count * F::Bytes;
+  }
+
+  return samples;
+}
+
+/*
+  Output formats take four floats and write exactly 4 * Bytes bytes. Rounding
+  follows the SSE2 code in AEConvert.cpp. The 8 and 16 bit formats saturate
+  in the packs, the 24 and 32 bit ones expect the input within -1.0 to 1.0
+  like the C code does, out of range samples wrap.
+*/
+struct SSE4_FrU8
+{
+  enum { Bytes = 1 };
+  static inline void Store(uint8_t *dst, const __m128 in)
+  {
+    const __m128 mul = _mm_set_ps1((float)INT8_MAX + .5f);
+    const __m128 add = _mm_set_ps1(1.0f);
+    __m128i con = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(in, add), mul));
+    con = _mm_packus_epi16(_mm_packs_epi32(con, con), con);
+    int32_t out = _mm_cvtsi128_si32(con);
+    memcpy(dst, &out, sizeof(out));
+  }
+};
+
+struct SSE4_FrS8
+{
+  enum { Bytes = 1 };
+  static inline void Store(uint8_t *dst, const __m128 in)
+  {
+    const __m128 mul = _mm_set_ps1((float)INT8_MAX + .5f);
+    __m128i con = _mm_cvtps_epi32(_mm_mul_ps(in, mul));
+    con = _mm_packs_epi16(_mm_packs_epi32(con, con), con);
+    int32_t out = _mm_cvtsi128_si32(con);
+    memcpy(dst, &out, sizeof(out));
+  }
+};
+
+template<bool swap>
+struct SSE4_FrS16
+{
+  enum { Bytes = 2 };
+  static inline void Store(uint8_t *dst, const __m128 in)
+  {
+    const __m128 mul = _mm_set_ps1((float)INT16_MAX);
+    MEMALIGN(16, float rand[4]);
+
+    /* random round to dither */
+    CAEUtil::FloatRand4(-0.5f, 0.5f, rand);
+    __m128i con = _mm_cvtps_epi32(_mm_mul_ps(in, _mm_add_ps(mul, _mm_load_ps(rand))));
+    con = _mm_packs_epi32(con, con);
+    if (swap)
+      con = _mm_shuffle_epi8(con, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+    _mm_storel_epi64((__m128i*)dst, con);
+  }
+};
+
+struct SSE4_FrS24NE4
+{
+  enum { Bytes = 4 };
+  static inline void Store(uint8_t *dst, const __m128 in)
+  {
+    const __m128 mul = _mm_set_ps1((float)INT24_MAX + .5f);
+    __m128i con = _mm_cvtps_epi32(_mm_mul_ps(in, mul));
+    _mm_storeu_si128((__m128i*)dst, _mm_slli_epi32(con, 8));
+  }
+};
+
+struct SSE4_FrS24NE3
+{
+  enum { Bytes = 3 };
+  static inline void Store(uint8_t *dst, const __m128 in)
+  {
+    const __m128 mul  = _mm_set_ps1((float)INT24_MAX + .5f);
+    const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    __m128i con = _mm_shuffle_epi8(_mm_cvtps_epi32(_mm_mul_ps(in, mul)), pack);
+    int32_t tail = _mm_extract_epi32(con, 2);
+    _mm_storel_epi64((__m128i*)dst, con);
+    memcpy(dst + 8, &tail, sizeof(tail));
+  }
+};
+
+template<bool swap>
+struct SSE4_FrS32
+{
+  enum { Bytes = 4 };
+  static inline void Store(uint8_t *dst, const __m128 in)
+  {
+    const __m128 mul = _mm_set_ps1(AE_MUL32);
+    __m128i con = _mm_cvtps_epi32(_mm_mul_ps(in, mul));
+    if (swap)
+      con = _mm_shuffle_epi8(con, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+    _mm_storeu_si128((__m128i*)dst, con);
+  }
+};
+
+template<class F>
+static unsigned int SSE4_FrFloat(float *data, const unsigned int samples, uint8_t *dest)
+{
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, dest += 4 * F::Bytes)
+    F::Store(dest, _mm_loadu_ps(data + i));
+
+  if (i < samples)
+  {
+    const unsigned int count = samples - i;
+    MEMALIGN(16, float   in [4 ]);
+    MEMALIGN(16, uint8_t out[16]);
+    memset(in, 0, sizeof(in));
+    memcpy(in, data + i, count * sizeof(float));
+    F::Store(out, _mm_load_ps(in));
+    memcpy(dest, out, count * F::Bytes);
+  }
+
+  return samples * F::Bytes;
+}
+
+CAEConvert::AEConvertToFn CAEConvert::ToFloatSSE4(enum AEDataFormat dataFormat)
+{
+  switch (dataFormat)
+  {
+    case AE_FMT_U8    : return &SSE4_ToFloat<SSE4_U8    >;
+    case AE_FMT_S8    : return &SSE4_ToFloat<SSE4_S8    >;
+    case AE_FMT_S16NE :
+    case AE_FMT_S16LE : return &SSE4_ToFloat<SSE4_S16LE >;
+    case AE_FMT_S16BE : return &SSE4_ToFloat<SSE4_S16BE >;
+    case AE_FMT_S24NE4:
+    case AE_FMT_S24LE4: return &SSE4_ToFloat<SSE4_S24LE4>;
+    case AE_FMT_S24BE4: return &SSE4_ToFloat<SSE4_S24BE4>;
+    case AE_FMT_S24NE3:
+    case AE_FMT_S24LE3: return &SSE4_ToFloat<SSE4_S24LE3>;
+    case AE_FMT_S24BE3: return &SSE4_ToFloat<SSE4_S24BE3>;
+    case AE_FMT_S32NE :
+    case AE_FMT_S32LE : return &SSE4_ToFloat<SSE4_S32LE >;
+    case AE_FMT_S32BE : return &SSE4_ToFloat<SSE4_S32BE >;
+    default:
+      return NULL;
+  }
+}
+
+CAEConvert::AEConvertFrFn CAEConvert::FrFloatSSE4(enum AEDataFormat dataFormat)
+{
+  switch (dataFormat)
+  {
+    case AE_FMT_U8    : return &SSE4_FrFloat<SSE4_FrU8        >;
+    case AE_FMT_S8    : return &SSE4_FrFloat<SSE4_FrS8        >;
+    case AE_FMT_S16NE :
+    case AE_FMT_S16LE : return &SSE4_FrFloat<SSE4_FrS16<false> >;
+    case AE_FMT_S16BE : return &SSE4_FrFloat<SSE4_FrS16<true > >;
+    case AE_FMT_S24NE4: return &SSE4_FrFloat<SSE4_FrS24NE4    >;
+    case AE_FMT_S24NE3: return &SSE4_FrFloat<SSE4_FrS24NE3    >;
+    case AE_FMT_S32NE :
+    case AE_FMT_S32LE : return &SSE4_FrFloat<SSE4_FrS32<false> >;
+    case AE_FMT_S32BE : return &SSE4_FrFloat<SSE4_FrS32<true > >;
+    default:
+      return NULL;
+  }
+}
+
+#else /* no SSE4.1 */
+
+CAEConvert::AEConvertToFn CAEConvert::ToFloatSSE4(enum AEDataFormat dataFormat)
+{
+  return NULL;
+}
+
+CAEConvert::AEConvertFrFn CAEConvert::FrFloatSSE4(enum AEDataFormat dataFormat)
+{
+  return NULL;
+}
+
+#endif
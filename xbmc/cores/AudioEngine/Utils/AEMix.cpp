@@ -0,0 +1,196 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEMix.h"
+#include "AEUtil.h"
+
+#include <algorithm>
+#include <math.h>
+
+/* samples whose gains are computed ahead of scaling them */
+#define GAIN_CHUNK 256
+
+/*
+  All paths compute dst = src * gain or dst = dst + (src * gain), rounding
+  after the multiply and after the add, so the result is the same bit for
+  bit as the former per frame SSEMulArray / SSEMulAddArray calls.
+*/
+bool CAEMix::MixConstant(float *dst, const float *src, float gain, int count, bool accumulate)
+{
+  bool clip = false;
+  int i = 0;
+
+#ifdef __SSE__
+  const __m128 g = _mm_set_ps1(gain);
+  if (accumulate)
+  {
+    // track the peaks, one compare per call instead of one per sample
+    __m128 hi = _mm_setzero_ps();
+    __m128 lo = _mm_setzero_ps();
+    for (; i + 8 <= count; i += 8)
+    {
+      __m128 d0 = _mm_add_ps(_mm_loadu_ps(dst + i    ), _mm_mul_ps(_mm_loadu_ps(src + i    ), g));
+      __m128 d1 = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+      _mm_storeu_ps(dst + i    , d0);
+      _mm_storeu_ps(dst + i + 4, d1);
+      hi = _mm_max_ps(hi, _mm_max_ps(d0, d1));
+      lo = _mm_min_ps(lo, _mm_min_ps(d0, d1));
+    }
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128 d = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g));
+      _mm_storeu_ps(dst + i, d);
+      hi = _mm_max_ps(hi, d);
+      lo = _mm_min_ps(lo, d);
+    }
+    __m128 over = _mm_or_ps(_mm_cmpgt_ps(hi, _mm_set_ps1(1.0f)), _mm_cmplt_ps(lo, _mm_set_ps1(-1.0f)));
+    clip = _mm_movemask_ps(over) != 0;
+  }
+  else
+  {
+    for (; i + 8 <= count; i += 8)
+    {
+      _mm_storeu_ps(dst + i    , _mm_mul_ps(_mm_loadu_ps(src + i    ), g));
+      _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+    }
+    for (; i + 4 <= count; i += 4)
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+  }
+#endif
+
+  if (accumulate)
+  {
+    for (; i < count; ++i)
+    {
+      dst[i] += src[i] * gain;
+      if (fabs(dst[i]) > 1.0f)
+        clip = true;
+    }
+  }
+  else
+  {
+    for (; i < count; ++i)
+      dst[i] = src[i] * gain;
+  }
+
+  return clip;
+}
+
+bool CAEMix::MixGains(float *dst, const float *src, const float *gains, int count, bool accumulate)
+{
+  bool clip = false;
+  int i = 0;
+
+#ifdef __SSE__
+  if (accumulate)
+  {
+    __m128 hi = _mm_setzero_ps();
+    __m128 lo = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128 d = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(gains + i)));
+      _mm_storeu_ps(dst + i, d);
+      hi = _mm_max_ps(hi, d);
+      lo = _mm_min_ps(lo, d);
+    }
+    __m128 over = _mm_or_ps(_mm_cmpgt_ps(hi, _mm_set_ps1(1.0f)), _mm_cmplt_ps(lo, _mm_set_ps1(-1.0f)));
+    clip = _mm_movemask_ps(over) != 0;
+  }
+  else
+  {
+    for (; i + 4 <= count; i += 4)
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(gains + i)));
+  }
+#endif
+
+  if (accumulate)
+  {
+    for (; i < count; ++i)
+    {
+      dst[i] += src[i] * gains[i];
+      if (fabs(dst[i]) > 1.0f)
+        clip = true;
+    }
+  }
+  else
+  {
+    for (; i < count; ++i)
+      dst[i] = src[i] * gains[i];
+  }
+
+  return clip;
+}
+
+bool CAEMix::Mix(float **dst, float **src, int planes, int channels, int frames,
+                 bool accumulate, AEMixGain &gain)
+{
+  const int floatsPerFrame = channels / planes;
+  bool clip = false;
+
+  // constant gain, one pass over each plane
+  if (!gain.perSample && gain.fadingSamples <= 0)
+  {
+    float volume = gain.volume * gain.rgain;
+    for (int j = 0; j < planes; ++j)
+      clip |= MixConstant(dst[j], src[j], volume, frames * floatsPerFrame, accumulate);
+    return clip;
+  }
+
+  // the limiter works on whole frames, a single frame was never limited
+  const bool limit = frames > 1;
+
+  // one gain per sample of a chunk, interleaved frames repeat theirs for
+  // every channel so the chunk is mixed in one pass like a plane
+  const int chunk = std::max(1, GAIN_CHUNK / floatsPerFrame);
+  float gains[GAIN_CHUNK];
+
+  for (int start = 0; start < frames; start += chunk)
+  {
+    int count = std::min(chunk, frames - start);
+
+    // gains of the chunk first, the limiter has to see the unscaled frames
+    for (int i = 0; i < count; ++i)
+    {
+      if (gain.fadingSamples > 0)
+      {
+        gain.volume += gain.fadingStep;
+        gain.fadingSamples--;
+      }
+
+      float volume = gain.volume * gain.rgain;
+      if (limit)
+        volume *= gain.limiter->Run(src, channels, (start + i) * floatsPerFrame, planes > 1);
+      for (int c = 0; c < floatsPerFrame; ++c)
+        gains[i * floatsPerFrame + c] = volume;
+    }
+
+    for (int j = 0; j < planes; ++j)
+      clip |= MixGains(dst[j] + start * floatsPerFrame, src[j] + start * floatsPerFrame,
+                       gains, count * floatsPerFrame, accumulate);
+  }
+
+  return clip;
+}
+
+void CAEMix::Clamp(float **data, int planes, int channels, int frames)
+{
+  for (int j = 0; j < planes; ++j)
+    CAEUtil::ClampArray(data[j], frames * channels / planes);
+}
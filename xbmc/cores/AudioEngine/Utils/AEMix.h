@@ -0,0 +1,56 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AELimiter.h"
+
+/**
+ * Gain state of one stream in the mix, the kernel updates volume and
+ * fadingSamples as it walks the frames.
+ */
+struct AEMixGain
+{
+  float       volume;         // fader volume, stepped per frame while fading
+  float       rgain;          // replay gain
+  int         fadingSamples;  // frames left to fade
+  float       fadingStep;     // volume change per frame
+  bool        perSample;      // gain changes per frame, limiter is run
+  CAELimiter *limiter;
+};
+
+class CAEMix
+{
+public:
+  /**
+   * Applies fade, replay gain, volume and limiter to frames of float
+   * samples and either stores the result into dst (accumulate = false,
+   * dst may be src) or adds it to dst. Returns true if an accumulated
+   * sample left the [-1, 1] range and the mix needs clamping.
+   */
+  static bool Mix(float **dst, float **src, int planes, int channels, int frames,
+                  bool accumulate, AEMixGain &gain);
+
+  /* soft clamps every plane of a finished mix */
+  static void Clamp(float **data, int planes, int channels, int frames);
+
+private:
+  static bool MixConstant(float *dst, const float *src, float gain, int count, bool accumulate);
+  static bool MixGains(float *dst, const float *src, const float *gains, int count, bool accumulate);
+};
@@ -28,9 +28,10 @@
 
 using namespace std;
 
-CAERemap::CAERemap() : m_inChannels(0), m_outChannels(0) 
+CAERemap::CAERemap() : m_inChannels(0), m_outChannels(0), m_isReorder(false), m_isIdentity(false), m_mixFn(NULL)
 {
   memset(m_mixInfo, 0, sizeof(m_mixInfo));
+  memset(m_matrix , 0, sizeof(m_matrix ));
   m_bAudio2 = false;
 }
 
@@ -88,7 +89,10 @@ bool CAERemap::Initialize(CAEChannelInfo input, CAEChannelInfo output, bool fina
 
   /* the final stage does not need any down/upmix */
   if (finalStage)
+  {
+    CompileMatrix();
     return true;
+  }
 
   /* downmix from the specified channel to the specified list of channels */
   #define RM(from, ...) \
@@ -253,6 +257,7 @@ bool CAERemap::Initialize(CAEChannelInfo input, CAEChannelInfo output, bool fina
   CLog::Log(LOGINFO, "====================\n");
 #endif
 
+  CompileMatrix();
   return true;
 }
 
@@ -293,8 +298,125 @@ void CAERemap::ResolveMix(const AEChannel from, CAEChannelInfo to)
   fromInfo->in_src   = false;
 }
 
-/* This method has unrolled loop for higher performance */
+/* out[o] = sum(in[i] * matrix[i][o]) for a single frame */
+template<int InCh, int OutCh>
+static inline void MixFrame(const float (*matrix)[AE_CH_MAX], const float *in, float *out)
+{
+  for (int o = 0; o < OutCh; ++o)
+  {
+    float sum = 0.0f;
+    for (int i = 0; i < InCh; ++i)
+      sum += in[i] * matrix[i][o];
+    out[o] = sum;
+  }
+}
+
+/*
+  Dense mix for a fixed channel count, the compiler fully unrolls these.
+  The SSE version keeps one column of the matrix per input channel in
+  registers and accumulates a whole output frame at once.
+*/
+template<int InCh, int OutCh>
+static void MixFixed(const float (*matrix)[AE_CH_MAX], const float *in, float *out, const unsigned int frames)
+{
+  unsigned int f = 0;
+
+#ifdef __SSE__
+  enum { VECS = (OutCh + 3) / 4 };
+  __m128 col[InCh][VECS];
+  for (int i = 0; i < InCh; ++i)
+    for (int v = 0; v < VECS; ++v)
+      col[i][v] = _mm_loadu_ps(&matrix[i][v * 4]);
+
+  /* full vector stores spill into the next frame, which gets overwritten right after */
+  for (; (frames - f) * OutCh >= VECS * 4; ++f, in += InCh, out += OutCh)
+  {
+    __m128 acc[VECS];
+    for (int v = 0; v < VECS; ++v)
+      acc[v] = _mm_setzero_ps();
+
+    for (int i = 0; i < InCh; ++i)
+    {
+      const __m128 s = _mm_load1_ps(in + i);
+      for (int v = 0; v < VECS; ++v)
+        acc[v] = _mm_add_ps(acc[v], _mm_mul_ps(s, col[i][v]));
+    }
+
+    for (int v = 0; v < VECS; ++v)
+      _mm_storeu_ps(out + v * 4, acc[v]);
+  }
+#endif
+
+  for (; f < frames; ++f, in += InCh, out += OutCh)
+    MixFrame<InCh, OutCh>(matrix, in, out);
+}
+
+void CAERemap::CompileMatrix()
+{
+  memset(m_matrix, 0, sizeof(m_matrix));
+  m_isReorder  = true;
+  m_isIdentity = m_inChannels == m_outChannels;
+  m_mixFn      = NULL;
+
+  for (int o = 0; o < m_outChannels; ++o)
+  {
+    const AEMixInfo *info = &m_mixInfo[m_output[o]];
+    m_reorder[o] = -1;
+    if (!info->in_dst || info->srcCount == 0)
+    {
+      m_isIdentity = false;
+      continue;
+    }
+
+    /* a single source is copied as is, see RemapGeneric */
+    if (info->srcCount == 1)
+    {
+      m_reorder[o] = info->srcIndex[0].index;
+      m_matrix[m_reorder[o]][o] = 1.0f;
+      if (m_reorder[o] != o)
+        m_isIdentity = false;
+      continue;
+    }
+
+    m_isReorder  = false;
+    m_isIdentity = false;
+    for (int i = 0; i < info->srcCount; ++i)
+      m_matrix[info->srcIndex[i].index][o] += info->srcIndex[i].level;
+  }
+
+  if (m_isReorder)
+    return;
+
+  /* specialized kernels for the common layouts, everything else takes the generic path */
+  if      (m_inChannels == 2 && m_outChannels == 6) m_mixFn = &MixFixed<2, 6>; /* 2.0 -> 5.1 */
+  else if (m_inChannels == 6 && m_outChannels == 2) m_mixFn = &MixFixed<6, 2>; /* 5.1 -> 2.0 */
+  else if (m_inChannels == 8 && m_outChannels == 6) m_mixFn = &MixFixed<8, 6>; /* 7.1 -> 5.1 */
+  else if (m_inChannels == 8 && m_outChannels == 2) m_mixFn = &MixFixed<8, 2>; /* 7.1 -> 2.0 */
+}
+
 void CAERemap::Remap(float * const in, float * const out, const unsigned int frames) const
+{
+  if (m_isIdentity)
+  {
+    if (in != out)
+      memcpy(out, in, frames * m_outChannels * sizeof(float));
+  }
+  else if (m_isReorder)
+  {
+    const float *src = in;
+    float       *dst = out;
+    for (unsigned int f = 0; f < frames; ++f, src += m_inChannels, dst += m_outChannels)
+      for (int o = 0; o < m_outChannels; ++o)
+        dst[o] = m_reorder[o] < 0 ? 0.0f : src[m_reorder[o]];
+  }
+  else if (m_mixFn)
+    m_mixFn(m_matrix, in, out, frames);
+  else
+    RemapGeneric(in, out, frames);
+}
+
+/* This method has unrolled loop for higher performance */
+void CAERemap::RemapGeneric(float * const in, float * const out, const unsigned int frames) const
 {
   const unsigned int frameBlocks = frames & ~0x3;
 
@@ -45,13 +45,24 @@ private:
     int               cpyCount; /* the number of times the channel has been cloned */
   } AEMixInfo;
 
+  typedef void (*MixFn)(const float (*matrix)[AE_CH_MAX], const float *in, float *out, const unsigned int frames);
+
   AEMixInfo      m_mixInfo[AE_CH_MAX+1];
   CAEChannelInfo m_output;
   int            m_inChannels;
   int            m_outChannels;
 
+  /* the mix compiled into a dense [input][output] coefficient matrix */
+  float          m_matrix[AE_CH_MAX][AE_CH_MAX];
+  int            m_reorder[AE_CH_MAX]; /* source index per output, -1 for silence */
+  bool           m_isReorder;
+  bool           m_isIdentity;
+  MixFn          m_mixFn;
+
   void ResolveMix(const AEChannel from, CAEChannelInfo to);
   void BuildUpmixMatrix(const CAEChannelInfo& input, const CAEChannelInfo& output);
+  void CompileMatrix();
+  void RemapGeneric(float * const in, float * const out, const unsigned int frames) const;
 
   bool           m_bAudio2;
 };
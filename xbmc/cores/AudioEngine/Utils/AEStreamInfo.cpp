@@ -19,6 +19,7 @@
  */
 
 #include "AEStreamInfo.h"
+#include "AESyncScan.h"
 
 #define IEC61937_PREAMBLE1 0xF872
 #define IEC61937_PREAMBLE2 0x4E1F
@@ -241,6 +242,17 @@ unsigned int CAEStreamInfo::DetectType(uint8_t *data, unsigned int size)
 
   while (size > 8)
   {
+    /* jump to the next position that could hold a sync word */
+    unsigned int next = CAESyncScan::Find(data, size, CAESyncScan::SYNC_ALL);
+    if (next >= size - 8)
+    {
+      skipped += size - 8;
+      break;
+    }
+    size    -= next;
+    skipped += next;
+    data    += next;
+
     /* if it could be DTS */
     unsigned int header = data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
     if (header == DTS_PREAMBLE_14LE ||
@@ -297,8 +309,14 @@ unsigned int CAEStreamInfo::SyncAC3(uint8_t *data, unsigned int size)
   for (; size - skip > 7; ++skip, ++data)
   {
     /* search for an ac3 sync word */
-    if (data[0] != 0x0b || data[1] != 0x77)
-      continue;
+    unsigned int next = CAESyncScan::Find(data, size - skip - 6, CAESyncScan::SYNC_AC3);
+    if (next == size - skip - 6)
+    {
+      skip = size - 7;
+      break;
+    }
+    skip += next;
+    data += next;
 
     uint8_t bsid  = data[5] >> 3;
     uint8_t acmod = data[6] >> 5;
@@ -454,6 +472,16 @@ unsigned int CAEStreamInfo::SyncDTS(uint8_t *data, unsigned int size)
   unsigned int skip = 0;
   for (; size - skip > 13; ++skip, ++data)
   {
+    /* search for a dts preamble */
+    unsigned int next = CAESyncScan::Find(data, size - skip - 12, CAESyncScan::SYNC_DTS);
+    if (next == size - skip - 12)
+    {
+      skip = size - 13;
+      break;
+    }
+    skip += next;
+    data += next;
+
     unsigned int header = data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
     unsigned int hd_sync = 0;
     bool match = true;
@@ -653,6 +681,17 @@ unsigned int CAEStreamInfo::SyncTrueHD(uint8_t *data, unsigned int size)
     if (!m_hasSync && left < 8)
       return size;
 
+    /* without sync only a major audio unit will do, jump to the next one */
+    if (!m_hasSync)
+    {
+      unsigned int next = CAESyncScan::Find(data, left - 2, CAESyncScan::SYNC_TRUEHD);
+      if (next == left - 2)
+        return size;
+      skip += next;
+      data += next;
+      left -= next;
+    }
+
     /* if its a major audio unit */
     uint16_t length   = ((data[0] & 0x0F) << 8 | data[1]) << 1;
     uint32_t syncword = ((((data[4] << 8 | data[5]) << 8) | data[6]) << 8) | data[7];
@@ -0,0 +1,155 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AESyncScan.h"
+#include "AEUtil.h"
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#if defined(TARGET_WINDOWS) && defined(__SSE2__)
+#include <intrin.h>
+#endif
+
+/* leading byte pairs of the DTS preambles: 14bit BE, 14bit LE, 16bit BE, 16bit LE */
+static const uint8_t DTSPairs[4][2] = { {0x1F, 0xFF}, {0xFF, 0x1F}, {0x7F, 0xFE}, {0xFE, 0x7F} };
+
+/* distance of the TrueHD major sync from the start of the unit */
+#define TRUEHD_SYNC_OFFSET 4
+
+static inline bool IsCandidate(const uint8_t *data, unsigned int pos, unsigned int size, int types)
+{
+  const uint8_t *p = data + pos;
+  if ((types & CAESyncScan::SYNC_AC3) && p[0] == 0x0B && p[1] == 0x77)
+    return true;
+
+  if (types & CAESyncScan::SYNC_DTS)
+  {
+    for (int i = 0; i < 4; ++i)
+      if (p[0] == DTSPairs[i][0] && p[1] == DTSPairs[i][1])
+        return true;
+  }
+
+  if ((types & CAESyncScan::SYNC_TRUEHD) && pos + TRUEHD_SYNC_OFFSET + 1 < size &&
+      p[TRUEHD_SYNC_OFFSET] == 0xF8 && p[TRUEHD_SYNC_OFFSET + 1] == 0x72)
+    return true;
+
+  return false;
+}
+
+#ifdef __SSE2__
+static inline unsigned int FirstBit(int mask)
+{
+#ifdef TARGET_WINDOWS
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+unsigned int CAESyncScan::Find(const uint8_t *data, unsigned int size, int types)
+{
+  unsigned int i = 0;
+
+  // the vector loop reads this far past the 16 positions it tests
+  const unsigned int ahead = (types & SYNC_TRUEHD) ? TRUEHD_SYNC_OFFSET + 1 : 1;
+
+#if defined(__SSE2__)
+  const __m128i ac3a = _mm_set1_epi8((char)0x0B), ac3b = _mm_set1_epi8((char)0x77);
+  const __m128i thda = _mm_set1_epi8((char)0xF8), thdb = _mm_set1_epi8((char)0x72);
+  __m128i dtsa[4], dtsb[4];
+  for (int d = 0; d < 4; ++d)
+  {
+    dtsa[d] = _mm_set1_epi8((char)DTSPairs[d][0]);
+    dtsb[d] = _mm_set1_epi8((char)DTSPairs[d][1]);
+  }
+
+  for (; i + 16 + ahead <= size; i += 16)
+  {
+    __m128i b0  = _mm_loadu_si128((const __m128i*)(data + i));
+    __m128i b1  = _mm_loadu_si128((const __m128i*)(data + i + 1));
+    __m128i hit = _mm_setzero_si128();
+
+    if (types & SYNC_AC3)
+      hit = _mm_and_si128(_mm_cmpeq_epi8(b0, ac3a), _mm_cmpeq_epi8(b1, ac3b));
+
+    if (types & SYNC_DTS)
+    {
+      for (int d = 0; d < 4; ++d)
+        hit = _mm_or_si128(hit, _mm_and_si128(_mm_cmpeq_epi8(b0, dtsa[d]), _mm_cmpeq_epi8(b1, dtsb[d])));
+    }
+
+    if (types & SYNC_TRUEHD)
+    {
+      __m128i b4 = _mm_loadu_si128((const __m128i*)(data + i + TRUEHD_SYNC_OFFSET));
+      __m128i b5 = _mm_loadu_si128((const __m128i*)(data + i + TRUEHD_SYNC_OFFSET + 1));
+      hit = _mm_or_si128(hit, _mm_and_si128(_mm_cmpeq_epi8(b4, thda), _mm_cmpeq_epi8(b5, thdb)));
+    }
+
+    int mask = _mm_movemask_epi8(hit);
+    if (mask)
+      return i + FirstBit(mask);
+  }
+#elif defined(__ARM_NEON__)
+  const uint8x16_t ac3a = vdupq_n_u8(0x0B), ac3b = vdupq_n_u8(0x77);
+  const uint8x16_t thda = vdupq_n_u8(0xF8), thdb = vdupq_n_u8(0x72);
+
+  for (; i + 16 + ahead <= size; i += 16)
+  {
+    uint8x16_t b0  = vld1q_u8(data + i);
+    uint8x16_t b1  = vld1q_u8(data + i + 1);
+    uint8x16_t hit = vdupq_n_u8(0);
+
+    if (types & SYNC_AC3)
+      hit = vandq_u8(vceqq_u8(b0, ac3a), vceqq_u8(b1, ac3b));
+
+    if (types & SYNC_DTS)
+    {
+      for (int d = 0; d < 4; ++d)
+        hit = vorrq_u8(hit, vandq_u8(vceqq_u8(b0, vdupq_n_u8(DTSPairs[d][0])),
+                                     vceqq_u8(b1, vdupq_n_u8(DTSPairs[d][1]))));
+    }
+
+    if (types & SYNC_TRUEHD)
+    {
+      uint8x16_t b4 = vld1q_u8(data + i + TRUEHD_SYNC_OFFSET);
+      uint8x16_t b5 = vld1q_u8(data + i + TRUEHD_SYNC_OFFSET + 1);
+      hit = vorrq_u8(hit, vandq_u8(vceqq_u8(b4, thda), vceqq_u8(b5, thdb)));
+    }
+
+    // no movemask on NEON, the scalar loop below finds the lane
+    uint64x2_t lanes = vreinterpretq_u64_u8(hit);
+    if (vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1))
+      break;
+  }
+#endif
+
+  for (; i + 1 < size; ++i)
+  {
+    if (IsCandidate(data, i, size, types))
+      return i;
+  }
+
+  return size;
+}
@@ -0,0 +1,45 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+
+/**
+ * Search for the sync words of compressed audio, 16 bytes at a time where
+ * SSE2 or NEON is available. A candidate is a position where the first two
+ * bytes of a sync word match, the parsers still have to validate it.
+ */
+class CAESyncScan
+{
+public:
+  enum
+  {
+    SYNC_AC3    = 0x01,  // 0B 77 at the position
+    SYNC_DTS    = 0x02,  // first half of one of the four DTS preambles
+    SYNC_TRUEHD = 0x04,  // F8 72 four bytes after the position, major sync of a MLP unit
+    SYNC_ALL    = SYNC_AC3 | SYNC_DTS | SYNC_TRUEHD
+  };
+
+  /**
+   * Returns the first position of a candidate of the given types whose
+   * matched bytes all lie within size, or size if there is none.
+   */
+  static unsigned int Find(const uint8_t *data, unsigned int size, int types);
+};
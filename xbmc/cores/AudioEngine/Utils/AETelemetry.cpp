@@ -0,0 +1,156 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AETelemetry.h"
+#include "threads/Atomics.h"
+#include "utils/log.h"
+#include "utils/TimeUtils.h"
+
+#include <string.h>
+
+CAETelemetry::CAETelemetry()
+{
+  Reset();
+}
+
+void CAETelemetry::Reset()
+{
+  memset((void*)m_stages, 0, sizeof(m_stages));
+  memset((void*)m_counters, 0, sizeof(m_counters));
+}
+
+void CAETelemetry::AddTime(AETelemetryStage stage, int64_t micros)
+{
+  Stage &s = m_stages[stage];
+  long value = micros < 0 ? 0 : (micros > 0x7fffffff ? 0x7fffffff : (long)micros);
+
+  int bucket = 0;
+  while (bucket < AE_TELEMETRY_BUCKETS - 1 && (value >> bucket))
+    bucket++;
+
+  AtomicIncrement(&s.buckets[bucket]);
+
+  // cas2 is not there on every platform, the total is kept in two longs.
+  // a snapshot taken between the two adds is off by a carry at most
+  AtomicAdd(&s.seconds, value / 1000000);
+  if (AtomicAdd(&s.micros, value % 1000000) >= 1000000)
+  {
+    AtomicSubtract(&s.micros, 1000000);
+    AtomicIncrement(&s.seconds);
+  }
+
+  long max = s.max;
+  while (value > max)
+  {
+    long old = cas(&s.max, max, value);
+    if (old == max)
+      break;
+    max = old;
+  }
+}
+
+void CAETelemetry::AddTicks(AETelemetryStage stage, int64_t ticks)
+{
+  AddTime(stage, ticks * 1000000 / CurrentHostFrequency());
+}
+
+void CAETelemetry::Count(AETelemetryCounter counter)
+{
+  AtomicIncrement(&m_counters[counter]);
+}
+
+void CAETelemetry::GetSnapshot(AETelemetrySnapshot &snapshot) const
+{
+  for (int i = 0; i < AE_TELEMETRY_STAGES; i++)
+  {
+    const Stage &s = m_stages[i];
+    AETelemetryStageStats &stats = snapshot.stages[i];
+
+    unsigned int count = 0;
+    for (int b = 0; b < AE_TELEMETRY_BUCKETS; b++)
+    {
+      stats.buckets[b] = s.buckets[b];
+      count += stats.buckets[b];
+    }
+    stats.count = count;
+    stats.max = s.max;
+    stats.mean = count ? ((double)s.seconds * 1000000 + s.micros) / count : 0.0;
+
+    // percentiles to the resolution of the buckets
+    stats.p50 = stats.p99 = 0;
+    unsigned int sum = 0;
+    for (int b = 0; b < AE_TELEMETRY_BUCKETS && count; b++)
+    {
+      unsigned int upper = b < AE_TELEMETRY_BUCKETS - 1 ? (1u << b) : stats.max;
+      sum += stats.buckets[b];
+      if (!stats.p50 && sum * 2 >= count)
+        stats.p50 = upper;
+      if (!stats.p99 && sum * 100 >= count * 99)
+        stats.p99 = upper;
+    }
+  }
+
+  for (int i = 0; i < AE_TELEMETRY_COUNTERS; i++)
+    snapshot.counters[i] = m_counters[i];
+}
+
+void CAETelemetry::Log(int loglevel, const char *name) const
+{
+  AETelemetrySnapshot snapshot;
+  GetSnapshot(snapshot);
+
+  for (int i = 0; i < AE_TELEMETRY_STAGES; i++)
+  {
+    const AETelemetryStageStats &stats = snapshot.stages[i];
+    if (!stats.count)
+      continue;
+    CLog::Log(loglevel, "%s - %-10s count: %u mean: %.0fus p50: <%uus p99: <%uus max: %uus",
+              name, StageName((AETelemetryStage)i), stats.count, stats.mean, stats.p50, stats.p99, stats.max);
+  }
+  CLog::Log(loglevel, "%s - %s: %u %s: %u %s: %u", name,
+            CounterName(AE_TELEMETRY_UNDERRUNS), snapshot.counters[AE_TELEMETRY_UNDERRUNS],
+            CounterName(AE_TELEMETRY_LATE), snapshot.counters[AE_TELEMETRY_LATE],
+            CounterName(AE_TELEMETRY_REOPENS), snapshot.counters[AE_TELEMETRY_REOPENS]);
+}
+
+const char *CAETelemetry::StageName(AETelemetryStage stage)
+{
+  switch (stage)
+  {
+    case AE_TELEMETRY_RESAMPLE:   return "resample";
+    case AE_TELEMETRY_MIX:        return "mix";
+    case AE_TELEMETRY_ENCODE:     return "encode";
+    case AE_TELEMETRY_CYCLE:      return "cycle";
+    case AE_TELEMETRY_SINK_WRITE: return "sinkwrite";
+    case AE_TELEMETRY_SINK_DELAY: return "sinkdelay";
+    default:                      return "unknown";
+  }
+}
+
+const char *CAETelemetry::CounterName(AETelemetryCounter counter)
+{
+  switch (counter)
+  {
+    case AE_TELEMETRY_UNDERRUNS: return "underruns";
+    case AE_TELEMETRY_LATE:      return "latebuffers";
+    case AE_TELEMETRY_REOPENS:   return "sinkreopens";
+    default:                     return "unknown";
+  }
+}
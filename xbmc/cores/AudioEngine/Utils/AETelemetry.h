@@ -0,0 +1,96 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+
+enum AETelemetryStage
+{
+  AE_TELEMETRY_RESAMPLE = 0,  // engine: resampling of all streams
+  AE_TELEMETRY_MIX,           // engine: mix, gui sounds and viz
+  AE_TELEMETRY_ENCODE,        // engine: transcoding
+  AE_TELEMETRY_CYCLE,         // engine: whole RunStages pass that moved data, internal, not in json-rpc
+  AE_TELEMETRY_SINK_WRITE,    // sink: conversion and AddPackets or LendBuffer/CommitBuffer
+  AE_TELEMETRY_SINK_DELAY,    // sink: delay reported after a write
+  AE_TELEMETRY_STAGES
+};
+
+enum AETelemetryCounter
+{
+  AE_TELEMETRY_UNDERRUNS = 0, // sink played silence while a stream was playing
+  AE_TELEMETRY_LATE,          // buffer reached the sink after its queue ran dry
+  AE_TELEMETRY_REOPENS,       // sink opened again after the first open
+  AE_TELEMETRY_COUNTERS
+};
+
+/* bucket n counts values from 2^(n-1) to below 2^n microseconds, the last one everything above */
+#define AE_TELEMETRY_BUCKETS 22
+
+struct AETelemetryStageStats
+{
+  unsigned int count;
+  unsigned int max;             // us
+  unsigned int p50;             // us, upper bound of the bucket
+  unsigned int p99;             // us, upper bound of the bucket
+  double       mean;            // us
+  unsigned int buckets[AE_TELEMETRY_BUCKETS];
+};
+
+struct AETelemetrySnapshot
+{
+  AETelemetryStageStats stages[AE_TELEMETRY_STAGES];
+  unsigned int counters[AE_TELEMETRY_COUNTERS];
+};
+
+/**
+ * Timing histograms and event counters of the audio engine and its sink.
+ * Writers never block: bucket, total and counter updates are atomic, so
+ * the engine and the sink thread can record into the same block. Readers
+ * take a snapshot at any time, values of a snapshot may be a few events
+ * apart from each other.
+ */
+class CAETelemetry
+{
+public:
+  CAETelemetry();
+  void Reset();
+  void AddTime(AETelemetryStage stage, int64_t micros);
+  void AddTicks(AETelemetryStage stage, int64_t ticks);  // CurrentHostCounter() ticks
+  void Count(AETelemetryCounter counter);
+  void GetSnapshot(AETelemetrySnapshot &snapshot) const;
+
+  /* one line per stage and the counters, prefixed with name */
+  void Log(int loglevel, const char *name) const;
+
+  static const char *StageName(AETelemetryStage stage);
+  static const char *CounterName(AETelemetryCounter counter);
+
+protected:
+  struct Stage
+  {
+    volatile long buckets[AE_TELEMETRY_BUCKETS];
+    volatile long max;
+    volatile long seconds;      // total, whole seconds
+    volatile long micros;       // total, rest below a second
+  };
+  Stage m_stages[AE_TELEMETRY_STAGES];
+  volatile long m_counters[AE_TELEMETRY_COUNTERS];
+};
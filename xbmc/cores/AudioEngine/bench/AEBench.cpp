@@ -0,0 +1,448 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  Headless benchmark of the audio engine, no sound card or GUI needed.
+
+  ActiveAE is started on the NULL sink, which drains in real time, or on
+  the PROFILER sink, which takes every buffer right away and lets the
+  engine run as fast as it can. Synthetic streams are fed for the given
+  amount of audio, after a warm up the run is measured as CPU time per
+  second of audio, RunStages times from the engine telemetry and the
+  number of operator new calls.
+
+  xbmc-aebench [--sink NULL|PROFILER] [--format float|s16|s24|s32]
+               [--rate 48000] [--channels 2] [--streams 1] [--seconds 10]
+               [--warmup 1] [--crossfade ms] [--max-cpu ms]
+
+  --crossfade fades half of the streams out and the others in every
+  given ms of audio, --max-cpu makes the run fail if the engine needs more
+  CPU per second of audio than given.
+*/
+
+#include "system.h"
+#include "cores/AudioEngine/AEFactory.h"
+#include "cores/AudioEngine/Interfaces/AE.h"
+#include "cores/AudioEngine/Interfaces/AEStream.h"
+#include "cores/AudioEngine/Utils/AETelemetry.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "filesystem/SpecialProtocol.h"
+#include "powermanagement/PowerManager.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/Settings.h"
+#include "threads/Atomics.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "commons/ilog.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <new>
+#include <string>
+#include <vector>
+#ifdef TARGET_POSIX
+#include <sys/resource.h>
+#else
+#include <ctime>
+#endif
+
+#define BENCH_CHUNK_FRAMES 1024
+#define BENCH_DRAIN_TIMEOUT 10000
+
+/* every operator new of the process is counted, the engine threads included */
+static volatile long g_allocations = 0;
+
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#define BENCH_THROW_NONE noexcept
+#else
+#define BENCH_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define BENCH_THROW_NONE throw()
+#endif
+
+void *operator new(size_t size) BENCH_THROW_BAD_ALLOC
+{
+  AtomicIncrement(&g_allocations);
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) BENCH_THROW_BAD_ALLOC
+{
+  return operator new(size);
+}
+
+void operator delete(void *p) BENCH_THROW_NONE
+{
+  free(p);
+}
+
+void operator delete[](void *p) BENCH_THROW_NONE
+{
+  free(p);
+}
+
+class NullLogger : public XbmcCommons::ILogger
+{
+public:
+  void log(int loglevel, const char* message) {}
+};
+
+struct BenchOptions
+{
+  std::string   sink;
+  AEDataFormat  format;
+  unsigned int  rate;
+  unsigned int  channels;
+  unsigned int  streams;
+  double        seconds;
+  double        warmup;
+  unsigned int  crossfade;  // ms, 0 for none
+  double        maxCpu;     // ms per second of audio, 0 for no limit
+};
+
+struct BenchStream
+{
+  IAEStream *stream;
+  uint64_t   framesFed;
+};
+
+static void Usage(const char *name)
+{
+  fprintf(stderr,
+          "usage: %s [--sink NULL|PROFILER] [--format float|s16|s24|s32]\n"
+          "       [--rate 48000] [--channels 2] [--streams 1] [--seconds 10]\n"
+          "       [--warmup 1] [--crossfade ms] [--max-cpu ms]\n", name);
+}
+
+static bool ParseFormat(const char *name, AEDataFormat &format)
+{
+  if      (!strcmp(name, "float")) format = AE_FMT_FLOAT;
+  else if (!strcmp(name, "s16"))   format = AE_FMT_S16NE;
+  else if (!strcmp(name, "s24"))   format = AE_FMT_S24NE4;
+  else if (!strcmp(name, "s32"))   format = AE_FMT_S32NE;
+  else
+    return false;
+  return true;
+}
+
+static bool ParseOptions(int argc, char **argv, BenchOptions &opts)
+{
+  opts.sink      = "NULL";
+  opts.format    = AE_FMT_FLOAT;
+  opts.rate      = 48000;
+  opts.channels  = 2;
+  opts.streams   = 1;
+  opts.seconds   = 10.0;
+  opts.warmup    = 1.0;
+  opts.crossfade = 0;
+  opts.maxCpu    = 0.0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (i + 1 >= argc)
+      return false;
+    const char *arg = argv[i];
+    const char *value = argv[++i];
+
+    if      (!strcmp(arg, "--sink"))      opts.sink = value;
+    else if (!strcmp(arg, "--format"))    { if (!ParseFormat(value, opts.format)) return false; }
+    else if (!strcmp(arg, "--rate"))      opts.rate = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--channels"))  opts.channels = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--streams"))   opts.streams = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--seconds"))   opts.seconds = strtod(value, NULL);
+    else if (!strcmp(arg, "--warmup"))    opts.warmup = strtod(value, NULL);
+    else if (!strcmp(arg, "--crossfade")) opts.crossfade = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--max-cpu"))   opts.maxCpu = strtod(value, NULL);
+    else
+      return false;
+  }
+
+  if (opts.sink != "NULL" && opts.sink != "PROFILER")
+    return false;
+
+  return opts.rate >= 8000 && opts.channels >= 1 && opts.channels <= 8 &&
+         opts.streams >= 1 && opts.seconds > 0.0 && opts.warmup >= 0.0;
+}
+
+/* user and system time of all threads in ms */
+static double ProcessCpuTime()
+{
+#ifdef TARGET_POSIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == -1)
+    return 0.0;
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+#else
+  return clock() * 1000.0 / CLOCKS_PER_SEC;
+#endif
+}
+
+/* one chunk of a sine per channel in the stream format */
+static void MakeChunk(const BenchOptions &opts, std::vector<uint8_t> &chunk)
+{
+  unsigned int bytes = CAEUtil::DataFormatToBits(opts.format) >> 3;
+  chunk.resize(BENCH_CHUNK_FRAMES * opts.channels * bytes);
+
+  for (unsigned int f = 0; f < BENCH_CHUNK_FRAMES; f++)
+  {
+    for (unsigned int c = 0; c < opts.channels; c++)
+    {
+      double value = 0.5 * sin(2.0 * M_PI * 220.0 * (c + 1) * f / opts.rate);
+      uint8_t *dst = &chunk[(f * opts.channels + c) * bytes];
+      switch (opts.format)
+      {
+        case AE_FMT_S16NE:  { int16_t v = (int16_t)(value * INT16_MAX); memcpy(dst, &v, bytes); break; }
+        case AE_FMT_S24NE4: { int32_t v = (int32_t)(value * 8388607.0); memcpy(dst, &v, bytes); break; }
+        case AE_FMT_S32NE:  { int32_t v = (int32_t)(value * INT32_MAX); memcpy(dst, &v, bytes); break; }
+        default:            { float v = (float)value; memcpy(dst, &v, bytes); break; }
+      }
+    }
+  }
+}
+
+/* one round over the streams, false if none of them took data */
+static bool Feed(std::vector<BenchStream> &streams, const std::vector<uint8_t> &chunk,
+                 unsigned int frameSize, uint64_t frames)
+{
+  bool fed = false;
+  for (unsigned int i = 0; i < streams.size(); i++)
+  {
+    BenchStream &s = streams[i];
+    if (s.framesFed >= frames)
+      continue;
+
+    unsigned int space = s.stream->GetSpace() / frameSize;
+    unsigned int count = std::min((uint64_t)std::min(space, (unsigned int)BENCH_CHUNK_FRAMES), frames - s.framesFed);
+    if (!count)
+      continue;
+
+    unsigned int added = s.stream->AddData((void*)&chunk[0], count * frameSize) / frameSize;
+    s.framesFed += added;
+    fed |= added > 0;
+  }
+  return fed;
+}
+
+static uint64_t FramesFed(const std::vector<BenchStream> &streams)
+{
+  uint64_t frames = 0;
+  for (unsigned int i = 0; i < streams.size(); i++)
+    frames += streams[i].framesFed;
+  return frames / streams.size();
+}
+
+static void PrintStage(const AETelemetrySnapshot &start, const AETelemetrySnapshot &end, AETelemetryStage stage)
+{
+  const AETelemetryStageStats &a = start.stages[stage];
+  const AETelemetryStageStats &b = end.stages[stage];
+
+  // histogram of the measured window only, the max of the snapshot covers the warm up
+  unsigned int count = 0, worst = 0, p99 = 0, sum = 0;
+  for (int i = 0; i < AE_TELEMETRY_BUCKETS; i++)
+  {
+    unsigned int n = b.buckets[i] - a.buckets[i];
+    count += n;
+    if (n)
+      worst = i < AE_TELEMETRY_BUCKETS - 1 ? (1u << i) : b.max;
+  }
+  for (int i = 0; i < AE_TELEMETRY_BUCKETS && count; i++)
+  {
+    sum += b.buckets[i] - a.buckets[i];
+    if (sum * 100 >= count * 99)
+    {
+      p99 = i < AE_TELEMETRY_BUCKETS - 1 ? (1u << i) : b.max;
+      break;
+    }
+  }
+
+  printf("%-10s count: %u p99: <%uus worst: <%uus max (with warm up): %uus\n",
+         CAETelemetry::StageName(stage), count, p99, worst, b.max);
+}
+
+int main(int argc, char **argv)
+{
+  BenchOptions opts;
+  if (!ParseOptions(argc, argv, opts))
+  {
+    Usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // we need to configure CThread to use a dummy logger
+  NullLogger nullLogger;
+  CThread::SetLogger(&nullLogger);
+
+  setlocale(LC_NUMERIC, "C");
+  g_advancedSettings.Initialize();
+
+  CStdString xbmcPath;
+  CUtil::GetHomePath(xbmcPath);
+  CSpecialProtocol::SetXBMCPath(xbmcPath);
+  CSpecialProtocol::SetXBMCBinPath(xbmcPath);
+
+  g_powerManager.Initialize();
+  if (!CAEFactory::LoadEngine())
+  {
+    fprintf(stderr, "Failed to load the audio engine.\n");
+    return EXIT_FAILURE;
+  }
+  if (!CSettings::Get().Initialize())
+  {
+    fprintf(stderr, "Failed to initialize the settings.\n");
+    return EXIT_FAILURE;
+  }
+  CSettings::Get().SetString("audiooutput.audiodevice", opts.sink == "NULL" ? "NULL:NULL" : "PROFILER:Profiler");
+
+  if (!CAEFactory::StartEngine())
+  {
+    fprintf(stderr, "Failed to start the audio engine.\n");
+    return EXIT_FAILURE;
+  }
+  CAEFactory::SetSoundMode(AE_SOUND_OFF);
+
+  std::vector<uint8_t> chunk;
+  MakeChunk(opts, chunk);
+  unsigned int frameSize = chunk.size() / BENCH_CHUNK_FRAMES;
+
+  std::vector<BenchStream> streams;
+  for (unsigned int i = 0; i < opts.streams; i++)
+  {
+    BenchStream s;
+    s.stream = CAEFactory::MakeStream(opts.format, opts.rate, opts.rate,
+                                      CAEUtil::GuessChLayout(opts.channels), AESTREAM_PAUSED);
+    s.framesFed = 0;
+    if (!s.stream)
+    {
+      fprintf(stderr, "Failed to create stream %u.\n", i);
+      return EXIT_FAILURE;
+    }
+    streams.push_back(s);
+  }
+
+  const CAETelemetry *telemetry = CAEFactory::GetTelemetry();
+  uint64_t warmupFrames = (uint64_t)(opts.warmup * opts.rate);
+  uint64_t totalFrames = warmupFrames + (uint64_t)(opts.seconds * opts.rate);
+  uint64_t fadeFrames = (uint64_t)opts.crossfade * opts.rate / 1000;
+  uint64_t nextFade = fadeFrames;
+  bool fadeOdd = false;
+
+  // prefill while paused, like a player does
+  Feed(streams, chunk, frameSize, totalFrames);
+  for (unsigned int i = 0; i < streams.size(); i++)
+    streams[i].stream->Resume();
+
+  bool measuring = false;
+  double cpuStart = 0.0;
+  long allocStart = 0;
+  uint64_t framesStart = 0;
+  AETelemetrySnapshot telemetryStart, telemetryEnd;
+  memset(&telemetryStart, 0, sizeof(telemetryStart));
+  memset(&telemetryEnd, 0, sizeof(telemetryEnd));
+
+  uint64_t fed;
+  while ((fed = FramesFed(streams)) < totalFrames)
+  {
+    if (!measuring && fed >= warmupFrames)
+    {
+      measuring = true;
+      framesStart = fed;
+      if (telemetry)
+        telemetry->GetSnapshot(telemetryStart);
+      allocStart = g_allocations;
+      cpuStart = ProcessCpuTime();
+    }
+
+    if (fadeFrames && fed >= nextFade)
+    {
+      for (unsigned int i = 0; i < streams.size(); i++)
+      {
+        if ((i & 1) == (fadeOdd ? 1u : 0u))
+          streams[i].stream->FadeVolume(1.0f, 0.0f, opts.crossfade);
+        else
+          streams[i].stream->FadeVolume(0.0f, 1.0f, opts.crossfade);
+      }
+      fadeOdd = !fadeOdd;
+      nextFade += fadeFrames;
+    }
+
+    if (!Feed(streams, chunk, frameSize, totalFrames))
+      XbmcThreads::ThreadSleep(1);
+  }
+
+  double cpu = ProcessCpuTime() - cpuStart;
+  long allocations = g_allocations - allocStart;
+  double audioSeconds = (double)(fed - framesStart) / opts.rate;
+  if (telemetry)
+    telemetry->GetSnapshot(telemetryEnd);
+
+  for (unsigned int i = 0; i < streams.size(); i++)
+    streams[i].stream->Drain(true);
+  XbmcThreads::EndTime drainTimer(BENCH_DRAIN_TIMEOUT);
+  for (unsigned int i = 0; i < streams.size(); i++)
+  {
+    while (!streams[i].stream->IsDrained() && !drainTimer.IsTimePast())
+      XbmcThreads::ThreadSleep(10);
+  }
+  for (unsigned int i = 0; i < streams.size(); i++)
+    CAEFactory::FreeStream(streams[i].stream);
+
+  CAEFactory::Shutdown();
+  CAEFactory::UnLoadEngine();
+
+  printf("sink: %s format: %s rate: %u channels: %u streams: %u crossfade: %ums\n",
+         opts.sink.c_str(), CAEUtil::DataFormatToStr(opts.format), opts.rate, opts.channels,
+         opts.streams, opts.crossfade);
+  if (audioSeconds <= 0.0)
+  {
+    fprintf(stderr, "No audio measured, increase --seconds.\n");
+    return EXIT_FAILURE;
+  }
+
+  double cpuPerSecond = cpu / audioSeconds;
+  printf("audio: %.2fs cpu: %.1fms cpu per second of audio: %.3fms\n", audioSeconds, cpu, cpuPerSecond);
+  printf("allocations: %ld (%.1f per second of audio)\n", allocations, allocations / audioSeconds);
+  if (telemetry)
+  {
+    PrintStage(telemetryStart, telemetryEnd, AE_TELEMETRY_CYCLE);
+    PrintStage(telemetryStart, telemetryEnd, AE_TELEMETRY_RESAMPLE);
+    PrintStage(telemetryStart, telemetryEnd, AE_TELEMETRY_MIX);
+    PrintStage(telemetryStart, telemetryEnd, AE_TELEMETRY_SINK_WRITE);
+    printf("underruns: %u latebuffers: %u\n",
+           telemetryEnd.counters[AE_TELEMETRY_UNDERRUNS] - telemetryStart.counters[AE_TELEMETRY_UNDERRUNS],
+           telemetryEnd.counters[AE_TELEMETRY_LATE] - telemetryStart.counters[AE_TELEMETRY_LATE]);
+  }
+
+  if (opts.maxCpu > 0.0 && cpuPerSecond > opts.maxCpu)
+  {
+    fprintf(stderr, "CPU per second of audio %.3fms is above the limit of %.3fms.\n", cpuPerSecond, opts.maxCpu);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
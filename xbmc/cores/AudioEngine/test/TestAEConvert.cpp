@@ -0,0 +1,165 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEConvert.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "utils/Stopwatch.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+/* the value a single sample should decode to, computed the slow way */
+float Reference(AEDataFormat format, const uint8_t *s)
+{
+  switch (format)
+  {
+    case AE_FMT_U8    : return s[0] * (2.0f / UINT8_MAX) - 1.0f;
+    case AE_FMT_S8    : return (int8_t)s[0] * (1.0f / (INT8_MAX + 0.5f));
+    case AE_FMT_S16LE : return (int16_t)(s[0] | (s[1] << 8)) * (1.0f / (INT16_MAX + 0.5f));
+    case AE_FMT_S16BE : return (int16_t)(s[1] | (s[0] << 8)) * (1.0f / (INT16_MAX + 0.5f));
+    case AE_FMT_S24LE4: return (float)(int)((s[2] << 24) | (s[1] << 16) | (s[0] << 8)) * (-1.0f / INT_MIN);
+    case AE_FMT_S24BE4: return (float)(int)((s[0] << 24) | (s[1] << 16) | (s[2] << 8)) * (-1.0f / INT_MIN);
+    case AE_FMT_S24LE3: return (float)(int)((s[2] << 24) | (s[1] << 16) | (s[0] << 8)) * (-1.0f / INT_MIN);
+    case AE_FMT_S24BE3: return (float)(int)((s[0] << 24) | (s[1] << 16) | (s[2] << 8)) * (-1.0f / INT_MIN);
+    case AE_FMT_S32LE : return (float)(int)(s[0] | (s[1] << 8) | (s[2] << 16) | (s[3] << 24)) * (1.0f / (float)INT32_MAX);
+    case AE_FMT_S32BE : return (float)(int)(s[3] | (s[2] << 8) | (s[1] << 16) | (s[0] << 24)) * (1.0f / (float)INT32_MAX);
+    default:
+      return 0.0f;
+  }
+}
+
+const AEDataFormat inputFormats[] =
+{
+  AE_FMT_U8, AE_FMT_S8, AE_FMT_S16LE, AE_FMT_S16BE, AE_FMT_S24LE4, AE_FMT_S24BE4,
+  AE_FMT_S24LE3, AE_FMT_S24BE3, AE_FMT_S32LE, AE_FMT_S32BE
+};
+
+const AEDataFormat outputFormats[] =
+{
+  AE_FMT_U8, AE_FMT_S8, AE_FMT_S16LE, AE_FMT_S16BE, AE_FMT_S24NE4, AE_FMT_S24NE3,
+  AE_FMT_S32LE, AE_FMT_S32BE
+};
+}
+
+TEST(TestAEConvert, ToFloat)
+{
+  for (unsigned int f = 0; f < sizeof(inputFormats) / sizeof(inputFormats[0]); ++f)
+  {
+    AEDataFormat format = inputFormats[f];
+    const unsigned int bytes = CAEUtil::DataFormatToBits(format) >> 3;
+    CAEConvert::AEConvertToFn convert = CAEConvert::ToFloat(format);
+    ASSERT_TRUE(convert != NULL) << CAEUtil::DataFormatToStr(format);
+
+    /* odd lengths make sure the tail handling of the vector kernels is hit */
+    for (unsigned int samples = 1; samples < 41; ++samples)
+    {
+      std::vector<uint8_t> in(samples * bytes);
+      std::vector<float>   out(samples + 1, 42.0f);
+      for (unsigned int i = 0; i < in.size(); ++i)
+        in[i] = rand() & 0xFF;
+
+      EXPECT_EQ(samples, convert(&in[0], samples, &out[0]));
+      for (unsigned int i = 0; i < samples; ++i)
+        EXPECT_FLOAT_EQ(Reference(format, &in[i * bytes]), out[i])
+          << CAEUtil::DataFormatToStr(format) << " sample " << i << " of " << samples;
+
+      /* nothing may be written past the end */
+      EXPECT_EQ(42.0f, out[samples]);
+    }
+  }
+}
+
+TEST(TestAEConvert, RoundTrip)
+{
+  for (unsigned int f = 0; f < sizeof(outputFormats) / sizeof(outputFormats[0]); ++f)
+  {
+    AEDataFormat format = outputFormats[f];
+    const unsigned int bits  = CAEUtil::DataFormatToUsedBits(format);
+    const unsigned int bytes = CAEUtil::DataFormatToBits(format) >> 3;
+    CAEConvert::AEConvertFrFn from = CAEConvert::FrFloat(format);
+    /* S24NE4 is written MSB aligned but read back LSB aligned, check it as S32 */
+    CAEConvert::AEConvertToFn to   = CAEConvert::ToFloat(format == AE_FMT_S24NE4 ? AE_FMT_S32NE : format);
+    ASSERT_TRUE(from != NULL && to != NULL) << CAEUtil::DataFormatToStr(format);
+
+    /* one LSB for rounding and dither, one for the asymmetric scale factors */
+    const float tolerance = 2.0f / (1 << (std::min(bits, 24U) - 1));
+
+    for (unsigned int samples = 1; samples < 41; ++samples)
+    {
+      std::vector<float>   in(samples);
+      std::vector<uint8_t> tmp(samples * bytes + 1, 0xAA);
+      std::vector<float>   out(samples);
+      for (unsigned int i = 0; i < samples; ++i)
+        in[i] = (rand() / (float)RAND_MAX) * 1.8f - 0.9f;
+
+      from(&in[0], samples, &tmp[0]);
+      EXPECT_EQ(0xAA, tmp[samples * bytes]) << CAEUtil::DataFormatToStr(format);
+
+      to(&tmp[0], samples, &out[0]);
+      for (unsigned int i = 0; i < samples; ++i)
+        EXPECT_NEAR(in[i], out[i], tolerance)
+          << CAEUtil::DataFormatToStr(format) << " sample " << i << " of " << samples;
+    }
+  }
+}
+
+/*
+  Throughput of the kernels selected for this cpu, run with
+  --gtest_also_run_disabled_tests --gtest_filter=TestAEConvert.*
+*/
+TEST(TestAEConvert, DISABLED_Benchmark)
+{
+  const unsigned int samples = 192000 * 8;
+  const unsigned int loops   = 50;
+  std::vector<uint8_t> raw(samples * sizeof(double));
+  std::vector<float>   pcm(samples);
+  for (unsigned int i = 0; i < raw.size(); ++i)
+    raw[i] = rand() & 0xFF;
+  for (unsigned int i = 0; i < samples; ++i)
+    pcm[i] = (rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+
+  CStopWatch watch;
+  for (unsigned int f = 0; f < sizeof(inputFormats) / sizeof(inputFormats[0]); ++f)
+  {
+    CAEConvert::AEConvertToFn convert = CAEConvert::ToFloat(inputFormats[f]);
+    watch.StartZero();
+    for (unsigned int l = 0; l < loops; ++l)
+      convert(&raw[0], samples, &pcm[0]);
+    std::cout << "ToFloat " << CAEUtil::DataFormatToStr(inputFormats[f]) << ": "
+              << (samples * (double)loops / watch.GetElapsedSeconds()) / 1e6 << " MSamples/s" << std::endl;
+  }
+
+  for (unsigned int f = 0; f < sizeof(outputFormats) / sizeof(outputFormats[0]); ++f)
+  {
+    CAEConvert::AEConvertFrFn convert = CAEConvert::FrFloat(outputFormats[f]);
+    watch.StartZero();
+    for (unsigned int l = 0; l < loops; ++l)
+      convert(&pcm[0], samples, &raw[0]);
+    std::cout << "FrFloat " << CAEUtil::DataFormatToStr(outputFormats[f]) << ": "
+              << (samples * (double)loops / watch.GetElapsedSeconds()) / 1e6 << " MSamples/s" << std::endl;
+  }
+}
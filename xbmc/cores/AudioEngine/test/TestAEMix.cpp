@@ -0,0 +1,254 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEMix.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "utils/Stopwatch.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <iostream>
+
+namespace
+{
+struct MixCase
+{
+  int   planes;
+  int   channels;
+  int   frames;
+  float amplify;    // > 1 drives the limiter
+  int   fading;     // frames left to fade, 0 for none
+  bool  perSample;
+};
+
+const MixCase mixCases[] =
+{
+  { 1, 2,    1, 1.0f,    0, false },
+  { 1, 2,  333, 1.0f,    0, false },
+  { 1, 6, 1024, 1.0f,    0, false },
+  { 8, 8,  257, 1.0f,    0, false },
+  { 1, 2,  333, 1.0f,  100, false },
+  { 1, 6,  512, 1.0f, 1000, false },
+  { 6, 6,  300, 1.0f,  200, false },
+  { 1, 2,  512, 4.0f,    0, true  },
+  { 1, 8,  301, 2.0f,   50, true  },
+  { 2, 2,  700, 8.0f,    0, true  },
+  { 1, 2,    1, 2.0f,    0, true  }
+};
+
+struct Buffer
+{
+  std::vector<std::vector<float> > planes;
+  std::vector<float*> ptrs;
+
+  Buffer(int planeCount, int floats)
+  {
+    planes.resize(planeCount);
+    for (int j = 0; j < planeCount; ++j)
+    {
+      planes[j].resize(floats);
+      for (int i = 0; i < floats; ++i)
+        planes[j][i] = (rand() / (float)RAND_MAX) * 1.6f - 0.8f;
+    }
+    Sync();
+  }
+  Buffer(const Buffer &other) : planes(other.planes) { Sync(); }
+  void Sync()
+  {
+    ptrs.resize(planes.size());
+    for (unsigned int j = 0; j < planes.size(); ++j)
+      ptrs[j] = &planes[j][0];
+  }
+};
+
+/* the mix loop of CActiveAE::RunStages before it was fused */
+bool ReferenceMix(float **out, float **mix, int planes, int channels, int frames,
+                  bool accumulate, AEMixGain &gain)
+{
+  bool needClamp = false;
+  int nb_floats = frames * channels / planes;
+  int nb_loops = 1;
+  if (gain.fadingSamples > 0 || gain.perSample)
+  {
+    nb_floats = channels / planes;
+    nb_loops = frames;
+  }
+
+  for (int i = 0; i < nb_loops; i++)
+  {
+    if (gain.fadingSamples > 0)
+    {
+      gain.volume += gain.fadingStep;
+      gain.fadingSamples--;
+    }
+
+    float volume = gain.volume * gain.rgain;
+    if (nb_loops > 1)
+      volume *= gain.limiter->Run(accumulate ? mix : out, channels, i*nb_floats, planes > 1);
+
+    for (int j = 0; j < planes; j++)
+    {
+      if (!accumulate)
+      {
+#ifdef __SSE__
+        CAEUtil::SSEMulArray(out[j]+i*nb_floats, volume, nb_floats);
+#else
+        for (int k = 0; k < nb_floats; ++k)
+          out[j][i*nb_floats+k] *= volume;
+#endif
+        continue;
+      }
+
+      float *dst = out[j]+i*nb_floats;
+      float *src = mix[j]+i*nb_floats;
+#ifdef __SSE__
+      CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
+      for (int k = 0; k < nb_floats; ++k)
+      {
+        if (fabs(dst[k]) > 1.0f)
+        {
+          needClamp = true;
+          break;
+        }
+      }
+#else
+      for (int k = 0; k < nb_floats; ++k)
+      {
+        dst[k] += src[k] * volume;
+        if (fabs(dst[k]) > 1.0f)
+          needClamp = true;
+      }
+#endif
+    }
+  }
+  return needClamp;
+}
+
+AEMixGain MakeGain(const MixCase &c, CAELimiter &limiter)
+{
+  limiter.SetAmplification(c.amplify);
+  AEMixGain gain;
+  gain.volume = 0.3f;
+  gain.rgain = 1.7f;
+  gain.fadingSamples = c.fading;
+  gain.fadingStep = c.fading ? 0.6f / c.fading : 0.0f;
+  gain.perSample = c.perSample;
+  gain.limiter = &limiter;
+  return gain;
+}
+
+void ExpectSame(const Buffer &ref, const Buffer &out, const char *what, int c)
+{
+  for (unsigned int j = 0; j < ref.planes.size(); ++j)
+    EXPECT_EQ(0, memcmp(&ref.planes[j][0], &out.planes[j][0], ref.planes[j].size() * sizeof(float)))
+      << what << " case " << c << " plane " << j;
+}
+}
+
+TEST(TestAEMix, BitIdentical)
+{
+  for (unsigned int c = 0; c < sizeof(mixCases) / sizeof(mixCases[0]); ++c)
+  {
+    const MixCase &mc = mixCases[c];
+    const int floats = mc.frames * mc.channels / mc.planes;
+
+    Buffer first(mc.planes, floats);
+    Buffer second(mc.planes, floats);
+
+    // first stream is scaled in place, the second one is mixed into it
+    Buffer refOut(first), out(first);
+    CAELimiter refLimiter1, limiter1, refLimiter2, limiter2;
+    AEMixGain refGain1 = MakeGain(mc, refLimiter1), gain1 = MakeGain(mc, limiter1);
+    AEMixGain refGain2 = MakeGain(mc, refLimiter2), gain2 = MakeGain(mc, limiter2);
+    refGain2.rgain = gain2.rgain = 2.5f;
+
+    ReferenceMix(&refOut.ptrs[0], NULL, mc.planes, mc.channels, mc.frames, false, refGain1);
+    EXPECT_FALSE(CAEMix::Mix(&out.ptrs[0], &out.ptrs[0], mc.planes, mc.channels, mc.frames, false, gain1));
+    ExpectSame(refOut, out, "scale", c);
+
+    bool refClamp = ReferenceMix(&refOut.ptrs[0], &second.ptrs[0], mc.planes, mc.channels, mc.frames, true, refGain2);
+    bool clamp = CAEMix::Mix(&out.ptrs[0], &second.ptrs[0], mc.planes, mc.channels, mc.frames, true, gain2);
+    EXPECT_EQ(refClamp, clamp) << "case " << c;
+    ExpectSame(refOut, out, "mix", c);
+
+    if (refClamp)
+    {
+      for (int j = 0; j < mc.planes; ++j)
+        CAEUtil::ClampArray(refOut.ptrs[j], floats);
+      CAEMix::Clamp(&out.ptrs[0], mc.planes, mc.channels, mc.frames);
+      ExpectSame(refOut, out, "clamp", c);
+    }
+
+    // state carried into the next buffer
+    EXPECT_EQ(0, memcmp(&refGain2.volume, &gain2.volume, sizeof(float))) << "case " << c;
+    EXPECT_EQ(refGain2.fadingSamples, gain2.fadingSamples) << "case " << c;
+  }
+}
+
+/*
+  Throughput of the fused kernel against the per frame path, run with
+  --gtest_also_run_disabled_tests --gtest_filter=TestAEMix.*
+*/
+TEST(TestAEMix, DISABLED_Benchmark)
+{
+  const MixCase cases[] =
+  {
+    { 1, 2, 1024, 1.0f, 0, false },
+    { 1, 8, 1024, 1.0f, 0, false },
+    { 1, 2, 1024, 1.0f, 1000000, false },
+    { 1, 8, 1024, 2.0f, 0, true }
+  };
+  const unsigned int loops = 2000;
+  CStopWatch watch;
+
+  for (unsigned int c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+  {
+    const MixCase &mc = cases[c];
+    const int floats = mc.frames * mc.channels / mc.planes;
+    Buffer out(mc.planes, floats), src(mc.planes, floats);
+    CAELimiter limiter;
+    AEMixGain gain;
+
+    // keep the accumulated mix below clipping so both paths scan every sample
+    for (int j = 0; j < mc.planes; ++j)
+      memset(out.ptrs[j], 0, floats * sizeof(float));
+
+    gain = MakeGain(mc, limiter);
+    gain.rgain = 1e-4f;
+    watch.StartZero();
+    for (unsigned int l = 0; l < loops; ++l)
+      ReferenceMix(&out.ptrs[0], &src.ptrs[0], mc.planes, mc.channels, mc.frames, true, gain);
+    float reference = watch.GetElapsedSeconds();
+
+    gain = MakeGain(mc, limiter);
+    gain.rgain = 1e-4f;
+    watch.StartZero();
+    for (unsigned int l = 0; l < loops; ++l)
+      CAEMix::Mix(&out.ptrs[0], &src.ptrs[0], mc.planes, mc.channels, mc.frames, true, gain);
+    float fused = watch.GetElapsedSeconds();
+
+    std::cout << mc.channels << "ch" << (mc.fading ? " fading" : "") << (mc.perSample ? " limiter" : "") << ": "
+              << (mc.frames * (double)loops / fused) / 1e6 << " MFrames/s (per frame path "
+              << (mc.frames * (double)loops / reference) / 1e6 << " MFrames/s)" << std::endl;
+  }
+}
@@ -0,0 +1,255 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AERemap.h"
+#include "utils/Stopwatch.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <vector>
+#include <iostream>
+
+namespace
+{
+struct RemapCase
+{
+  const char     *name;
+  AEStdChLayout   input;
+  AEStdChLayout   output;
+};
+
+const RemapCase remapCases[] =
+{
+  { "2.0 -> 5.1", AE_CH_LAYOUT_2_0, AE_CH_LAYOUT_5_1 },
+  { "5.1 -> 2.0", AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_2_0 },
+  { "7.1 -> 5.1", AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_5_1 },
+  { "7.1 -> 2.0", AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_2_0 },
+  { "5.1 -> 5.1", AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_5_1 },
+  { "4.0 -> 2.1", AE_CH_LAYOUT_4_0, AE_CH_LAYOUT_2_1 }
+};
+
+/*
+  Mix matrices of the generic remap before the fixed layout kernels, with
+  normalization forced, one row per input channel. The layouts are
+    2.0: FL,FR   2.1: FL,FR,LFE   4.0: FL,FR,BL,BR
+    5.1: FL,FR,FC,BL,BR,LFE   7.1: FL,FR,FC,BL,BR,SL,SR,LFE
+*/
+const float matrix20to51[] =
+{
+  1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+  0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f
+};
+
+const float matrix51to20[] =
+{
+  0.292893201f, 0.0f,
+  0.0f,         0.292893201f,
+  0.207106769f, 0.207106769f,
+  0.292893201f, 0.0f,
+  0.0f,         0.292893201f,
+  0.207106769f, 0.207106769f
+};
+
+const float matrix71to51[] =
+{
+  0.585786402f, 0.0f,         0.0f, 0.0f,         0.0f,         0.0f,
+  0.0f,         0.585786402f, 0.0f, 0.0f,         0.0f,         0.0f,
+  0.0f,         0.0f,         1.0f, 0.0f,         0.0f,         0.0f,
+  0.0f,         0.0f,         0.0f, 0.585786402f, 0.0f,         0.0f,
+  0.0f,         0.0f,         0.0f, 0.0f,         0.585786402f, 0.0f,
+  0.414213538f, 0.0f,         0.0f, 0.414213538f, 0.0f,         0.0f,
+  0.0f,         0.414213538f, 0.0f, 0.0f,         0.414213538f, 0.0f,
+  0.0f,         0.0f,         0.0f, 0.0f,         0.0f,         1.0f
+};
+
+const float matrix71to20[] =
+{
+  0.226540908f, 0.0f,
+  0.0f,         0.226540908f,
+  0.160188615f, 0.160188615f,
+  0.226540908f, 0.0f,
+  0.0f,         0.226540908f,
+  0.226540908f, 0.0f,
+  0.0f,         0.226540908f,
+  0.160188615f, 0.160188615f
+};
+
+const float matrix51to51[] =
+{
+  1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+  0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+  0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+  0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+  0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+  0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f
+};
+
+const float matrix40to21[] =
+{
+  0.5f, 0.0f, 0.0f,
+  0.0f, 0.5f, 0.0f,
+  0.5f, 0.0f, 0.0f,
+  0.0f, 0.5f, 0.0f
+};
+
+const float *referenceMatrices[] =
+{
+  matrix20to51,
+  matrix51to20,
+  matrix71to51,
+  matrix71to20,
+  matrix51to51,
+  matrix40to21
+};
+
+/*
+  Recover the mix matrix by feeding one impulse per input channel, the
+  result is then used to check every frame position of a longer buffer.
+*/
+std::vector<float> ProbeMatrix(const CAERemap &remap, unsigned int in, unsigned int out)
+{
+  std::vector<float> impulses(in * in, 0.0f);
+  std::vector<float> matrix(in * out);
+  for (unsigned int i = 0; i < in; ++i)
+    impulses[i * in + i] = 1.0f;
+  remap.Remap(&impulses[0], &matrix[0], in);
+  return matrix;
+}
+
+/* plain per output channel loop, used as the reference and as the baseline to beat */
+void ReferenceRemap(const std::vector<float> &matrix, const float *in, float *out,
+                    unsigned int frames, unsigned int inCh, unsigned int outCh)
+{
+  for (unsigned int o = 0; o < outCh; ++o)
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+      float sum = 0.0f;
+      for (unsigned int i = 0; i < inCh; ++i)
+        if (matrix[i * outCh + o] != 0.0f)
+          sum += in[f * inCh + i] * matrix[i * outCh + o];
+      out[f * outCh + o] = sum;
+    }
+}
+}
+
+TEST(TestAERemap, Coefficients)
+{
+  for (unsigned int c = 0; c < sizeof(remapCases) / sizeof(remapCases[0]); ++c)
+  {
+    CAEChannelInfo input  = remapCases[c].input;
+    CAEChannelInfo output = remapCases[c].output;
+    const unsigned int inCh  = input.Count();
+    const unsigned int outCh = output.Count();
+
+    CAERemap remap;
+    ASSERT_TRUE(remap.Initialize(input, output, false, true)) << remapCases[c].name;
+
+    /* one frame with a different level per channel */
+    std::vector<float> in(inCh);
+    std::vector<float> out(outCh);
+    for (unsigned int i = 0; i < inCh; ++i)
+      in[i] = 0.1f * (i + 1);
+    remap.Remap(&in[0], &out[0], 1);
+
+    const float *matrix = referenceMatrices[c];
+    for (unsigned int o = 0; o < outCh; ++o)
+    {
+      float sum = 0.0f;
+      for (unsigned int i = 0; i < inCh; ++i)
+        sum += in[i] * matrix[i * outCh + o];
+      EXPECT_NEAR(sum, out[o], 1e-6f) << remapCases[c].name << " channel " << o;
+    }
+  }
+}
+
+TEST(TestAERemap, Layouts)
+{
+  for (unsigned int c = 0; c < sizeof(remapCases) / sizeof(remapCases[0]); ++c)
+  {
+    CAEChannelInfo input  = remapCases[c].input;
+    CAEChannelInfo output = remapCases[c].output;
+    const unsigned int inCh  = input.Count();
+    const unsigned int outCh = output.Count();
+
+    CAERemap remap;
+    ASSERT_TRUE(remap.Initialize(input, output, false, true)) << remapCases[c].name;
+    std::vector<float> matrix = ProbeMatrix(remap, inCh, outCh);
+
+    for (unsigned int frames = 1; frames < 23; ++frames)
+    {
+      std::vector<float> in(frames * inCh);
+      std::vector<float> out(frames * outCh + 1, 42.0f);
+      std::vector<float> ref(frames * outCh);
+      for (unsigned int i = 0; i < in.size(); ++i)
+        in[i] = (rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+
+      remap.Remap(&in[0], &out[0], frames);
+      ReferenceRemap(matrix, &in[0], &ref[0], frames, inCh, outCh);
+      for (unsigned int i = 0; i < ref.size(); ++i)
+        EXPECT_NEAR(ref[i], out[i], 1e-6f) << remapCases[c].name << " sample " << i;
+
+      /* nothing may be written past the last frame */
+      EXPECT_EQ(42.0f, out[frames * outCh]) << remapCases[c].name;
+    }
+  }
+}
+
+/*
+  Compares the compiled kernels against the per channel walk, run with
+  --gtest_also_run_disabled_tests --gtest_filter=TestAERemap.*
+*/
+TEST(TestAERemap, DISABLED_Benchmark)
+{
+  const unsigned int frames = 192000;
+  const unsigned int loops  = 20;
+  CStopWatch watch;
+
+  for (unsigned int c = 0; c < sizeof(remapCases) / sizeof(remapCases[0]); ++c)
+  {
+    CAEChannelInfo input  = remapCases[c].input;
+    CAEChannelInfo output = remapCases[c].output;
+    const unsigned int inCh  = input.Count();
+    const unsigned int outCh = output.Count();
+
+    CAERemap remap;
+    ASSERT_TRUE(remap.Initialize(input, output, false, true));
+    std::vector<float> matrix = ProbeMatrix(remap, inCh, outCh);
+
+    std::vector<float> in(frames * inCh);
+    std::vector<float> out(frames * outCh);
+    for (unsigned int i = 0; i < in.size(); ++i)
+      in[i] = (rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+
+    watch.StartZero();
+    for (unsigned int l = 0; l < loops; ++l)
+      remap.Remap(&in[0], &out[0], frames);
+    float kernel = watch.GetElapsedSeconds();
+
+    watch.StartZero();
+    for (unsigned int l = 0; l < loops; ++l)
+      ReferenceRemap(matrix, &in[0], &out[0], frames, inCh, outCh);
+    float walk = watch.GetElapsedSeconds();
+
+    std::cout << remapCases[c].name << ": "
+              << (frames * (double)loops / kernel) / 1e6 << " MFrames/s (per channel walk "
+              << (frames * (double)loops / walk) / 1e6 << " MFrames/s)" << std::endl;
+  }
+}
@@ -0,0 +1,179 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AESyncScan.h"
+#include "cores/AudioEngine/Utils/AEStreamInfo.h"
+#include "utils/Stopwatch.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+
+namespace
+{
+/* the byte by byte search the parsers did before */
+unsigned int ReferenceFind(const uint8_t *data, unsigned int size, int types)
+{
+  for (unsigned int i = 0; i + 1 < size; ++i)
+  {
+    const uint8_t *p = data + i;
+    if ((types & CAESyncScan::SYNC_AC3) && p[0] == 0x0B && p[1] == 0x77)
+      return i;
+    if ((types & CAESyncScan::SYNC_DTS) &&
+        ((p[0] == 0x1F && p[1] == 0xFF) || (p[0] == 0xFF && p[1] == 0x1F) ||
+         (p[0] == 0x7F && p[1] == 0xFE) || (p[0] == 0xFE && p[1] == 0x7F)))
+      return i;
+    if ((types & CAESyncScan::SYNC_TRUEHD) && i + 5 < size && p[4] == 0xF8 && p[5] == 0x72)
+      return i;
+  }
+  return size;
+}
+
+/* random bytes drawn mostly from the ones the sync words start with */
+void Fill(std::vector<uint8_t> &buffer)
+{
+  static const uint8_t interesting[] = { 0x0B, 0x77, 0x1F, 0xFF, 0x7F, 0xFE, 0xF8, 0x72 };
+  for (unsigned int i = 0; i < buffer.size(); ++i)
+  {
+    if (rand() % 4 == 0)
+      buffer[i] = interesting[rand() % sizeof(interesting)];
+    else
+      buffer[i] = rand() & 0xFF;
+  }
+}
+
+/* bytes that can not start any sync word */
+void FillJunk(uint8_t *data, unsigned int size)
+{
+  for (unsigned int i = 0; i < size; ++i)
+  {
+    uint8_t b = rand() & 0xFF;
+    if (b == 0x0B || b == 0x1F || b == 0xFF || b == 0x7F || b == 0xFE || b == 0xF8)
+      b = 0;
+    data[i] = b;
+  }
+}
+
+/* 16 bit big endian DTS core frame, 512 samples at 48kHz */
+void MakeDTSFrame(uint8_t *frame, unsigned int fsize)
+{
+  memset(frame, 0, fsize);
+  frame[0] = 0x7F; frame[1] = 0xFE; frame[2] = 0x80; frame[3] = 0x01;
+  unsigned int blocks = 16 - 1;
+  unsigned int size = fsize - 1;
+  frame[4] = (blocks >> 7) & 0x1;
+  frame[5] = ((blocks & 0x3F) << 2) | ((size >> 12) & 0x3);
+  frame[6] = (size >> 4) & 0xFF;
+  frame[7] = (size & 0xF) << 4;   // amode 2 (stereo)
+  frame[8] = 0x80 | (13 << 2);    // sfreq 48kHz
+}
+}
+
+TEST(TestAESyncScan, MatchesReference)
+{
+  std::vector<uint8_t> buffer(512 + 32);
+  for (int run = 0; run < 20000; ++run)
+  {
+    Fill(buffer);
+    unsigned int offset = rand() % 32;
+    unsigned int size = rand() % 512;
+    int types = 1 + rand() % CAESyncScan::SYNC_ALL;
+
+    EXPECT_EQ(ReferenceFind(&buffer[offset], size, types), CAESyncScan::Find(&buffer[offset], size, types))
+      << "run " << run << " size " << size << " types " << types;
+  }
+}
+
+TEST(TestAESyncScan, NoCandidate)
+{
+  std::vector<uint8_t> buffer(4096);
+  FillJunk(&buffer[0], buffer.size());
+  for (unsigned int size = 0; size < 64; ++size)
+    EXPECT_EQ(size, CAESyncScan::Find(&buffer[0], size, CAESyncScan::SYNC_ALL));
+  EXPECT_EQ(buffer.size(), CAESyncScan::Find(&buffer[0], buffer.size(), CAESyncScan::SYNC_ALL));
+
+  // a major sync whose unit would start before the buffer is no candidate
+  buffer[0] = 0xF8;
+  buffer[1] = 0x72;
+  EXPECT_EQ(buffer.size(), CAESyncScan::Find(&buffer[0], buffer.size(), CAESyncScan::SYNC_TRUEHD));
+}
+
+TEST(TestAESyncScan, DTSAfterJunk)
+{
+  const unsigned int junk = 3001, fsize = 1024, frames = 4;
+  std::vector<uint8_t> stream(junk + fsize * frames);
+  FillJunk(&stream[0], junk);
+  for (unsigned int i = 0; i < frames; ++i)
+    MakeDTSFrame(&stream[junk + i * fsize], fsize);
+
+  CAEStreamInfo info;
+  uint8_t *packet = NULL;
+  unsigned int packetSize = 0, packets = 0, pos = 0;
+  while (pos < stream.size())
+  {
+    unsigned int size = 0;
+    int used = info.AddData(&stream[pos], stream.size() - pos, &packet, &size);
+    ASSERT_GT(used, 0);
+    pos += used;
+    if (size)
+    {
+      EXPECT_EQ(fsize, size);
+      EXPECT_EQ(0, memcmp(packet, &stream[junk], fsize));
+      packetSize = std::max(packetSize, size);
+      packets++;
+    }
+  }
+  delete[] packet;
+
+  EXPECT_EQ(CAEStreamInfo::STREAM_TYPE_DTS_512, info.GetDataType());
+  EXPECT_EQ(48000U, info.GetSampleRate());
+  EXPECT_GE(packets, frames - 1);
+}
+
+/*
+  Scan speed over a stream without sync, as after a seek into the middle of
+  a frame, run with --gtest_also_run_disabled_tests --gtest_filter=TestAESyncScan.*
+*/
+TEST(TestAESyncScan, DISABLED_Benchmark)
+{
+  std::vector<uint8_t> buffer(1024 * 1024);
+  FillJunk(&buffer[0], buffer.size());
+  const unsigned int loops = 200;
+  CStopWatch watch;
+  unsigned int found = 0;
+
+  watch.StartZero();
+  for (unsigned int l = 0; l < loops; ++l)
+    found += ReferenceFind(&buffer[0], buffer.size(), CAESyncScan::SYNC_ALL);
+  float reference = watch.GetElapsedSeconds();
+
+  watch.StartZero();
+  for (unsigned int l = 0; l < loops; ++l)
+    found += CAESyncScan::Find(&buffer[0], buffer.size(), CAESyncScan::SYNC_ALL);
+  float vector = watch.GetElapsedSeconds();
+
+  EXPECT_EQ(2 * loops * buffer.size(), found);
+  std::cout << "sync scan: " << (buffer.size() * (double)loops / vector) / 1e6 << " MB/s (byte by byte "
+            << (buffer.size() * (double)loops / reference) / 1e6 << " MB/s)" << std::endl;
+}
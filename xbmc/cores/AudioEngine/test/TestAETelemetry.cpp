@@ -0,0 +1,73 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AETelemetry.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestAETelemetry, Buckets)
+{
+  CAETelemetry telemetry;
+  AETelemetrySnapshot snapshot;
+
+  telemetry.AddTime(AE_TELEMETRY_MIX, 0);
+  telemetry.AddTime(AE_TELEMETRY_MIX, 1);
+  telemetry.AddTime(AE_TELEMETRY_MIX, 3);
+  telemetry.AddTime(AE_TELEMETRY_MIX, 4);
+  telemetry.AddTime(AE_TELEMETRY_MIX, 10000000);
+  telemetry.AddTime(AE_TELEMETRY_MIX, -5);
+  telemetry.GetSnapshot(snapshot);
+
+  const AETelemetryStageStats &mix = snapshot.stages[AE_TELEMETRY_MIX];
+  EXPECT_EQ(6u, mix.count);
+  EXPECT_EQ(2u, mix.buckets[0]);   // 0 and the negative time
+  EXPECT_EQ(1u, mix.buckets[1]);   // 1
+  EXPECT_EQ(1u, mix.buckets[2]);   // 3
+  EXPECT_EQ(1u, mix.buckets[3]);   // 4
+  EXPECT_EQ(1u, mix.buckets[AE_TELEMETRY_BUCKETS - 1]);
+  EXPECT_EQ(10000000u, mix.max);
+  EXPECT_EQ(2u, mix.p50);         // third of six values is 1
+  EXPECT_EQ(10000000u, mix.p99);
+
+  EXPECT_EQ(0u, snapshot.stages[AE_TELEMETRY_RESAMPLE].count);
+  EXPECT_EQ(0u, snapshot.stages[AE_TELEMETRY_RESAMPLE].p99);
+}
+
+TEST(TestAETelemetry, Counters)
+{
+  CAETelemetry telemetry;
+  AETelemetrySnapshot snapshot;
+
+  telemetry.Count(AE_TELEMETRY_UNDERRUNS);
+  telemetry.Count(AE_TELEMETRY_UNDERRUNS);
+  telemetry.Count(AE_TELEMETRY_REOPENS);
+  telemetry.AddTime(AE_TELEMETRY_SINK_DELAY, 50000);
+  telemetry.GetSnapshot(snapshot);
+
+  EXPECT_EQ(2u, snapshot.counters[AE_TELEMETRY_UNDERRUNS]);
+  EXPECT_EQ(0u, snapshot.counters[AE_TELEMETRY_LATE]);
+  EXPECT_EQ(1u, snapshot.counters[AE_TELEMETRY_REOPENS]);
+  EXPECT_DOUBLE_EQ(50000.0, snapshot.stages[AE_TELEMETRY_SINK_DELAY].mean);
+
+  telemetry.Reset();
+  telemetry.GetSnapshot(snapshot);
+  EXPECT_EQ(0u, snapshot.counters[AE_TELEMETRY_UNDERRUNS]);
+  EXPECT_EQ(0u, snapshot.stages[AE_TELEMETRY_SINK_DELAY].count);
+}
@@ -24,14 +24,27 @@
 
 #include "guilib/Resolution.h"
 #include "guilib/Geometry.h"
+#include "settings/VideoSettings.h"
+#include "PlatformDefs.h"
 #include "RenderFormats.h"
 #include "RenderFeatures.h"
 
 #define MAX_PLANES 3
 #define MAX_FIELDS 3
-#define NUM_BUFFERS 3
+#define NUM_BUFFERS 8         // most buffers a renderer holds
+#define NUM_BUFFERS_DEFAULT 3 // buffers used unless the decoder needs more, see CXBMCRenderManager::GetRenderDepth
+
+#define AUTOSOURCE -1
+
+#define IMAGE_FLAG_WRITING   0x01 /* image is in use after a call to GetImage, caller may be reading or writing */
+#define IMAGE_FLAG_READING   0x02 /* image is in use after a call to GetImage, caller is only reading */
+#define IMAGE_FLAG_DYNAMIC   0x04 /* image was allocated due to a call to GetImage */
+#define IMAGE_FLAG_RESERVED  0x08 /* image is reserved, must be asked for specifically used to preserve images */
+#define IMAGE_FLAG_READY     0x16 /* image is ready to be uploaded to texture memory */
+#define IMAGE_FLAG_INUSE (IMAGE_FLAG_WRITING | IMAGE_FLAG_READING | IMAGE_FLAG_RESERVED)
 
 class CSetting;
+class CRenderCapture;
 
 typedef struct YV12Image
 {
@@ -83,6 +96,20 @@ public:
   void GetVideoRect(CRect &source, CRect &dest);
   float GetAspectRatio() const;
 
+  // what the render manager drives, the renderer is picked at runtime
+  virtual void         Update() = 0;
+  virtual void         SetupScreenshot() {};
+  virtual bool         RenderCapture(CRenderCapture* capture) = 0;
+  virtual bool         Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation) = 0;
+  virtual bool         IsConfigured() = 0;
+  virtual int          GetImage(YV12Image *image, int source = AUTOSOURCE, bool readonly = false) = 0;
+  virtual void         ReleaseImage(int source, bool preserve = false) = 0;
+  virtual void         FlipPage(int source) = 0;
+  virtual unsigned int PreInit() = 0;
+  virtual void         UnInit() = 0;
+  virtual void         Reset() = 0;
+  virtual void         RenderUpdate(bool clear, DWORD flags = 0, DWORD alpha = 255) = 0;
+
   virtual bool AddVideoPicture(DVDVideoPicture* picture, int index) { return false; }
   virtual void Flush() {};
 
@@ -94,10 +121,15 @@ public:
   virtual void         SetBufferSize(int numBuffers) { }
   virtual void         ReleaseBuffer(int idx) { }
 
-  virtual bool Supports(ERENDERFEATURE feature) { return false; }
+  virtual bool Supports(ERENDERFEATURE feature) = 0;
+  virtual bool Supports(EDEINTERLACEMODE mode) = 0;
+  virtual bool Supports(EINTERLACEMETHOD method) = 0;
+  virtual bool Supports(ESCALINGMETHOD method) = 0;
+
+  virtual EINTERLACEMETHOD AutoInterlaceMethod() = 0;
 
   // Supported pixel formats, can be called before configure
-  std::vector<ERenderFormat> SupportedFormats()  { return std::vector<ERenderFormat>(); }
+  virtual std::vector<ERenderFormat> SupportedFormats()  { return std::vector<ERenderFormat>(); }
 
   virtual void RegisterRenderUpdateCallBack(const void *ctx, RenderUpdateCallBackFn fn);
   virtual void RegisterRenderFeaturesCallBack(const void *ctx, RenderFeaturesCallBackFn fn);
@@ -48,6 +48,7 @@
 #include "RenderFormats.h"
 #include "cores/IPlayer.h"
 #include "cores/dvdplayer/DVDCodecs/DVDCodecUtils.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoPicturePool.h"
 
 #ifdef HAVE_LIBVDPAU
 #include "cores/dvdplayer/DVDCodecs/Video/VDPAU.h"
@@ -132,6 +133,7 @@ CLinuxRendererGL::YUVBUFFER::YUVBUFFER()
   memset(&image , 0, sizeof(image));
   memset(&pbo   , 0, sizeof(pbo));
   flipindex = 0;
+  software = NULL;
 #ifdef HAVE_LIBVDPAU
   vdpau = NULL;
 #endif
@@ -142,6 +144,7 @@ CLinuxRendererGL::YUVBUFFER::YUVBUFFER()
 
 CLinuxRendererGL::YUVBUFFER::~YUVBUFFER()
 {
+  SAFE_RELEASE(software);
 #ifdef HAVE_LIBVA
   delete &vaapi;
 #endif
@@ -363,7 +366,10 @@ int CLinuxRendererGL::GetImage(YV12Image *image, int source, bool readonly)
   if( readonly )
     im.flags |= IMAGE_FLAG_READING;
   else
+  {
     im.flags |= IMAGE_FLAG_WRITING;
+    SAFE_RELEASE(m_buffers[source].software);
+  }
 
   // copy the image - should be operator of YV12Image
   for (int p=0;p<MAX_PLANES;p++)
@@ -395,6 +401,33 @@ void CLinuxRendererGL::ReleaseImage(int source, bool preserve)
   m_bImageReady = true;
 }
 
+bool CLinuxRendererGL::AddVideoPicture(DVDVideoPicture* picture, int index)
+{
+  /* a picture the decoder won't touch again while it is referenced is
+   * uploaded straight from its buffer, which saves copying it into the
+   * image. The reference is dropped in ReleaseBuffer once the render
+   * manager is done with the index. */
+  if (!picture->buffer || picture->buffer->data[0] != picture->data[0])
+    return false;
+  if (!m_bValidated || picture->format != m_format
+  ||  m_textureUpload != &CLinuxRendererGL::UploadYV12Texture)
+    return false;
+
+  YUVBUFFER &buf = m_buffers[index];
+  YV12Image &im  = buf.image;
+  if ((im.flags&(~IMAGE_FLAG_READY)) != 0
+  ||  picture->iWidth != im.width || picture->iHeight != im.height)
+    return false;
+
+  CDVDVideoPictureBuffer *software = picture->buffer->Acquire();
+  SAFE_RELEASE(buf.software);
+  buf.software = software;
+
+  im.flags |= IMAGE_FLAG_READY;
+  m_bImageReady = true;
+  return true;
+}
+
 void CLinuxRendererGL::GetPlaneTextureSize(YUVPLANE& plane)
 {
   /* texture is assumed to be bound */
@@ -566,9 +599,8 @@ void CLinuxRendererGL::Flush()
 
 void CLinuxRendererGL::ReleaseBuffer(int idx)
 {
-#if defined(HAVE_LIBVDPAU) || defined(HAVE_LIBVA) || defined(TARGET_DARWIN)
   YUVBUFFER &buf = m_buffers[idx];
-#endif
+  SAFE_RELEASE(buf.software);
 #ifdef HAVE_LIBVDPAU
   SAFE_RELEASE(buf.vdpau);
 #endif
@@ -1819,6 +1851,23 @@ bool CLinuxRendererGL::UploadYV12Texture(int source)
 
   if (!(im->flags&IMAGE_FLAG_READY))
     return false;
+
+  // the planes of a decoder picture are in client memory, the pbos of this buffer stay unused
+  YV12Image software;
+  GLuint    nopbo = 0;
+  GLuint   *pbo   = NULL;
+  if (buf.software)
+  {
+    software = *im;
+    for (int p = 0; p < MAX_PLANES; p++)
+    {
+      software.plane[p]  = buf.software->data[p];
+      software.stride[p] = buf.software->iLineSize[p];
+    }
+    im  = &software;
+    pbo = &nopbo;
+  }
+
   bool deinterlacing;
   if (m_currentField == FIELD_FULL)
     deinterlacing = false;
@@ -1835,47 +1884,47 @@ bool CLinuxRendererGL::UploadYV12Texture(int source)
     // Load Even Y Field
     LoadPlane( fields[FIELD_TOP][0] , GL_LUMINANCE, buf.flipindex
              , im->width, im->height >> 1
-             , im->stride[0]*2, im->bpp, im->plane[0] );
+             , im->stride[0]*2, im->bpp, im->plane[0], pbo );
 
     //load Odd Y Field
     LoadPlane( fields[FIELD_BOT][0], GL_LUMINANCE, buf.flipindex
              , im->width, im->height >> 1
-             , im->stride[0]*2, im->bpp, im->plane[0] + im->stride[0]) ;
+             , im->stride[0]*2, im->bpp, im->plane[0] + im->stride[0], pbo) ;
 
     // Load Even U & V Fields
     LoadPlane( fields[FIELD_TOP][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[1]*2, im->bpp, im->plane[1] );
+             , im->stride[1]*2, im->bpp, im->plane[1], pbo );
 
     LoadPlane( fields[FIELD_TOP][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[2]*2, im->bpp, im->plane[2] );
+             , im->stride[2]*2, im->bpp, im->plane[2], pbo );
 
     // Load Odd U & V Fields
     LoadPlane( fields[FIELD_BOT][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[1]*2, im->bpp, im->plane[1] + im->stride[1] );
+             , im->stride[1]*2, im->bpp, im->plane[1] + im->stride[1], pbo );
 
     LoadPlane( fields[FIELD_BOT][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> (im->cshift_y + 1)
-             , im->stride[2]*2, im->bpp, im->plane[2] + im->stride[2] );
+             , im->stride[2]*2, im->bpp, im->plane[2] + im->stride[2], pbo );
   }
   else
   {
     //Load Y plane
     LoadPlane( fields[FIELD_FULL][0], GL_LUMINANCE, buf.flipindex
              , im->width, im->height
-             , im->stride[0], im->bpp, im->plane[0] );
+             , im->stride[0], im->bpp, im->plane[0], pbo );
 
     //load U plane
     LoadPlane( fields[FIELD_FULL][1], GL_LUMINANCE, buf.flipindex
              , im->width >> im->cshift_x, im->height >> im->cshift_y
-             , im->stride[1], im->bpp, im->plane[1] );
+             , im->stride[1], im->bpp, im->plane[1], pbo );
 
     //load V plane
     LoadPlane( fields[FIELD_FULL][2], GL_ALPHA, buf.flipindex
              , im->width >> im->cshift_x, im->height >> im->cshift_y
-             , im->stride[2], im->bpp, im->plane[2] );
+             , im->stride[2], im->bpp, im->plane[2], pbo);
   }
 
   VerifyGLState();
@@ -1892,6 +1941,8 @@ void CLinuxRendererGL::DeleteYV12Texture(int index)
   YUVFIELDS &fields = m_buffers[index].fields;
   GLuint    *pbo    = m_buffers[index].pbo;
 
+  SAFE_RELEASE(m_buffers[index].software);
+
   if( fields[FIELD_FULL][0].id == 0 ) return;
 
   /* finish up all textures, and delete them */
@@ -507,4 +507,40 @@ void CRenderCaptureDX::CleanupDX()
   m_surfaceHeight = 0;
 }
 
+#else /*HAS_DX*/
+
+CRenderCaptureSoftware::CRenderCaptureSoftware()
+{
+}
+
+CRenderCaptureSoftware::~CRenderCaptureSoftware()
+{
+  delete[] m_pixels;
+}
+
+int CRenderCaptureSoftware::GetCaptureFormat()
+{
+  return CAPTUREFORMAT_BGRA;
+}
+
+void CRenderCaptureSoftware::BeginRender()
+{
+  if (m_bufferSize != m_width * m_height * 4)
+  {
+    delete[] m_pixels;
+    m_bufferSize = m_width * m_height * 4;
+    m_pixels = new uint8_t[m_bufferSize];
+  }
+}
+
+void CRenderCaptureSoftware::EndRender()
+{
+  SetState(CAPTURESTATE_DONE);
+}
+
+void* CRenderCaptureSoftware::GetRenderBuffer()
+{
+  return m_pixels;
+}
+
 #endif /*HAS_DX*/
@@ -266,4 +266,28 @@ class CRenderCapture : public CRenderCaptureDX
     CRenderCapture() {};
 };
 
+#else /*HAS_DX*/
+
+//the software renderer converts straight into the pixel buffer
+class CRenderCaptureSoftware : public CRenderCaptureBase
+{
+  public:
+    CRenderCaptureSoftware();
+    ~CRenderCaptureSoftware();
+
+    int   GetCaptureFormat();
+
+    void  BeginRender();
+    void  EndRender();
+    void  ReadOut() {};
+
+    void* GetRenderBuffer();
+};
+
+class CRenderCapture : public CRenderCaptureSoftware
+{
+  public:
+    CRenderCapture() {};
+};
+
 #endif
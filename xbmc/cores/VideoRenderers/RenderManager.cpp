@@ -45,9 +45,8 @@
   #include "LinuxRendererGLES.h"
 #elif defined(HAS_DX)
   #include "WinRenderer.h"
-#elif defined(HAS_SDL)
-  #include "LinuxRenderer.h"
 #endif
+#include "SoftwareRenderer.h"
 
 #include "RenderCapture.h"
 
@@ -58,6 +57,9 @@
 
 #define MAXPRESENTDELAY 0.500
 
+/* seconds of video the queue absorbs of a decoder returning pictures in bursts */
+#define MAXBURSTTIME 0.100
+
 /* at any point we want an exclusive lock on rendermanager */
 /* we must make sure we don't have a graphiccontext lock */
 /* these two functions allow us to step out from that lock */
@@ -89,15 +91,12 @@ private:
   CCriticalSection &m_owned;
 };
 
-static void requeue(std::deque<int> &trg, std::deque<int> &src)
-{
-  trg.push_back(src.front());
-  src.pop_front();
-}
-
 CXBMCRenderManager::CXBMCRenderManager()
 {
   m_pRenderer = NULL;
+#if defined(HAS_GL) || HAS_GLES == 2
+  m_pPlatformRenderer = NULL;
+#endif
   m_bIsStarted = false;
 
   m_presentstep = PRESENT_IDLE;
@@ -112,6 +111,7 @@ CXBMCRenderManager::CXBMCRenderManager()
   m_errorindex = 0;
   m_QueueSize   = 2;
   m_QueueSkip   = 0;
+  m_QueueMemory = 0;
   m_format      = RENDER_FMT_NONE;
 }
 
@@ -119,6 +119,9 @@ CXBMCRenderManager::~CXBMCRenderManager()
 {
   delete m_pRenderer;
   m_pRenderer = NULL;
+#if defined(HAS_GL) || HAS_GLES == 2
+  m_pPlatformRenderer = NULL;
+#endif
 }
 
 void CXBMCRenderManager::GetVideoRect(CRect &source, CRect &dest)
@@ -212,18 +215,62 @@ CStdString CXBMCRenderManager::GetVSyncState()
     avgerror += m_errorbuff[i];
   avgerror /= ERRORBUFFSIZE;
 
-  CStdString state = StringUtils::Format("sync:%+3d%% avg:%3d%% error:%2d%%"
-                                         ,     MathUtils::round_int(m_presentcorr * 100)
-                                         ,     MathUtils::round_int(avgerror      * 100)
-                                         , abs(MathUtils::round_int(m_presenterr  * 100)));
+  SRenderQueueStats stats;
+  m_queue.GetStats(stats);
+
+  CStdString state = StringUtils::Format("sync:%+3d%% avg:%3d%% error:%2d%% queue:%3dms jitter:%2dms"
+                                         ,     MathUtils::round_int(m_presentcorr   * 100)
+                                         ,     MathUtils::round_int(avgerror        * 100)
+                                         , abs(MathUtils::round_int(m_presenterr    * 100))
+                                         ,     MathUtils::round_int(stats.residency * 1000)
+                                         ,     MathUtils::round_int(stats.jitter    * 1000));
   return state;
 }
 
-bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation, int buffers)
+static unsigned int GetPictureSize(ERenderFormat format, unsigned int width, unsigned int height)
 {
+  unsigned int pixels = width * height;
+  switch(format)
+  {
+    case RENDER_FMT_YUV420P:
+    case RENDER_FMT_NV12:
+      return pixels * 3 / 2;
+    case RENDER_FMT_YUV420P10:
+    case RENDER_FMT_YUV420P16:
+      return pixels * 3;
+    case RENDER_FMT_UYVY422:
+    case RENDER_FMT_YUYV422:
+      return pixels * 2;
+    default:
+      return 0; // the decoder owns the surfaces
+  }
+}
 
-  CSingleLock    lock2(m_presentlock);
+int CXBMCRenderManager::GetRenderDepth(float fps, int latency)
+{
+  int depth = g_advancedSettings.m_videoRenderBuffers;
+  if(depth <= 0)
+  {
+    depth = NUM_BUFFERS_DEFAULT;
 
+    /* a frame threaded decoder returns the pictures it held back all at
+     * once, room for them keeps the player from waiting on the renderer
+     * meanwhile. It takes more of them to cover a burst the more frames
+     * the display shows per second. */
+    if(latency > 0)
+    {
+      float rate = g_graphicsContext.GetFPS();
+      if(fps > 0.0f && (fps < rate || rate <= 0.0f))
+        rate = fps;
+      int burst = (int)ceil(rate * MAXBURSTTIME);
+      depth += std::min(latency, std::max(burst, 1));
+    }
+  }
+  return std::max(2, std::min(depth, NUM_BUFFERS));
+}
+
+bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation, int buffers, int latency)
+{
   /* make sure any queued frame was fully presented */
   XbmcThreads::EndTime endtime(5000);
   while(m_presentstep != PRESENT_IDLE)
@@ -233,9 +280,8 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
       CLog::Log(LOGWARNING, "CRenderManager::Configure - timeout waiting for state");
       return false;
     }
-    m_presentevent.wait(lock2, endtime.MillisLeft());
+    m_idleEvent.WaitMSec(endtime.MillisLeft());
   };
-  lock2.Leave();
 
   CExclusiveLock lock(m_sharedSection);
   if(!m_pRenderer)
@@ -254,19 +300,19 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
       CApplicationMessenger::Get().SwitchToFullscreen();
       lock.Enter();
     }
-    lock2.Enter();
     m_format = format;
 
+    int depth     = GetRenderDepth(fps, latency);
     int processor = m_pRenderer->GetProcessorSize();
     if(processor > buffers)                          /* DXVA-HD returns processor size 6 */
       m_QueueSize = 3;                               /* we need queue size of 3 to get future frames in the processor */
     else if(processor)
       m_QueueSize = buffers - processor + 1;         /* respect maximum refs */
     else
-      m_QueueSize = m_pRenderer->GetMaxBufferSize(); /* no refs to data */
+      m_QueueSize = depth;                           /* no refs to data */
 
     m_QueueSize = std::min(m_QueueSize, (int)m_pRenderer->GetMaxBufferSize());
-    m_QueueSize = std::min(m_QueueSize, NUM_BUFFERS);
+    m_QueueSize = std::min(m_QueueSize, processor ? NUM_BUFFERS_DEFAULT : depth); /* surfaces of the decoder are few */
     if(m_QueueSize < 2)
     {
       m_QueueSize = 2;
@@ -276,21 +322,18 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
     m_pRenderer->SetBufferSize(m_QueueSize);
     m_pRenderer->Update();
 
-    m_queued.clear();
-    m_discard.clear();
-    m_free.clear();
     m_presentsource = 0;
-    for (int i=1; i < m_QueueSize; i++)
-      m_free.push_back(i);
+    m_queue.Reset(m_QueueSize, m_presentsource);
 
     m_bIsStarted = true;
     m_bReconfigured = true;
-    m_presentstep = PRESENT_IDLE;
-    m_presentevent.notifyAll();
+    while(!ChangePresentStep(m_presentstep, PRESENT_IDLE)) {}
 
     m_firstFlipPage = false;  // tempfix
 
-    CLog::Log(LOGDEBUG, "CXBMCRenderManager::Configure - %d", m_QueueSize);
+    m_QueueMemory = m_QueueSize * GetPictureSize(format, width, height);
+    CLog::Log(LOGDEBUG, "CXBMCRenderManager::Configure - %d buffers of %d wanted for a latency of %d, %u kB"
+                      , m_QueueSize, depth, latency, m_QueueMemory / 1024);
   }
 
   return result;
@@ -316,35 +359,44 @@ void CXBMCRenderManager::Update()
     m_pRenderer->Update();
 }
 
+bool CXBMCRenderManager::ChangePresentStep(long from, EPRESENTSTEP to)
+{
+  if(cas(&m_presentstep, from, to) != from)
+    return false;
+
+  /* wake whoever waits for this step, each event has a single waiter */
+  if(to == PRESENT_IDLE)
+    m_idleEvent.Set();
+  else if(from == PRESENT_IDLE)
+    m_readyEvent.Set();
+  return true;
+}
+
 bool CXBMCRenderManager::FrameWait(int ms)
 {
   XbmcThreads::EndTime timeout(ms);
-  CSingleLock lock(m_presentlock);
   while(m_presentstep == PRESENT_IDLE && !timeout.IsTimePast())
-    m_presentevent.wait(lock, timeout.MillisLeft());
+    m_readyEvent.WaitMSec(timeout.MillisLeft());
   return m_presentstep != PRESENT_IDLE;
 }
 
 void CXBMCRenderManager::FrameMove()
 {
   { CSharedLock lock(m_sharedSection);
-    CSingleLock lock2(m_presentlock);
 
     if (!m_pRenderer)
       return;
 
     if (m_presentstep == PRESENT_FRAME2)
     {
-      if(!m_queued.empty())
+      int queued[RENDERQUEUE_SLOTS];
+      if(m_queue.GetQueued(queued) > 0)
       {
         double timestamp = GetPresentTime();
         SPresent& m = m_Queue[m_presentsource];
-        SPresent& q = m_Queue[m_queued.front()];
+        SPresent& q = m_Queue[queued[0]];
         if(timestamp > m.timestamp + (q.timestamp - m.timestamp) * 0.5)
-        {
-          m_presentstep = PRESENT_READY;
-          m_presentevent.notifyAll();
-        }
+          ChangePresentStep(PRESENT_FRAME2, PRESENT_READY);
       }
     }
 
@@ -354,18 +406,18 @@ void CXBMCRenderManager::FrameMove()
     if(m_presentstep == PRESENT_FLIP)
     {
       m_pRenderer->FlipPage(m_presentsource);
-      m_presentstep = PRESENT_FRAME;
-      m_presentevent.notifyAll();
+      ChangePresentStep(PRESENT_FLIP, PRESENT_FRAME);
     }
 
     /* release all previous */
-    for(std::deque<int>::iterator it = m_discard.begin(); it != m_discard.end(); )
+    int discarded[RENDERQUEUE_SLOTS];
+    int count = m_queue.GetDiscarded(discarded);
+    for(int i = 0; i < count; i++)
     {
       // TODO check for fence
-      m_pRenderer->ReleaseBuffer(*it);
-      m_overlays.Release(*it);
-      m_free.push_back(*it);
-      it = m_discard.erase(it);
+      m_pRenderer->ReleaseBuffer(discarded[i]);
+      m_overlays.Release(discarded[i]);
+      m_queue.Release(discarded[i]);
     }
   }
 }
@@ -378,28 +430,24 @@ void CXBMCRenderManager::FrameFinish()
   if(g_graphicsContext.IsFullScreenVideo())
     WaitPresentTime(m.timestamp);
 
-  { CSingleLock lock(m_presentlock);
-
-    if(m_presentstep == PRESENT_FRAME)
-    {
-      if( m.presentmethod == PRESENT_METHOD_BOB
-      ||  m.presentmethod == PRESENT_METHOD_WEAVE)
-        m_presentstep = PRESENT_FRAME2;
-      else
-        m_presentstep = PRESENT_IDLE;
-    }
-    else if(m_presentstep == PRESENT_FRAME2)
-      m_presentstep = PRESENT_IDLE;
-
-
-    if(m_presentstep == PRESENT_IDLE)
-    {
-      if(!m_queued.empty())
-        m_presentstep = PRESENT_READY;
-    }
+  if(m_presentstep == PRESENT_FRAME)
+  {
+    m_queue.Displayed(m.timestamp, GetPresentTime());
 
-    m_presentevent.notifyAll();
+    if( m.presentmethod == PRESENT_METHOD_BOB
+    ||  m.presentmethod == PRESENT_METHOD_WEAVE)
+      ChangePresentStep(PRESENT_FRAME, PRESENT_FRAME2);
+    else
+      ChangePresentStep(PRESENT_FRAME, PRESENT_IDLE);
   }
+  else if(m_presentstep == PRESENT_FRAME2)
+    ChangePresentStep(PRESENT_FRAME2, PRESENT_IDLE);
+
+  /* FlipPage only moves an idle step on, so a frame it queued after this
+   * check finds the step idle and does it itself */
+  int queued[RENDERQUEUE_SLOTS];
+  if(m_presentstep == PRESENT_IDLE && m_queue.GetQueued(queued) > 0)
+    ChangePresentStep(PRESENT_IDLE, PRESENT_READY);
 }
 
 unsigned int CXBMCRenderManager::PreInit()
@@ -414,21 +462,28 @@ unsigned int CXBMCRenderManager::PreInit()
   m_bIsStarted = false;
   if (!m_pRenderer)
   {
+    // the software renderer runs without a display, e.g. for tests
+    if (g_advancedSettings.m_videoSoftwareRenderer)
+      m_pRenderer = new CSoftwareRenderer();
+    else
+    {
 #if defined(HAS_GL)
-    m_pRenderer = new CLinuxRendererGL();
+      m_pRenderer = m_pPlatformRenderer = new CLinuxRendererGL();
 #elif HAS_GLES == 2
-    m_pRenderer = new CLinuxRendererGLES();
+      m_pRenderer = m_pPlatformRenderer = new CLinuxRendererGLES();
 #elif defined(HAS_DX)
-    m_pRenderer = new CWinRenderer();
-#elif defined(HAS_SDL)
-    m_pRenderer = new CLinuxRenderer();
+      m_pRenderer = new CWinRenderer();
+#else
+      m_pRenderer = new CSoftwareRenderer();
 #endif
+    }
   }
 
   UpdateDisplayLatency();
 
   m_QueueSize   = 2;
   m_QueueSkip   = 0;
+  m_QueueMemory = 0;
 
   return m_pRenderer->PreInit();
 }
@@ -685,26 +740,23 @@ void CXBMCRenderManager::FlipPage(volatile bool& bStop, double timestamp /* = 0L
     if(timestamp > GetPresentTime() + 5.0)
       timestamp = GetPresentTime() + 5.0;
 
-    CSingleLock lock2(m_presentlock);
-
-    if(m_free.empty())
-      return;
-
+    // the slot AddVideoPicture filled, or a free one for frames without a picture
+    if(source < 0)
+      source = m_queue.GetFill();
     if(source < 0)
-      source = m_free.front();
+      return;
+    CRenderQueue::EState state = m_queue.GetState(source);
+    if(state != CRenderQueue::STATE_FREE && state != CRenderQueue::STATE_FILLING)
+      return;
 
     SPresent& m = m_Queue[source];
     m.timestamp     = timestamp;
     m.presentfield  = sync;
     m.presentmethod = presentmethod;
-    requeue(m_queued, m_free);
+    m_queue.Queue(source, GetPresentTime());
 
-    /* signal to any waiters to check state */
-    if(m_presentstep == PRESENT_IDLE)
-    {
-      m_presentstep = PRESENT_READY;
-      m_presentevent.notifyAll();
-    }
+    /* wake the render thread, unless it is busy anyway */
+    ChangePresentStep(PRESENT_IDLE, PRESENT_READY);
   }
 }
 
@@ -853,7 +905,7 @@ void CXBMCRenderManager::UpdateResolution()
 unsigned int CXBMCRenderManager::GetProcessorSize()
 {
   CSharedLock lock(m_sharedSection);
-  return std::max(4, NUM_BUFFERS);
+  return std::max(4, NUM_BUFFERS_DEFAULT);
 }
 
 // Supported pixel formats, can be called before configure
@@ -871,13 +923,10 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
   if (!m_pRenderer)
     return -1;
 
-  int index;
-  {
-    CSingleLock lock(m_presentlock);
-    if (m_free.empty())
-      return -1;
-    index = m_free.front();
-  }
+  // kept for this frame until FlipPage queues it
+  int index = m_queue.GetFill();
+  if (index < 0)
+    return -1;
 
   if(m_pRenderer->AddVideoPicture(&pic, index))
     return 1;
@@ -905,30 +954,31 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
   {
     CDVDCodecUtils::CopyDXVA2Picture(&image, &pic);
   }
+  // the hardware formats are only among the SupportedFormats of the platform renderer
 #ifdef HAVE_LIBVDPAU
   else if(pic.format == RENDER_FMT_VDPAU
        || pic.format == RENDER_FMT_VDPAU_420)
-    m_pRenderer->AddProcessor(pic.vdpau, index);
+    m_pPlatformRenderer->AddProcessor(pic.vdpau, index);
 #endif
 #ifdef HAVE_LIBOPENMAX
   else if(pic.format == RENDER_FMT_OMXEGL)
-    m_pRenderer->AddProcessor(pic.openMax, &pic, index);
+    m_pPlatformRenderer->AddProcessor(pic.openMax, &pic, index);
 #endif
 #ifdef TARGET_DARWIN
   else if(pic.format == RENDER_FMT_CVBREF)
-    m_pRenderer->AddProcessor(pic.cvBufferRef, index);
+    m_pPlatformRenderer->AddProcessor(pic.cvBufferRef, index);
 #endif
 #ifdef HAVE_LIBVA
   else if(pic.format == RENDER_FMT_VAAPI)
-    m_pRenderer->AddProcessor(*pic.vaapi, index);
+    m_pPlatformRenderer->AddProcessor(*pic.vaapi, index);
 #endif
 #ifdef HAS_LIBSTAGEFRIGHT
   else if(pic.format == RENDER_FMT_EGLIMG)
-    m_pRenderer->AddProcessor(pic.stf, pic.eglimg, index);
+    m_pPlatformRenderer->AddProcessor(pic.stf, pic.eglimg, index);
 #endif
 #if defined(TARGET_ANDROID)
   else if(pic.format == RENDER_FMT_MEDIACODEC)
-    m_pRenderer->AddProcessor(pic.mediacodec, index);
+    m_pPlatformRenderer->AddProcessor(pic.mediacodec, index);
 #endif
 
   m_pRenderer->ReleaseImage(index, false);
@@ -994,12 +1044,11 @@ EINTERLACEMETHOD CXBMCRenderManager::AutoInterlaceMethodInternal(EINTERLACEMETHO
 
 int CXBMCRenderManager::WaitForBuffer(volatile bool& bStop, int timeout)
 {
-  CSingleLock lock2(m_presentlock);
-
   XbmcThreads::EndTime endtime(timeout);
-  while(m_free.empty())
+
+  /* a released slot wakes us right away, the timeout only polls bStop */
+  while(!m_queue.WaitFree(std::min(50, (int)endtime.MillisLeft())))
   {
-    m_presentevent.wait(lock2, std::min(50, timeout));
     if(endtime.IsTimePast() || bStop)
     {
       if (timeout != 0 && !bStop)
@@ -1009,21 +1058,20 @@ int CXBMCRenderManager::WaitForBuffer(volatile bool& bStop, int timeout)
   }
 
   // make sure overlay buffer is released, this won't happen on AddOverlay
-  m_overlays.Release(m_free.front());
+  m_overlays.Release(m_queue.GetFill());
 
   // return buffer level
-  return m_queued.size() + m_discard.size();;
+  return m_queue.GetPending();
 }
 
 void CXBMCRenderManager::PrepareNextRender()
 {
-  CSingleLock lock(m_presentlock);
-
-  if (m_queued.empty())
+  int queued[RENDERQUEUE_SLOTS];
+  int count = m_queue.GetQueued(queued);
+  if (count == 0)
   {
-    CLog::Log(LOGERROR, "CRenderManager::PrepareNextRender - asked to prepare with nothing available");
-    m_presentstep = PRESENT_IDLE;
-    m_presentevent.notifyAll();
+    /* the player discarded the queue meanwhile */
+    ChangePresentStep(PRESENT_READY, PRESENT_IDLE);
     return;
   }
 
@@ -1031,19 +1079,14 @@ void CXBMCRenderManager::PrepareNextRender()
   double frametime = 1.0 / GetMaximumFPS();
 
   /* see if any future queued frames are already due */
-  std::deque<int>::reverse_iterator curr, prev;
-  int idx;
-  curr = prev = m_queued.rbegin();
-  ++prev;
-  while (prev != m_queued.rend())
+  int curr = count - 1;
+  for (; curr > 0; curr--)
   {
-    if(clocktime > m_Queue[*prev].timestamp                 /* previous frame is late */
-    && clocktime > m_Queue[*curr].timestamp - frametime)    /* selected frame is close to it's display time */
+    if(clocktime > m_Queue[queued[curr - 1]].timestamp         /* previous frame is late */
+    && clocktime > m_Queue[queued[curr]].timestamp - frametime) /* selected frame is close to it's display time */
       break;
-    ++curr;
-    ++prev;
   }
-  idx = *curr;
+  int idx = queued[curr];
 
   /* in fullscreen we will block after render, but only for MAXPRESENTDELAY */
   bool next;
@@ -1054,30 +1097,27 @@ void CXBMCRenderManager::PrepareNextRender()
 
   if (next)
   {
+    /* the player may have discarded it, we look again on the next FrameMove */
+    if (!m_queue.Present(idx, clocktime))
+      return;
+
     /* skip late frames */
-    while(m_queued.front() != idx)
+    for (int i = 0; i < curr; i++)
     {
-      requeue(m_discard, m_queued);
-      m_QueueSkip++;
+      if (m_queue.Discard(queued[i]))
+        m_QueueSkip++;
     }
 
-    m_presentstep   = PRESENT_FLIP;
-    m_discard.push_back(m_presentsource);
+    /* DiscardBuffer may have made the step idle, the frame is ours anyway */
     m_presentsource = idx;
-    m_queued.pop_front();
-    m_presentevent.notifyAll();
+    while (!ChangePresentStep(m_presentstep, PRESENT_FLIP)) {}
   }
 }
 
 void CXBMCRenderManager::DiscardBuffer()
 {
   CSharedLock lock(m_sharedSection);
-  CSingleLock lock2(m_presentlock);
-
-  while(!m_queued.empty())
-    requeue(m_discard, m_queued);
 
-  if(m_presentstep == PRESENT_READY)
-    m_presentstep   = PRESENT_IDLE;
-  m_presentevent.notifyAll();
+  m_queue.DiscardQueued();
+  ChangePresentStep(PRESENT_READY, PRESENT_IDLE);
 }
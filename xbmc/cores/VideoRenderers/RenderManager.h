@@ -29,7 +29,7 @@
 #include "threads/Thread.h"
 #include "settings/VideoSettings.h"
 #include "OverlayRenderer.h"
-#include <deque>
+#include "RenderQueue.h"
 #include "PlatformDefs.h"
 
 class CRenderCapture;
@@ -42,7 +42,7 @@ struct DVDVideoPicture;
 #define ERRORBUFFSIZE 30
 
 class CWinRenderer;
-class CLinuxRenderer;
+class CSoftwareRenderer;
 class CLinuxRendererGL;
 class CLinuxRendererGLES;
 
@@ -83,7 +83,7 @@ public:
    * @param orientation
    * @param numbers of kept buffer references
    */
-  bool Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format,  unsigned int orientation, int buffers = 0);
+  bool Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format,  unsigned int orientation, int buffers = 0, int latency = 0);
   bool IsConfigured() const;
 
   int AddVideoPicture(DVDVideoPicture& picture);
@@ -109,7 +109,7 @@ public:
   void AddOverlay(CDVDOverlay* o, double pts)
   {
     CSharedLock lock(m_sharedSection);
-    m_overlays.AddOverlay(o, pts, m_free.front());
+    m_overlays.AddOverlay(o, pts, m_queue.GetFill());
   }
 
   void AddCleanup(OVERLAY::COverlay* o)
@@ -126,6 +126,9 @@ public:
   inline bool IsStarted() { return m_bIsStarted;}
   double GetDisplayLatency() { return m_displayLatency; }
   int    GetSkippedFrames()  { return m_QueueSkip; }
+  int    GetBufferCount()    { return m_QueueSize; }
+  unsigned int GetBufferMemory() { return m_QueueMemory; } // bytes of the pictures queued at most, 0 for hardware surfaces
+  void   GetQueueStats(SRenderQueueStats &stats) const { m_queue.GetStats(stats); }
 
   bool Supports(ERENDERFEATURE feature);
   bool Supports(EDEINTERLACEMODE method);
@@ -143,14 +146,11 @@ public:
 
   bool RendererHandlesPresent() const;
 
+  CBaseRenderer       *m_pRenderer;
 #ifdef HAS_GL
-  CLinuxRendererGL    *m_pRenderer;
+  CLinuxRendererGL    *m_pPlatformRenderer; // takes the hardware pictures, NULL with the software renderer
 #elif HAS_GLES == 2
-  CLinuxRendererGLES  *m_pRenderer;
-#elif defined(HAS_DX)
-  CWinRenderer        *m_pRenderer;
-#elif defined(HAS_SDL)
-  CLinuxRenderer      *m_pRenderer;
+  CLinuxRendererGLES  *m_pPlatformRenderer;
 #endif
 
   unsigned int GetProcessorSize();
@@ -206,6 +206,9 @@ protected:
   , PRESENT_READY
   };
 
+  /* compare and swap of m_presentstep, sets the events */
+  bool ChangePresentStep(long from, EPRESENTSTEP to);
+
   enum EPRESENTMETHOD
   {
     PRESENT_METHOD_SINGLE = 0,
@@ -217,8 +220,12 @@ protected:
   double m_displayLatency;
   void UpdateDisplayLatency();
 
+  /* buffers to queue for a decoder holding latency pictures back */
+  int GetRenderDepth(float fps, int latency);
+
   int m_QueueSize;
   int m_QueueSkip;
+  unsigned int m_QueueMemory;
 
   struct SPresent
   {
@@ -227,9 +234,7 @@ protected:
     EPRESENTMETHOD presentmethod;
   } m_Queue[NUM_BUFFERS];
 
-  std::deque<int> m_free;
-  std::deque<int> m_queued;
-  std::deque<int> m_discard;
+  CRenderQueue m_queue;
 
   ERenderFormat   m_format;
 
@@ -237,10 +242,10 @@ protected:
   double     m_presenterr;
   double     m_errorbuff[ERRORBUFFSIZE];
   int        m_errorindex;
-  EPRESENTSTEP     m_presentstep;
+  volatile long m_presentstep; // EPRESENTSTEP, see ChangePresentStep
   int        m_presentsource;
-  XbmcThreads::ConditionVariable  m_presentevent;
-  CCriticalSection m_presentlock;
+  CEvent     m_readyEvent;      // set when the step leaves PRESENT_IDLE
+  CEvent     m_idleEvent;       // set when the step returns to PRESENT_IDLE
   CEvent     m_flushEvent;
 
 
@@ -0,0 +1,222 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RenderQueue.h"
+#include "threads/Atomics.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+CRenderQueue::CRenderQueue()
+{
+  Reset(2, 0);
+}
+
+void CRenderQueue::Reset(int size, int present)
+{
+  m_size = std::max(1, std::min(size, RENDERQUEUE_SLOTS));
+  for (int i = 0; i < RENDERQUEUE_SLOTS; i++)
+  {
+    m_slots[i].state    = i == present ? STATE_PRESENT : STATE_FREE;
+    m_slots[i].sequence = 0;
+    m_slots[i].queued   = 0.0;
+  }
+  m_present   = present;
+  m_next      = 0;
+  m_filling   = -1;
+  m_sequence  = 0;
+  m_lastError = 0.0;
+  m_hasError  = false;
+
+  m_presented   = 0;
+  m_discarded   = 0;
+  m_jitterCount = 0;
+  memset(m_residency, 0, sizeof(m_residency));
+  memset(m_jitter,    0, sizeof(m_jitter));
+  m_freeEvent.Set();
+}
+
+bool CRenderQueue::Change(int index, EState from, EState to)
+{
+  return cas(&m_slots[index].state, from, to) == from;
+}
+
+int CRenderQueue::GetFree()
+{
+  for (int i = 0; i < m_size; i++)
+  {
+    int index = (m_next + i) % m_size;
+    if (m_slots[index].state == STATE_FREE)
+      return index;
+  }
+  return -1;
+}
+
+int CRenderQueue::GetFill()
+{
+  if (m_filling >= 0)
+    return m_filling;
+
+  int index = GetFree();
+  if (index >= 0 && Change(index, STATE_FREE, STATE_FILLING))
+    m_filling = index;
+  return m_filling;
+}
+
+bool CRenderQueue::WaitFree(int ms)
+{
+  if (m_filling >= 0 || GetFree() >= 0)
+    return true;
+  m_freeEvent.WaitMSec(ms);
+  return GetFree() >= 0;
+}
+
+bool CRenderQueue::Queue(int index, double clock)
+{
+  Slot &slot = m_slots[index];
+  slot.sequence = ++m_sequence;
+  slot.queued   = clock;
+  // the swap publishes the slot, the render thread reads nothing of it before
+  EState from = index == m_filling ? STATE_FILLING : STATE_FREE;
+  if (!Change(index, from, STATE_QUEUED))
+    return false;
+  if (index == m_filling)
+    m_filling = -1;
+  m_next = (index + 1) % m_size;
+  return true;
+}
+
+int CRenderQueue::DiscardQueued()
+{
+  int count = 0;
+  for (int i = 0; i < m_size; i++)
+  {
+    if (m_slots[i].state == STATE_QUEUED && Change(i, STATE_QUEUED, STATE_DISCARD))
+      count++;
+  }
+  AtomicAdd(&m_discarded, count);
+  return count;
+}
+
+int CRenderQueue::GetPending()
+{
+  int count = 0;
+  for (int i = 0; i < m_size; i++)
+  {
+    long state = m_slots[i].state;
+    if (state == STATE_QUEUED || state == STATE_DISCARD)
+      count++;
+  }
+  return count;
+}
+
+int CRenderQueue::GetQueued(int *indexes)
+{
+  int count = 0;
+  for (int i = 0; i < m_size; i++)
+  {
+    if (m_slots[i].state != STATE_QUEUED)
+      continue;
+
+    // oldest first, there are only a handful
+    int pos = count++;
+    for (; pos > 0 && m_slots[indexes[pos - 1]].sequence > m_slots[i].sequence; pos--)
+      indexes[pos] = indexes[pos - 1];
+    indexes[pos] = i;
+  }
+  return count;
+}
+
+bool CRenderQueue::Present(int index, double clock)
+{
+  if (!Change(index, STATE_QUEUED, STATE_PRESENT))
+    return false;
+
+  if (m_present != index)
+    Change(m_present, STATE_PRESENT, STATE_DISCARD);
+  m_present = index;
+
+  long presented = AtomicIncrement(&m_presented);
+  m_residency[(presented - 1) % RENDERQUEUE_WINDOW] = std::max(0.0, clock - m_slots[index].queued);
+  return true;
+}
+
+bool CRenderQueue::Discard(int index)
+{
+  if (!Change(index, STATE_QUEUED, STATE_DISCARD))
+    return false;
+  AtomicIncrement(&m_discarded);
+  return true;
+}
+
+int CRenderQueue::GetDiscarded(int *indexes)
+{
+  int count = 0;
+  for (int i = 0; i < m_size; i++)
+  {
+    if (m_slots[i].state == STATE_DISCARD)
+      indexes[count++] = i;
+  }
+  return count;
+}
+
+void CRenderQueue::Release(int index)
+{
+  if (Change(index, STATE_DISCARD, STATE_FREE))
+    m_freeEvent.Set();
+}
+
+void CRenderQueue::Displayed(double timestamp, double clock)
+{
+  double error = clock - timestamp;
+  if (m_hasError)
+  {
+    long count = AtomicIncrement(&m_jitterCount);
+    m_jitter[(count - 1) % RENDERQUEUE_WINDOW] = fabs(error - m_lastError);
+  }
+  m_lastError = error;
+  m_hasError  = true;
+}
+
+void CRenderQueue::GetStats(SRenderQueueStats &stats) const
+{
+  memset(&stats, 0, sizeof(stats));
+  stats.presented = m_presented;
+  stats.discarded = m_discarded;
+
+  int residencies = std::min((int)stats.presented, RENDERQUEUE_WINDOW);
+  for (int i = 0; i < residencies; i++)
+  {
+    stats.residency   += m_residency[i];
+    stats.residencyMax = std::max(stats.residencyMax, m_residency[i]);
+  }
+  if (residencies)
+    stats.residency /= residencies;
+
+  int jitters = std::min((int)m_jitterCount, RENDERQUEUE_WINDOW);
+  for (int i = 0; i < jitters; i++)
+  {
+    stats.jitter   += m_jitter[i];
+    stats.jitterMax = std::max(stats.jitterMax, m_jitter[i]);
+  }
+  if (jitters)
+    stats.jitter /= jitters;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/Event.h"
+
+#define RENDERQUEUE_SLOTS   8   // at least NUM_BUFFERS
+#define RENDERQUEUE_WINDOW  64  // frames the statistics are taken over
+
+struct SRenderQueueStats
+{
+  unsigned int presented;  // frames since the last reset
+  unsigned int discarded;  // frames dropped from the queue without being shown
+  double residency;        // seconds from FlipPage to present, average of the window
+  double residencyMax;
+  double jitter;           // seconds the display error changed from frame to frame, average of the window
+  double jitterMax;
+};
+
+/**
+ * The buffers of the render manager as a ring of slots with an atomic
+ * state each. The player thread takes a free slot to fill, keeps it until
+ * it is queued, the render thread presents queued slots and frees them
+ * again once the renderer released them:
+ *
+ *   FREE -> FILLING -> QUEUED -> PRESENT -> DISCARD -> FREE
+ *                         \_________________/
+ *
+ * Every transition is a compare and swap, so the player can drop queued
+ * slots (DiscardQueued) while the render thread picks one to present and
+ * exactly one of them wins. Only the player leaves FREE, only the render
+ * thread enters it. The slot being filled is the player's alone, so the
+ * overlays, the picture and the flip of a frame all go to the same slot
+ * whatever the render thread frees meanwhile.
+ */
+class CRenderQueue
+{
+public:
+  enum EState
+  {
+    STATE_FREE = 0
+  , STATE_FILLING
+  , STATE_QUEUED
+  , STATE_PRESENT
+  , STATE_DISCARD
+  };
+
+  CRenderQueue();
+
+  /* size slots, all free but present which is on display. Neither thread
+     may use the queue meanwhile. */
+  void Reset(int size, int present);
+  int  Size() const { return m_size; }
+  EState GetState(int index) const { return (EState)m_slots[index].state; }
+
+  // player thread
+  int  GetFree();                           // the next free slot, -1 if none
+  int  GetFill();                           // the slot being filled, taken from the free ones on first use, -1 if none
+  bool WaitFree(int ms);                    // true once there is a slot to fill
+  bool Queue(int index, double clock);      // a free or the filled slot, clock is the present clock of the call
+  int  DiscardQueued();                     // drops everything not presented yet
+  int  GetPending();                        // slots queued or not released yet
+
+  // render thread
+  int  GetQueued(int *indexes);             // the queued slots in the order they came, up to Size()
+  bool Present(int index, double clock);    // false if the player dropped the slot
+  bool Discard(int index);                  // a late queued slot
+  int  GetPresent() const { return m_present; }
+  int  GetDiscarded(int *indexes);          // slots the renderer has to release, up to Size()
+  void Release(int index);                  // wakes the player
+  void Displayed(double timestamp, double clock);
+
+  /* any thread, values may be a frame apart from each other */
+  void GetStats(SRenderQueueStats &stats) const;
+
+private:
+  bool Change(int index, EState from, EState to);
+
+  struct Slot
+  {
+    volatile long state;
+    long          sequence;  // queue order
+    double        queued;    // present clock at Queue
+  };
+  Slot   m_slots[RENDERQUEUE_SLOTS];
+  int    m_size;
+  CEvent m_freeEvent;
+
+  // player thread only
+  int  m_next;
+  int  m_filling;
+  long m_sequence;
+
+  // render thread only
+  int    m_present;
+  double m_lastError;
+  bool   m_hasError;
+
+  // counted atomically, the windows are written by the render thread only
+  volatile long m_presented;
+  volatile long m_discarded;
+  double m_residency[RENDERQUEUE_WINDOW];
+  double m_jitter[RENDERQUEUE_WINDOW];
+  volatile long m_jitterCount;
+};
@@ -0,0 +1,464 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "SoftwareRenderer.h"
+#include "RenderCapture.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/DisplaySettings.h"
+#include "settings/MediaSettings.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/MathUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/URIUtils.h"
+
+#include <string.h>
+
+CSoftwareRenderer::CSoftwareRenderer()
+{
+  m_bConfigured = false;
+  m_NumYV12Buffers = 0;
+  m_iYV12RenderBuffer = 0;
+
+  for (int i = 0; i < NUM_BUFFERS; i++)
+  {
+    memset(&m_buffers[i].image, 0, sizeof(YV12Image));
+    m_buffers[i].data = NULL;
+  }
+
+  m_surface = NULL;
+  m_surfaceWidth = 0;
+  m_surfaceHeight = 0;
+  m_surfaceSize = 0;
+
+  m_checksum = 0;
+  m_frames = 0;
+  m_convertTime = 0;
+}
+
+CSoftwareRenderer::~CSoftwareRenderer()
+{
+  UnInit();
+}
+
+unsigned int CSoftwareRenderer::PreInit()
+{
+  m_bConfigured = false;
+  UnInit();
+  m_resolution = CDisplaySettings::Get().GetCurrentResolution();
+  if ( m_resolution == RES_WINDOW )
+    m_resolution = RES_DESKTOP;
+
+  m_iYV12RenderBuffer = 0;
+
+  m_formats.clear();
+  m_formats.push_back(RENDER_FMT_YUV420P);
+  m_formats.push_back(RENDER_FMT_YUV420P10);
+  m_formats.push_back(RENDER_FMT_YUV420P16);
+  m_formats.push_back(RENDER_FMT_NV12);
+  m_formats.push_back(RENDER_FMT_YUYV422);
+  m_formats.push_back(RENDER_FMT_UYVY422);
+
+  return true;
+}
+
+void CSoftwareRenderer::UnInit()
+{
+  if (m_frames)
+    CLog::Log(LOGDEBUG, "CSoftwareRenderer::UnInit - %u frames rendered, %.2f ms each"
+                      , m_frames, 1000.0 * m_convertTime / CurrentHostFrequency() / m_frames);
+
+  for (int i = 0; i < NUM_BUFFERS; i++)
+    DeleteImage(i);
+
+  _aligned_free(m_surface);
+  m_surface = NULL;
+  m_surfaceWidth = 0;
+  m_surfaceHeight = 0;
+  m_surfaceSize = 0;
+
+  m_checksum = 0;
+  m_frames = 0;
+  m_convertTime = 0;
+  m_bConfigured = false;
+}
+
+bool CSoftwareRenderer::Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation)
+{
+  m_sourceWidth = width;
+  m_sourceHeight = height;
+  m_renderOrientation = orientation;
+  m_fps = fps;
+
+  // Save the flags.
+  m_iFlags = flags;
+  m_format = format;
+
+  // Calculate the input frame aspect ratio.
+  CalculateFrameAspectRatio(d_width, d_height);
+  ChooseBestResolution(fps);
+  SetViewMode(CMediaSettings::Get().GetCurrentVideoSettings().m_ViewMode);
+  ManageDisplay();
+
+  // the images are allocated in the new size on first use
+  for (int i = 0; i < NUM_BUFFERS; i++)
+    DeleteImage(i);
+
+  m_iYV12RenderBuffer = 0;
+  m_bConfigured = true;
+  return true;
+}
+
+bool CSoftwareRenderer::CreateImage(int index)
+{
+  YV12Image &im = m_buffers[index].image;
+
+  DeleteImage(index);
+
+  im.height = m_sourceHeight;
+  im.width  = m_sourceWidth;
+  im.bpp    = 1;
+
+  if (m_format == RENDER_FMT_YUYV422
+  ||  m_format == RENDER_FMT_UYVY422)
+  {
+    im.cshift_x = 0;
+    im.cshift_y = 0;
+    im.stride[0] = im.width * 2;
+    im.planesize[0] = im.stride[0] * im.height;
+  }
+  else if (m_format == RENDER_FMT_NV12)
+  {
+    im.cshift_x = 1;
+    im.cshift_y = 1;
+    im.stride[0] = im.width;
+    im.stride[1] = im.width;
+    im.planesize[0] = im.stride[0] * im.height;
+    im.planesize[1] = im.stride[1] * im.height / 2;
+  }
+  else
+  {
+    if (m_format == RENDER_FMT_YUV420P16
+    ||  m_format == RENDER_FMT_YUV420P10)
+      im.bpp = 2;
+
+    im.cshift_x = 1;
+    im.cshift_y = 1;
+    im.stride[0] = im.bpp *   im.width;
+    im.stride[1] = im.bpp * ( im.width >> im.cshift_x );
+    im.stride[2] = im.bpp * ( im.width >> im.cshift_x );
+    im.planesize[0] = im.stride[0] *   im.height;
+    im.planesize[1] = im.stride[1] * ( im.height >> im.cshift_y );
+    im.planesize[2] = im.stride[2] * ( im.height >> im.cshift_y );
+  }
+
+  /* the planes start 16 byte aligned */
+  int size = 0;
+  for (int p = 0; p < MAX_PLANES; p++)
+    size += (im.planesize[p] + 15) & ~15;
+
+  uint8_t *data = (uint8_t*)_aligned_malloc(size + 16, 16);
+  if (!data)
+  {
+    CLog::Log(LOGERROR, "CSoftwareRenderer::CreateImage - unable to allocate a %ux%u image", im.width, im.height);
+    memset(&im, 0, sizeof(im));
+    return false;
+  }
+  memset(data, 0, size);
+
+  m_buffers[index].data = data;
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    im.plane[p] = im.planesize[p] ? data : NULL;
+    data += (im.planesize[p] + 15) & ~15;
+  }
+  return true;
+}
+
+void CSoftwareRenderer::DeleteImage(int index)
+{
+  _aligned_free(m_buffers[index].data);
+  m_buffers[index].data = NULL;
+  memset(&m_buffers[index].image, 0, sizeof(YV12Image));
+}
+
+int CSoftwareRenderer::GetImage(YV12Image *image, int source, bool readonly)
+{
+  if (!image) return -1;
+  if (!m_bConfigured || m_NumYV12Buffers == 0) return -1;
+
+  /* take next available buffer */
+  if( source == AUTOSOURCE )
+    source = (m_iYV12RenderBuffer + 1) % m_NumYV12Buffers;
+
+  if (!m_buffers[source].data && !CreateImage(source))
+    return -1;
+
+  YV12Image &im = m_buffers[source].image;
+
+  if ((im.flags&(~IMAGE_FLAG_READY)) != 0)
+  {
+     CLog::Log(LOGDEBUG, "CSoftwareRenderer::GetImage - request image but none to give");
+     return -1;
+  }
+
+  if( readonly )
+    im.flags |= IMAGE_FLAG_READING;
+  else
+    im.flags |= IMAGE_FLAG_WRITING;
+
+  *image = im;
+  return source;
+}
+
+void CSoftwareRenderer::ReleaseImage(int source, bool preserve)
+{
+  YV12Image &im = m_buffers[source].image;
+
+  im.flags &= ~IMAGE_FLAG_INUSE;
+  im.flags |= IMAGE_FLAG_READY;
+  /* if image should be preserved reserve it so it's not auto seleceted */
+
+  if( preserve )
+    im.flags |= IMAGE_FLAG_RESERVED;
+}
+
+void CSoftwareRenderer::FlipPage(int source)
+{
+  if( source >= 0 && source < m_NumYV12Buffers )
+    m_iYV12RenderBuffer = source;
+  else if (m_NumYV12Buffers)
+    m_iYV12RenderBuffer = (m_iYV12RenderBuffer + 1) % m_NumYV12Buffers;
+}
+
+void CSoftwareRenderer::Reset()
+{
+  for(int i=0; i<m_NumYV12Buffers; i++)
+  {
+    /* reset all image flags, the next picture is awaited */
+    m_buffers[i].image.flags = 0;
+  }
+}
+
+void CSoftwareRenderer::Flush()
+{
+  Reset();
+  m_iYV12RenderBuffer = 0;
+}
+
+void CSoftwareRenderer::Update()
+{
+  if (!m_bConfigured) return;
+  ManageDisplay();
+}
+
+bool CSoftwareRenderer::Convert(CVideoScaler &scaler, const YV12Image &im, DWORD flags, uint8_t *dst, unsigned int width, unsigned int height, unsigned int stride)
+{
+  uint8_t *src[MAX_PLANES];
+  int      srcStride[MAX_PLANES];
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    src[p]       = im.plane[p];
+    srcStride[p] = im.stride[p];
+  }
+
+  /* bob takes every other line of the frame, weave shows it whole */
+  unsigned int srcHeight = im.height;
+  int field = flags & RENDER_FLAG_FIELDMASK;
+  if (field && !(flags & RENDER_FLAG_WEAVE))
+  {
+    for (int p = 0; p < MAX_PLANES; p++)
+    {
+      if (field == RENDER_FLAG_BOT && src[p])
+        src[p] += srcStride[p];
+      srcStride[p] *= 2;
+    }
+    srcHeight >>= 1;
+  }
+
+  ESCALINGMETHOD method = CMediaSettings::Get().GetCurrentVideoSettings().m_ScalingMethod;
+  if (!CVideoScaler::Supports(method))
+    method = VS_SCALINGMETHOD_LINEAR;
+
+  if (!scaler.Configure(m_format, im.width, srcHeight, width, height, method, m_iFlags))
+    return false;
+  return scaler.Convert(src, srcStride, dst, stride);
+}
+
+void CSoftwareRenderer::RenderUpdate(bool clear, DWORD flags, DWORD alpha)
+{
+  if (!m_bConfigured || m_NumYV12Buffers == 0)
+    return;
+
+  YV12Image &im = m_buffers[m_iYV12RenderBuffer].image;
+  if (!(im.flags & IMAGE_FLAG_READY))
+    return;
+
+  ManageDisplay();
+
+  /* there is no screen, the surface is the video rectangle alone */
+  unsigned int width  = MathUtils::round_int(m_destRect.Width());
+  unsigned int height = MathUtils::round_int(m_destRect.Height());
+  if (width == 0 || height == 0)
+  {
+    width  = m_sourceWidth;
+    height = m_sourceHeight;
+  }
+
+  if (width != m_surfaceWidth || height != m_surfaceHeight)
+  {
+    _aligned_free(m_surface);
+    m_surfaceWidth  = width;
+    m_surfaceHeight = height;
+    m_surfaceSize   = width * height * 4;
+    m_surface = (uint8_t*)_aligned_malloc(m_surfaceSize, 16);
+    if (!m_surface)
+    {
+      m_surfaceWidth = m_surfaceHeight = m_surfaceSize = 0;
+      return;
+    }
+  }
+
+  int64_t start = CurrentHostCounter();
+  if (!Convert(m_scaler, im, flags, m_surface, m_surfaceWidth, m_surfaceHeight, m_surfaceWidth * 4))
+    return;
+  m_convertTime += CurrentHostCounter() - start;
+  m_frames++;
+
+  if (g_advancedSettings.m_videoRenderChecksums)
+  {
+    Crc32 crc;
+    crc.Compute((const char*)m_surface, m_surfaceSize);
+    m_checksum = crc;
+    CLog::Log(LOGDEBUG, "CSoftwareRenderer::RenderUpdate - frame %u checksum %08x", m_frames, m_checksum);
+  }
+
+  if (!g_advancedSettings.m_videoRenderDumpPath.empty())
+    DumpSurface();
+}
+
+void CSoftwareRenderer::DumpSurface()
+{
+  CStdString file = URIUtils::AddFileToFolder(g_advancedSettings.m_videoRenderDumpPath
+                                            , StringUtils::Format("frame%06u.ppm", m_frames));
+
+  XFILE::CFile dump;
+  if (!dump.OpenForWrite(file, true))
+  {
+    CLog::Log(LOGERROR, "CSoftwareRenderer::DumpSurface - unable to write %s", file.c_str());
+    return;
+  }
+
+  CStdString header = StringUtils::Format("P6\n%u %u\n255\n", m_surfaceWidth, m_surfaceHeight);
+  dump.Write(header.c_str(), header.size());
+
+  std::vector<uint8_t> line(m_surfaceWidth * 3);
+  for (unsigned int y = 0; y < m_surfaceHeight; y++)
+  {
+    const uint8_t *bgra = m_surface + y * m_surfaceWidth * 4;
+    for (unsigned int x = 0; x < m_surfaceWidth; x++)
+    {
+      line[x * 3 + 0] = bgra[x * 4 + 2];
+      line[x * 3 + 1] = bgra[x * 4 + 1];
+      line[x * 3 + 2] = bgra[x * 4 + 0];
+    }
+    dump.Write(&line[0], line.size());
+  }
+  dump.Close();
+}
+
+const uint8_t* CSoftwareRenderer::GetSurface(unsigned int &width, unsigned int &height, unsigned int &stride)
+{
+  width  = m_surfaceWidth;
+  height = m_surfaceHeight;
+  stride = m_surfaceWidth * 4;
+  return m_surface;
+}
+
+bool CSoftwareRenderer::RenderCapture(CRenderCapture* capture)
+{
+#if defined(HAS_GL) || HAS_GLES == 2 || defined(HAS_DX)
+  // the capture reads back from the gpu, which we never drew to
+  return false;
+#else
+  if (!m_bConfigured || m_NumYV12Buffers == 0)
+    return false;
+
+  YV12Image &im = m_buffers[m_iYV12RenderBuffer].image;
+  if (!(im.flags & IMAGE_FLAG_READY))
+    return false;
+
+  capture->BeginRender();
+  bool result = Convert(m_captureScaler, im, 0, (uint8_t*)capture->GetRenderBuffer()
+                      , capture->GetWidth(), capture->GetHeight(), capture->GetWidth() * 4);
+  capture->EndRender();
+  return result;
+#endif
+}
+
+bool CSoftwareRenderer::Supports(ERENDERFEATURE feature)
+{
+  if (feature == RENDERFEATURE_STRETCH         ||
+      feature == RENDERFEATURE_CROP            ||
+      feature == RENDERFEATURE_ZOOM            ||
+      feature == RENDERFEATURE_VERTICAL_SHIFT  ||
+      feature == RENDERFEATURE_PIXEL_RATIO     ||
+      feature == RENDERFEATURE_POSTPROCESS)
+    return true;
+
+  return false;
+}
+
+bool CSoftwareRenderer::Supports(EDEINTERLACEMODE mode)
+{
+  if(mode == VS_DEINTERLACEMODE_OFF
+  || mode == VS_DEINTERLACEMODE_AUTO
+  || mode == VS_DEINTERLACEMODE_FORCE)
+    return true;
+
+  return false;
+}
+
+bool CSoftwareRenderer::Supports(EINTERLACEMETHOD method)
+{
+  if(method == VS_INTERLACEMETHOD_AUTO
+  || method == VS_INTERLACEMETHOD_DEINTERLACE
+  || method == VS_INTERLACEMETHOD_DEINTERLACE_HALF
+  || method == VS_INTERLACEMETHOD_SW_BLEND
+  || method == VS_INTERLACEMETHOD_RENDER_WEAVE
+  || method == VS_INTERLACEMETHOD_RENDER_BOB)
+    return true;
+
+  return false;
+}
+
+bool CSoftwareRenderer::Supports(ESCALINGMETHOD method)
+{
+  return CVideoScaler::Supports(method)
+      || method == VS_SCALINGMETHOD_AUTO;
+}
+
+EINTERLACEMETHOD CSoftwareRenderer::AutoInterlaceMethod()
+{
+  return VS_INTERLACEMETHOD_RENDER_BOB;
+}
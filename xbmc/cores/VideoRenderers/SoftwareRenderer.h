@@ -0,0 +1,114 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "settings/VideoSettings.h"
+#include "RenderFlags.h"
+#include "RenderFormats.h"
+#include "BaseRenderer.h"
+#include "VideoScaler.h"
+
+#include <stdint.h>
+#include <vector>
+
+class CRenderCapture;
+
+/**
+ * Renders video without a GPU. The pictures are converted and scaled to
+ * BGRA in a surface in memory, which may be dumped to files or
+ * checksummed per frame. It takes the place of the GL and DirectX
+ * renderers on builds without either, and is picked on any build with
+ * <video><softwarerenderer> in advancedsettings.xml, so the player can be
+ * driven through the render manager on machines without a display, for
+ * sync, frame drop and throughput tests.
+ */
+class CSoftwareRenderer : public CBaseRenderer
+{
+public:
+  CSoftwareRenderer();
+  virtual ~CSoftwareRenderer();
+
+  virtual void Update();
+  virtual void SetupScreenshot() {};
+
+  // Player functions
+  virtual bool Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags, ERenderFormat format, unsigned extended_format, unsigned int orientation);
+  virtual bool IsConfigured() { return m_bConfigured; }
+  virtual int          GetImage(YV12Image *image, int source = AUTOSOURCE, bool readonly = false);
+  virtual void         ReleaseImage(int source, bool preserve = false);
+  virtual void         FlipPage(int source);
+  virtual unsigned int PreInit();
+  virtual void         UnInit();
+  virtual void         Reset(); /* resets renderer after seek for example */
+  virtual void         Flush();
+  virtual void         SetBufferSize(int numBuffers) { m_NumYV12Buffers = numBuffers; }
+  virtual unsigned int GetMaxBufferSize() { return NUM_BUFFERS; }
+
+  virtual void RenderUpdate(bool clear, DWORD flags = 0, DWORD alpha = 255);
+  bool RenderCapture(CRenderCapture* capture);
+
+  // Feature support
+  virtual bool SupportsMultiPassRendering() { return false; }
+  virtual bool Supports(ERENDERFEATURE feature);
+  virtual bool Supports(EDEINTERLACEMODE mode);
+  virtual bool Supports(EINTERLACEMETHOD method);
+  virtual bool Supports(ESCALINGMETHOD method);
+
+  virtual EINTERLACEMETHOD AutoInterlaceMethod();
+
+  virtual std::vector<ERenderFormat> SupportedFormats() { return m_formats; }
+
+  /* the last frame rendered, BGRA, valid until the next RenderUpdate */
+  const uint8_t* GetSurface(unsigned int &width, unsigned int &height, unsigned int &stride);
+  uint32_t       GetChecksum() const { return m_checksum; }
+  unsigned int   GetFramesRendered() const { return m_frames; }
+
+protected:
+  bool CreateImage(int index);
+  void DeleteImage(int index);
+  bool Convert(CVideoScaler &scaler, const YV12Image &im, DWORD flags, uint8_t *dst, unsigned int width, unsigned int height, unsigned int stride);
+  void DumpSurface();
+
+  bool m_bConfigured;
+  int  m_NumYV12Buffers;
+  int  m_iYV12RenderBuffer;
+  std::vector<ERenderFormat> m_formats;
+
+  struct BUFFER
+  {
+    YV12Image image;
+    uint8_t  *data;
+  } m_buffers[NUM_BUFFERS];
+
+  CVideoScaler m_scaler;
+  CVideoScaler m_captureScaler; // captures have their own size, the filters of both are kept
+
+  uint8_t     *m_surface;
+  unsigned int m_surfaceWidth;
+  unsigned int m_surfaceHeight;
+  unsigned int m_surfaceSize;
+
+  // what a run through the renderer did
+  uint32_t     m_checksum;
+  unsigned int m_frames;
+  int64_t      m_convertTime;
+};
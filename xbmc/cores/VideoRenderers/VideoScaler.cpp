@@ -0,0 +1,568 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoScaler.h"
+#include "RenderFlags.h"
+#include "VideoShaders/ConvolutionKernels.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+/* entries of the kernel texture, the same the convolution shaders load */
+#define KERNEL_SIZE 256
+
+static inline int16_t Clip16(int value)
+{
+  return (int16_t)std::min(std::max(value, -32768), 32767);
+}
+
+static inline uint8_t Clip8(int value)
+{
+  return (uint8_t)std::min(std::max(value, 0), 255);
+}
+
+static void C_HScale(int16_t *dst, int width, const uint8_t *src, const int16_t *filter, const int32_t *pos, int size)
+{
+  for (int x = 0; x < width; x++)
+  {
+    const uint8_t *s = src + pos[x];
+    const int16_t *f = filter + (x >> 3) * size * 8 + (x & 7) * 4;
+    int sum = 1 << (VIDEOSCALER_FILTER_BITS - VIDEOSCALER_SAMPLE_BITS - 1);
+    for (int k = 0; k < size; k += 4, f += 32)
+      sum += s[k] * f[0] + s[k + 1] * f[1] + s[k + 2] * f[2] + s[k + 3] * f[3];
+    dst[x] = Clip16(sum >> (VIDEOSCALER_FILTER_BITS - VIDEOSCALER_SAMPLE_BITS));
+  }
+}
+
+static void C_VScale(int16_t *dst, int width, const int16_t* const *src, const int16_t *filter, int size)
+{
+  for (int x = 0; x < width; x++)
+  {
+    int sum = 1 << (VIDEOSCALER_FILTER_BITS - 1);
+    for (int k = 0; k < size; k++)
+      sum += src[k][x] * filter[k];
+    dst[x] = Clip16(sum >> VIDEOSCALER_FILTER_BITS);
+  }
+}
+
+/* the products keep their upper 16 bits like pmulhw, the results are 8 bit << 3 */
+static void C_YUV2RGB(uint8_t *dst, int width, const int16_t *y, const int16_t *u, const int16_t *v, const int16_t *matrix)
+{
+  const int center = 128 << VIDEOSCALER_SAMPLE_BITS;
+  for (int x = 0; x < width; x++, dst += 4)
+  {
+    int luma = (Clip16(y[x] - matrix[0]) * matrix[1]) >> 16;
+    int cb   = Clip16(u[x] - center);
+    int cr   = Clip16(v[x] - center);
+
+    int r = luma + ((cr * matrix[2]) >> 16);
+    int g = luma + ((cb * matrix[3]) >> 16) + ((cr * matrix[4]) >> 16);
+    int b = luma + ((cb * matrix[5]) >> 16);
+
+    dst[0] = Clip8((b + 4) >> 3);
+    dst[1] = Clip8((g + 4) >> 3);
+    dst[2] = Clip8((r + 4) >> 3);
+    dst[3] = 0xff;
+  }
+}
+
+static const CVideoScaler::SScalerKernels g_kernelsC =
+{
+  C_HScale,
+  C_VScale,
+  C_YUV2RGB
+};
+
+const CVideoScaler::SScalerKernels& CVideoScaler::GetKernels()
+{
+  // every thread gets the same table, so the race on the first call is harmless
+  static const SScalerKernels *kernels = NULL;
+  if (!kernels)
+    kernels = &GetKernels(g_cpuInfo.GetCPUFeatures());
+  return *kernels;
+}
+
+const CVideoScaler::SScalerKernels& CVideoScaler::GetKernels(unsigned int features)
+{
+  const SScalerKernels *kernels = NULL;
+  if (features & CPU_FEATURE_AVX2)
+    kernels = GetKernelsAVX2();
+  if (!kernels && (features & CPU_FEATURE_SSE2))
+    kernels = GetKernelsSSE2();
+  if (!kernels)
+    kernels = &g_kernelsC;
+  return *kernels;
+}
+
+// the factors of u and v for r, g and b, the same as the YUV2RGB shaders use
+static const float yuv_coef_bt601[4]    = { 1.403f,  -0.344f,  -0.714f,  1.773f  };
+static const float yuv_coef_bt709[4]    = { 1.5701f, -0.1870f, -0.4664f, 1.8556f };
+static const float yuv_coef_ebu[4]      = { 1.140f,  -0.3960f, -0.581f,  2.029f  };
+static const float yuv_coef_smtp240m[4] = { 1.5756f, -0.2253f, -0.5000f, 1.8270f };
+
+/* the radius of the filter of a method, in source samples */
+static double FilterRadius(ESCALINGMETHOD method)
+{
+  switch (method)
+  {
+    case VS_SCALINGMETHOD_NEAREST:
+      return 0.5;
+    case VS_SCALINGMETHOD_LINEAR:
+      return 1.0;
+    case VS_SCALINGMETHOD_LANCZOS3:
+    case VS_SCALINGMETHOD_SPLINE36:
+      return 3.0;
+    default:
+      return 2.0;
+  }
+}
+
+/*
+  The weight at distance x, read from the kernel texture. Entry i of the 4
+  tap kernels holds W(i / size + j - 2) in tap j, the 6 tap kernels hold
+  W(2 * i / size + 2 * j - 3) in their 3 taps.
+*/
+static double FilterWeight(ESCALINGMETHOD method, CConvolutionKernel *kernel, double x)
+{
+  if (method == VS_SCALINGMETHOD_NEAREST)
+    return x >= -0.5 && x < 0.5 ? 1.0 : 0.0;
+  if (method == VS_SCALINGMETHOD_LINEAR)
+    return std::max(0.0, 1.0 - fabs(x));
+
+  double radius = FilterRadius(method);
+  double spread = radius > 2.0 ? 2.0 : 1.0;
+  int    taps   = radius > 2.0 ? 3 : 4;
+
+  double z     = (x + radius) / spread;
+  int    tap   = (int)floor(z);
+  int    entry = (int)floor((z - tap) * kernel->GetSize() + 0.5);
+  if (entry == kernel->GetSize())
+  {
+    entry = 0;
+    tap++;
+  }
+
+  if (tap < 0 || tap >= taps)
+    return 0.0;
+  return kernel->GetFloatPixels()[entry * 4 + tap];
+}
+
+CVideoScaler::CVideoScaler()
+{
+  m_kernels    = &GetKernels();
+  m_format     = RENDER_FMT_NONE;
+  m_method     = VS_SCALINGMETHOD_NEAREST;
+  m_flags      = 0;
+  m_srcWidth   = 0;
+  m_srcHeight  = 0;
+  m_dstWidth   = 0;
+  m_dstHeight  = 0;
+  m_configured = false;
+  m_lineSize   = 0;
+  m_src        = NULL;
+  m_srcStride  = NULL;
+  memset(m_matrix, 0, sizeof(m_matrix));
+}
+
+CVideoScaler::~CVideoScaler()
+{
+}
+
+bool CVideoScaler::Supports(ERenderFormat format)
+{
+  return format == RENDER_FMT_YUV420P
+      || format == RENDER_FMT_YUV420P10
+      || format == RENDER_FMT_YUV420P16
+      || format == RENDER_FMT_NV12
+      || format == RENDER_FMT_YUYV422
+      || format == RENDER_FMT_UYVY422;
+}
+
+bool CVideoScaler::Supports(ESCALINGMETHOD method)
+{
+  return method == VS_SCALINGMETHOD_NEAREST
+      || method == VS_SCALINGMETHOD_LINEAR
+      || method == VS_SCALINGMETHOD_CUBIC
+      || method == VS_SCALINGMETHOD_LANCZOS2
+      || method == VS_SCALINGMETHOD_LANCZOS3_FAST
+      || method == VS_SCALINGMETHOD_LANCZOS3
+      || method == VS_SCALINGMETHOD_SPLINE36_FAST
+      || method == VS_SCALINGMETHOD_SPLINE36;
+}
+
+bool CVideoScaler::Configure(ERenderFormat format, unsigned int srcWidth, unsigned int srcHeight,
+                             unsigned int dstWidth, unsigned int dstHeight, ESCALINGMETHOD method, unsigned int flags)
+{
+  flags &= CONF_FLAGS_YUVCOEF_MASK(0xffffffff) | CONF_FLAGS_YUV_FULLRANGE | CONF_FLAGS_CHROMA_MASK(0xffffffff);
+
+  if (m_configured
+  &&  m_format    == format
+  &&  m_srcWidth  == srcWidth
+  &&  m_srcHeight == srcHeight
+  &&  m_dstWidth  == dstWidth
+  &&  m_dstHeight == dstHeight
+  &&  m_method    == method
+  &&  m_flags     == flags)
+    return true;
+
+  m_configured = false;
+  if (!Supports(format) || !Supports(method))
+  {
+    CLog::Log(LOGERROR, "CVideoScaler::Configure - unsupported format %d or scaling method %d", format, method);
+    return false;
+  }
+  if (!srcWidth || !srcHeight || !dstWidth || !dstHeight)
+    return false;
+
+  m_format    = format;
+  m_srcWidth  = srcWidth;
+  m_srcHeight = srcHeight;
+  m_dstWidth  = dstWidth;
+  m_dstHeight = dstHeight;
+  m_method    = method;
+  m_flags     = flags;
+
+  CConvolutionKernel *kernel = NULL;
+  if (method != VS_SCALINGMETHOD_NEAREST && method != VS_SCALINGMETHOD_LINEAR)
+    kernel = new CConvolutionKernel(method, KERNEL_SIZE);
+
+  bool packed = format == RENDER_FMT_YUYV422 || format == RENDER_FMT_UYVY422;
+
+  // output pixel centers in source samples
+  double stepx  = (double)srcWidth  / dstWidth;
+  double stepy  = (double)srcHeight / dstHeight;
+  double startx = stepx * 0.5 - 0.5;
+  double starty = stepy * 0.5 - 0.5;
+
+  // where the chroma samples sit between the luma samples, mpeg2 by default
+  double chromax = 0.0;
+  double chromay = 0.5;
+  if (CONF_FLAGS_CHROMA_MASK(flags) == CONF_FLAGS_CHROMA_CENTER)
+    chromax = 0.5;
+  else if (CONF_FLAGS_CHROMA_MASK(flags) == CONF_FLAGS_CHROMA_TOPLEFT)
+    chromay = 0.0;
+
+  m_lineSize = ((dstWidth + 15) & ~15) + 16;
+
+  bool ok = true;
+  for (int p = 0; p < 3; p++)
+  {
+    SPlane &plane = m_planes[p];
+    if (p == 0)
+    {
+      plane.width  = srcWidth;
+      plane.height = srcHeight;
+      ok &= InitFilter(plane.hfilter, kernel, dstWidth,  plane.width,  stepx, startx, true);
+      ok &= InitFilter(plane.vfilter, kernel, dstHeight, plane.height, stepy, starty, false);
+    }
+    else
+    {
+      plane.width  = (srcWidth + 1) >> 1;
+      plane.height = packed ? srcHeight : (srcHeight + 1) >> 1;
+      ok &= InitFilter(plane.hfilter, kernel, dstWidth,  plane.width, stepx / 2, (startx - chromax) / 2, true);
+      if (packed)
+        ok &= InitFilter(plane.vfilter, kernel, dstHeight, plane.height, stepy, starty, false);
+      else
+        ok &= InitFilter(plane.vfilter, kernel, dstHeight, plane.height, stepy / 2, (starty - chromay) / 2, false);
+    }
+
+    plane.ring.assign(plane.vfilter.size * m_lineSize, 0);
+    plane.rows.assign(plane.vfilter.size, -1);
+    plane.line.assign(std::max(plane.width, plane.hfilter.size), 0);
+    plane.out.assign(m_lineSize, 0);
+    plane.taps.assign(plane.vfilter.size, NULL);
+  }
+  delete kernel;
+
+  if (!ok)
+    return false;
+
+  InitMatrix(flags);
+
+  CLog::Log(LOGDEBUG, "CVideoScaler::Configure - %ux%u to %ux%u, %dx%d luma and %dx%d chroma taps"
+                    , srcWidth, srcHeight, dstWidth, dstHeight
+                    , m_planes[0].hfilter.size, m_planes[0].vfilter.size
+                    , m_planes[1].hfilter.size, m_planes[1].vfilter.size);
+
+  m_configured = true;
+  return true;
+}
+
+/*
+  The filter of every output is normalized, quantized and trimmed of its
+  zero taps, samples outside the plane repeat the edge. The horizontal taps
+  are padded to a multiple of 4 and kept within the line, so the kernels
+  never read past it; the vertical ones are padded to pairs.
+*/
+bool CVideoScaler::InitFilter(SFilter &filter, CConvolutionKernel *kernel, int dstSize, int srcSize, double step, double start, bool horizontal)
+{
+  if (dstSize <= 0 || srcSize <= 0)
+    return false;
+
+  double factor  = std::max(1.0, step);
+  double radius  = FilterRadius(m_method) * factor;
+  int    maxTaps = (int)floor(radius * 2.0) + 1;
+
+  std::vector<int>    first(dstSize);
+  std::vector<int>    count(dstSize);
+  std::vector<int>    coefs(dstSize * maxTaps);
+  std::vector<double> weights(maxTaps);
+
+  int size = 1;
+  for (int i = 0; i < dstSize; i++)
+  {
+    double pos = start + i * step;
+    int    a   = (int)ceil(pos - radius);
+    int    b   = (int)floor(pos + radius);
+    int    lo  = std::min(std::max(a, 0), srcSize - 1);
+    int    hi  = std::min(std::max(b, 0), srcSize - 1);
+
+    std::fill(weights.begin(), weights.end(), 0.0);
+    double sum = 0.0;
+    for (int j = a; j <= b; j++)
+    {
+      double w = FilterWeight(m_method, kernel, (j - pos) / factor);
+      weights[std::min(std::max(j, 0), srcSize - 1) - lo] += w;
+      sum += w;
+    }
+    if (fabs(sum) < 1e-6)
+    {
+      // too narrow to hit a sample, take the nearest
+      std::fill(weights.begin(), weights.end(), 0.0);
+      int nearest = (int)floor(pos + 0.5);
+      weights[std::min(std::max(nearest, lo), hi) - lo] = 1.0;
+      sum = 1.0;
+    }
+
+    int *c     = &coefs[i * maxTaps];
+    int  n     = hi - lo + 1;
+    int  total = 0;
+    int  big   = 0;
+    for (int k = 0; k < n; k++)
+    {
+      c[k] = (int)floor(weights[k] / sum * (1 << VIDEOSCALER_FILTER_BITS) + 0.5);
+      total += c[k];
+      if (abs(c[k]) > abs(c[big]))
+        big = k;
+    }
+    c[big] += (1 << VIDEOSCALER_FILTER_BITS) - total;
+
+    int head = 0;
+    while (head < n - 1 && c[head] == 0)
+      head++;
+    int tail = n;
+    while (tail > head + 1 && c[tail - 1] == 0)
+      tail--;
+    if (head)
+      memmove(c, c + head, (tail - head) * sizeof(int));
+
+    first[i] = lo + head;
+    count[i] = tail - head;
+    size     = std::max(size, count[i]);
+  }
+
+  if (horizontal)
+  {
+    size = (size + 3) & ~3;
+    int groups  = (dstSize + 7) / 8;
+    int lineLen = std::max(srcSize, size);
+
+    filter.size = size;
+    filter.coefs.assign(groups * 8 * size, 0);
+    filter.pos.assign(groups * 8, 0);
+    for (int i = 0; i < dstSize; i++)
+    {
+      int pos = std::min(first[i], lineLen - size);
+      int16_t *f = &filter.coefs[(i >> 3) * size * 8 + (i & 7) * 4];
+      for (int k = 0; k < count[i]; k++)
+      {
+        int tap = first[i] - pos + k;
+        f[(tap >> 2) * 32 + (tap & 3)] = (int16_t)coefs[i * maxTaps + k];
+      }
+      filter.pos[i] = pos;
+    }
+  }
+  else
+  {
+    if (size > 1)
+      size = (size + 1) & ~1;
+
+    filter.size = size;
+    filter.coefs.assign(dstSize * size, 0);
+    filter.pos.assign(dstSize, 0);
+    for (int i = 0; i < dstSize; i++)
+    {
+      for (int k = 0; k < count[i]; k++)
+        filter.coefs[i * size + k] = (int16_t)coefs[i * maxTaps + k];
+      filter.pos[i] = first[i];
+    }
+  }
+  return true;
+}
+
+void CVideoScaler::InitMatrix(unsigned int flags)
+{
+  const float *coef;
+  switch (CONF_FLAGS_YUVCOEF_MASK(flags))
+  {
+    case CONF_FLAGS_YUVCOEF_240M:
+      coef = yuv_coef_smtp240m; break;
+    case CONF_FLAGS_YUVCOEF_BT709:
+      coef = yuv_coef_bt709; break;
+    case CONF_FLAGS_YUVCOEF_EBU:
+      coef = yuv_coef_ebu; break;
+    case CONF_FLAGS_YUVCOEF_BT601:
+    default:
+      coef = yuv_coef_bt601; break;
+  }
+
+  float offset = 0.0f;
+  float luma   = 1.0f;
+  float chroma = 1.0f;
+  if (!(flags & CONF_FLAGS_YUV_FULLRANGE))
+  {
+    offset = 16.0f;
+    luma   = 255.0f / (235 - 16);
+    chroma = 255.0f / (240 - 16);
+  }
+
+  memset(m_matrix, 0, sizeof(m_matrix));
+  m_matrix[0] = (int16_t)(offset * (1 << VIDEOSCALER_SAMPLE_BITS));
+  m_matrix[1] = (int16_t)floor(luma * 8192.0f + 0.5f);
+  for (int i = 0; i < 4; i++)
+    m_matrix[i + 2] = (int16_t)floor(coef[i] * chroma * 8192.0f + 0.5f);
+}
+
+const uint8_t* CVideoScaler::GetSourceLine(int p, int row)
+{
+  SPlane &plane = m_planes[p];
+  uint8_t *line = &plane.line[0];
+  int width = plane.width;
+
+  switch (m_format)
+  {
+    case RENDER_FMT_YUV420P10:
+    case RENDER_FMT_YUV420P16:
+    {
+      // the lower bits don't make it to 8 bit rgb anyway
+      const uint16_t *s = (const uint16_t*)(m_src[p] + row * m_srcStride[p]);
+      int shift = m_format == RENDER_FMT_YUV420P10 ? 2 : 8;
+      for (int x = 0; x < width; x++)
+        line[x] = (uint8_t)std::min(s[x] >> shift, 255);
+      return line;
+    }
+
+    case RENDER_FMT_NV12:
+      if (p > 0)
+      {
+        const uint8_t *s = m_src[1] + row * m_srcStride[1] + p - 1;
+        for (int x = 0; x < width; x++)
+          line[x] = s[x * 2];
+        return line;
+      }
+      break;
+
+    case RENDER_FMT_YUYV422:
+    case RENDER_FMT_UYVY422:
+    {
+      const uint8_t *s = m_src[0] + row * m_srcStride[0];
+      if (m_format == RENDER_FMT_UYVY422)
+        s += p == 0 ? 1 : -1;
+      if (p == 0)
+      {
+        for (int x = 0; x < width; x++)
+          line[x] = s[x * 2];
+      }
+      else
+      {
+        s += p * 2 - 1;
+        for (int x = 0; x < width; x++)
+          line[x] = s[x * 4];
+      }
+      return line;
+    }
+
+    default:
+      break;
+  }
+
+  const uint8_t *s = m_src[p] + row * m_srcStride[p];
+  if (width >= plane.hfilter.size)
+    return s;
+
+  // narrower than the filter, the taps past the plane are 0
+  memcpy(line, s, width);
+  return line;
+}
+
+const int16_t* CVideoScaler::GetScaledLine(int p, int row)
+{
+  SPlane  &plane = m_planes[p];
+  int      slot  = row % plane.vfilter.size;
+  int16_t *line  = &plane.ring[slot * m_lineSize];
+  if (plane.rows[slot] != row)
+  {
+    m_kernels->hscale(line, m_dstWidth, GetSourceLine(p, row), &plane.hfilter.coefs[0], &plane.hfilter.pos[0], plane.hfilter.size);
+    plane.rows[slot] = row;
+  }
+  return line;
+}
+
+bool CVideoScaler::Convert(uint8_t* const src[], const int srcStride[], uint8_t *dst, int dstStride)
+{
+  if (!m_configured)
+    return false;
+
+  m_src       = src;
+  m_srcStride = srcStride;
+  for (int p = 0; p < 3; p++)
+    std::fill(m_planes[p].rows.begin(), m_planes[p].rows.end(), -1);
+
+  for (unsigned int y = 0; y < m_dstHeight; y++)
+  {
+    const int16_t *lines[3];
+    for (int p = 0; p < 3; p++)
+    {
+      SPlane &plane = m_planes[p];
+      int size = plane.vfilter.size;
+      int pos  = plane.vfilter.pos[y];
+
+      // a single tap is the line as it is
+      if (size == 1)
+      {
+        lines[p] = GetScaledLine(p, pos);
+        continue;
+      }
+
+      for (int k = 0; k < size; k++)
+        plane.taps[k] = GetScaledLine(p, std::min(pos + k, plane.height - 1));
+      m_kernels->vscale(&plane.out[0], m_dstWidth, &plane.taps[0], &plane.vfilter.coefs[y * size], size);
+      lines[p] = &plane.out[0];
+    }
+    m_kernels->yuv2rgb(dst + y * dstStride, m_dstWidth, lines[0], lines[1], lines[2], m_matrix);
+  }
+
+  m_src       = NULL;
+  m_srcStride = NULL;
+  return true;
+}
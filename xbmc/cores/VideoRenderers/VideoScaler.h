@@ -0,0 +1,137 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RenderFormats.h"
+#include "settings/VideoSettings.h"
+
+#include <stdint.h>
+#include <vector>
+
+class CConvolutionKernel;
+
+/* the filter taps are Q14, the samples between the passes are 8 bit << 6 */
+#define VIDEOSCALER_FILTER_BITS 14
+#define VIDEOSCALER_SAMPLE_BITS 6
+
+/**
+ * Converts and scales YUV pictures to BGRA on the CPU, the counterpart of
+ * the YUV2RGB and convolution shaders for captures, thumbnails and the
+ * software renderer. The colour matrices are those of the shaders and the
+ * filter taps are sampled from CConvolutionKernel, so a picture comes out
+ * the way the GL renderer would draw it. When downscaling the filters are
+ * widened to the source step, thumbnails don't alias.
+ *
+ * Every line is scaled horizontally once, into a ring of 14 bit lines per
+ * plane, then the rings are filtered vertically and converted. The line
+ * kernels are picked by CCPUInfo, all sets give the same output bit for bit.
+ */
+class CVideoScaler
+{
+public:
+  /* size taps per output, pos is the first sample of every output */
+  typedef void (*HScaleFn) (int16_t *dst, int width, const uint8_t *src, const int16_t *filter, const int32_t *pos, int size);
+  /* size lines weighted by size taps, size is even */
+  typedef void (*VScaleFn) (int16_t *dst, int width, const int16_t* const *src, const int16_t *filter, int size);
+  /* matrix is offset of luma, then the luma, vr, ug, vg and ub factors in Q13 */
+  typedef void (*YUV2RGBFn)(uint8_t *dst, int width, const int16_t *y, const int16_t *u, const int16_t *v, const int16_t *matrix);
+
+  /*
+    The line kernels a conversion is built from. The horizontal filter is
+    stored in groups of 8 outputs, each group holds size / 4 blocks of 8
+    outputs with 4 taps. hscale and vscale may write up to 16 outputs past
+    width into the lines, yuv2rgb writes exactly width pixels.
+  */
+  struct SScalerKernels
+  {
+    HScaleFn  hscale;
+    VScaleFn  vscale;
+    YUV2RGBFn yuv2rgb;
+  };
+
+  /* the fastest kernels of this cpu */
+  static const SScalerKernels& GetKernels();
+  /* the fastest kernels for a set of CPU_FEATURE_ flags, the C kernels for 0 */
+  static const SScalerKernels& GetKernels(unsigned int features);
+
+  CVideoScaler();
+  ~CVideoScaler();
+
+  static bool Supports(ERenderFormat format);
+  static bool Supports(ESCALINGMETHOD method);
+
+  /* flags are the CONF_FLAGS_ of the picture, matrix, range and chroma position. Cheap if nothing changed */
+  bool Configure(ERenderFormat format, unsigned int srcWidth, unsigned int srcHeight,
+                 unsigned int dstWidth, unsigned int dstHeight, ESCALINGMETHOD method, unsigned int flags);
+  /* converts a picture in the configured format to BGRA */
+  bool Convert(uint8_t* const src[], const int srcStride[], uint8_t *dst, int dstStride);
+
+  /* for tests and benchmarks, the kernels stay until the next call */
+  void SetKernels(const SScalerKernels &kernels) { m_kernels = &kernels; }
+
+private:
+  struct SFilter
+  {
+    int                  size;
+    std::vector<int16_t> coefs;
+    std::vector<int32_t> pos;
+  };
+
+  struct SPlane
+  {
+    int     width;
+    int     height;
+    SFilter hfilter;
+    SFilter vfilter;
+
+    std::vector<int16_t>  ring;    // vfilter.size horizontally scaled lines
+    std::vector<int>      rows;    // the source row in each ring line, -1 for none
+    std::vector<uint8_t>  line;    // the source line when it has to be unpacked or padded
+    std::vector<int16_t>  out;     // the vertically scaled line
+    std::vector<const int16_t*> taps;
+  };
+
+  bool InitFilter(SFilter &filter, CConvolutionKernel *kernel, int dstSize, int srcSize, double step, double start, bool horizontal);
+  void InitMatrix(unsigned int flags);
+  const uint8_t* GetSourceLine(int plane, int row);
+  const int16_t* GetScaledLine(int plane, int row);
+
+  static const SScalerKernels* GetKernelsSSE2();
+  static const SScalerKernels* GetKernelsAVX2();
+
+  const SScalerKernels *m_kernels;
+
+  ERenderFormat  m_format;
+  ESCALINGMETHOD m_method;
+  unsigned int   m_flags;
+  unsigned int   m_srcWidth;
+  unsigned int   m_srcHeight;
+  unsigned int   m_dstWidth;
+  unsigned int   m_dstHeight;
+  bool           m_configured;
+
+  SPlane   m_planes[3];
+  int      m_lineSize;
+  int16_t  m_matrix[8];
+
+  uint8_t* const *m_src;
+  const int      *m_srcStride;
+};
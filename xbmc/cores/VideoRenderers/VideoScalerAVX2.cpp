@@ -0,0 +1,142 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  This file is built with AVX2 code generation enabled, nothing in here may
+  be called unless CCPUInfo reports CPU_FEATURE_AVX2. The build defines
+  HAS_AVX2_KERNELS where it can compile the intrinsics, Visual Studio only
+  has them from 2012 onwards.
+*/
+
+#include "VideoScaler.h"
+
+#ifdef HAS_AVX2_KERNELS
+#include <immintrin.h>
+
+/*
+  A whole group of 8 outputs at a time, the 4 taps of every output in a
+  block are fetched with one gather. phaddd works within the 128bit lanes,
+  its sums are put back in order with a permute.
+*/
+static void AVX2_HScale(int16_t *dst, int width, const uint8_t *src, const int16_t *filter, const int32_t *pos, int size)
+{
+  const __m256i round = _mm256_set1_epi32(1 << (VIDEOSCALER_FILTER_BITS - VIDEOSCALER_SAMPLE_BITS - 1));
+
+  for (int x = 0; x < width; x += 8)
+  {
+    const int16_t *f = filter + (x >> 3) * size * 8;
+    __m256i p   = _mm256_loadu_si256((const __m256i*)(pos + x));
+    __m256i acc = round;
+
+    for (int k = 0; k < size; k += 4, f += 32)
+    {
+      __m256i s  = _mm256_i32gather_epi32((const int*)(src + k), p, 1);
+      __m256i m0 = _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(s)),      _mm256_loadu_si256((const __m256i*)f));
+      __m256i m1 = _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(s, 1)), _mm256_loadu_si256((const __m256i*)(f + 16)));
+      acc = _mm256_add_epi32(acc, _mm256_permute4x64_epi64(_mm256_hadd_epi32(m0, m1), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    acc = _mm256_srai_epi32(acc, VIDEOSCALER_FILTER_BITS - VIDEOSCALER_SAMPLE_BITS);
+    _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+  }
+}
+
+/* the unpacks and packs both work within the lanes, so the order comes out right */
+static void AVX2_VScale(int16_t *dst, int width, const int16_t* const *src, const int16_t *filter, int size)
+{
+  const __m256i round = _mm256_set1_epi32(1 << (VIDEOSCALER_FILTER_BITS - 1));
+
+  for (int x = 0; x < width; x += 16)
+  {
+    __m256i lo = round;
+    __m256i hi = round;
+    for (int k = 0; k < size; k += 2)
+    {
+      __m256i c = _mm256_set1_epi32((uint16_t)filter[k] | ((uint32_t)(uint16_t)filter[k + 1] << 16));
+      __m256i a = _mm256_loadu_si256((const __m256i*)(src[k] + x));
+      __m256i b = _mm256_loadu_si256((const __m256i*)(src[k + 1] + x));
+      lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), c));
+      hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), c));
+    }
+    lo = _mm256_srai_epi32(lo, VIDEOSCALER_FILTER_BITS);
+    hi = _mm256_srai_epi32(hi, VIDEOSCALER_FILTER_BITS);
+    _mm256_storeu_si256((__m256i*)(dst + x), _mm256_packs_epi32(lo, hi));
+  }
+}
+
+static void AVX2_YUV2RGB(uint8_t *dst, int width, const int16_t *y, const int16_t *u, const int16_t *v, const int16_t *matrix)
+{
+  const __m256i offset = _mm256_set1_epi16(matrix[0]);
+  const __m256i cy     = _mm256_set1_epi16(matrix[1]);
+  const __m256i vr     = _mm256_set1_epi16(matrix[2]);
+  const __m256i ug     = _mm256_set1_epi16(matrix[3]);
+  const __m256i vg     = _mm256_set1_epi16(matrix[4]);
+  const __m256i ub     = _mm256_set1_epi16(matrix[5]);
+  const __m256i center = _mm256_set1_epi16(128 << VIDEOSCALER_SAMPLE_BITS);
+  const __m256i round  = _mm256_set1_epi16(4);
+  const __m256i alpha  = _mm256_set1_epi8((char)0xff);
+
+  int x = 0;
+  for (; x + 16 <= width; x += 16, dst += 64)
+  {
+    __m256i luma = _mm256_mulhi_epi16(_mm256_subs_epi16(_mm256_loadu_si256((const __m256i*)(y + x)), offset), cy);
+    __m256i cb   = _mm256_subs_epi16(_mm256_loadu_si256((const __m256i*)(u + x)), center);
+    __m256i cr   = _mm256_subs_epi16(_mm256_loadu_si256((const __m256i*)(v + x)), center);
+    luma = _mm256_add_epi16(luma, round);
+
+    __m256i r = _mm256_add_epi16(luma, _mm256_mulhi_epi16(cr, vr));
+    __m256i g = _mm256_add_epi16(luma, _mm256_add_epi16(_mm256_mulhi_epi16(cb, ug), _mm256_mulhi_epi16(cr, vg)));
+    __m256i b = _mm256_add_epi16(luma, _mm256_mulhi_epi16(cb, ub));
+
+    // every lane holds 8 pixels in its lower half
+    r = _mm256_packus_epi16(_mm256_srai_epi16(r, 3), _mm256_setzero_si256());
+    g = _mm256_packus_epi16(_mm256_srai_epi16(g, 3), _mm256_setzero_si256());
+    b = _mm256_packus_epi16(_mm256_srai_epi16(b, 3), _mm256_setzero_si256());
+
+    __m256i bg = _mm256_unpacklo_epi8(b, g);
+    __m256i ra = _mm256_unpacklo_epi8(r, alpha);
+    __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+    __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+    _mm256_storeu_si256((__m256i*)dst,        _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i*)(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  if (x < width)
+    CVideoScaler::GetKernels(0).yuv2rgb(dst, width - x, y + x, u + x, v + x, matrix);
+}
+
+static const CVideoScaler::SScalerKernels g_kernelsAVX2 =
+{
+  AVX2_HScale,
+  AVX2_VScale,
+  AVX2_YUV2RGB
+};
+
+const CVideoScaler::SScalerKernels* CVideoScaler::GetKernelsAVX2()
+{
+  return &g_kernelsAVX2;
+}
+
+#else /* no AVX2 */
+
+const CVideoScaler::SScalerKernels* CVideoScaler::GetKernelsAVX2()
+{
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  This file is built with SSE2 code generation enabled, nothing in here may
+  be called unless CCPUInfo reports CPU_FEATURE_SSE2. The build defines
+  HAS_SSE2_KERNELS where it can compile the intrinsics.
+*/
+
+#include "VideoScaler.h"
+#include <string.h>
+
+#ifdef HAS_SSE2_KERNELS
+#include <emmintrin.h>
+
+static inline __m128i SSE2_Load32(const uint8_t *src)
+{
+  int32_t value;
+  memcpy(&value, src, sizeof(value));
+  return _mm_cvtsi32_si128(value);
+}
+
+/*
+  4 outputs at a time, their 4 taps of a block are gathered into one
+  register and multiplied with pmaddwd, the pairs are then summed across.
+*/
+static void SSE2_HScale(int16_t *dst, int width, const uint8_t *src, const int16_t *filter, const int32_t *pos, int size)
+{
+  const __m128i zero  = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(1 << (VIDEOSCALER_FILTER_BITS - VIDEOSCALER_SAMPLE_BITS - 1));
+
+  for (int x = 0; x < width; x += 8)
+  {
+    const int16_t *group = filter + (x >> 3) * size * 8;
+    __m128i sum[2];
+
+    for (int half = 0; half < 2; half++)
+    {
+      const int32_t *p = pos + x + half * 4;
+      const int16_t *f = group + half * 16;
+      __m128i acc = round;
+
+      for (int k = 0; k < size; k += 4, f += 32)
+      {
+        __m128i s01 = _mm_unpacklo_epi32(SSE2_Load32(src + p[0] + k), SSE2_Load32(src + p[1] + k));
+        __m128i s23 = _mm_unpacklo_epi32(SSE2_Load32(src + p[2] + k), SSE2_Load32(src + p[3] + k));
+        __m128i s   = _mm_unpacklo_epi64(s01, s23);
+
+        __m128i m01 = _mm_madd_epi16(_mm_unpacklo_epi8(s, zero), _mm_loadu_si128((const __m128i*)f));
+        __m128i m23 = _mm_madd_epi16(_mm_unpackhi_epi8(s, zero), _mm_loadu_si128((const __m128i*)(f + 8)));
+
+        __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(m01), _mm_castsi128_ps(m23), _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 odd  = _mm_shuffle_ps(_mm_castsi128_ps(m01), _mm_castsi128_ps(m23), _MM_SHUFFLE(3, 1, 3, 1));
+        acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd)));
+      }
+      sum[half] = _mm_srai_epi32(acc, VIDEOSCALER_FILTER_BITS - VIDEOSCALER_SAMPLE_BITS);
+    }
+    _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(sum[0], sum[1]));
+  }
+}
+
+/* the lines are interleaved in pairs, so pmaddwd does two taps at once */
+static void SSE2_VScale(int16_t *dst, int width, const int16_t* const *src, const int16_t *filter, int size)
+{
+  const __m128i round = _mm_set1_epi32(1 << (VIDEOSCALER_FILTER_BITS - 1));
+
+  for (int x = 0; x < width; x += 8)
+  {
+    __m128i lo = round;
+    __m128i hi = round;
+    for (int k = 0; k < size; k += 2)
+    {
+      __m128i c = _mm_set1_epi32((uint16_t)filter[k] | ((uint32_t)(uint16_t)filter[k + 1] << 16));
+      __m128i a = _mm_loadu_si128((const __m128i*)(src[k] + x));
+      __m128i b = _mm_loadu_si128((const __m128i*)(src[k + 1] + x));
+      lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), c));
+      hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), c));
+    }
+    lo = _mm_srai_epi32(lo, VIDEOSCALER_FILTER_BITS);
+    hi = _mm_srai_epi32(hi, VIDEOSCALER_FILTER_BITS);
+    _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(lo, hi));
+  }
+}
+
+/* pmulhw keeps the upper 16 bits of the products, the same as the C kernel */
+static void SSE2_YUV2RGB(uint8_t *dst, int width, const int16_t *y, const int16_t *u, const int16_t *v, const int16_t *matrix)
+{
+  const __m128i offset = _mm_set1_epi16(matrix[0]);
+  const __m128i cy     = _mm_set1_epi16(matrix[1]);
+  const __m128i vr     = _mm_set1_epi16(matrix[2]);
+  const __m128i ug     = _mm_set1_epi16(matrix[3]);
+  const __m128i vg     = _mm_set1_epi16(matrix[4]);
+  const __m128i ub     = _mm_set1_epi16(matrix[5]);
+  const __m128i center = _mm_set1_epi16(128 << VIDEOSCALER_SAMPLE_BITS);
+  const __m128i round  = _mm_set1_epi16(4);
+  const __m128i alpha  = _mm_set1_epi8((char)0xff);
+
+  int x = 0;
+  for (; x + 8 <= width; x += 8, dst += 32)
+  {
+    __m128i luma = _mm_mulhi_epi16(_mm_subs_epi16(_mm_loadu_si128((const __m128i*)(y + x)), offset), cy);
+    __m128i cb   = _mm_subs_epi16(_mm_loadu_si128((const __m128i*)(u + x)), center);
+    __m128i cr   = _mm_subs_epi16(_mm_loadu_si128((const __m128i*)(v + x)), center);
+    luma = _mm_add_epi16(luma, round);
+
+    __m128i r = _mm_add_epi16(luma, _mm_mulhi_epi16(cr, vr));
+    __m128i g = _mm_add_epi16(luma, _mm_add_epi16(_mm_mulhi_epi16(cb, ug), _mm_mulhi_epi16(cr, vg)));
+    __m128i b = _mm_add_epi16(luma, _mm_mulhi_epi16(cb, ub));
+
+    r = _mm_packus_epi16(_mm_srai_epi16(r, 3), _mm_setzero_si128());
+    g = _mm_packus_epi16(_mm_srai_epi16(g, 3), _mm_setzero_si128());
+    b = _mm_packus_epi16(_mm_srai_epi16(b, 3), _mm_setzero_si128());
+
+    __m128i bg = _mm_unpacklo_epi8(b, g);
+    __m128i ra = _mm_unpacklo_epi8(r, alpha);
+    _mm_storeu_si128((__m128i*)dst,        _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(bg, ra));
+  }
+  if (x < width)
+    CVideoScaler::GetKernels(0).yuv2rgb(dst, width - x, y + x, u + x, v + x, matrix);
+}
+
+static const CVideoScaler::SScalerKernels g_kernelsSSE2 =
+{
+  SSE2_HScale,
+  SSE2_VScale,
+  SSE2_YUV2RGB
+};
+
+const CVideoScaler::SScalerKernels* CVideoScaler::GetKernelsSSE2()
+{
+  return &g_kernelsSSE2;
+}
+
+#else /* no SSE2 */
+
+const CVideoScaler::SScalerKernels* CVideoScaler::GetKernelsSSE2()
+{
+  return NULL;
+}
+
+#endif
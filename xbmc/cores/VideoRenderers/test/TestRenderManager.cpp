@@ -0,0 +1,175 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoRenderers/RenderManager.h"
+#include "cores/VideoRenderers/SoftwareRenderer.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoCodec.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/MediaSettings.h"
+#include "utils/Crc32.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+#include <vector>
+
+#define WIDTH  64
+#define HEIGHT 48
+
+class TestRenderManager : public testing::Test
+{
+protected:
+  TestRenderManager()
+  {
+    m_softwareRenderer = g_advancedSettings.m_videoSoftwareRenderer;
+    m_renderChecksums  = g_advancedSettings.m_videoRenderChecksums;
+    m_videoSettings    = CMediaSettings::Get().GetCurrentVideoSettings();
+
+    // no display here, the frames are rendered into memory
+    g_advancedSettings.m_videoSoftwareRenderer = true;
+    g_advancedSettings.m_videoRenderChecksums  = true;
+    CMediaSettings::Get().GetCurrentVideoSettings().m_DeinterlaceMode = VS_DEINTERLACEMODE_OFF;
+
+    m_stop = false;
+    m_manager.PreInit();
+  }
+
+  ~TestRenderManager()
+  {
+    m_manager.UnInit();
+    g_advancedSettings.m_videoSoftwareRenderer = m_softwareRenderer;
+    g_advancedSettings.m_videoRenderChecksums  = m_renderChecksums;
+    CMediaSettings::Get().GetCurrentVideoSettings() = m_videoSettings;
+  }
+
+  /* a yuv420p picture, the luma given per line */
+  void MakePicture(DVDVideoPicture &picture, uint8_t luma, uint8_t step)
+  {
+    m_planes.resize(WIDTH * HEIGHT * 3 / 2);
+    uint8_t *y = &m_planes[0];
+    uint8_t *u = y + WIDTH * HEIGHT;
+    uint8_t *v = u + WIDTH * HEIGHT / 4;
+    for (int line = 0; line < HEIGHT; line++)
+      memset(y + line * WIDTH, (uint8_t)(luma + line * step), WIDTH);
+    memset(u, 128, WIDTH * HEIGHT / 4);
+    memset(v, 128, WIDTH * HEIGHT / 4);
+
+    memset(&picture, 0, sizeof(picture));
+    picture.format         = RENDER_FMT_YUV420P;
+    picture.iWidth         = WIDTH;
+    picture.iHeight        = HEIGHT;
+    picture.iDisplayWidth  = WIDTH;
+    picture.iDisplayHeight = HEIGHT;
+    picture.data[0]        = y;
+    picture.data[1]        = u;
+    picture.data[2]        = v;
+    picture.iLineSize[0]   = WIDTH;
+    picture.iLineSize[1]   = WIDTH / 2;
+    picture.iLineSize[2]   = WIDTH / 2;
+  }
+
+  /* what the player and the render thread do for a frame */
+  bool RenderPicture(DVDVideoPicture &picture)
+  {
+    if (m_manager.AddVideoPicture(picture) < 0)
+      return false;
+    m_manager.FlipPage(m_stop, 0.0);
+    m_manager.FrameMove();
+    m_manager.Render(true, 0, 255);
+    m_manager.FrameFinish();
+    return true;
+  }
+
+  CSoftwareRenderer* Renderer()
+  {
+    return dynamic_cast<CSoftwareRenderer*>(m_manager.m_pRenderer);
+  }
+
+  uint32_t SurfaceChecksum()
+  {
+    unsigned int width, height, stride;
+    const uint8_t *surface = Renderer()->GetSurface(width, height, stride);
+    Crc32 crc;
+    crc.Compute((const char*)surface, stride * height);
+    return crc;
+  }
+
+  CXBMCRenderManager   m_manager;
+  volatile bool        m_stop;
+  std::vector<uint8_t> m_planes;
+
+  bool           m_softwareRenderer;
+  bool           m_renderChecksums;
+  CVideoSettings m_videoSettings;
+};
+
+TEST_F(TestRenderManager, SoftwareRenderer)
+{
+  ASSERT_TRUE(Renderer() != NULL);
+  EXPECT_TRUE(m_manager.Configure(WIDTH, HEIGHT, WIDTH, HEIGHT, 25.0f, 0, RENDER_FMT_YUV420P, 0, 0));
+  EXPECT_TRUE(m_manager.IsConfigured());
+}
+
+TEST_F(TestRenderManager, Checksum)
+{
+  ASSERT_TRUE(Renderer() != NULL);
+  ASSERT_TRUE(m_manager.Configure(WIDTH, HEIGHT, WIDTH, HEIGHT, 25.0f, 0, RENDER_FMT_YUV420P, 0, 0));
+
+  DVDVideoPicture picture;
+  MakePicture(picture, 128, 0);
+  ASSERT_TRUE(RenderPicture(picture));
+  ASSERT_EQ(1u, Renderer()->GetFramesRendered());
+
+  // the logged checksum is the one of the surface
+  unsigned int width, height, stride;
+  const uint8_t *surface = Renderer()->GetSurface(width, height, stride);
+  ASSERT_TRUE(surface != NULL);
+  EXPECT_LT(0u, width);
+  EXPECT_LT(0u, height);
+  uint32_t gray = Renderer()->GetChecksum();
+  EXPECT_EQ(SurfaceChecksum(), gray);
+
+  // mid gray stays gray
+  for (unsigned int line = 0; line < height; line++)
+  {
+    for (unsigned int x = 0; x < width; x++)
+    {
+      const uint8_t *pixel = surface + line * stride + x * 4;
+      for (int c = 0; c < 3; c++)
+        EXPECT_NEAR(130, pixel[c], 4) << "at " << x << "," << line;
+    }
+  }
+
+  // the same picture renders the same, a different one does not
+  MakePicture(picture, 128, 0);
+  ASSERT_TRUE(RenderPicture(picture));
+  EXPECT_EQ(2u, Renderer()->GetFramesRendered());
+  EXPECT_EQ(gray, Renderer()->GetChecksum());
+
+  MakePicture(picture, 16, 4);
+  ASSERT_TRUE(RenderPicture(picture));
+  EXPECT_EQ(3u, Renderer()->GetFramesRendered());
+  EXPECT_NE(gray, Renderer()->GetChecksum());
+  EXPECT_EQ(SurfaceChecksum(), Renderer()->GetChecksum());
+
+  MakePicture(picture, 128, 0);
+  ASSERT_TRUE(RenderPicture(picture));
+  EXPECT_EQ(gray, Renderer()->GetChecksum());
+}
@@ -0,0 +1,247 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoRenderers/RenderQueue.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestRenderQueue, Cycle)
+{
+  CRenderQueue queue;
+  queue.Reset(3, 0);
+  EXPECT_EQ(CRenderQueue::STATE_PRESENT, queue.GetState(0));
+
+  int index = queue.GetFree();
+  ASSERT_EQ(1, index);
+  EXPECT_TRUE(queue.Queue(index, 0.0));
+  EXPECT_EQ(CRenderQueue::STATE_QUEUED, queue.GetState(index));
+  EXPECT_EQ(1, queue.GetPending());
+
+  // a queued slot is not handed out again
+  EXPECT_EQ(2, queue.GetFree());
+
+  EXPECT_TRUE(queue.Present(index, 0.0));
+  EXPECT_EQ(index, queue.GetPresent());
+  EXPECT_EQ(CRenderQueue::STATE_DISCARD, queue.GetState(0));
+
+  int discarded[RENDERQUEUE_SLOTS];
+  ASSERT_EQ(1, queue.GetDiscarded(discarded));
+  EXPECT_EQ(0, discarded[0]);
+  queue.Release(0);
+  EXPECT_EQ(CRenderQueue::STATE_FREE, queue.GetState(0));
+  EXPECT_EQ(0, queue.GetPending());
+}
+
+TEST(TestRenderQueue, Order)
+{
+  CRenderQueue queue;
+  queue.Reset(4, 0);
+
+  // slots are used round robin, but come out in the order they were queued
+  for (int i = 0; i < 3; i++)
+    queue.Queue(queue.GetFree(), 0.0);
+  EXPECT_EQ(-1, queue.GetFree());
+
+  int queued[RENDERQUEUE_SLOTS];
+  ASSERT_EQ(3, queue.GetQueued(queued));
+  EXPECT_EQ(1, queued[0]);
+  EXPECT_EQ(2, queued[1]);
+  EXPECT_EQ(3, queued[2]);
+
+  EXPECT_TRUE(queue.Present(1, 0.0));
+  queue.Release(0);
+  EXPECT_EQ(0, queue.GetFree());
+  queue.Queue(0, 0.0);
+
+  ASSERT_EQ(3, queue.GetQueued(queued));
+  EXPECT_EQ(2, queued[0]);
+  EXPECT_EQ(3, queued[1]);
+  EXPECT_EQ(0, queued[2]);
+}
+
+TEST(TestRenderQueue, Fill)
+{
+  CRenderQueue queue;
+  queue.Reset(3, 0);
+
+  int index = queue.GetFill();
+  ASSERT_EQ(1, index);
+  EXPECT_EQ(CRenderQueue::STATE_FILLING, queue.GetState(index));
+  EXPECT_EQ(1, queue.GetFill());
+  EXPECT_TRUE(queue.Queue(index, 0.0));
+  EXPECT_TRUE(queue.Present(index, 0.0));
+
+  // the slot being filled stays the same while the render thread frees
+  // one in front of it
+  EXPECT_EQ(2, queue.GetFill());
+  queue.Release(0);
+  EXPECT_EQ(CRenderQueue::STATE_FREE, queue.GetState(0));
+  EXPECT_EQ(2, queue.GetFill());
+  EXPECT_TRUE(queue.WaitFree(0));
+
+  // dropping the queue leaves it alone, it isn't queued yet
+  EXPECT_EQ(0, queue.DiscardQueued());
+  EXPECT_EQ(0, queue.GetPending());
+  EXPECT_TRUE(queue.Queue(2, 0.0));
+
+  int queued[RENDERQUEUE_SLOTS];
+  ASSERT_EQ(1, queue.GetQueued(queued));
+  EXPECT_EQ(2, queued[0]);
+  EXPECT_EQ(0, queue.GetFill());
+}
+
+TEST(TestRenderQueue, DiscardQueued)
+{
+  CRenderQueue queue;
+  queue.Reset(3, 0);
+  queue.Queue(queue.GetFree(), 0.0);
+  queue.Queue(queue.GetFree(), 0.0);
+
+  EXPECT_EQ(2, queue.DiscardQueued());
+  EXPECT_FALSE(queue.Present(1, 0.0));
+  EXPECT_FALSE(queue.Discard(2));
+  EXPECT_EQ(0, queue.GetPresent());
+
+  // the render thread still has to release them
+  EXPECT_EQ(2, queue.GetPending());
+  EXPECT_EQ(-1, queue.GetFree());
+
+  SRenderQueueStats stats;
+  queue.GetStats(stats);
+  EXPECT_EQ(0u, stats.presented);
+  EXPECT_EQ(2u, stats.discarded);
+}
+
+namespace
+{
+class CDiscarder : public CThread
+{
+public:
+  CDiscarder(CRenderQueue &queue) : CThread("Discarder"), m_queue(queue), m_discarded(0) {}
+  void Process()
+  {
+    for (int i = 0; i < 1000; i++)
+      m_discarded += m_queue.DiscardQueued();
+  }
+  CRenderQueue &m_queue;
+  int           m_discarded;
+};
+}
+
+TEST(TestRenderQueue, DiscardRace)
+{
+  CRenderQueue queue;
+  int presented = 0;
+  int discarded = 0;
+
+  // the player drops the queue while the render thread takes from it, every
+  // slot ends up either presented or dropped, never both
+  for (int round = 0; round < 100; round++)
+  {
+    queue.Reset(4, 0);
+    for (int i = 0; i < 3; i++)
+      queue.Queue(queue.GetFree(), 0.0);
+
+    CDiscarder discarder(queue);
+    discarder.Create();
+    int queued[RENDERQUEUE_SLOTS];
+    int count = queue.GetQueued(queued);
+    for (int i = 0; i < count; i++)
+    {
+      if (queue.Present(queued[i], 0.0))
+        presented++;
+    }
+    discarder.StopThread();
+    discarded += discarder.m_discarded;
+
+    SRenderQueueStats stats;
+    queue.GetStats(stats);
+    EXPECT_EQ(3u, stats.presented + stats.discarded);
+    EXPECT_EQ(stats.discarded, (unsigned int)discarder.m_discarded);
+  }
+  EXPECT_EQ(300, presented + discarded);
+}
+
+TEST(TestRenderQueue, Stats)
+{
+  CRenderQueue queue;
+  queue.Reset(3, 0);
+
+  double clock = 10.0;
+  for (int i = 0; i < 10; i++)
+  {
+    int index = queue.GetFree();
+    queue.Queue(index, clock);
+    queue.Present(index, clock + (i % 2 ? 0.030 : 0.010));
+
+    // shown alternately 5ms late and right on time
+    queue.Displayed(clock, clock + (i % 2 ? 0.005 : 0.0));
+
+    int discarded[RENDERQUEUE_SLOTS];
+    int count = queue.GetDiscarded(discarded);
+    for (int d = 0; d < count; d++)
+      queue.Release(discarded[d]);
+    clock += 0.040;
+  }
+
+  SRenderQueueStats stats;
+  queue.GetStats(stats);
+  EXPECT_EQ(10u, stats.presented);
+  EXPECT_EQ(0u, stats.discarded);
+  EXPECT_NEAR(0.020, stats.residency,    1e-9);
+  EXPECT_NEAR(0.030, stats.residencyMax, 1e-9);
+  EXPECT_NEAR(0.005, stats.jitter,       1e-9);
+  EXPECT_NEAR(0.005, stats.jitterMax,    1e-9);
+}
+
+namespace
+{
+class CReleaser : public CThread
+{
+public:
+  CReleaser(CRenderQueue &queue) : CThread("Releaser"), m_queue(queue) {}
+  void Process()
+  {
+    Sleep(50);
+    m_queue.Release(0);
+  }
+  CRenderQueue &m_queue;
+};
+}
+
+TEST(TestRenderQueue, WaitFree)
+{
+  CRenderQueue queue;
+  queue.Reset(2, 0);
+  queue.Queue(queue.GetFree(), 0.0);
+  EXPECT_FALSE(queue.WaitFree(0));
+
+  queue.Present(1, 0.0);
+  CReleaser releaser(queue);
+  releaser.Create();
+
+  // woken by the release, long before the timeout
+  XbmcThreads::EndTime timeout(5000);
+  EXPECT_TRUE(queue.WaitFree(5000));
+  EXPECT_GT(timeout.MillisLeft(), 4000u);
+  EXPECT_EQ(0, queue.GetFree());
+  releaser.StopThread();
+}
@@ -0,0 +1,433 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/VideoRenderers/VideoScaler.h"
+#include "cores/VideoRenderers/RenderFlags.h"
+#include "DllSwScale.h"
+#include "utils/CPUInfo.h"
+#include "utils/Stopwatch.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+struct KernelSet
+{
+  const char  *name;
+  unsigned int features;
+};
+
+const KernelSet kernelSets[] =
+{
+  { "C"   , 0                                   },
+  { "SSE2", CPU_FEATURE_SSE2                    },
+  { "AVX2", CPU_FEATURE_SSE2 | CPU_FEATURE_AVX2 }
+};
+
+bool Supported(const KernelSet &set)
+{
+  return (g_cpuInfo.GetCPUFeatures() & set.features) == set.features;
+}
+
+int Random(int from, int to)
+{
+  return from + rand() % (to - from + 1);
+}
+
+/* a YUV420P picture in one buffer */
+struct Picture
+{
+  Picture(int w, int h, int luma, int cb, int cr)
+    : width(w), height(h), data(w * h + 2 * ((w + 1) / 2) * ((h + 1) / 2))
+  {
+    int cw = (w + 1) / 2;
+    int ch = (h + 1) / 2;
+    plane[0]  = &data[0];
+    plane[1]  = plane[0] + w * h;
+    plane[2]  = plane[1] + cw * ch;
+    stride[0] = w;
+    stride[1] = cw;
+    stride[2] = cw;
+    memset(plane[0], luma, w * h);
+    memset(plane[1], cb, cw * ch);
+    memset(plane[2], cr, cw * ch);
+  }
+
+  void Randomize()
+  {
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = rand() & 0xff;
+  }
+
+  int                  width;
+  int                  height;
+  std::vector<uint8_t> data;
+  uint8_t             *plane[3];
+  int                  stride[3];
+};
+
+std::vector<uint8_t> Convert(CVideoScaler &scaler, const Picture &picture, int w, int h)
+{
+  std::vector<uint8_t> out(w * h * 4);
+  EXPECT_TRUE(scaler.Convert((uint8_t* const*)picture.plane, picture.stride, &out[0], w * 4));
+  return out;
+}
+
+const ESCALINGMETHOD methods[] =
+{
+  VS_SCALINGMETHOD_NEAREST,
+  VS_SCALINGMETHOD_LINEAR,
+  VS_SCALINGMETHOD_CUBIC,
+  VS_SCALINGMETHOD_LANCZOS2,
+  VS_SCALINGMETHOD_LANCZOS3_FAST,
+  VS_SCALINGMETHOD_LANCZOS3,
+  VS_SCALINGMETHOD_SPLINE36_FAST,
+  VS_SCALINGMETHOD_SPLINE36
+};
+}
+
+TEST(TestVideoScaler, Kernels)
+{
+  const CVideoScaler::SScalerKernels &reference = CVideoScaler::GetKernels(0);
+  int16_t matrix[8] = { 16 << 6, 9535, 14688, -1751, -4366, 17306, 0, 0 };
+
+  for (unsigned int k = 1; k < sizeof(kernelSets) / sizeof(kernelSets[0]); ++k)
+  {
+    if (!Supported(kernelSets[k]))
+      continue;
+    const CVideoScaler::SScalerKernels &kernels = CVideoScaler::GetKernels(kernelSets[k].features);
+
+    for (int width = 1; width < 100; width += 3)
+    {
+      /* the lines have room for the outputs the kernels may write past width */
+      int lineSize = ((width + 15) & ~15) + 16;
+      int groups   = (width + 7) / 8;
+
+      for (int size = 4; size <= 12; size += 4)
+      {
+        std::vector<uint8_t> src(width * 3 + size);
+        for (size_t i = 0; i < src.size(); i++)
+          src[i] = rand() & 0xff;
+        std::vector<int16_t> filter(groups * 8 * size);
+        for (size_t i = 0; i < filter.size(); i++)
+          filter[i] = Random(-8192, 24576);
+        std::vector<int32_t> pos(groups * 8, 0);
+        for (int i = 0; i < width; i++)
+          pos[i] = Random(0, width * 3);
+
+        std::vector<int16_t> ref(lineSize), out(lineSize);
+        reference.hscale(&ref[0], width, &src[0], &filter[0], &pos[0], size);
+        kernels.hscale(&out[0], width, &src[0], &filter[0], &pos[0], size);
+        EXPECT_TRUE(std::equal(ref.begin(), ref.begin() + width, out.begin())) << kernelSets[k].name << " hscale " << width << " " << size;
+      }
+
+      for (int size = 2; size <= 6; size += 2)
+      {
+        std::vector<std::vector<int16_t> > lines(size, std::vector<int16_t>(lineSize));
+        std::vector<const int16_t*> src(size);
+        std::vector<int16_t> filter(size);
+        for (int l = 0; l < size; l++)
+        {
+          for (int x = 0; x < lineSize; x++)
+            lines[l][x] = Random(-2000, 20000);
+          src[l]    = &lines[l][0];
+          filter[l] = Random(-4096, 16384);
+        }
+
+        std::vector<int16_t> ref(lineSize), out(lineSize);
+        reference.vscale(&ref[0], width, &src[0], &filter[0], size);
+        kernels.vscale(&out[0], width, &src[0], &filter[0], size);
+        EXPECT_TRUE(std::equal(ref.begin(), ref.begin() + width, out.begin())) << kernelSets[k].name << " vscale " << width << " " << size;
+      }
+
+      std::vector<int16_t> y(lineSize), u(lineSize), v(lineSize);
+      for (int x = 0; x < lineSize; x++)
+      {
+        y[x] = Random(-2000, 20000);
+        u[x] = Random(-2000, 20000);
+        v[x] = Random(-2000, 20000);
+      }
+      std::vector<uint8_t> ref(width * 4 + 4, 0xAA), out(width * 4 + 4, 0xAA);
+      reference.yuv2rgb(&ref[0], width, &y[0], &u[0], &v[0], matrix);
+      kernels.yuv2rgb(&out[0], width, &y[0], &u[0], &v[0], matrix);
+      EXPECT_TRUE(ref == out) << kernelSets[k].name << " yuv2rgb " << width;
+      EXPECT_EQ(0xAA, out[width * 4]);
+    }
+  }
+}
+
+TEST(TestVideoScaler, Colours)
+{
+  struct Colour
+  {
+    unsigned int flags;
+    int y, u, v;
+    int r, g, b;
+  };
+  const Colour colours[] =
+  {
+    { CONF_FLAGS_YUVCOEF_BT601, 235, 128, 128, 255, 255, 255 },
+    { CONF_FLAGS_YUVCOEF_BT601,  16, 128, 128,   0,   0,   0 },
+    { CONF_FLAGS_YUVCOEF_BT601,  81,  90, 240, 255,   0,   0 },
+    { CONF_FLAGS_YUVCOEF_BT601, 145,  54,  34,   0, 255,   0 },
+    { CONF_FLAGS_YUVCOEF_BT709,  63, 102, 240, 255,   0,   0 },
+    { CONF_FLAGS_YUVCOEF_BT709,  32, 240, 118,   0,   0, 255 },
+    { CONF_FLAGS_YUVCOEF_BT709 | CONF_FLAGS_YUV_FULLRANGE, 200, 128, 128, 200, 200, 200 },
+  };
+
+  CVideoScaler scaler;
+  for (unsigned int i = 0; i < sizeof(colours) / sizeof(colours[0]); i++)
+  {
+    const Colour &c = colours[i];
+    Picture picture(16, 16, c.y, c.u, c.v);
+    ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P, 16, 16, 24, 12, VS_SCALINGMETHOD_LANCZOS3, c.flags));
+    std::vector<uint8_t> out = Convert(scaler, picture, 24, 12);
+    for (size_t p = 0; p < out.size(); p += 4)
+    {
+      EXPECT_NEAR(c.b, out[p + 0], 2) << "colour " << i;
+      EXPECT_NEAR(c.g, out[p + 1], 2) << "colour " << i;
+      EXPECT_NEAR(c.r, out[p + 2], 2) << "colour " << i;
+      EXPECT_EQ(0xff, out[p + 3]);
+    }
+  }
+}
+
+TEST(TestVideoScaler, Flat)
+{
+  /* every filter is normalized, a flat picture stays flat whatever the size */
+  const int sizes[][2] = { { 7, 5 }, { 64, 36 }, { 333, 201 }, { 1024, 600 } };
+  Picture picture(160, 90, 120, 128, 128);
+
+  CVideoScaler scaler;
+  for (unsigned int m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+  {
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+      int w = sizes[s][0];
+      int h = sizes[s][1];
+      ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P, 160, 90, w, h, methods[m], CONF_FLAGS_YUV_FULLRANGE));
+      std::vector<uint8_t> out = Convert(scaler, picture, w, h);
+      for (size_t p = 0; p < out.size(); p += 4)
+      {
+        ASSERT_EQ(120, out[p]) << "method " << methods[m] << " " << w << "x" << h << " pixel " << p / 4;
+      }
+    }
+  }
+}
+
+TEST(TestVideoScaler, Identity)
+{
+  /* interpolating filters leave the samples alone at 1:1 */
+  const ESCALINGMETHOD identity[] =
+  {
+    VS_SCALINGMETHOD_NEAREST,
+    VS_SCALINGMETHOD_LINEAR,
+    VS_SCALINGMETHOD_LANCZOS2,
+    VS_SCALINGMETHOD_LANCZOS3,
+    VS_SCALINGMETHOD_SPLINE36
+  };
+  Picture picture(67, 31, 0, 128, 128);
+  for (int i = 0; i < 67 * 31; i++)
+    picture.plane[0][i] = rand() & 0xff;
+
+  CVideoScaler scaler;
+  for (unsigned int m = 0; m < sizeof(identity) / sizeof(identity[0]); m++)
+  {
+    ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P, 67, 31, 67, 31, identity[m], CONF_FLAGS_YUV_FULLRANGE));
+    std::vector<uint8_t> out = Convert(scaler, picture, 67, 31);
+    for (int i = 0; i < 67 * 31; i++)
+    {
+      ASSERT_EQ(picture.plane[0][i], out[i * 4 + 0]) << "method " << identity[m] << " pixel " << i;
+      ASSERT_EQ(picture.plane[0][i], out[i * 4 + 1]);
+      ASSERT_EQ(picture.plane[0][i], out[i * 4 + 2]);
+    }
+  }
+}
+
+TEST(TestVideoScaler, Downscale)
+{
+  /* the filters are widened to the step, a single pixel pattern averages out instead of aliasing */
+  Picture picture(256, 128, 0, 128, 128);
+  for (int y = 0; y < 128; y++)
+    for (int x = 0; x < 256; x++)
+      picture.plane[0][y * 256 + x] = (x + y) & 1 ? 255 : 0;
+
+  CVideoScaler scaler;
+  for (unsigned int m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+  {
+    ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P, 256, 128, 45, 23, methods[m], CONF_FLAGS_YUV_FULLRANGE));
+    std::vector<uint8_t> out = Convert(scaler, picture, 45, 23);
+    for (size_t p = 0; p < out.size(); p += 4)
+      ASSERT_NEAR(128, out[p], 12) << "method " << methods[m] << " pixel " << p / 4;
+  }
+}
+
+TEST(TestVideoScaler, Formats)
+{
+  /* the same picture in every layout, 4:2:2 chroma is taken from every line of the 4:2:0 picture */
+  const int w = 90;
+  const int h = 50;
+  Picture picture(w, h, 0, 0, 0);
+  picture.Randomize();
+
+  std::vector<uint8_t> nv12(w * h * 3 / 2);
+  std::vector<uint8_t> p16(w * h * 3);
+  std::vector<uint8_t> yuyv(w * h * 2);
+  for (int y = 0; y < h; y++)
+  {
+    for (int x = 0; x < w; x++)
+    {
+      uint8_t luma = picture.plane[0][y * w + x];
+      uint8_t cb   = picture.plane[1][(y / 2) * (w / 2) + x / 2];
+      uint8_t cr   = picture.plane[2][(y / 2) * (w / 2) + x / 2];
+      nv12[y * w + x] = luma;
+      nv12[w * h + (y / 2) * w + x] = x & 1 ? cr : cb;
+      p16[(y * w + x) * 2 + 1] = luma;
+      p16[w * h * 2 + ((y / 2) * (w / 2) + x / 2) * 2 + 1] = cb;
+      p16[w * h * 2 + w * h / 2 + ((y / 2) * (w / 2) + x / 2) * 2 + 1] = cr;
+      yuyv[y * w * 2 + x * 2] = luma;
+      yuyv[y * w * 2 + x * 2 + 1] = x & 1 ? cr : cb;
+    }
+  }
+
+  CVideoScaler scaler;
+  ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P, w, h, 120, 70, VS_SCALINGMETHOD_LANCZOS3_FAST, 0));
+  std::vector<uint8_t> ref = Convert(scaler, picture, 120, 70);
+
+  std::vector<uint8_t> out(120 * 70 * 4);
+  uint8_t *nv12planes[] = { &nv12[0], &nv12[w * h], NULL };
+  int      nv12strides[] = { w, w, 0 };
+  ASSERT_TRUE(scaler.Configure(RENDER_FMT_NV12, w, h, 120, 70, VS_SCALINGMETHOD_LANCZOS3_FAST, 0));
+  ASSERT_TRUE(scaler.Convert(nv12planes, nv12strides, &out[0], 120 * 4));
+  EXPECT_TRUE(ref == out) << "nv12";
+
+  uint8_t *p16planes[] = { &p16[0], &p16[w * h * 2], &p16[w * h * 2 + w * h / 2] };
+  int      p16strides[] = { w * 2, w, w };
+  ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P16, w, h, 120, 70, VS_SCALINGMETHOD_LANCZOS3_FAST, 0));
+  ASSERT_TRUE(scaler.Convert(p16planes, p16strides, &out[0], 120 * 4));
+  EXPECT_TRUE(ref == out) << "yuv420p16";
+
+  /* the vertical chroma filter differs, the luma of a grey picture does not */
+  Picture grey(w, h, 0, 128, 128);
+  for (int i = 0; i < w * h; i++)
+    grey.plane[0][i] = picture.plane[0][i];
+  for (int y = 0; y < h; y++)
+    for (int x = 1; x < w; x += 2)
+      yuyv[y * w * 2 + x * 2 - 1] = yuyv[y * w * 2 + x * 2 + 1] = 128;
+
+  ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P, w, h, 120, 70, VS_SCALINGMETHOD_LANCZOS3_FAST, 0));
+  ref = Convert(scaler, grey, 120, 70);
+  uint8_t *yuyvplanes[] = { &yuyv[0], NULL, NULL };
+  int      yuyvstrides[] = { w * 2, 0, 0 };
+  ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUYV422, w, h, 120, 70, VS_SCALINGMETHOD_LANCZOS3_FAST, 0));
+  ASSERT_TRUE(scaler.Convert(yuyvplanes, yuyvstrides, &out[0], 120 * 4));
+  EXPECT_TRUE(ref == out) << "yuyv";
+}
+
+TEST(TestVideoScaler, KernelSetsAgree)
+{
+  Picture picture(640, 360, 0, 0, 0);
+  picture.Randomize();
+
+  CVideoScaler scaler;
+  ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P, 640, 360, 427, 240, VS_SCALINGMETHOD_LANCZOS3, CONF_FLAGS_YUVCOEF_BT709));
+  scaler.SetKernels(CVideoScaler::GetKernels(0));
+  std::vector<uint8_t> ref = Convert(scaler, picture, 427, 240);
+
+  for (unsigned int k = 1; k < sizeof(kernelSets) / sizeof(kernelSets[0]); ++k)
+  {
+    if (!Supported(kernelSets[k]))
+      continue;
+    scaler.SetKernels(CVideoScaler::GetKernels(kernelSets[k].features));
+    EXPECT_TRUE(ref == Convert(scaler, picture, 427, 240)) << kernelSets[k].name;
+  }
+}
+
+/*
+  Milliseconds per picture of every kernel set this cpu supports and of
+  swscale, run with --gtest_also_run_disabled_tests --gtest_filter=TestVideoScaler.*
+*/
+TEST(TestVideoScaler, DISABLED_Benchmark)
+{
+  const int w = 1920;
+  const int h = 1080;
+  const int sizes[][2] = { { 1920, 1080 }, { 1280, 720 }, { 320, 180 } };
+  const int loops = 20;
+
+  Picture picture(w, h, 0, 0, 0);
+  picture.Randomize();
+
+  DllSwScale dllSwScale;
+  bool swscale = dllSwScale.Load();
+
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+  {
+    int dw = sizes[s][0];
+    int dh = sizes[s][1];
+    std::vector<uint8_t> out(dw * dh * 4);
+    CStopWatch watch;
+
+    const ESCALINGMETHOD bench[] = { VS_SCALINGMETHOD_LINEAR, VS_SCALINGMETHOD_LANCZOS3 };
+    for (unsigned int m = 0; m < sizeof(bench) / sizeof(bench[0]); ++m)
+    {
+      CVideoScaler scaler;
+      ASSERT_TRUE(scaler.Configure(RENDER_FMT_YUV420P, w, h, dw, dh, bench[m], 0));
+      for (unsigned int k = 0; k < sizeof(kernelSets) / sizeof(kernelSets[0]); ++k)
+      {
+        if (!Supported(kernelSets[k]))
+          continue;
+        scaler.SetKernels(CVideoScaler::GetKernels(kernelSets[k].features));
+        watch.StartZero();
+        for (int l = 0; l < loops; ++l)
+          scaler.Convert(picture.plane, picture.stride, &out[0], dw * 4);
+        std::cout << dw << "x" << dh << " " << (bench[m] == VS_SCALINGMETHOD_LINEAR ? "linear " : "lanczos3 ")
+                  << kernelSets[k].name << ": " << watch.GetElapsedMilliseconds() / loops << " ms/picture" << std::endl;
+      }
+    }
+
+    if (!swscale)
+      continue;
+
+    const int swsflags[] = { SWS_FAST_BILINEAR, SWS_BILINEAR, SWS_LANCZOS };
+    const char *swsnames[] = { "fast bilinear", "bilinear", "lanczos" };
+    for (unsigned int f = 0; f < sizeof(swsflags) / sizeof(swsflags[0]); ++f)
+    {
+      struct SwsContext *context = dllSwScale.sws_getContext(w, h, PIX_FMT_YUV420P, dw, dh, PIX_FMT_BGRA,
+                                                             swsflags[f] | SwScaleCPUFlags(), NULL, NULL, NULL);
+      if (!context)
+        continue;
+      uint8_t *dst[]       = { &out[0], NULL, NULL, NULL };
+      int      dstStride[] = { dw * 4, 0, 0, 0 };
+      watch.StartZero();
+      for (int l = 0; l < loops; ++l)
+        dllSwScale.sws_scale(context, picture.plane, picture.stride, 0, h, dst, dstStride);
+      std::cout << dw << "x" << dh << " swscale " << swsnames[f] << ": "
+                << watch.GetElapsedMilliseconds() / loops << " ms/picture" << std::endl;
+      dllSwScale.sws_freeContext(context);
+    }
+  }
+  dllSwScale.Unload();
+}
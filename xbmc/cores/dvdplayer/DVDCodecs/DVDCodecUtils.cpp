@@ -23,7 +23,89 @@
 #include "cores/VideoRenderers/RenderManager.h"
 #include "utils/log.h"
 #include "utils/fastmemcpy.h"
-#include "DllSwScale.h"
+#include "utils/CPUInfo.h"
+
+/* pictures from this size on are copied to the renderer with non-temporal
+   stores, they would only push the decoder out of the cache */
+#define STREAM_MIN_BYTES (1024 * 1024)
+
+static void C_CopyLine(uint8_t *dst, const uint8_t *src, int size)
+{
+  fast_memcpy(dst, src, size);
+}
+
+static void C_InterleaveLine(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  for (int x = 0; x < width; x++)
+  {
+    *dst++ = u[x];
+    *dst++ = v[x];
+  }
+}
+
+static void C_PackYUY2Line(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 2 <= width; x += 2, dst += 4)
+  {
+    dst[0] = y[x];
+    dst[1] = u[x >> 1];
+    dst[2] = y[x + 1];
+    dst[3] = v[x >> 1];
+  }
+  if (x < width)
+  {
+    dst[0] = y[x];
+    dst[1] = u[x >> 1];
+  }
+}
+
+static void C_PackUYVYLine(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 2 <= width; x += 2, dst += 4)
+  {
+    dst[0] = u[x >> 1];
+    dst[1] = y[x];
+    dst[2] = v[x >> 1];
+    dst[3] = y[x + 1];
+  }
+  if (x < width)
+  {
+    dst[0] = u[x >> 1];
+    dst[1] = y[x];
+  }
+}
+
+static void C_Fence()
+{
+}
+
+static const CDVDCodecUtils::SPictureKernels g_kernelsC =
+{
+  C_CopyLine,
+  C_CopyLine,
+  C_InterleaveLine,
+  C_PackYUY2Line,
+  C_PackUYVYLine,
+  C_Fence
+};
+
+static void CopyPlane(CDVDCodecUtils::CopyLineFn copy, uint8_t *d, int dstride, const uint8_t *s, int sstride, int size, int h)
+{
+  if (size == sstride && size == dstride)
+  {
+    copy(d, s, size * h);
+    return;
+  }
+
+  for (int y = 0; y < h; y++)
+  {
+    copy(d, s, size);
+    s += sstride;
+    d += dstride;
+  }
+}
 
 // allocate a new picture (PIX_FMT_YUV420P)
 DVDVideoPicture* CDVDCodecUtils::AllocatePicture(int iWidth, int iHeight)
@@ -49,6 +131,7 @@ DVDVideoPicture* CDVDCodecUtils::AllocatePicture(int iWidth, int iHeight)
       pPicture->iLineSize[1] = w;
       pPicture->iLineSize[2] = w;
       pPicture->iLineSize[3] = 0;
+      pPicture->buffer = NULL;
     }
     else
     {
@@ -68,94 +151,35 @@ void CDVDCodecUtils::FreePicture(DVDVideoPicture* pPicture)
 
 bool CDVDCodecUtils::CopyPicture(DVDVideoPicture* pDst, DVDVideoPicture* pSrc)
 {
-  uint8_t *s, *d;
+  CopyLineFn copy = GetKernels().copy;
   int w = pSrc->iWidth;
   int h = pSrc->iHeight;
 
-  s = pSrc->data[0];
-  d = pDst->data[0];
-
-  for (int y = 0; y < h; y++)
-  {
-    fast_memcpy(d, s, w);
-    s += pSrc->iLineSize[0];
-    d += pDst->iLineSize[0];
-  }
+  CopyPlane(copy, pDst->data[0], pDst->iLineSize[0], pSrc->data[0], pSrc->iLineSize[0], w, h);
 
   w >>= 1;
   h >>= 1;
 
-  s = pSrc->data[1];
-  d = pDst->data[1];
-  for (int y = 0; y < h; y++)
-  {
-    fast_memcpy(d, s, w);
-    s += pSrc->iLineSize[1];
-    d += pDst->iLineSize[1];
-  }
-
-  s = pSrc->data[2];
-  d = pDst->data[2];
-  for (int y = 0; y < h; y++)
-  {
-    fast_memcpy(d, s, w);
-    s += pSrc->iLineSize[2];
-    d += pDst->iLineSize[2];
-  }
+  CopyPlane(copy, pDst->data[1], pDst->iLineSize[1], pSrc->data[1], pSrc->iLineSize[1], w, h);
+  CopyPlane(copy, pDst->data[2], pDst->iLineSize[2], pSrc->data[2], pSrc->iLineSize[2], w, h);
   return true;
 }
 
 bool CDVDCodecUtils::CopyPicture(YV12Image* pImage, DVDVideoPicture *pSrc)
 {
-  uint8_t *s = pSrc->data[0];
-  uint8_t *d = pImage->plane[0];
+  const SPictureKernels& kernels = GetKernels();
   int w = pImage->width * pImage->bpp;
   int h = pImage->height;
-  if ((w == pSrc->iLineSize[0]) && ((unsigned int) pSrc->iLineSize[0] == pImage->stride[0]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[0];
-      d += pImage->stride[0];
-    }
-  }
-  s = pSrc->data[1];
-  d = pImage->plane[1];
+  CopyLineFn copy = w * h >= STREAM_MIN_BYTES ? kernels.stream : kernels.copy;
+
+  CopyPlane(copy, pImage->plane[0], pImage->stride[0], pSrc->data[0], pSrc->iLineSize[0], w, h);
+
   w =(pImage->width  >> pImage->cshift_x) * pImage->bpp;
   h =(pImage->height >> pImage->cshift_y);
-  if ((w==pSrc->iLineSize[1]) && ((unsigned int) pSrc->iLineSize[1]==pImage->stride[1]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[1];
-      d += pImage->stride[1];
-    }
-  }
-  s = pSrc->data[2];
-  d = pImage->plane[2];
-  if ((w==pSrc->iLineSize[2]) && ((unsigned int) pSrc->iLineSize[2]==pImage->stride[2]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[2];
-      d += pImage->stride[2];
-    }
-  }
+
+  CopyPlane(copy, pImage->plane[1], pImage->stride[1], pSrc->data[1], pSrc->iLineSize[1], w, h);
+  CopyPlane(copy, pImage->plane[2], pImage->stride[2], pSrc->data[2], pSrc->iLineSize[2], w, h);
+  kernels.fence();
   return true;
 }
 
@@ -178,33 +202,26 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToNV12Picture(DVDVideoPicture *pSrc)
       pPicture->data[1] = pPicture->data[0] + (pPicture->iWidth * pPicture->iHeight);
       pPicture->data[2] = NULL;
       pPicture->data[3] = NULL;
+      pPicture->buffer = NULL;
       pPicture->iLineSize[0] = pPicture->iWidth;
       pPicture->iLineSize[1] = pPicture->iWidth;
       pPicture->iLineSize[2] = 0;
       pPicture->iLineSize[3] = 0;
       pPicture->format = RENDER_FMT_NV12;
       
+      const SPictureKernels& kernels = GetKernels();
+
       // copy luma
-      uint8_t *s = pSrc->data[0];
-      uint8_t *d = pPicture->data[0];
-      for (int y = 0; y < (int)pSrc->iHeight; y++)
-      {
-        fast_memcpy(d, s, pSrc->iWidth);
-        s += pSrc->iLineSize[0];
-        d += pPicture->iLineSize[0];
-      }
+      CopyPlane(kernels.copy, pPicture->data[0], pPicture->iLineSize[0],
+                pSrc->data[0], pSrc->iLineSize[0], pSrc->iWidth, pSrc->iHeight);
 
       //copy chroma
       for (int y = 0; y < (int)pSrc->iHeight/2; y++) {
         uint8_t *s_u = pSrc->data[1] + (y * pSrc->iLineSize[1]);
         uint8_t *s_v = pSrc->data[2] + (y * pSrc->iLineSize[2]);
         uint8_t *d_uv = pPicture->data[1] + (y * pPicture->iLineSize[1]);
-        for (int x = 0; x < (int)pSrc->iWidth/2; x++) {
-          *d_uv++ = *s_u++;
-          *d_uv++ = *s_v++;
-        }
+        kernels.interleave(d_uv, s_u, s_v, pSrc->iWidth/2);
       }
-      
     }
     else
     {
@@ -233,38 +250,23 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToYUV422PackedPicture(DVDVideoPicture *p
       pPicture->data[1] = NULL;
       pPicture->data[2] = NULL;
       pPicture->data[3] = NULL;
+      pPicture->buffer = NULL;
       pPicture->iLineSize[0] = pPicture->iWidth * 2;
       pPicture->iLineSize[1] = 0;
       pPicture->iLineSize[2] = 0;
       pPicture->iLineSize[3] = 0;
       pPicture->format = format;
 
-      //if this is going to be used for anything else than testing the renderer
-      //the library should not be loaded on every function call
-      DllSwScale  dllSwScale;
-      if (!dllSwScale.Load())
-      {
-        CLog::Log(LOGERROR,"CDVDCodecUtils::ConvertToYUY2Picture - failed to load rescale libraries!");
-      }
-      else
+      // 4:2:0 to 4:2:2, every chroma line is used for two luma lines
+      const SPictureKernels& kernels = GetKernels();
+      PackLineFn pack = format == RENDER_FMT_UYVY422 ? kernels.packUYVY : kernels.packYUY2;
+      for (int y = 0; y < (int)pSrc->iHeight; y++)
       {
-        // Perform the scaling.
-        uint8_t* src[] =       { pSrc->data[0],          pSrc->data[1],      pSrc->data[2],      NULL };
-        int      srcStride[] = { pSrc->iLineSize[0],     pSrc->iLineSize[1], pSrc->iLineSize[2], 0    };
-        uint8_t* dst[] =       { pPicture->data[0],      NULL,               NULL,               NULL };
-        int      dstStride[] = { pPicture->iLineSize[0], 0,                  0,                  0    };
-
-        int dstformat;
-        if (format == RENDER_FMT_UYVY422)
-          dstformat = PIX_FMT_UYVY422;
-        else
-          dstformat = PIX_FMT_YUYV422;
-
-        struct SwsContext *ctx = dllSwScale.sws_getContext(pSrc->iWidth, pSrc->iHeight, PIX_FMT_YUV420P,
-                                                           pPicture->iWidth, pPicture->iHeight, dstformat,
-                                                           SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-        dllSwScale.sws_scale(ctx, src, srcStride, 0, pSrc->iHeight, dst, dstStride);
-        dllSwScale.sws_freeContext(ctx);
+        pack(pPicture->data[0] + y * pPicture->iLineSize[0],
+             pSrc->data[0] + y * pSrc->iLineSize[0],
+             pSrc->data[1] + (y >> 1) * pSrc->iLineSize[1],
+             pSrc->data[2] + (y >> 1) * pSrc->iLineSize[2],
+             pSrc->iWidth);
       }
     }
     else
@@ -279,69 +281,32 @@ DVDVideoPicture* CDVDCodecUtils::ConvertToYUV422PackedPicture(DVDVideoPicture *p
 
 bool CDVDCodecUtils::CopyNV12Picture(YV12Image* pImage, DVDVideoPicture *pSrc)
 {
-  uint8_t *s = pSrc->data[0];
-  uint8_t *d = pImage->plane[0];
+  const SPictureKernels& kernels = GetKernels();
   int w = pSrc->iWidth;
   int h = pSrc->iHeight;
+  CopyLineFn copy = w * h >= STREAM_MIN_BYTES ? kernels.stream : kernels.copy;
+
   // Copy Y
-  if ((w == pSrc->iLineSize[0]) && ((unsigned int) pSrc->iLineSize[0] == pImage->stride[0]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[0];
-      d += pImage->stride[0];
-    }
-  }
-  
-  s = pSrc->data[1];
-  d = pImage->plane[1];
-  w = pSrc->iWidth;
-  h = pSrc->iHeight >> 1;
+  CopyPlane(copy, pImage->plane[0], pImage->stride[0], pSrc->data[0], pSrc->iLineSize[0], w, h);
+
   // Copy packed UV (width is same as for Y as it's both U and V components)
-  if ((w==pSrc->iLineSize[1]) && ((unsigned int) pSrc->iLineSize[1]==pImage->stride[1]))
-  {
-    fast_memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w);
-      s += pSrc->iLineSize[1];
-      d += pImage->stride[1];
-    }
-  }
+  CopyPlane(copy, pImage->plane[1], pImage->stride[1], pSrc->data[1], pSrc->iLineSize[1], w, h >> 1);
+  kernels.fence();
 
   return true;
 }
 
 bool CDVDCodecUtils::CopyYUV422PackedPicture(YV12Image* pImage, DVDVideoPicture *pSrc)
 {
-  uint8_t *s = pSrc->data[0];
-  uint8_t *d = pImage->plane[0];
-  int w = pSrc->iWidth;
+  const SPictureKernels& kernels = GetKernels();
+  int w = pSrc->iWidth * 2;
   int h = pSrc->iHeight;
+  CopyLineFn copy = w * h >= STREAM_MIN_BYTES ? kernels.stream : kernels.copy;
 
   // Copy YUYV
-  if ((w * 2 == pSrc->iLineSize[0]) && ((unsigned int) pSrc->iLineSize[0] == pImage->stride[0]))
-  {
-    fast_memcpy(d, s, w*h*2);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      fast_memcpy(d, s, w*2);
-      s += pSrc->iLineSize[0];
-      d += pImage->stride[0];
-    }
-  }
-  
+  CopyPlane(copy, pImage->plane[0], pImage->stride[0], pSrc->data[0], pSrc->iLineSize[0], w, h);
+  kernels.fence();
+
   return true;
 }
 
@@ -480,3 +445,24 @@ int CDVDCodecUtils::PixfmtFromEFormat(ERenderFormat fmt)
   }
   return PIX_FMT_NONE;
 }
+
+const CDVDCodecUtils::SPictureKernels& CDVDCodecUtils::GetKernels()
+{
+  // every thread gets the same table, so the race on the first call is harmless
+  static const SPictureKernels *kernels = NULL;
+  if (!kernels)
+    kernels = &GetKernels(g_cpuInfo.GetCPUFeatures());
+  return *kernels;
+}
+
+const CDVDCodecUtils::SPictureKernels& CDVDCodecUtils::GetKernels(unsigned int features)
+{
+  const SPictureKernels *kernels = NULL;
+  if (features & CPU_FEATURE_AVX2)
+    kernels = GetKernelsAVX2();
+  if (!kernels && (features & CPU_FEATURE_SSE2))
+    kernels = GetKernelsSSE2();
+  if (!kernels)
+    kernels = &g_kernelsC;
+  return *kernels;
+}
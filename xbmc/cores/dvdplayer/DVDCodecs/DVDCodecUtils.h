@@ -45,5 +45,31 @@ public:
 
   static ERenderFormat EFormatFromPixfmt(int fmt);
   static int           PixfmtFromEFormat(ERenderFormat format);
+
+  typedef void (*CopyLineFn)      (uint8_t *dst, const uint8_t *src, int size);
+  typedef void (*InterleaveLineFn)(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width);
+  typedef void (*PackLineFn)      (uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width);
+  typedef void (*FenceFn)         ();
+
+  /* the line kernels the picture copies are built from */
+  struct SPictureKernels
+  {
+    CopyLineFn       copy;       // cached stores
+    CopyLineFn       stream;     // non-temporal stores, for pictures that go to the renderer
+    InterleaveLineFn interleave; // width u and width v samples into width uv pairs
+    PackLineFn       packYUY2;   // width luma samples and (width + 1) / 2 chroma samples
+    PackLineFn       packUYVY;
+    FenceFn          fence;      // after the last stream call of a picture, before it is handed on
+  };
+
+  /* the fastest kernels of this cpu */
+  static const SPictureKernels& GetKernels();
+  /* the fastest kernels for a set of CPU_FEATURE_ flags, the C kernels for 0 */
+  static const SPictureKernels& GetKernels(unsigned int features);
+
+private:
+  /* x86 kernel tables, these return NULL if the kernel set was not compiled in */
+  static const SPictureKernels* GetKernelsSSE2();
+  static const SPictureKernels* GetKernelsAVX2();
 };
 
@@ -0,0 +1,164 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  This file is built with AVX2 code generation enabled, nothing in here may
+  be called unless CCPUInfo reports CPU_FEATURE_AVX2. The build defines
+  HAS_AVX2_KERNELS where it can compile the intrinsics, Visual Studio only
+  has them from 2012 onwards.
+*/
+
+#include "DVDCodecUtils.h"
+#include <string.h>
+#include <algorithm>
+
+#ifdef HAS_AVX2_KERNELS
+#include <immintrin.h>
+
+/*
+  Same layout as the SSE2 kernels. The unpacks work within the 128bit
+  lanes, so their results are put back in order with a lane permute.
+*/
+static void AVX2_CopyLine(uint8_t *dst, const uint8_t *src, int size)
+{
+  int i = 0;
+  for (; i + 128 <= size; i += 128)
+  {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+    __m256i c = _mm256_loadu_si256((const __m256i*)(src + i + 64));
+    __m256i d = _mm256_loadu_si256((const __m256i*)(src + i + 96));
+    _mm256_storeu_si256((__m256i*)(dst + i),      a);
+    _mm256_storeu_si256((__m256i*)(dst + i + 32), b);
+    _mm256_storeu_si256((__m256i*)(dst + i + 64), c);
+    _mm256_storeu_si256((__m256i*)(dst + i + 96), d);
+  }
+  if (i < size)
+    memcpy(dst + i, src + i, size - i);
+}
+
+static void AVX2_StreamLine(uint8_t *dst, const uint8_t *src, int size)
+{
+  // non-temporal stores have to be aligned, starting on a cache line keeps
+  // the write combining buffers from being flushed half full
+  int i = std::min(size, (int)(-(intptr_t)dst & 63));
+  if (i)
+    memcpy(dst, src, i);
+
+  for (; i + 128 <= size; i += 128)
+  {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+    __m256i c = _mm256_loadu_si256((const __m256i*)(src + i + 64));
+    __m256i d = _mm256_loadu_si256((const __m256i*)(src + i + 96));
+    _mm256_stream_si256((__m256i*)(dst + i),      a);
+    _mm256_stream_si256((__m256i*)(dst + i + 32), b);
+    _mm256_stream_si256((__m256i*)(dst + i + 64), c);
+    _mm256_stream_si256((__m256i*)(dst + i + 96), d);
+  }
+  if (i < size)
+    memcpy(dst + i, src + i, size - i);
+}
+
+/* a and b interleaved, 64 bytes in order */
+static inline void AVX2_Unpack(__m256i a, __m256i b, __m256i &first, __m256i &second)
+{
+  __m256i lo = _mm256_unpacklo_epi8(a, b);
+  __m256i hi = _mm256_unpackhi_epi8(a, b);
+  first  = _mm256_permute2x128_si256(lo, hi, 0x20);
+  second = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+static void AVX2_InterleaveLine(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32, dst += 64)
+  {
+    __m256i uv0, uv1;
+    AVX2_Unpack(_mm256_loadu_si256((const __m256i*)(u + x)),
+                _mm256_loadu_si256((const __m256i*)(v + x)), uv0, uv1);
+    _mm256_storeu_si256((__m256i*)(dst),      uv0);
+    _mm256_storeu_si256((__m256i*)(dst + 32), uv1);
+  }
+  if (x < width)
+    CDVDCodecUtils::GetKernels(0).interleave(dst, u + x, v + x, width - x);
+}
+
+template<bool uyvy>
+static void AVX2_PackLine(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 64 <= width; x += 64, dst += 128)
+  {
+    __m256i y0 = _mm256_loadu_si256((const __m256i*)(y + x));
+    __m256i y1 = _mm256_loadu_si256((const __m256i*)(y + x + 32));
+    __m256i uv0, uv1, p0, p1, p2, p3;
+    AVX2_Unpack(_mm256_loadu_si256((const __m256i*)(u + (x >> 1))),
+                _mm256_loadu_si256((const __m256i*)(v + (x >> 1))), uv0, uv1);
+    if (uyvy)
+    {
+      AVX2_Unpack(uv0, y0, p0, p1);
+      AVX2_Unpack(uv1, y1, p2, p3);
+    }
+    else
+    {
+      AVX2_Unpack(y0, uv0, p0, p1);
+      AVX2_Unpack(y1, uv1, p2, p3);
+    }
+    _mm256_storeu_si256((__m256i*)(dst),      p0);
+    _mm256_storeu_si256((__m256i*)(dst + 32), p1);
+    _mm256_storeu_si256((__m256i*)(dst + 64), p2);
+    _mm256_storeu_si256((__m256i*)(dst + 96), p3);
+  }
+  if (x < width)
+  {
+    const CDVDCodecUtils::SPictureKernels& kernels = CDVDCodecUtils::GetKernels(0);
+    (uyvy ? kernels.packUYVY : kernels.packYUY2)(dst, y + x, u + (x >> 1), v + (x >> 1), width - x);
+  }
+}
+
+static void AVX2_Fence()
+{
+  _mm_sfence();
+}
+
+static const CDVDCodecUtils::SPictureKernels g_kernelsAVX2 =
+{
+  AVX2_CopyLine,
+  AVX2_StreamLine,
+  AVX2_InterleaveLine,
+  AVX2_PackLine<false>,
+  AVX2_PackLine<true>,
+  AVX2_Fence
+};
+
+const CDVDCodecUtils::SPictureKernels* CDVDCodecUtils::GetKernelsAVX2()
+{
+  return &g_kernelsAVX2;
+}
+
+#else /* no AVX2 */
+
+const CDVDCodecUtils::SPictureKernels* CDVDCodecUtils::GetKernelsAVX2()
+{
+  return NULL;
+}
+
+#endif
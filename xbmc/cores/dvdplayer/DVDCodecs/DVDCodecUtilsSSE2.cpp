@@ -0,0 +1,155 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  This file is built with SSE2 code generation enabled, nothing in here may
+  be called unless CCPUInfo reports CPU_FEATURE_SSE2. The build defines
+  HAS_SSE2_KERNELS where it can compile the intrinsics.
+*/
+
+#include "DVDCodecUtils.h"
+#include <string.h>
+#include <algorithm>
+
+#ifdef HAS_SSE2_KERNELS
+#include <emmintrin.h>
+
+/*
+  The line tails are left to the C kernels. The uv pairs of the packed
+  formats come from the same unpack as the NV12 interleave, they are then
+  unpacked once more with the luma samples.
+*/
+static void SSE2_CopyLine(uint8_t *dst, const uint8_t *src, int size)
+{
+  int i = 0;
+  for (; i + 64 <= size; i += 64)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 16));
+    __m128i c = _mm_loadu_si128((const __m128i*)(src + i + 32));
+    __m128i d = _mm_loadu_si128((const __m128i*)(src + i + 48));
+    _mm_storeu_si128((__m128i*)(dst + i),      a);
+    _mm_storeu_si128((__m128i*)(dst + i + 16), b);
+    _mm_storeu_si128((__m128i*)(dst + i + 32), c);
+    _mm_storeu_si128((__m128i*)(dst + i + 48), d);
+  }
+  if (i < size)
+    memcpy(dst + i, src + i, size - i);
+}
+
+static void SSE2_StreamLine(uint8_t *dst, const uint8_t *src, int size)
+{
+  // non-temporal stores have to be aligned, starting on a cache line keeps
+  // the write combining buffers from being flushed half full
+  int i = std::min(size, (int)(-(intptr_t)dst & 63));
+  if (i)
+    memcpy(dst, src, i);
+
+  for (; i + 64 <= size; i += 64)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 16));
+    __m128i c = _mm_loadu_si128((const __m128i*)(src + i + 32));
+    __m128i d = _mm_loadu_si128((const __m128i*)(src + i + 48));
+    _mm_stream_si128((__m128i*)(dst + i),      a);
+    _mm_stream_si128((__m128i*)(dst + i + 16), b);
+    _mm_stream_si128((__m128i*)(dst + i + 32), c);
+    _mm_stream_si128((__m128i*)(dst + i + 48), d);
+  }
+  if (i < size)
+    memcpy(dst + i, src + i, size - i);
+}
+
+static void SSE2_InterleaveLine(uint8_t *dst, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 16 <= width; x += 16, dst += 32)
+  {
+    __m128i cu = _mm_loadu_si128((const __m128i*)(u + x));
+    __m128i cv = _mm_loadu_si128((const __m128i*)(v + x));
+    _mm_storeu_si128((__m128i*)(dst),      _mm_unpacklo_epi8(cu, cv));
+    _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi8(cu, cv));
+  }
+  if (x < width)
+    CDVDCodecUtils::GetKernels(0).interleave(dst, u + x, v + x, width - x);
+}
+
+template<bool uyvy>
+static void SSE2_PackLine(uint8_t *dst, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  int x = 0;
+  for (; x + 32 <= width; x += 32, dst += 64)
+  {
+    __m128i y0 = _mm_loadu_si128((const __m128i*)(y + x));
+    __m128i y1 = _mm_loadu_si128((const __m128i*)(y + x + 16));
+    __m128i cu = _mm_loadu_si128((const __m128i*)(u + (x >> 1)));
+    __m128i cv = _mm_loadu_si128((const __m128i*)(v + (x >> 1)));
+    __m128i uv0 = _mm_unpacklo_epi8(cu, cv);
+    __m128i uv1 = _mm_unpackhi_epi8(cu, cv);
+    if (uyvy)
+    {
+      _mm_storeu_si128((__m128i*)(dst),      _mm_unpacklo_epi8(uv0, y0));
+      _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi8(uv0, y0));
+      _mm_storeu_si128((__m128i*)(dst + 32), _mm_unpacklo_epi8(uv1, y1));
+      _mm_storeu_si128((__m128i*)(dst + 48), _mm_unpackhi_epi8(uv1, y1));
+    }
+    else
+    {
+      _mm_storeu_si128((__m128i*)(dst),      _mm_unpacklo_epi8(y0, uv0));
+      _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi8(y0, uv0));
+      _mm_storeu_si128((__m128i*)(dst + 32), _mm_unpacklo_epi8(y1, uv1));
+      _mm_storeu_si128((__m128i*)(dst + 48), _mm_unpackhi_epi8(y1, uv1));
+    }
+  }
+  if (x < width)
+  {
+    const CDVDCodecUtils::SPictureKernels& kernels = CDVDCodecUtils::GetKernels(0);
+    (uyvy ? kernels.packUYVY : kernels.packYUY2)(dst, y + x, u + (x >> 1), v + (x >> 1), width - x);
+  }
+}
+
+static void SSE2_Fence()
+{
+  _mm_sfence();
+}
+
+static const CDVDCodecUtils::SPictureKernels g_kernelsSSE2 =
+{
+  SSE2_CopyLine,
+  SSE2_StreamLine,
+  SSE2_InterleaveLine,
+  SSE2_PackLine<false>,
+  SSE2_PackLine<true>,
+  SSE2_Fence
+};
+
+const CDVDCodecUtils::SPictureKernels* CDVDCodecUtils::GetKernelsSSE2()
+{
+  return &g_kernelsSSE2;
+}
+
+#else /* no SSE2 */
+
+const CDVDCodecUtils::SPictureKernels* CDVDCodecUtils::GetKernelsSSE2()
+{
+  return NULL;
+}
+
+#endif
@@ -50,6 +50,7 @@ struct OpenMaxVideoBuffer;
 class CDVDVideoCodecStageFright;
 class CDVDMediaCodecInfo;
 typedef void* EGLImageKHR;
+class CDVDVideoPictureBuffer;
 
 
 // should be entirely filled by all codecs
@@ -63,6 +64,7 @@ struct DVDVideoPicture
     struct {
       uint8_t* data[4];      // [4] = alpha channel, currently not used
       int iLineSize[4];   // [4] = alpha channel, currently not used
+      CDVDVideoPictureBuffer* buffer; // holds data if set, the renderer may keep a reference instead of a copy
     };
     struct {
       DXVA::CSurfaceContext* context;
@@ -213,6 +215,12 @@ public:
    */
   virtual void SetDropState(bool bDrop) = 0;
 
+  /*
+   * decode keyframes only, everything else is discarded before decoding.
+   * used to find a picture for a thumbnail quickly after a seek
+   */
+  virtual void SetKeyframesOnly(bool bKeyframesOnly) {};
+
   /*
    * will be called by video player indicating the playback speed. see DVD_PLAYSPEED_NORMAL,
    * DVD_PLAYSPEED_PAUSE and friends.
@@ -273,6 +281,12 @@ public:
    */
   virtual unsigned GetAllowedReferences() { return 0; }
 
+  /**
+   * Number of pictures the decoder holds back and may then return
+   * in a burst, the renderer queues deeper to take them
+   */
+  virtual unsigned GetDecoderLatency() { return 0; }
+
   /**
    * Hide or Show Settings depending on the currently running hardware 
    *
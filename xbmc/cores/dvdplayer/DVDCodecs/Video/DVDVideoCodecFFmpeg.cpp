@@ -137,6 +137,78 @@ enum PixelFormat CDVDVideoCodecFFmpeg::GetFormat( struct AVCodecContext * avctx
   return ctx->m_dllAvCodec.avcodec_default_get_format(avctx, fmt);
 }
 
+/* the pictures are decoded into pool buffers, so the renderer can hold on
+   to them with a reference instead of copying them. Anything the pool does
+   not handle goes to the default buffers of libavcodec. */
+int CDVDVideoCodecFFmpeg::GetBuffer(AVCodecContext *avctx, AVFrame *pic)
+{
+  CDVDVideoCodecFFmpeg* ctx = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+
+  SPicturePoolFormat format;
+  if (!ctx->GetPoolFormat(avctx, format))
+    return ctx->m_dllAvCodec.avcodec_default_get_buffer(avctx, pic);
+
+  CDVDVideoPictureBuffer* buffer = ctx->m_pPool->Get(format);
+  if (!buffer)
+    return -1;
+
+  for (int i = 0; i < 4; i++)
+  {
+    pic->base[i]     = buffer->data[i];
+    pic->data[i]     = buffer->data[i];
+    pic->linesize[i] = buffer->iLineSize[i];
+  }
+  pic->type             = FF_BUFFER_TYPE_USER;
+  pic->opaque           = buffer;
+  pic->reordered_opaque = avctx->reordered_opaque;
+  return 0;
+}
+
+void CDVDVideoCodecFFmpeg::ReleaseBuffer(AVCodecContext *avctx, AVFrame *pic)
+{
+  CDVDVideoCodecFFmpeg* ctx = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+
+  if (pic->type != FF_BUFFER_TYPE_USER)
+  {
+    ctx->m_dllAvCodec.avcodec_default_release_buffer(avctx, pic);
+    return;
+  }
+
+  ((CDVDVideoPictureBuffer*)pic->opaque)->Release();
+  pic->opaque = NULL;
+  for (int i = 0; i < 4; i++)
+    pic->data[i] = NULL;
+}
+
+bool CDVDVideoCodecFFmpeg::GetPoolFormat(AVCodecContext *avctx, SPicturePoolFormat &format)
+{
+  switch (avctx->pix_fmt)
+  {
+    case PIX_FMT_YUV420P:
+    case PIX_FMT_YUVJ420P:
+      format.bpp = 1;
+      break;
+    case PIX_FMT_YUV420P10:
+    case PIX_FMT_YUV420P16:
+      format.bpp = 2;
+      break;
+    default:
+      return false;
+  }
+
+  if (avctx->width <= 0 || avctx->height <= 0)
+    return false;
+
+  int align[AV_NUM_DATA_POINTERS];
+  format.width  = avctx->width;
+  format.height = avctx->height;
+  m_dllAvCodec.avcodec_align_dimensions2(avctx, &format.width, &format.height, align);
+  format.edge     = (avctx->flags & CODEC_FLAG_EMU_EDGE) ? 0 : m_dllAvCodec.avcodec_get_edge_width();
+  format.cshift_x = 1;
+  format.cshift_y = 1;
+  return true;
+}
+
 CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
 {
   m_pCodecContext = NULL;
@@ -164,6 +236,10 @@ CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
   m_iLastKeyframe = 0;
   m_dts = DVD_NOPTS_VALUE;
   m_started = false;
+  m_threading = THREADING_NONE;
+  m_decodeTime = 0.0;
+  m_decodeFrames = 0;
+  m_pPool = NULL;
 }
 
 CDVDVideoCodecFFmpeg::~CDVDVideoCodecFFmpeg()
@@ -238,25 +314,16 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pCodecContext->workaround_bugs = FF_BUG_AUTODETECT;
   m_pCodecContext->get_format = GetFormat;
   m_pCodecContext->codec_tag = hints.codec_tag;
-  /* Only allow slice threading, since frame threading is more
-   * sensitive to changes in frame sizes, and it causes crashes
-   * during HW accell - so we unset it in this case.
-   *
-   * When we detect Hi10p and user did not disable hi10pmultithreading
-   * via advancedsettings.xml we keep the ffmpeg default thread type.
-   * */
-  if(m_isHi10p && !g_advancedSettings.m_videoDisableHi10pMultithreading)
-  {
-    CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Keep default threading for Hi10p: %d",
-                        m_pCodecContext->thread_type);
-  }
-  else if ((EDECODEMETHOD) CSettings::Get().GetInt("videoplayer.decodingmethod") == VS_DECODEMETHOD_SOFTWARE && CSettings::Get().GetBool("videoplayer.useframemtdec"))
+
+  // hardware decoders replace the buffer callbacks with their own
+  if (pCodec->capabilities & CODEC_CAP_DR1)
   {
-    CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Keep default threading %d by videoplayer.useframemtdec",
-                        m_pCodecContext->thread_type);
+    if (!m_pPool)
+      m_pPool = new CDVDVideoPicturePool();
+    m_pCodecContext->get_buffer            = GetBuffer;
+    m_pCodecContext->release_buffer        = ReleaseBuffer;
+    m_pCodecContext->thread_safe_callbacks = 1;
   }
-  else
-    m_pCodecContext->thread_type = FF_THREAD_SLICE;
 
 #if defined(TARGET_DARWIN_IOS)
   // ffmpeg with enabled neon will crash and burn if this is enabled
@@ -296,11 +363,28 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
       m_dllAvUtil.av_opt_set(m_pCodecContext, it->m_name.c_str(), it->m_value.c_str(), 0);
   }
 
-  int num_threads = std::min(8 /*MAX_THREADS*/, g_cpuInfo.getCPUCount());
-  if( num_threads > 1 && !hints.software && m_pHardware == NULL // thumbnail extraction fails when run threaded
-  && ( pCodec->id == AV_CODEC_ID_H264
-    || pCodec->id == AV_CODEC_ID_MPEG4 ))
-    m_pCodecContext->thread_count = num_threads;
+  /* Frame threading is more sensitive to changes in frame sizes, and it
+   * causes crashes during HW accell - so it's only allowed when decoding
+   * in software was chosen by videoplayer.useframemtdec, or for Hi10p
+   * unless the user disabled hi10pmultithreading via advancedsettings.xml.
+   * */
+  CDVDVideoThreadPolicy::SStream stream;
+  stream.codec        = pCodec->id;
+  stream.capabilities = pCodec->capabilities;
+  stream.width        = hints.width;
+  stream.height       = hints.height;
+  stream.realtime     = hints.realtime;
+  stream.software     = hints.software;
+  stream.allowFrame   = (m_isHi10p && !g_advancedSettings.m_videoDisableHi10pMultithreading)
+                     || ((EDECODEMETHOD) CSettings::Get().GetInt("videoplayer.decodingmethod") == VS_DECODEMETHOD_SOFTWARE
+                         && CSettings::Get().GetBool("videoplayer.useframemtdec"));
+
+  SThreadingPolicy threading = CDVDVideoThreadPolicy::Choose(stream, g_cpuInfo.getCPUCount());
+  m_threading = threading.mode;
+  m_pCodecContext->thread_type  = threading.mode == THREADING_FRAME ? FF_THREAD_FRAME : FF_THREAD_SLICE;
+  m_pCodecContext->thread_count = threading.threads;
+  CLog::Log(LOGNOTICE,"CDVDVideoCodecFFmpeg::Open() %s threading with %d threads, %s"
+                     , CDVDVideoThreadPolicy::GetModeName(threading.mode), threading.threads, threading.reason);
 
   if (m_dllAvCodec.avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
   {
@@ -322,6 +406,13 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
 
 void CDVDVideoCodecFFmpeg::Dispose()
 {
+  if (m_decodeFrames)
+    CLog::Log(LOGNOTICE, "CDVDVideoCodecFFmpeg::Dispose - %s threading, %.2f ms per frame for %u frames"
+                       , CDVDVideoThreadPolicy::GetModeName(m_threading)
+                       , GetDecodeTime() / DVD_TIME_BASE * 1000.0, m_decodeFrames);
+  m_decodeTime = 0.0;
+  m_decodeFrames = 0;
+
   if (m_pFrame) m_dllAvUtil.av_free(m_pFrame);
   m_pFrame = NULL;
 
@@ -343,6 +434,9 @@ void CDVDVideoCodecFFmpeg::Dispose()
   }
   SAFE_RELEASE(m_pHardware);
 
+  // pictures still held by the renderer keep the pool alive
+  SAFE_RELEASE(m_pPool);
+
   FilterClose();
 
   m_dllAvCodec.Unload();
@@ -375,6 +469,12 @@ void CDVDVideoCodecFFmpeg::SetDropState(bool bDrop)
   }
 }
 
+void CDVDVideoCodecFFmpeg::SetKeyframesOnly(bool bKeyframesOnly)
+{
+  if (m_pCodecContext)
+    m_pCodecContext->skip_frame = bKeyframesOnly ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+}
+
 unsigned int CDVDVideoCodecFFmpeg::SetFilters(unsigned int flags)
 {
   m_filters_next.clear();
@@ -482,7 +582,11 @@ int CDVDVideoCodecFFmpeg::Decode(uint8_t* pData, int iSize, double dts, double p
   /* We lie, but this flag is only used by pngdec.c.
    * Setting it correctly would allow CorePNG decoding. */
   avpkt.flags = AV_PKT_FLAG_KEY;
+  double decodeStart = CDVDClock::GetAbsoluteClock(false);
   len = m_dllAvCodec.avcodec_decode_video2(m_pCodecContext, m_pFrame, &iGotPicture, &avpkt);
+  m_decodeTime += CDVDClock::GetAbsoluteClock(false) - decodeStart;
+  if (iGotPicture)
+    m_decodeFrames++;
 
   if(m_iLastKeyframe < m_pCodecContext->has_b_frames + 2)
     m_iLastKeyframe = m_pCodecContext->has_b_frames + 2;
@@ -674,7 +778,10 @@ bool CDVDVideoCodecFFmpeg::GetPictureCommon(DVDVideoPicture* pDvdVideoPicture)
 bool CDVDVideoCodecFFmpeg::GetPicture(DVDVideoPicture* pDvdVideoPicture)
 {
   if(m_pHardware)
+  {
+    pDvdVideoPicture->buffer = NULL;
     return m_pHardware->GetPicture(m_pCodecContext, m_pFrame, pDvdVideoPicture);
+  }
 
   if(!GetPictureCommon(pDvdVideoPicture))
     return false;
@@ -686,6 +793,13 @@ bool CDVDVideoCodecFFmpeg::GetPicture(DVDVideoPicture* pDvdVideoPicture)
       pDvdVideoPicture->iLineSize[i] = m_pFrame->linesize[i];
   }
 
+  // only a picture straight from the decoder is still in its buffer
+  if (!m_pFilterGraph && m_pFrame->type == FF_BUFFER_TYPE_USER && m_pFrame->opaque
+  && ((CDVDVideoPictureBuffer*)m_pFrame->opaque)->data[0] == m_pFrame->data[0])
+    pDvdVideoPicture->buffer = (CDVDVideoPictureBuffer*)m_pFrame->opaque;
+  else
+    pDvdVideoPicture->buffer = NULL;
+
   pDvdVideoPicture->iFlags |= pDvdVideoPicture->data[0] ? 0 : DVP_FLAG_DROPPED;
   pDvdVideoPicture->extended_format = 0;
 
@@ -924,3 +1038,12 @@ unsigned CDVDVideoCodecFFmpeg::GetAllowedReferences()
   else
     return 0;
 }
+
+unsigned CDVDVideoCodecFFmpeg::GetDecoderLatency()
+{
+  /* each frame thread holds a picture until the ones before it are done */
+  if(!m_pHardware && m_pCodecContext && m_threading == THREADING_FRAME && m_pCodecContext->thread_count > 1)
+    return m_pCodecContext->thread_count - 1;
+  else
+    return 0;
+}
@@ -28,6 +28,8 @@
 #include "DllSwScale.h"
 #include "DllAvFilter.h"
 #include "DllPostProc.h"
+#include "DVDVideoThreadPolicy.h"
+#include "DVDVideoPicturePool.h"
 
 class CCriticalSection;
 
@@ -58,10 +60,15 @@ public:
   bool GetPictureCommon(DVDVideoPicture* pDvdVideoPicture);
   virtual bool GetPicture(DVDVideoPicture* pDvdVideoPicture);
   virtual void SetDropState(bool bDrop);
+  virtual void SetKeyframesOnly(bool bKeyframesOnly);
   virtual unsigned int SetFilters(unsigned int filters);
   virtual const char* GetName() { return m_name.c_str(); }; // m_name is never changed after open
   virtual unsigned GetConvergeCount();
   virtual unsigned GetAllowedReferences();
+  virtual unsigned GetDecoderLatency();
+
+  /* average time the decoder took per frame it returned, in DVD_TIME_BASE units */
+  double             GetDecodeTime() { return m_decodeFrames ? m_decodeTime / m_decodeFrames : 0.0; }
 
   bool               IsHardwareAllowed()                     { return !m_bSoftware; }
   IHardwareDecoder * GetHardware()                           { return m_pHardware; };
@@ -74,6 +81,9 @@ public:
 
 protected:
   static enum PixelFormat GetFormat(struct AVCodecContext * avctx, const PixelFormat * fmt);
+  static int  GetBuffer(AVCodecContext *avctx, AVFrame *pic);
+  static void ReleaseBuffer(AVCodecContext *avctx, AVFrame *pic);
+  bool GetPoolFormat(AVCodecContext *avctx, SPicturePoolFormat &format);
 
   int  FilterOpen(const CStdString& filters, bool scale);
   void FilterClose();
@@ -126,5 +136,9 @@ protected:
   int m_iLastKeyframe;
   double m_dts;
   bool   m_started;
+  EThreadingMode m_threading; // chosen on open
+  double m_decodeTime;        // spent in the decoder since open
+  unsigned int m_decodeFrames;
   std::vector<PixelFormat> m_formats;
+  CDVDVideoPicturePool *m_pPool; // software decoded pictures, shared with the renderer
 };
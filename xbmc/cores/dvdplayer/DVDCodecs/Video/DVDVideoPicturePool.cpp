@@ -0,0 +1,172 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "DVDVideoPicturePool.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#include <string.h>
+
+/* planes and lines start on a cache line, which is more than any decoder
+   or upload path asks for */
+#define POOL_ALIGN 64
+#define POOL_ALIGNED(x) (((x) + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1))
+
+CDVDVideoPictureBuffer::CDVDVideoPictureBuffer(CDVDVideoPicturePool *pool, const SPicturePoolFormat &format)
+  : m_pool(pool)
+  , m_format(format)
+  , m_base(NULL)
+  , m_refs(1)
+{
+  int offset[3];
+  int size = 0;
+  for (int p = 0; p < 3; p++)
+  {
+    int sx = p ? format.cshift_x : 0;
+    int sy = p ? format.cshift_y : 0;
+    int w  = (format.width  + (1 << sx) - 1) >> sx;
+    int h  = (format.height + (1 << sy) - 1) >> sy;
+
+    // the left edge is rounded up to an aligned start of the picture
+    int left = POOL_ALIGNED((format.edge >> sx) * format.bpp);
+    int top  = format.edge >> sy;
+
+    iLineSize[p] = POOL_ALIGNED(left * 2 + w * format.bpp);
+    offset[p]    = size + top * iLineSize[p] + left;
+
+    // decoders read a little past the last line
+    size += POOL_ALIGNED(iLineSize[p] * (h + top * 2) + POOL_ALIGN);
+  }
+
+  m_base = (uint8_t*)_aligned_malloc(size, POOL_ALIGN);
+  for (int p = 0; p < 3; p++)
+    data[p] = m_base ? m_base + offset[p] : NULL;
+  data[3]      = NULL;
+  iLineSize[3] = 0;
+}
+
+CDVDVideoPictureBuffer::~CDVDVideoPictureBuffer()
+{
+  if (m_base)
+    _aligned_free(m_base);
+}
+
+CDVDVideoPictureBuffer* CDVDVideoPictureBuffer::Acquire()
+{
+  AtomicIncrement(&m_refs);
+  return this;
+}
+
+long CDVDVideoPictureBuffer::Release()
+{
+  long count = AtomicDecrement(&m_refs);
+  if (count == 0)
+    m_pool->Return(this);
+  return count;
+}
+
+CDVDVideoPicturePool::CDVDVideoPicturePool()
+  : m_allocated(0)
+  , m_refs(1)
+{
+  memset(&m_format, 0, sizeof(m_format));
+}
+
+CDVDVideoPicturePool::~CDVDVideoPicturePool()
+{
+  for (std::vector<CDVDVideoPictureBuffer*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+    delete *it;
+}
+
+CDVDVideoPicturePool* CDVDVideoPicturePool::Acquire()
+{
+  AtomicIncrement(&m_refs);
+  return this;
+}
+
+long CDVDVideoPicturePool::Release()
+{
+  long count = AtomicDecrement(&m_refs);
+  if (count == 0)
+    delete this;
+  return count;
+}
+
+CDVDVideoPictureBuffer* CDVDVideoPicturePool::Get(const SPicturePoolFormat &format)
+{
+  CDVDVideoPictureBuffer *buffer = NULL;
+  {
+    CSingleLock lock(m_section);
+    if (format != m_format)
+    {
+      for (std::vector<CDVDVideoPictureBuffer*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+        delete *it;
+      m_allocated -= m_free.size();
+      m_free.clear();
+      m_format = format;
+    }
+
+    if (!m_free.empty())
+    {
+      buffer = m_free.back();
+      m_free.pop_back();
+      buffer->m_refs = 1;
+    }
+    else
+    {
+      buffer = new CDVDVideoPictureBuffer(this, format);
+      if (!buffer->m_base)
+      {
+        CLog::Log(LOGERROR, "CDVDVideoPicturePool::Get - unable to allocate a %dx%d picture", format.width, format.height);
+        delete buffer;
+        return NULL;
+      }
+      m_allocated++;
+    }
+  }
+
+  Acquire();
+  return buffer;
+}
+
+int CDVDVideoPicturePool::GetAllocated()
+{
+  CSingleLock lock(m_section);
+  return m_allocated;
+}
+
+void CDVDVideoPicturePool::Return(CDVDVideoPictureBuffer *buffer)
+{
+  {
+    CSingleLock lock(m_section);
+    if (buffer->m_format == m_format)
+      m_free.push_back(buffer);
+    else
+    {
+      m_allocated--;
+      delete buffer;
+    }
+  }
+
+  // the buffer's reference, this may be the last one
+  Release();
+}
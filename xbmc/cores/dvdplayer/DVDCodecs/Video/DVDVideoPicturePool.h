@@ -0,0 +1,107 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+
+#include <stdint.h>
+#include <vector>
+
+class CDVDVideoPicturePool;
+
+/* geometry of the planar pictures of a pool */
+struct SPicturePoolFormat
+{
+  int width;     // as the decoder aligned it
+  int height;
+  int edge;      // border the decoder may draw into around the picture, 0 if none
+  int bpp;       // bytes per sample
+  int cshift_x;  // chroma subsampling
+  int cshift_y;
+
+  bool operator==(const SPicturePoolFormat &f) const
+  {
+    return width    == f.width    && height   == f.height
+        && edge     == f.edge     && bpp      == f.bpp
+        && cshift_x == f.cshift_x && cshift_y == f.cshift_y;
+  }
+  bool operator!=(const SPicturePoolFormat &f) const { return !(*this == f); }
+};
+
+/**
+ * A decoded picture owned by a CDVDVideoPicturePool. The decoder holds one
+ * reference while it uses the picture as output or as a reference frame,
+ * the renderer may take another one instead of copying the picture. It
+ * goes back to the pool once the last reference is released, so nobody
+ * may write to it while it is shared.
+ */
+class CDVDVideoPictureBuffer
+{
+public:
+  CDVDVideoPictureBuffer* Acquire();
+  long Release();
+
+  uint8_t* data[4];      // [3] is always NULL
+  int      iLineSize[4];
+
+private:
+  friend class CDVDVideoPicturePool;
+  CDVDVideoPictureBuffer(CDVDVideoPicturePool *pool, const SPicturePoolFormat &format);
+  ~CDVDVideoPictureBuffer();
+
+  CDVDVideoPicturePool *m_pool;
+  SPicturePoolFormat    m_format;
+  uint8_t              *m_base;
+  volatile long         m_refs;
+};
+
+/**
+ * Recycles the picture buffers of one decoder. The pool is reference
+ * counted as well, every buffer that is out holds a reference, so
+ * pictures still queued in the renderer stay valid after the decoder
+ * that made them was closed.
+ */
+class CDVDVideoPicturePool
+{
+public:
+  CDVDVideoPicturePool();
+  CDVDVideoPicturePool* Acquire();
+  long Release();
+
+  /* a buffer with one reference, NULL if it could not be allocated. Free
+     buffers of another format are dropped, a stream only changes its
+     format on a resolution change. */
+  CDVDVideoPictureBuffer* Get(const SPicturePoolFormat &format);
+
+  /* buffers currently allocated, free or not */
+  int GetAllocated();
+
+private:
+  friend class CDVDVideoPictureBuffer;
+  ~CDVDVideoPicturePool();
+  void Return(CDVDVideoPictureBuffer *buffer);
+
+  CCriticalSection                     m_section;
+  std::vector<CDVDVideoPictureBuffer*> m_free;
+  SPicturePoolFormat                   m_format;
+  int                                  m_allocated;
+  volatile long                        m_refs;
+};
@@ -0,0 +1,82 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDVideoThreadPolicy.h"
+
+#include <algorithm>
+
+#define MAX_THREADS     8
+#define MAX_THREADS_SD  4   // slices of sd streams don't go round more threads
+
+static SThreadingPolicy MakePolicy(EThreadingMode mode, int threads, const char* reason)
+{
+  SThreadingPolicy policy;
+  policy.mode    = mode;
+  policy.threads = mode == THREADING_NONE ? 1 : threads;
+  policy.reason  = reason;
+  return policy;
+}
+
+SThreadingPolicy CDVDVideoThreadPolicy::Choose(const SStream& stream, int cpus)
+{
+  int threads = std::min(MAX_THREADS, cpus);
+
+  if (threads <= 1)
+    return MakePolicy(THREADING_NONE, 1, "single cpu");
+
+  // thumbnail extraction fails when run threaded
+  if (stream.software)
+    return MakePolicy(THREADING_NONE, 1, "decoding outside of playback");
+
+  if (stream.codec != AV_CODEC_ID_H264
+  &&  stream.codec != AV_CODEC_ID_MPEG4)
+    return MakePolicy(THREADING_NONE, 1, "codec is decoded single threaded");
+
+  bool frame = (stream.capabilities & CODEC_CAP_FRAME_THREADS) != 0;
+  bool slice = (stream.capabilities & CODEC_CAP_SLICE_THREADS) != 0;
+
+  if (stream.height > 0 && stream.height < 720)
+    threads = std::min(MAX_THREADS_SD, threads);
+
+  if (stream.realtime)
+  {
+    if (slice)
+      return MakePolicy(THREADING_SLICE, threads, "live source, low latency");
+    return MakePolicy(THREADING_NONE, 1, "live source, codec has no slice threading");
+  }
+
+  if (frame && stream.allowFrame)
+    return MakePolicy(THREADING_FRAME, std::min(MAX_THREADS, cpus), "throughput");
+
+  if (slice)
+    return MakePolicy(THREADING_SLICE, threads, stream.allowFrame ? "codec has no frame threading" : "frame threading not allowed");
+
+  return MakePolicy(THREADING_NONE, 1, "codec has no threading allowed");
+}
+
+const char* CDVDVideoThreadPolicy::GetModeName(EThreadingMode mode)
+{
+  switch (mode)
+  {
+    case THREADING_SLICE: return "slice";
+    case THREADING_FRAME: return "frame";
+    default:              return "none";
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DllAvCodec.h"
+
+enum EThreadingMode
+{
+  THREADING_NONE = 0,
+  THREADING_SLICE, // slices of a frame in parallel, no added latency
+  THREADING_FRAME  // frames in parallel, a frame of latency per thread
+};
+
+/* what the policy decided, and why */
+struct SThreadingPolicy
+{
+  EThreadingMode mode;
+  int            threads;
+  const char*    reason;
+};
+
+/*
+ * Chooses how ffmpeg spreads decoding of a video stream over the cpus.
+ * Frame threading gives the most throughput, which files want, but keeps
+ * a frame per thread in flight and can't be combined with hardware
+ * decoding. Live sources get slice threading, which adds no latency to
+ * channel switches. It is decided whenever a codec is opened, so a stream
+ * change brings a new decision.
+ */
+class CDVDVideoThreadPolicy
+{
+public:
+  struct SStream
+  {
+    AVCodecID codec;
+    int  capabilities; // CODEC_CAP_* of the decoder
+    int  width;
+    int  height;
+    bool realtime;     // live source, latency shows
+    bool software;     // decoded without the player, like for thumbnails
+    bool allowFrame;   // frame threading is allowed, no hardware decoder can take over
+  };
+
+  static SThreadingPolicy Choose(const SStream& stream, int cpus);
+  static const char* GetModeName(EThreadingMode mode);
+};
@@ -143,7 +143,7 @@ DemuxPacket* CDVDDemuxBXA::Read()
 
   if(pPacket->iSize < 1)
   {
-    delete pPacket;
+    CDVDDemuxUtils::FreeDemuxPacket(pPacket);
     pPacket = NULL;
   }
   else
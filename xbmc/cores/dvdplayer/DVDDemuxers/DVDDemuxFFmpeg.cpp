@@ -37,6 +37,7 @@
 #include "DVDInputStreams/DVDInputStreamPVRManager.h"
 #include "DVDInputStreams/DVDInputStreamFFmpeg.h"
 #include "DVDDemuxUtils.h"
+#include "DVDKeyframeIndex.h"
 #include "DVDClock.h" // for DVD_TIME_BASE
 #include "commons/Exception.h"
 #include "settings/AdvancedSettings.h"
@@ -215,6 +216,9 @@ CDVDDemuxFFmpeg::CDVDDemuxFFmpeg() : CDVDDemux()
   m_bAVI = false;
   m_speed = DVD_PLAYSPEED_NORMAL;
   m_program = UINT_MAX;
+  m_indexStream = -1;
+  m_indexLoaded = 0;
+  m_indexKeyframes = false;
   m_pkt.result = -1;
   memset(&m_pkt.pkt, 0, sizeof(AVPacket));
 }
@@ -244,6 +248,7 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
   m_iCurrentPts = DVD_NOPTS_VALUE;
   m_speed = DVD_PLAYSPEED_NORMAL;
   m_program = UINT_MAX;
+  m_indexStream = -1;
   const AVIOInterruptCB int_cb = { interrupt_cb, this };
 
   if (!pInput) return false;
@@ -491,6 +496,8 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
 
   CreateStreams();
 
+  LoadKeyframeIndex();
+
   return true;
 }
 
@@ -506,6 +513,7 @@ void CDVDDemuxFFmpeg::Dispose()
       CLog::Log(LOGWARNING, "CDVDDemuxFFmpeg::Dispose - demuxer changed our byte context behind our back, possible memleak");
       m_ioContext = m_pFormatContext->pb;
     }
+    SaveKeyframeIndex();
     m_dllAvFormat.avformat_close_input(&m_pFormatContext);
   }
 
@@ -810,6 +818,14 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
           }
         }
 
+        if (m_indexKeyframes && m_pkt.pkt.stream_index == m_indexStream
+        && (m_pkt.pkt.flags & AV_PKT_FLAG_KEY) && m_pkt.pkt.pos >= 0)
+        {
+          int64_t timestamp = m_pkt.pkt.dts != (int64_t)AV_NOPTS_VALUE ? m_pkt.pkt.dts : m_pkt.pkt.pts;
+          if (timestamp != (int64_t)AV_NOPTS_VALUE)
+            AddKeyframe(stream, m_pkt.pkt.pos, timestamp);
+        }
+
         // store internal id until we know the continuous id presented to player
         // the stream might not have been created yet
         pPacket->iStreamId = m_pkt.pkt.stream_index;
@@ -1013,7 +1029,12 @@ static double SelectAspect(AVStream* st, bool* forced)
 
 void CDVDDemuxFFmpeg::CreateStreams(unsigned int program)
 {
-  DisposeStreams();
+  // keep the old streams until the demuxer is closed
+  std::map<int, CDemuxStream*>::iterator it;
+  for(it = m_streams.begin(); it != m_streams.end(); ++it)
+    m_retired_streams.push_back(it->second);
+  m_streams.clear();
+  m_stream_index.clear();
 
   // add the ffmpeg streams to our own stream map
   if (m_pFormatContext->nb_programs)
@@ -1062,6 +1083,10 @@ void CDVDDemuxFFmpeg::DisposeStreams()
     delete it->second;
   m_streams.clear();
   m_stream_index.clear();
+
+  for(unsigned int i = 0; i < m_retired_streams.size(); i++)
+    delete m_retired_streams[i];
+  m_retired_streams.clear();
 }
 
 CDemuxStream* CDVDDemuxFFmpeg::AddStream(int iId)
@@ -1322,7 +1347,7 @@ void CDVDDemuxFFmpeg::AddStream(int iId, CDemuxStream* stream)
     /* replace old stream, keeping old index */
     stream->iId = res.first->second->iId;
 
-    delete res.first->second;
+    m_retired_streams.push_back(res.first->second);
     res.first->second = stream;
   }
   if(g_advancedSettings.m_logLevel > LOG_LEVEL_NORMAL)
@@ -1491,3 +1516,96 @@ bool CDVDDemuxFFmpeg::IsProgramChange()
   }
   return false;
 }
+
+void CDVDDemuxFFmpeg::LoadKeyframeIndex()
+{
+  m_indexStream = -1;
+  m_indexLoaded = 0;
+  m_indexKeyframes = false;
+
+  // only files a seek can jump around in, menus and live streams find nothing here
+  if (!m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE) && !m_pInput->IsStreamType(DVDSTREAM_TYPE_HTTP))
+    return;
+  if (m_pInput->GetLength() <= 0 || !m_pInput->Seek(0, SEEK_POSSIBLE))
+    return;
+
+  // the stream ffmpeg seeks in, the first video stream or else the first audio stream
+  int index = -1;
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVStream* st = m_pFormatContext->streams[i];
+    if (st->codec->codec_type == AVMEDIA_TYPE_VIDEO && !(st->disposition & AV_DISPOSITION_ATTACHED_PIC))
+    {
+      index = i;
+      break;
+    }
+    if (index < 0 && st->codec->codec_type == AVMEDIA_TYPE_AUDIO)
+      index = i;
+  }
+  if (index < 0)
+    return;
+
+  // files with an index of their own don't need ours
+  AVStream* st = m_pFormatContext->streams[index];
+  if (st->nb_index_entries > 0)
+    return;
+
+  m_indexStream = index;
+  m_indexKeyframes = m_pFormatContext->iformat->read_seek == NULL;
+
+  std::string path = CDVDKeyframeIndex::GetCachePath(m_pInput->GetFileName());
+  CDVDKeyframeIndex cache;
+  if (cache.Load(path)
+  &&  cache.Matches(m_pInput->GetLength(), st->codec->codec_id, st->time_base.num, st->time_base.den))
+  {
+    for (unsigned int i = 0; i < cache.m_entries.size(); i++)
+      m_dllAvFormat.av_add_index_entry(st, cache.m_entries[i].pos, cache.m_entries[i].timestamp, 0, 0, AVINDEX_KEYFRAME);
+    CLog::Log(LOGDEBUG, "%s - loaded %d keyframes of stream %d from %s", __FUNCTION__, st->nb_index_entries, index, path.c_str());
+  }
+  m_indexLoaded = st->nb_index_entries;
+}
+
+void CDVDDemuxFFmpeg::SaveKeyframeIndex()
+{
+  if (m_indexStream < 0 || m_indexStream >= (int)m_pFormatContext->nb_streams || !m_pInput)
+    return;
+
+  // nothing found that isn't cached already
+  AVStream* st = m_pFormatContext->streams[m_indexStream];
+  m_indexStream = -1;
+  if (st->nb_index_entries <= m_indexLoaded)
+    return;
+
+  CDVDKeyframeIndex cache;
+  cache.m_fileSize    = m_pInput->GetLength();
+  cache.m_codec       = st->codec->codec_id;
+  cache.m_timeBaseNum = st->time_base.num;
+  cache.m_timeBaseDen = st->time_base.den;
+  for (int i = 0; i < st->nb_index_entries; i++)
+  {
+    if (!(st->index_entries[i].flags & AVINDEX_KEYFRAME))
+      continue;
+    CDVDKeyframeIndex::Entry entry;
+    entry.pos       = st->index_entries[i].pos;
+    entry.timestamp = st->index_entries[i].timestamp;
+    cache.m_entries.push_back(entry);
+  }
+
+  if (cache.SaveToCache(m_pInput->GetFileName()))
+    CLog::Log(LOGDEBUG, "%s - saved %d keyframes to %s", __FUNCTION__, (int)cache.m_entries.size(),
+              CDVDKeyframeIndex::GetCachePath(m_pInput->GetFileName()).c_str());
+}
+
+void CDVDDemuxFFmpeg::AddKeyframe(AVStream* stream, int64_t pos, int64_t timestamp)
+{
+  // a keyframe about every second is plenty to start a seek from
+  int64_t spacing = stream->time_base.num > 0 ? stream->time_base.den / stream->time_base.num : 1;
+
+  int i = m_dllAvFormat.av_index_search_timestamp(stream, timestamp, AVSEEK_FLAG_BACKWARD);
+  if (i >= 0 && timestamp - stream->index_entries[i].timestamp < spacing)
+    return;
+  if (i + 1 < stream->nb_index_entries && stream->index_entries[i + 1].timestamp - timestamp < spacing)
+    return;
+
+  m_dllAvFormat.av_add_index_entry(stream, pos, timestamp, 0, 0, AVINDEX_KEYFRAME);
+}
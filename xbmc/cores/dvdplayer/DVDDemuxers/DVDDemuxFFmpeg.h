@@ -133,9 +133,14 @@ protected:
   void UpdateCurrentPTS();
   bool IsProgramChange();
 
+  void LoadKeyframeIndex();
+  void SaveKeyframeIndex();
+  void AddKeyframe(AVStream* stream, int64_t pos, int64_t timestamp);
+
   CCriticalSection m_critSection;
   std::map<int, CDemuxStream*> m_streams;
   std::vector<std::map<int, CDemuxStream*>::iterator> m_stream_index;
+  std::vector<CDemuxStream*> m_retired_streams; // replaced while open, still referenced by readers ahead of the player
 
   AVIOContext* m_ioContext;
 
@@ -150,6 +155,10 @@ protected:
   unsigned m_program;
   XbmcThreads::EndTime  m_timeout;
 
+  int      m_indexStream;    // stream whose keyframes are cached, -1 if none
+  int      m_indexLoaded;    // index entries of that stream after opening
+  bool     m_indexKeyframes; // the format has no seek of its own, keyframes read are indexed
+
   // Due to limitations of ffmpeg, we only can detect a program change
   // with a packet. This struct saves the packet for the next read and
   // signals STREAMCHANGE to player
@@ -0,0 +1,402 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDDemuxReadAhead.h"
+#include "DVDDemuxFFmpeg.h"
+#include "DVDDemuxUtils.h"
+#include "DVDClock.h"
+#include "DVDInputStreams/DVDInputStream.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+/* time Read waits for the reader before it returns an empty packet */
+#define READAHEAD_WAIT_MS 100
+
+static double GetPacketTime(const DemuxPacket* packet)
+{
+  if (packet->dts != DVD_NOPTS_VALUE)
+    return packet->dts;
+  return packet->pts;
+}
+
+CDVDDemuxReadAhead::CDVDDemuxReadAhead(CDVDDemux* demuxer, CDVDInputStream* input, int maxBytes, double maxTime)
+  : CThread("DemuxReadAhead")
+  , m_demuxer(demuxer)
+  , m_input(input)
+  , m_bytes(0)
+  , m_maxBytes(maxBytes)
+  , m_maxTime(maxTime)
+  , m_timeFront(DVD_NOPTS_VALUE)
+  , m_timeBack(DVD_NOPTS_VALUE)
+  , m_suspended(0)
+  , m_eof(false)
+  , m_aborted(false)
+{
+  GetStreams(m_streams);
+  m_readStreams = m_streams;
+  GetState(m_state);
+  m_readState = m_state;
+  m_fileName = m_demuxer->GetFileName();
+  m_inputPos = m_input ? m_input->Seek(0, SEEK_CUR) : -1;
+  CLog::Log(LOGDEBUG, "CDVDDemuxReadAhead - reading ahead up to %d bytes, %.1f seconds", m_maxBytes, m_maxTime);
+}
+
+CDVDDemuxReadAhead::~CDVDDemuxReadAhead()
+{
+  if (IsRunning())
+  {
+    {
+      CSingleLock lock(m_section);
+      m_bStop = true;
+      m_cond.notifyAll();
+    }
+    // don't wait for a stalled read
+    m_demuxer->Abort();
+    StopThread();
+  }
+  ClearBuffer();
+  delete m_demuxer;
+}
+
+bool CDVDDemuxReadAhead::Supports(CDVDInputStream* input, CDVDDemux* demuxer)
+{
+  if (!dynamic_cast<CDVDDemuxFFmpeg*>(demuxer))
+    return false;
+  if (dynamic_cast<CDVDInputStream::IMenus*>(input))
+    return false;
+  return input->IsStreamType(DVDSTREAM_TYPE_FILE)
+      || input->IsStreamType(DVDSTREAM_TYPE_HTTP);
+}
+
+void CDVDDemuxReadAhead::Process()
+{
+  while (!m_bStop)
+  {
+    {
+      CSingleLock lock(m_section);
+      if (m_suspended || m_eof || m_aborted || IsFull())
+      {
+        m_cond.wait(lock, READAHEAD_WAIT_MS);
+        continue;
+      }
+    }
+
+    // the packet is queued before the demuxer is let go, so a seek
+    // waiting for it drops it along with the rest of the buffer
+    CSingleLock demuxLock(m_demuxSection);
+    DemuxPacket* packet = m_demuxer->Read();
+
+    // a read replaces the stream of its packet, adds streams at the end
+    // or creates them all anew on a program change
+    bool changed = false;
+    bool stateChanged = false;
+    if (packet)
+    {
+      int id = packet->iStreamId;
+      const std::vector<CDemuxStream*>& streams = m_readStreams.streams;
+      if (id == DMX_SPECIALID_STREAMCHANGE
+      ||  m_demuxer->GetNrOfStreams() != (int)streams.size()
+      || (id >= 0 && id < (int)streams.size() && m_demuxer->GetStream(id) != streams[id]))
+      {
+        GetStreams(m_readStreams);
+        changed = true;
+      }
+
+      State state;
+      GetState(state);
+      if (state != m_readState)
+      {
+        m_readState = state;
+        stateChanged = true;
+      }
+    }
+    int64_t inputPos = m_input ? m_input->Seek(0, SEEK_CUR) : -1;
+
+    CSingleLock lock(m_section);
+    m_inputPos = inputPos;
+    if (packet)
+    {
+      m_buffer.push_back(Entry());
+      Entry& entry = m_buffer.back();
+      entry.packet  = packet;
+      entry.changed = changed;
+      if (changed)
+        entry.streams = m_readStreams;
+      entry.stateChanged = stateChanged;
+      if (stateChanged)
+        entry.state = m_readState;
+
+      m_bytes += packet->iSize;
+      double time = GetPacketTime(packet);
+      if (time != DVD_NOPTS_VALUE)
+      {
+        m_timeFront = time;
+        if (m_timeBack == DVD_NOPTS_VALUE)
+          m_timeBack = time;
+      }
+    }
+    else
+      m_eof = true;
+
+    m_cond.notifyAll();
+  }
+}
+
+bool CDVDDemuxReadAhead::IsFull() const
+{
+  // a single packet always fits
+  if (m_buffer.empty())
+    return false;
+  if (m_bytes >= m_maxBytes)
+    return true;
+  if (m_timeFront != DVD_NOPTS_VALUE && m_timeBack != DVD_NOPTS_VALUE)
+    return m_timeFront - m_timeBack > m_maxTime * DVD_TIME_BASE;
+  return false;
+}
+
+void CDVDDemuxReadAhead::ClearBuffer()
+{
+  for (std::deque<Entry>::iterator it = m_buffer.begin(); it != m_buffer.end(); ++it)
+    CDVDDemuxUtils::FreeDemuxPacket(it->packet);
+  m_buffer.clear();
+  m_bytes     = 0;
+  m_timeFront = DVD_NOPTS_VALUE;
+  m_timeBack  = DVD_NOPTS_VALUE;
+}
+
+void CDVDDemuxReadAhead::GetStreams(Streams& streams)
+{
+  int count = std::max(0, m_demuxer->GetNrOfStreams());
+  streams.streams.resize(count);
+  streams.codecNames.resize(count);
+  for (int i = 0; i < count; i++)
+  {
+    streams.streams[i] = m_demuxer->GetStream(i);
+    streams.codecNames[i].clear();
+    m_demuxer->GetStreamCodecName(i, streams.codecNames[i]);
+  }
+}
+
+void CDVDDemuxReadAhead::GetState(State& state)
+{
+  state.chapter      = m_demuxer->GetChapter();
+  state.chapterCount = m_demuxer->GetChapterCount();
+  state.streamLength = m_demuxer->GetStreamLength();
+  state.chapterName.clear();
+  m_demuxer->GetChapterName(state.chapterName);
+}
+
+bool CDVDDemuxReadAhead::State::operator!=(const State& other) const
+{
+  return chapter      != other.chapter
+      || chapterCount != other.chapterCount
+      || streamLength != other.streamLength
+      || chapterName  != other.chapterName;
+}
+
+void CDVDDemuxReadAhead::Suspend()
+{
+  CSingleLock lock(m_section);
+  m_suspended++;
+  m_cond.notifyAll();
+}
+
+void CDVDDemuxReadAhead::Resume(bool flush)
+{
+  // called with m_demuxSection held
+  CSingleLock lock(m_section);
+  if (flush)
+  {
+    ClearBuffer();
+    m_eof = false;
+    GetStreams(m_streams);
+    m_readStreams = m_streams;
+    GetState(m_state);
+    m_readState = m_state;
+    if (m_input)
+      m_inputPos = m_input->Seek(0, SEEK_CUR);
+  }
+  m_suspended--;
+  m_cond.notifyAll();
+}
+
+void CDVDDemuxReadAhead::Reset()
+{
+  Suspend();
+  CSingleLock lock(m_demuxSection);
+  m_demuxer->Reset();
+  Resume(true);
+}
+
+void CDVDDemuxReadAhead::Abort()
+{
+  {
+    CSingleLock lock(m_section);
+    m_aborted = true;
+    m_cond.notifyAll();
+  }
+  m_demuxer->Abort();
+}
+
+void CDVDDemuxReadAhead::Flush()
+{
+  Suspend();
+  CSingleLock lock(m_demuxSection);
+  m_demuxer->Flush();
+  Resume(true);
+}
+
+DemuxPacket* CDVDDemuxReadAhead::Read()
+{
+  if (!IsRunning())
+    Create();
+
+  CSingleLock lock(m_section);
+
+  XbmcThreads::EndTime timeout(READAHEAD_WAIT_MS);
+  while (m_buffer.empty() && !m_eof && !m_aborted)
+  {
+    unsigned int left = timeout.MillisLeft();
+    if (!left)
+      break;
+    m_cond.wait(lock, left);
+  }
+
+  if (m_buffer.empty())
+  {
+    if (m_eof)
+    {
+      // hand on the failed read once, the reader tries again after it
+      m_eof = false;
+      m_cond.notifyAll();
+      return NULL;
+    }
+    if (m_aborted)
+      return NULL;
+
+    // the input stalls, let the player loop go round
+    return CDVDDemuxUtils::AllocateDemuxPacket(0);
+  }
+
+  Entry& entry = m_buffer.front();
+  DemuxPacket* packet = entry.packet;
+  if (entry.changed)
+  {
+    m_streams.streams.swap(entry.streams.streams);
+    m_streams.codecNames.swap(entry.streams.codecNames);
+  }
+  if (entry.stateChanged)
+    m_state = entry.state;
+  m_buffer.pop_front();
+
+  m_bytes -= packet->iSize;
+  double time = GetPacketTime(packet);
+  if (time != DVD_NOPTS_VALUE)
+    m_timeBack = time;
+
+  m_cond.notifyAll();
+  return packet;
+}
+
+bool CDVDDemuxReadAhead::SeekTime(int time, bool backwords, double* startpts)
+{
+  Suspend();
+  CSingleLock lock(m_demuxSection);
+  bool ret = m_demuxer->SeekTime(time, backwords, startpts);
+  // a failed seek leaves the demuxer where it was
+  Resume(ret);
+  return ret;
+}
+
+bool CDVDDemuxReadAhead::SeekChapter(int chapter, double* startpts)
+{
+  Suspend();
+  CSingleLock lock(m_demuxSection);
+  bool ret = m_demuxer->SeekChapter(chapter, startpts);
+  Resume(ret);
+  return ret;
+}
+
+int CDVDDemuxReadAhead::GetChapterCount()
+{
+  CSingleLock lock(m_section);
+  return m_state.chapterCount;
+}
+
+int CDVDDemuxReadAhead::GetChapter()
+{
+  CSingleLock lock(m_section);
+  return m_state.chapter;
+}
+
+void CDVDDemuxReadAhead::GetChapterName(std::string& strChapterName)
+{
+  CSingleLock lock(m_section);
+  strChapterName = m_state.chapterName;
+}
+
+void CDVDDemuxReadAhead::SetSpeed(int iSpeed)
+{
+  Suspend();
+  CSingleLock lock(m_demuxSection);
+  m_demuxer->SetSpeed(iSpeed);
+  Resume(false);
+}
+
+int CDVDDemuxReadAhead::GetStreamLength()
+{
+  CSingleLock lock(m_section);
+  return m_state.streamLength;
+}
+
+CDemuxStream* CDVDDemuxReadAhead::GetStream(int iStreamId)
+{
+  CSingleLock lock(m_section);
+  if (iStreamId < 0 || iStreamId >= (int)m_streams.streams.size())
+    return NULL;
+  return m_streams.streams[iStreamId];
+}
+
+int CDVDDemuxReadAhead::GetNrOfStreams()
+{
+  CSingleLock lock(m_section);
+  return m_streams.streams.size();
+}
+
+std::string CDVDDemuxReadAhead::GetFileName()
+{
+  return m_fileName;
+}
+
+void CDVDDemuxReadAhead::GetStreamCodecName(int iStreamId, CStdString &strName)
+{
+  CSingleLock lock(m_section);
+  if (iStreamId >= 0 && iStreamId < (int)m_streams.codecNames.size())
+    strName = m_streams.codecNames[iStreamId];
+}
+
+int64_t CDVDDemuxReadAhead::GetInputPosition()
+{
+  CSingleLock lock(m_section);
+  return m_inputPos;
+}
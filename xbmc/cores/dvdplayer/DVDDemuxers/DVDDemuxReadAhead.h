@@ -0,0 +1,137 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDDemux.h"
+#include "threads/Thread.h"
+#include "threads/CriticalSection.h"
+#include "threads/Condition.h"
+#include <deque>
+#include <vector>
+
+class CDVDInputStream;
+
+/**
+ * Reads a demuxer on a thread of its own into a packet buffer bounded by
+ * size and time, so a stalling input only stalls the player once the
+ * buffer has run dry. Read waits a short time for the next packet and
+ * hands out an empty packet when none arrived, which keeps the player
+ * loop going.
+ *
+ * Calls that move the read position (seeks, flush, reset) wait for the
+ * read in progress and drop the buffer. The streams handed out are the
+ * ones of the packet last returned by Read, so a stream change the reader
+ * ran into shows up when the player reaches it. Chapters, length and codec
+ * names are taken by the reader along with the packets and handed out the
+ * same way, the calls the player makes every loop never wait for a read.
+ */
+class CDVDDemuxReadAhead : public CDVDDemux, private CThread
+{
+public:
+  /* takes ownership of demuxer, input is the one it reads from, may be NULL */
+  CDVDDemuxReadAhead(CDVDDemux* demuxer, CDVDInputStream* input, int maxBytes, double maxTime);
+  virtual ~CDVDDemuxReadAhead();
+
+  /* true if demuxer can be read ahead for this input, it has to keep the
+     streams it replaces until it is closed and the input must not need
+     the player, like menus do */
+  static bool Supports(CDVDInputStream* input, CDVDDemux* demuxer);
+
+  void Reset();
+  void Abort();
+  void Flush();
+  DemuxPacket* Read();
+  bool SeekTime(int time, bool backwords = false, double* startpts = NULL);
+  bool SeekChapter(int chapter, double* startpts = NULL);
+  int GetChapterCount();
+  int GetChapter();
+  void GetChapterName(std::string& strChapterName);
+  void SetSpeed(int iSpeed);
+  int GetStreamLength();
+  CDemuxStream* GetStream(int iStreamId);
+  int GetNrOfStreams();
+  std::string GetFileName();
+  void GetStreamCodecName(int iStreamId, CStdString &strName);
+
+  /* where the reader is in the input, for the cache state. the input is
+     the reader's to seek while it runs, -1 without one */
+  int64_t GetInputPosition();
+
+protected:
+  virtual void Process();
+
+private:
+  struct Streams
+  {
+    std::vector<CDemuxStream*> streams;
+    std::vector<CStdString>    codecNames;
+  };
+
+  struct State
+  {
+    int chapter;
+    int chapterCount;
+    int streamLength;
+    std::string chapterName;
+
+    bool operator!=(const State& other) const;
+  };
+
+  struct Entry
+  {
+    DemuxPacket* packet;
+    bool changed;      // streams differ from the entry before
+    Streams streams;   // streams from this packet on, if changed
+    bool stateChanged; // state differs from the entry before
+    State state;       // state from this packet on, if changed
+  };
+
+  void Suspend();
+  void Resume(bool flush);
+  bool IsFull() const;
+  void ClearBuffer();
+  void GetStreams(Streams& streams);
+  void GetState(State& state);
+
+  CDVDDemux* m_demuxer;
+  CDVDInputStream* m_input;
+  CCriticalSection m_demuxSection;        // held around every call to the demuxer once the reader runs
+  CCriticalSection m_section;             // buffer and state below
+  XbmcThreads::ConditionVariable m_cond;  // buffer state changed
+
+  std::deque<Entry> m_buffer;
+  Streams m_streams;     // as of the packet last returned
+  Streams m_readStreams; // as of the packet last read, reader only
+  State   m_state;       // as of the packet last returned
+  State   m_readState;   // as of the packet last read, reader only
+  std::string m_fileName;
+  int64_t m_inputPos;
+
+  int    m_bytes;
+  int    m_maxBytes;
+  double m_maxTime;
+  double m_timeFront;
+  double m_timeBack;
+  int    m_suspended;
+  int    m_flushing;
+  bool   m_eof;
+  bool   m_aborted;
+};
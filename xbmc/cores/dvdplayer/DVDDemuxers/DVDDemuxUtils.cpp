@@ -24,15 +24,115 @@
 #include "DVDDemuxUtils.h"
 #include "DVDClock.h"
 #include "utils/log.h"
+#include "threads/Atomics.h"
 #include "DllAvCodec.h"
 
+/* payload size classes go from 2^POOL_MIN_SHIFT to 2^POOL_MAX_SHIFT bytes,
+ * bigger packets bypass the pool */
+#define POOL_MIN_SHIFT   8
+#define POOL_MAX_SHIFT   21
+#define POOL_CLASSES     (POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1)
+/* free packets a class may hold, bounded by bytes for the big classes */
+#define POOL_CLASS_BYTES (4 * 1024 * 1024)
+#define POOL_MAX_SLOTS   64
+#define POOL_MIN_SLOTS   4
+
+namespace
+{
+  /* what AllocateDemuxPacket really allocates, the packet comes first so
+   * the block is found from the pointer the callers hold */
+  struct PacketBlock
+  {
+    DemuxPacket packet;
+    uint8_t*    buffer;     // aligned payload, kept while the block is pooled
+    int         sizeClass;  // -1 if the block bypasses the pool
+  };
+
+  /* free blocks sit in fixed slots, a slot only ever changes between NULL
+   * and a block with a single compare-and-swap, so push and pop never lock
+   * and a block coming back in between does no harm */
+  struct PoolClass
+  {
+    void* volatile slots[POOL_MAX_SLOTS];
+    int            count;
+  };
+
+  PoolClass     g_classes[POOL_CLASSES];
+  volatile long g_classesReady = 0;
+  volatile long g_allocs       = 0;
+  volatile long g_hits         = 0;
+  volatile long g_inUse        = 0;
+  volatile long g_peakInUse    = 0;
+
+  void InitClasses()
+  {
+    for (int i = 0; i < POOL_CLASSES; i++)
+    {
+      int slots = POOL_CLASS_BYTES >> (i + POOL_MIN_SHIFT);
+      if (slots > POOL_MAX_SLOTS) slots = POOL_MAX_SLOTS;
+      if (slots < POOL_MIN_SLOTS) slots = POOL_MIN_SLOTS;
+      g_classes[i].count = slots;
+    }
+  }
+
+  int SizeClass(int iDataSize)
+  {
+    int sizeClass = 0;
+    while ((1 << (sizeClass + POOL_MIN_SHIFT)) < iDataSize)
+    {
+      if (++sizeClass == POOL_CLASSES)
+        return -1;
+    }
+    return sizeClass;
+  }
+
+  PacketBlock* PopBlock(int sizeClass)
+  {
+    PoolClass &c = g_classes[sizeClass];
+    for (int i = 0; i < c.count; i++)
+    {
+      void* block = c.slots[i];
+      if (block && casptr(&c.slots[i], block, NULL) == block)
+        return (PacketBlock*)block;
+    }
+    return NULL;
+  }
+
+  bool PushBlock(PacketBlock* block)
+  {
+    PoolClass &c = g_classes[block->sizeClass];
+    for (int i = 0; i < c.count; i++)
+    {
+      if (!c.slots[i] && casptr(&c.slots[i], NULL, block) == NULL)
+        return true;
+    }
+    return false;
+  }
+
+  void DeleteBlock(PacketBlock* block)
+  {
+    if (block->buffer) _aligned_free(block->buffer);
+    delete block;
+  }
+}
+
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      PacketBlock* block = (PacketBlock*)pPacket;
+      AtomicDecrement(&g_inUse);
+
+      // someone swapped the payload, it can't go back into its class
+      if (pPacket->pData && pPacket->pData != block->buffer)
+      {
+        _aligned_free(pPacket->pData);
+        block->sizeClass = -1;
+      }
+
+      if (block->sizeClass < 0 || !PushBlock(block))
+        DeleteBlock(block);
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -42,8 +142,35 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
-  if (!pPacket) return NULL;
+  if (!g_classesReady)
+  {
+    // racing threads compute the same sizes, no harm in doing it twice
+    InitClasses();
+    g_classesReady = 1;
+  }
+
+  int sizeClass = SizeClass(iDataSize);
+
+  PacketBlock* block = sizeClass >= 0 ? PopBlock(sizeClass) : NULL;
+  if (block)
+    AtomicIncrement(&g_hits);
+  else
+  {
+    block = new PacketBlock;
+    if (!block) return NULL;
+    block->buffer    = NULL;
+    block->sizeClass = sizeClass;
+  }
+
+  long inUse = AtomicIncrement(&g_inUse);
+  AtomicIncrement(&g_allocs);
+  for (long peak = g_peakInUse; inUse > peak; peak = g_peakInUse)
+  {
+    if (cas(&g_peakInUse, peak, inUse) == peak)
+      break;
+  }
+
+  DemuxPacket* pPacket = &block->packet;
 
   try
   {
@@ -51,21 +178,26 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 
     if (iDataSize > 0)
     {
-      // need to allocate a few bytes more.
-      // From avcodec.h (ffmpeg)
-      /**
-        * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
-        * this is mainly needed because some optimized bitstream readers read
-        * 32 or 64 bit at once and could read over the end<br>
-        * Note, if the first 23 bits of the additional bytes are not 0 then damaged
-        * MPEG bitstreams could cause overread and segfault
-        */
-      pPacket->pData =(uint8_t*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
-      if (!pPacket->pData)
+      if (!block->buffer)
       {
-        FreeDemuxPacket(pPacket);
-        return NULL;
+        // need to allocate a few bytes more.
+        // From avcodec.h (ffmpeg)
+        /**
+          * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
+          * this is mainly needed because some optimized bitstream readers read
+          * 32 or 64 bit at once and could read over the end<br>
+          * Note, if the first 23 bits of the additional bytes are not 0 then damaged
+          * MPEG bitstreams could cause overread and segfault
+          */
+        int capacity = sizeClass >= 0 ? 1 << (sizeClass + POOL_MIN_SHIFT) : iDataSize;
+        block->buffer = (uint8_t*)_aligned_malloc(capacity + FF_INPUT_BUFFER_PADDING_SIZE, 16);
+        if (!block->buffer)
+        {
+          FreeDemuxPacket(pPacket);
+          return NULL;
+        }
       }
+      pPacket->pData = block->buffer;
 
       // reset the last 8 bytes to 0;
       memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
@@ -84,3 +216,41 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
   }
   return pPacket;
 }
+
+void CDVDDemuxUtils::GetPoolStats(DemuxPacketPoolStats &stats)
+{
+  stats.allocs      = g_allocs;
+  stats.hits        = g_hits;
+  stats.inUse       = g_inUse;
+  stats.peakInUse   = g_peakInUse;
+  stats.pooled      = 0;
+  stats.pooledBytes = 0;
+
+  if (!g_classesReady)
+    return;
+
+  for (int i = 0; i < POOL_CLASSES; i++)
+  {
+    for (int j = 0; j < g_classes[i].count; j++)
+    {
+      if (g_classes[i].slots[j])
+      {
+        stats.pooled++;
+        stats.pooledBytes += 1 << (i + POOL_MIN_SHIFT);
+      }
+    }
+  }
+}
+
+void CDVDDemuxUtils::ReleasePool()
+{
+  if (!g_classesReady)
+    return;
+
+  for (int i = 0; i < POOL_CLASSES; i++)
+  {
+    PacketBlock* block;
+    while ((block = PopBlock(i)))
+      DeleteBlock(block);
+  }
+}
@@ -22,10 +22,25 @@
 
 #include "DVDDemuxPacket.h"
 
+struct DemuxPacketPoolStats
+{
+  long allocs;      // packets handed out
+  long hits;        // of those taken from the pool
+  long inUse;       // packets currently handed out
+  long peakInUse;   // highest inUse since start
+  long pooled;      // free packets held by the pool
+  long pooledBytes; // payload bytes held by the pool
+};
+
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+
+  /* packets are recycled in power of two size classes, these return
+   * the counters of the pool and give its free packets back to the heap */
+  static void GetPoolStats(DemuxPacketPoolStats &stats);
+  static void ReleasePool();
 };
 
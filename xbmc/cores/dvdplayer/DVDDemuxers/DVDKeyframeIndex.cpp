@@ -0,0 +1,181 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDKeyframeIndex.h"
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/Crc32.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+#define KEYFRAME_INDEX_MAGIC    0x4946484B  // "KHFI" on little endian, an index from another byte order is ignored
+#define KEYFRAME_INDEX_VERSION  1
+#define KEYFRAME_INDEX_MAX      (1 << 20)   // entries, 16MB on disk
+#define KEYFRAME_INDEX_FOLDER   "special://thumbnails/keyframes/"
+#define KEYFRAME_INDEX_CACHE    (64 << 20)  // bytes of all cached indexes, the oldest go first
+
+struct KeyframeIndexHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  int64_t  fileSize;
+  int32_t  codec;
+  int32_t  timeBaseNum;
+  int32_t  timeBaseDen;
+  uint32_t count;
+};
+
+CDVDKeyframeIndex::CDVDKeyframeIndex()
+{
+  Clear();
+}
+
+void CDVDKeyframeIndex::Clear()
+{
+  m_fileSize    = 0;
+  m_codec       = 0;
+  m_timeBaseNum = 0;
+  m_timeBaseDen = 0;
+  m_entries.clear();
+}
+
+bool CDVDKeyframeIndex::Load(const std::string &path)
+{
+  Clear();
+
+  XFILE::CFile file;
+  if (!file.Open(path))
+    return false;
+
+  KeyframeIndexHeader header;
+  if (file.Read(&header, sizeof(header)) != sizeof(header)
+  ||  header.magic   != KEYFRAME_INDEX_MAGIC
+  ||  header.version != KEYFRAME_INDEX_VERSION
+  ||  header.count   >  KEYFRAME_INDEX_MAX
+  ||  file.GetLength() != (int64_t)(sizeof(header) + header.count * sizeof(Entry)))
+  {
+    CLog::Log(LOGWARNING, "CDVDKeyframeIndex::Load - ignoring damaged index %s", path.c_str());
+    return false;
+  }
+
+  m_entries.resize(header.count);
+  if (header.count && file.Read(&m_entries[0], header.count * sizeof(Entry)) != header.count * sizeof(Entry))
+  {
+    m_entries.clear();
+    return false;
+  }
+
+  m_fileSize    = header.fileSize;
+  m_codec       = header.codec;
+  m_timeBaseNum = header.timeBaseNum;
+  m_timeBaseDen = header.timeBaseDen;
+  return true;
+}
+
+bool CDVDKeyframeIndex::Save(const std::string &path) const
+{
+  KeyframeIndexHeader header;
+  header.magic       = KEYFRAME_INDEX_MAGIC;
+  header.version     = KEYFRAME_INDEX_VERSION;
+  header.fileSize    = m_fileSize;
+  header.codec       = m_codec;
+  header.timeBaseNum = m_timeBaseNum;
+  header.timeBaseDen = m_timeBaseDen;
+  header.count       = std::min(m_entries.size(), (size_t)KEYFRAME_INDEX_MAX);
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true))
+  {
+    CLog::Log(LOGERROR, "CDVDKeyframeIndex::Save - unable to write %s", path.c_str());
+    return false;
+  }
+
+  int size = header.count * sizeof(Entry);
+  bool ret = file.Write(&header, sizeof(header)) == sizeof(header)
+          && (!size || file.Write(&m_entries[0], size) == size);
+  file.Close();
+
+  if (!ret)
+    XFILE::CFile::Delete(path);
+  return ret;
+}
+
+bool CDVDKeyframeIndex::Matches(int64_t fileSize, int codec, int timeBaseNum, int timeBaseDen) const
+{
+  return m_fileSize    == fileSize
+      && m_codec       == codec
+      && m_timeBaseNum == timeBaseNum
+      && m_timeBaseDen == timeBaseDen;
+}
+
+bool CDVDKeyframeIndex::SaveToCache(const std::string &file) const
+{
+  if (!XFILE::CDirectory::Exists(KEYFRAME_INDEX_FOLDER))
+    XFILE::CDirectory::Create(KEYFRAME_INDEX_FOLDER);
+
+  if (!Save(GetCachePath(file)))
+    return false;
+
+  Prune(KEYFRAME_INDEX_FOLDER, KEYFRAME_INDEX_CACHE);
+  return true;
+}
+
+std::string CDVDKeyframeIndex::GetCachePath(const std::string &file)
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(file);
+  return URIUtils::AddFileToFolder(KEYFRAME_INDEX_FOLDER, StringUtils::Format("%08x.kfi", (unsigned int)crc));
+}
+
+static bool OlderFirst(const CFileItemPtr &a, const CFileItemPtr &b)
+{
+  return a->m_dateTime < b->m_dateTime;
+}
+
+void CDVDKeyframeIndex::Prune(const std::string &folder, int64_t maxSize)
+{
+  CFileItemList items;
+  if (!XFILE::CDirectory::GetDirectory(folder, items, ".kfi", XFILE::DIR_FLAG_NO_FILE_DIRS))
+    return;
+
+  std::vector<CFileItemPtr> files;
+  int64_t size = 0;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    if (items[i]->m_bIsFolder)
+      continue;
+    files.push_back(items[i]);
+    size += items[i]->m_dwSize;
+  }
+  if (size <= maxSize)
+    return;
+
+  std::sort(files.begin(), files.end(), OlderFirst);
+  for (unsigned int i = 0; i < files.size() && size > maxSize; i++)
+  {
+    if (XFILE::CFile::Delete(files[i]->GetPath()))
+      size -= files[i]->m_dwSize;
+  }
+  CLog::Log(LOGDEBUG, "CDVDKeyframeIndex::Prune - %s holds %"PRId64" bytes of indexes", folder.c_str(), size);
+}
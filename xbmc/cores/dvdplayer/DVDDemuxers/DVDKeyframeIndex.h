@@ -0,0 +1,67 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Keyframe positions of one stream of a media file, as the demuxer found
+ * them while playing or extracting thumbnails. They are kept in a small
+ * file next to the texture cache, so the next playback of a file without
+ * an index of its own can seek straight to a known keyframe. The oldest
+ * files are deleted once all of them take more than 64MB.
+ */
+class CDVDKeyframeIndex
+{
+public:
+  struct Entry
+  {
+    int64_t pos;        // byte offset in the file
+    int64_t timestamp;  // in the time base of the stream
+  };
+
+  CDVDKeyframeIndex();
+  void Clear();
+
+  /* false if there is no index at path or it is damaged */
+  bool Load(const std::string &path);
+  bool Save(const std::string &path) const;
+
+  /* true if the index was made for this file and stream */
+  bool Matches(int64_t fileSize, int codec, int timeBaseNum, int timeBaseDen) const;
+
+  /* saves the index of a media file to the cache and prunes it */
+  bool SaveToCache(const std::string &file) const;
+
+  /* the cache file of the index of a media file */
+  static std::string GetCachePath(const std::string &file);
+
+  /* deletes the oldest indexes in folder until they take at most maxSize bytes */
+  static void Prune(const std::string &folder, int64_t maxSize);
+
+  int64_t m_fileSize;
+  int     m_codec;
+  int     m_timeBaseNum;
+  int     m_timeBaseDen;
+  std::vector<Entry> m_entries;
+};
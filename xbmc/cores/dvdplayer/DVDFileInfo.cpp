@@ -47,7 +47,8 @@
 #include "DVDDemuxers/DVDDemuxVobsub.h"
 
 #include "DllAvCodec.h"
-#include "DllSwScale.h"
+#include "cores/VideoRenderers/RenderFlags.h"
+#include "cores/VideoRenderers/VideoScaler.h"
 #include "filesystem/File.h"
 #include "TextureCache.h"
 #include "Util.h"
@@ -92,8 +93,59 @@ int DegreeToOrientation(int degrees)
   }
 }
 
-bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails)
+CDVDThumbContext::CDVDThumbContext()
 {
+  m_hint   = NULL;
+  m_codec  = NULL;
+  m_scaler = new CVideoScaler();
+  m_reused = false;
+}
+
+CDVDThumbContext::~CDVDThumbContext()
+{
+  Close();
+  delete m_scaler;
+}
+
+void CDVDThumbContext::Close()
+{
+  delete m_codec;
+  m_codec = NULL;
+  delete m_hint;
+  m_hint = NULL;
+}
+
+CDVDVideoCodec* CDVDThumbContext::GetCodec(CDVDStreamInfo &hint)
+{
+  m_reused = m_codec && m_hint->Equal(hint, true);
+  if (m_reused)
+  {
+    m_codec->Reset();
+    return m_codec;
+  }
+
+  Close();
+  if (hint.codec == AV_CODEC_ID_MPEG2VIDEO || hint.codec == AV_CODEC_ID_MPEG1VIDEO)
+  {
+    // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
+    CDVDCodecOptions dvdOptions;
+    m_codec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
+  }
+  else
+  {
+    m_codec = CDVDFactoryCodec::CreateVideoCodec( hint );
+  }
+
+  if (m_codec)
+    m_hint = new CDVDStreamInfo(hint, true);
+  return m_codec;
+}
+
+bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails, CDVDThumbContext *pContext, bool *pStreamDetailsFilled)
+{
+  if (pStreamDetailsFilled)
+    *pStreamDetailsFilled = false;
+
   std::string redactPath = CURL::GetRedacted(strPath);
   unsigned int nTime = XbmcThreads::SystemClockMillis();
   CDVDInputStream *pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, strPath, "");
@@ -141,7 +193,9 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
 
   if (pStreamDetails)
   {
-    DemuxerToStreamDetails(pInputStream, pDemuxer, *pStreamDetails, strPath);
+    bool filled = DemuxerToStreamDetails(pInputStream, pDemuxer, *pStreamDetails, strPath);
+    if (pStreamDetailsFilled)
+      *pStreamDetailsFilled = filled;
 
     //extern subtitles
     std::vector<CStdString> filenames;
@@ -188,24 +242,16 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
   bool bOk = false;
   int packetsTried = 0;
 
+  CDVDThumbContext localContext;
+  CDVDThumbContext &context = pContext ? *pContext : localContext;
+  context.m_reused = false;
+
   if (nVideoStream != -1)
   {
-    CDVDVideoCodec *pVideoCodec;
-
     CDVDStreamInfo hint(*pDemuxer->GetStream(nVideoStream), true);
     hint.software = true;
 
-    if (hint.codec == AV_CODEC_ID_MPEG2VIDEO || hint.codec == AV_CODEC_ID_MPEG1VIDEO)
-    {
-      // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
-      CDVDCodecOptions dvdOptions;
-      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
-    }
-    else
-    {
-      pVideoCodec = CDVDFactoryCodec::CreateVideoCodec( hint );
-    }
-
+    CDVDVideoCodec *pVideoCodec = context.GetCodec(hint);
     if (pVideoCodec)
     {
       int nTotalLen = pDemuxer->GetStreamLength();
@@ -221,8 +267,16 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
 
         // num streams * 80 frames, should get a valid frame, if not abort.
         int abort_index = pDemuxer->GetNrOfStreams() * 80;
+
+        // the seek lands on a keyframe, the frames after it don't need decoding.
+        // streams without intra frames get the second half decoded in full
+        int keyframe_index = abort_index / 2;
+        pVideoCodec->SetKeyframesOnly(true);
         do
         {
+          if (abort_index == keyframe_index)
+            pVideoCodec->SetKeyframesOnly(false);
+
           DemuxPacket* pPacket = pDemuxer->Read();
           packetsTried++;
 
@@ -262,39 +316,38 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
               aspect = hint.aspect;
             unsigned int nHeight = (unsigned int)((double)g_advancedSettings.GetThumbSize() / aspect);
 
-            DllSwScale dllSwScale;
-            dllSwScale.Load();
-
-            uint8_t *pOutBuf = new uint8_t[nWidth * nHeight * 4];
-            struct SwsContext *context = dllSwScale.sws_getContext(picture.iWidth, picture.iHeight,
-                  PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_BGRA, SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+            // the filters are widened to the step, the thumb doesn't alias
+            ERenderFormat format = CVideoScaler::Supports(picture.format) ? picture.format : RENDER_FMT_YUV420P;
+            unsigned int  flags  = RenderManager::GetFlagsColorMatrix(picture.color_matrix, picture.iWidth, picture.iHeight)
+                                 | RenderManager::GetFlagsChromaPosition(picture.chroma_position);
+            if (picture.color_range == 1)
+              flags |= CONF_FLAGS_YUV_FULLRANGE;
 
-            if (context)
+            context.m_picture.resize(nWidth * nHeight * 4);
+            uint8_t *pOutBuf = &context.m_picture[0];
+            if (context.m_scaler->Configure(format, picture.iWidth, picture.iHeight, nWidth, nHeight, VS_SCALINGMETHOD_LINEAR, flags))
             {
-              uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2], 0 };
-              int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2], 0 };
-              uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
-              int     dstStride[] = { (int)nWidth*4, 0, 0, 0 };
+              uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2] };
+              int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2] };
               int orientation = DegreeToOrientation(hint.orientation);
-              dllSwScale.sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
-              dllSwScale.sws_freeContext(context);
+              context.m_scaler->Convert(src, srcStride, pOutBuf, nWidth * 4);
 
               details.width = nWidth;
               details.height = nHeight;
               CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, orientation, nWidth, nHeight, CTextureCache::GetCachedPath(details.file));
               bOk = true;
             }
-
-            dllSwScale.Unload();
-            delete [] pOutBuf;
           }
         }
         else
         {
           CLog::Log(LOGDEBUG,"%s - decode failed in %s after %d packets.", __FUNCTION__, redactPath.c_str(), packetsTried);
         }
+
+        // a decoder that failed isn't trusted with the next file
+        if (iDecoderState & VC_ERROR)
+          context.Close();
       }
-      delete pVideoCodec;
     }
   }
 
@@ -311,7 +364,8 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
   }
 
   unsigned int nTotalTime = XbmcThreads::SystemClockMillis() - nTime;
-  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s> in %d packets. ", __FUNCTION__, nTotalTime, redactPath.c_str(), packetsTried);
+  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s> in %d packets%s. ", __FUNCTION__, nTotalTime, redactPath.c_str(), packetsTried,
+            context.IsReused() ? ", decoder reused" : "");
   return bOk;
 }
 
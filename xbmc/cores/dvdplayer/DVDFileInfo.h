@@ -22,18 +22,55 @@
 
 #include "utils/StdString.h"
 
+#include <stdint.h>
+#include <vector>
+
 class CFileItem;
 class CDVDDemux;
 class CStreamDetails;
 class CStreamDetailSubtitle;
 class CDVDInputStream;
+class CDVDStreamInfo;
+class CDVDVideoCodec;
 class CTextureDetails;
+class CVideoScaler;
+
+/**
+ * What ExtractThumb keeps open from one file to the next: the video decoder,
+ * the scaler and the picture buffer. A file with the same codec parameters
+ * as the one before only flushes the decoder instead of opening a new one.
+ * A context is used by one thread at a time, batches keep one per worker.
+ */
+class CDVDThumbContext
+{
+public:
+  CDVDThumbContext();
+  ~CDVDThumbContext();
+
+  /* closes the decoder, the next file opens a new one */
+  void Close();
+
+  /* whether the last file was decoded by the decoder of the one before */
+  bool IsReused() const { return m_reused; }
+
+private:
+  friend class CDVDFileInfo;
+  friend class TestDVDThumbContext;
+  CDVDVideoCodec* GetCodec(CDVDStreamInfo &hint);
+
+  CDVDStreamInfo *m_hint;
+  CDVDVideoCodec *m_codec;
+  CVideoScaler   *m_scaler;
+  std::vector<uint8_t> m_picture;
+  bool            m_reused;
+};
 
 class CDVDFileInfo
 {
 public:
   // Extract a thumbnail immage from the media at strPath, optionally populating a streamdetails class with the data
-  static bool ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails);
+  // pStreamDetailsFilled is set when the stream details were read, which may happen without a thumb
+  static bool ExtractThumb(const CStdString &strPath, CTextureDetails &details, CStreamDetails *pStreamDetails, CDVDThumbContext *pContext = NULL, bool *pStreamDetailsFilled = NULL);
 
   // Probe the files streams and store the info in the VideoInfoTag
   static bool GetFileStreamDetails(CFileItem *pItem);
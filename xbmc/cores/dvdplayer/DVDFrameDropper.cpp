@@ -0,0 +1,147 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDFrameDropper.h"
+#include "DVDClock.h"
+#include "utils/StringUtils.h"
+
+#define LATE_PREDICTIONS 3 //late predictions in a row before frames are dropped
+
+//upper ends of the lateness buckets in milliseconds, the last one takes the rest
+static const double LatenessBuckets[FRAMEDROP_LATENESS - 1] = { 0.0, 10.0, 20.0, 40.0, 80.0, 160.0, 320.0 };
+
+static const char* DropReasonNames[FRAMEDROP_REASONS] = { "predicted", "player", "decoder", "renderer" };
+
+void CFrameTimeHistory::Add(double time)
+{
+  if (m_count == FRAMEDROP_HISTORY)
+    m_sum -= m_times[m_pos];
+  else
+    m_count++;
+
+  m_times[m_pos] = time;
+  m_sum += time;
+  m_pos = (m_pos + 1) % FRAMEDROP_HISTORY;
+}
+
+void CFrameTimeHistory::Flush()
+{
+  m_sum   = 0.0;
+  m_pos   = 0;
+  m_count = 0;
+}
+
+CDVDFrameDropper::CDVDFrameDropper()
+{
+  Flush();
+  ResetStats();
+}
+
+void CDVDFrameDropper::Flush()
+{
+  m_sleep    = DVD_NOPTS_VALUE;
+  m_time     = 0.0;
+  m_duration = 0.0;
+  m_late     = 0;
+}
+
+void CDVDFrameDropper::ResetStats()
+{
+  for (int i = 0; i < FRAMEDROP_REASONS; i++)
+    m_drops[i] = 0;
+  for (int i = 0; i < FRAMEDROP_LATENESS; i++)
+    m_lateness[i] = 0;
+
+  //costs belong to the stream, they start over with it
+  m_decode.Flush();
+  m_output.Flush();
+}
+
+void CDVDFrameDropper::AddDecodeTime(double time)
+{
+  m_decode.Add(time);
+}
+
+void CDVDFrameDropper::AddOutputTime(double time)
+{
+  m_output.Add(time);
+}
+
+void CDVDFrameDropper::AddPicture(double sleep, double now, double duration)
+{
+  m_sleep    = sleep;
+  m_time     = now;
+  m_duration = duration;
+
+  m_lateness[GetLatenessBucket(-sleep)]++;
+}
+
+void CDVDFrameDropper::AddSkipped(double duration)
+{
+  //the picture after it gets the time of the skipped one to spare
+  if (m_sleep != DVD_NOPTS_VALUE)
+    m_sleep += duration;
+}
+
+bool CDVDFrameDropper::ShouldDrop(double now)
+{
+  if (m_sleep == DVD_NOPTS_VALUE)
+    return false;
+
+  double sleep = m_sleep + m_duration - (now - m_time) - m_decode.GetAverage() - m_output.GetAverage();
+  if (sleep < 0.0)
+    m_late++;
+  else
+    m_late = 0;
+
+  return m_late >= LATE_PREDICTIONS;
+}
+
+int CDVDFrameDropper::GetLatenessBucket(double late)
+{
+  double ms = late * 1000.0 / DVD_TIME_BASE;
+  for (int i = 0; i < FRAMEDROP_LATENESS - 1; i++)
+  {
+    if (ms <= LatenessBuckets[i])
+      return i;
+  }
+  return FRAMEDROP_LATENESS - 1;
+}
+
+std::string CDVDFrameDropper::GetStats() const
+{
+  std::string stats = "late(ms)";
+  for (int i = 0; i < FRAMEDROP_LATENESS; i++)
+  {
+    if (i < FRAMEDROP_LATENESS - 1)
+      stats += StringUtils::Format(" <=%d:%u", (int)LatenessBuckets[i], m_lateness[i]);
+    else
+      stats += StringUtils::Format(" >%d:%u", (int)LatenessBuckets[i - 1], m_lateness[i]);
+  }
+
+  stats += ", drops";
+  for (int i = 0; i < FRAMEDROP_REASONS; i++)
+    stats += StringUtils::Format(" %s:%u", DropReasonNames[i], m_drops[i]);
+
+  stats += StringUtils::Format(", decode:%.1fms, output:%.1fms"
+                              , m_decode.GetAverage() / DVD_TIME_BASE * 1000.0
+                              , m_output.GetAverage() / DVD_TIME_BASE * 1000.0);
+  return stats;
+}
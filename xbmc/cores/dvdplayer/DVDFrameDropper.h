@@ -0,0 +1,104 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#define FRAMEDROP_HISTORY   32 // decode and output times the cost is averaged over
+#define FRAMEDROP_LATENESS   8 // lateness histogram buckets
+
+enum EFrameDropReason
+{
+  FRAMEDROP_PREDICTED = 0, // skipped by the decoder, the picture was predicted to be late
+  FRAMEDROP_PLAYER,        // the player dropped the packet, like after a seek
+  FRAMEDROP_DECODER,       // the decoder gave a picture it marked as dropped
+  FRAMEDROP_RENDERER,      // the renderer had no buffer for the picture in time
+  FRAMEDROP_REASONS
+};
+
+/* average of the last FRAMEDROP_HISTORY samples */
+class CFrameTimeHistory
+{
+  public:
+    CFrameTimeHistory()       { Flush(); }
+    void   Add(double time);
+    void   Flush();
+    double GetAverage() const { return m_count ? m_sum / m_count : 0.0; }
+
+  private:
+    double m_times[FRAMEDROP_HISTORY];
+    double m_sum;
+    int    m_pos;
+    int    m_count;
+};
+
+/*
+ * Decides whether the decoder should skip the non reference frames of the next
+ * packet. The picture of the next packet is predicted to be late when the time
+ * the last picture had to spare, plus a frame duration, doesn't cover the time
+ * passed since and what decoding and outputting a picture recently cost. Drops
+ * start after a few of those predictions in a row, so a single slow frame
+ * doesn't cause one.
+ *
+ * All times are absolute clock times in DVD_TIME_BASE units, scaled by the
+ * playback speed where they relate to the stream.
+ */
+class CDVDFrameDropper
+{
+  public:
+    CDVDFrameDropper();
+
+    void Flush();      //forget the timing, after a seek or speed change
+    void ResetStats(); //clear the histograms, for a new session
+
+    void AddDecodeTime(double time); //time the decoder took for a packet it didn't skip frames of
+    void AddOutputTime(double time); //time handing a picture to the renderer took
+
+    //a picture reached the output, sleep is the time it has to wait to be shown, negative if late
+    void AddPicture(double sleep, double now, double duration);
+    //the next picture in line won't reach the output
+    void AddSkipped(double duration);
+
+    //true if the decoder should skip non reference frames of the next packet
+    bool ShouldDrop(double now);
+
+    void AddDrop(EFrameDropReason reason)           { m_drops[reason]++; }
+    unsigned int GetDrops(EFrameDropReason reason) const { return m_drops[reason]; }
+    unsigned int GetLateness(int bucket) const      { return m_lateness[bucket]; }
+    static int   GetLatenessBucket(double late);
+
+    double GetDecodeCost() const                    { return m_decode.GetAverage(); }
+    double GetOutputCost() const                    { return m_output.GetAverage(); }
+
+    std::string GetStats() const; //histograms for the log
+
+  private:
+    CFrameTimeHistory m_decode;
+    CFrameTimeHistory m_output;
+
+    double m_sleep;     //time the last picture had to spare, DVD_NOPTS_VALUE if unknown
+    double m_time;      //absolute clock when it reached the output
+    double m_duration;  //its duration
+    int    m_late;      //late predictions in a row
+
+    unsigned int m_drops[FRAMEDROP_REASONS];
+    unsigned int m_lateness[FRAMEDROP_LATENESS];
+};
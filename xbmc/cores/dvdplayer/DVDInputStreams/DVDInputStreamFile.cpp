@@ -25,12 +25,18 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 
+#include <algorithm>
+#include <string.h>
+
 using namespace XFILE;
 
 CDVDInputStreamFile::CDVDInputStreamFile() : CDVDInputStream(DVDSTREAM_TYPE_FILE)
 {
   m_pFile = NULL;
   m_eof = true;
+  m_view.data = NULL;
+  m_view.size = 0;
+  m_viewPos = 0;
 }
 
 CDVDInputStreamFile::~CDVDInputStreamFile()
@@ -107,12 +113,49 @@ void CDVDInputStreamFile::Close()
   CDVDInputStream::Close();
   m_pFile = NULL;
   m_eof = true;
+  // the view went with the file
+  m_view.data = NULL;
+  m_view.size = 0;
+  m_viewPos = 0;
+}
+
+bool CDVDInputStreamFile::MapFile()
+{
+  if (!m_pFile)
+    return false;
+  if (m_view.data)
+    return true;
+
+  // only local files without the file cache hand out a view
+  SMappedView view;
+  if (m_pFile->IoControl(IOCTRL_MMAP, &view) < 0)
+    return false;
+
+  m_view = view;
+  m_viewPos = m_pFile->GetPosition();
+  return true;
 }
 
 int CDVDInputStreamFile::Read(uint8_t* buf, int buf_size)
 {
   if(!m_pFile) return -1;
 
+  if (m_view.data)
+  {
+    if (m_viewPos < m_view.size)
+    {
+      int size = (int)std::min<int64_t>(buf_size, m_view.size - m_viewPos);
+      memcpy(buf, m_view.data + m_viewPos, size);
+      m_viewPos += size;
+      return size;
+    }
+
+    // past the view, go on reading the file itself
+    if (m_pFile->Seek(m_viewPos, SEEK_SET) != m_viewPos)
+      return -1;
+    m_view.data = NULL;
+  }
+
   unsigned int ret = m_pFile->Read(buf, buf_size);
 
   /* we currently don't support non completing reads */
@@ -128,6 +171,26 @@ int64_t CDVDInputStreamFile::Seek(int64_t offset, int whence)
   if(whence == SEEK_POSSIBLE)
     return m_pFile->IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
 
+  if (m_view.data)
+  {
+    int64_t pos;
+    if (whence == SEEK_SET)
+      pos = offset;
+    else if (whence == SEEK_CUR)
+      pos = m_viewPos + offset;
+    else if (whence == SEEK_END)
+      pos = m_pFile->GetLength() + offset;
+    else
+      return -1;
+
+    if (pos < 0)
+      return -1;
+
+    m_viewPos = pos;
+    m_eof = false;
+    return pos;
+  }
+
   int64_t ret = m_pFile->Seek(offset, whence);
 
   /* if we succeed, we are not eof anymore */
@@ -39,7 +39,16 @@ public:
   virtual void SetReadRate(unsigned rate);
   virtual bool GetCacheStatus(XFILE::SCacheStatus *status);
 
+  /*! \brief Read from a mapped view of the file rather than through Read()
+   Only for local files that are not written to while they are read. Reads
+   past the end of the view, e.g. after the file grew, go through Read() again.
+   \return true if the file is read from the view
+   */
+  bool MapFile();
+
 protected:
   XFILE::CFile* m_pFile;
   bool m_eof;
+  XFILE::SMappedView m_view;
+  int64_t m_viewPos;
 };
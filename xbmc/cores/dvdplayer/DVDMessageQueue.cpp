@@ -27,7 +27,74 @@
 
 using namespace std;
 
-CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owner(owner)
+/* queued packets looked at after a Get for the time of the oldest one */
+#define MSGQ_TIMEBACK_LOOKAHEAD 8
+
+static bool GetPacketTime(CDVDMsg* msg, double &time)
+{
+  if (!msg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return false;
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)msg)->GetPacket();
+  if (!packet)
+    return false;
+  if (packet->dts != DVD_NOPTS_VALUE)
+    time = packet->dts;
+  else if (packet->pts != DVD_NOPTS_VALUE)
+    time = packet->pts;
+  else
+    return false;
+  return true;
+}
+
+CDVDMessageRing::CDVDMessageRing(int priority, unsigned int slots)
+  : m_priority(priority)
+  , m_head(0)
+  , m_count(0)
+  , m_slots(max(slots, 1U), (CDVDMsg*)NULL)
+{
+}
+
+void CDVDMessageRing::Push(CDVDMsg* msg)
+{
+  if (m_count == m_slots.size())
+  {
+    // unroll into a twice as large ring, the oldest message goes first
+    std::vector<CDVDMsg*> slots(m_slots.size() * 2, (CDVDMsg*)NULL);
+    for (unsigned int i = 0; i < m_count; i++)
+      slots[i] = At(i);
+    m_slots.swap(slots);
+    m_head = 0;
+  }
+  m_slots[(m_head + m_count) % m_slots.size()] = msg;
+  m_count++;
+}
+
+CDVDMsg* CDVDMessageRing::Pop()
+{
+  CDVDMsg* msg = m_slots[m_head];
+  m_slots[m_head] = NULL;
+  m_head = (m_head + 1) % m_slots.size();
+  m_count--;
+  return msg;
+}
+
+void CDVDMessageRing::Flush(CDVDMsg::Message type)
+{
+  unsigned int kept = 0;
+  for (unsigned int i = 0; i < m_count; i++)
+  {
+    unsigned int slot = (m_head + i) % m_slots.size();
+    CDVDMsg* msg = m_slots[slot];
+    m_slots[slot] = NULL;
+    if (type == CDVDMsg::NONE || msg->IsType(type))
+      msg->Release();
+    else
+      m_slots[(m_head + kept++) % m_slots.size()] = msg;
+  }
+  m_count = kept;
+}
+
+CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_owner(owner)
 {
   m_iDataSize     = 0;
   m_bAbortRequest = false;
@@ -39,12 +106,49 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owne
   m_TimeFront     = DVD_NOPTS_VALUE;
   m_TimeSize      = 1.0 / 4.0; /* 4 seconds */
   m_iMaxDataSize  = 0;
+
+  m_rings.reserve(4);
+  m_rings.push_back(CDVDMessageRing(1, MSGQ_CONTROL_SLOTS));
+  m_rings.push_back(CDVDMessageRing(0, MSGQ_PACKET_SLOTS));
 }
 
 CDVDMessageQueue::~CDVDMessageQueue()
 {
   // remove all remaining messages
-  Flush();
+  Flush(CDVDMsg::NONE);
+}
+
+CDVDMessageRing& CDVDMessageQueue::GetRing(int priority)
+{
+  vector<CDVDMessageRing>::iterator it = m_rings.begin();
+  while (it != m_rings.end() && it->GetPriority() > priority)
+    ++it;
+  if (it != m_rings.end() && it->GetPriority() == priority)
+    return *it;
+  return *m_rings.insert(it, CDVDMessageRing(priority, MSGQ_CONTROL_SLOTS));
+}
+
+bool CDVDMessageQueue::IsEmpty() const
+{
+  for (vector<CDVDMessageRing>::const_iterator it = m_rings.begin(); it != m_rings.end(); ++it)
+  {
+    if (it->GetCount())
+      return false;
+  }
+  return true;
+}
+
+void CDVDMessageQueue::UpdateTimeBack(CDVDMsg* msg)
+{
+  // the oldest packet still queued, or the one just taken when none is left
+  CDVDMessageRing& ring = GetRing(0);
+  unsigned int count = min(ring.GetCount(), (unsigned int)MSGQ_TIMEBACK_LOOKAHEAD);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    if (GetPacketTime(ring.At(i), m_TimeBack))
+      return;
+  }
+  GetPacketTime(msg, m_TimeBack);
 }
 
 void CDVDMessageQueue::Init()
@@ -61,13 +165,8 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
   CSingleLock lock(m_section);
 
-  for(SList::iterator it = m_list.begin(); it != m_list.end();)
-  {
-    if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
-      it = m_list.erase(it);
-    else
-      ++it;
-  }
+  for (vector<CDVDMessageRing>::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
+    it->Flush(type);
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
@@ -84,7 +183,7 @@ void CDVDMessageQueue::Abort()
 
   m_bAbortRequest = true;
 
-  m_hEvent.Set(); // inform waiter for abort action
+  m_cond.notifyAll(); // inform waiter for abort action
 }
 
 void CDVDMessageQueue::End()
@@ -115,33 +214,23 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     return MSGQ_INVALID_MSG;
   }
 
-  SList::iterator it = m_list.begin();
-  while(it != m_list.end())
-  {
-    if(priority <= it->priority)
-      break;
-    ++it;
-  }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  // the queue keeps the reference of the caller
+  GetRing(priority).Push(pMsg);
 
   if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
   {
     DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
     if(packet)
     {
+      // with no data queued the new packet is also the oldest one
+      bool drained = m_iDataSize == 0;
       m_iDataSize += packet->iSize;
-      if     (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if(packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-      if(m_TimeBack == DVD_NOPTS_VALUE)
+      if (GetPacketTime(pMsg, m_TimeFront) && (drained || m_TimeBack == DVD_NOPTS_VALUE))
         m_TimeBack = m_TimeFront;
     }
   }
 
-  pMsg->Release();
-
-  m_hEvent.Set(); // inform waiter for new packet
+  m_cond.notifyAll(); // inform waiter for new packet
 
   return MSGQ_OK;
 }
@@ -160,7 +249,7 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(IsEmpty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
 #if !defined(TARGET_RASPBERRY_PI)
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
@@ -168,31 +257,36 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     m_bEmptied = true;
   }
 
+  XbmcThreads::EndTime timeout(iTimeoutInMilliSeconds);
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    CDVDMessageRing* ring = NULL;
+    for (vector<CDVDMessageRing>::iterator it = m_rings.begin(); it != m_rings.end() && !ring; ++it)
     {
-      DVDMessageListItem& item(m_list.back());
-      priority = item.priority;
+      if (it->GetCount())
+        ring = &*it;
+    }
 
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
+    if(ring && ring->GetPriority() >= priority && !m_bCaching)
+    {
+      CDVDMsg* msg = ring->Pop();
+      priority = ring->GetPriority();
+
+      if (msg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
       {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
+        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)msg)->GetPacket();
         if(packet)
         {
           m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
+          UpdateTimeBack(msg);
         }
 
         if(m_bEmptied && m_iDataSize > 0)
           m_bEmptied = false;
       }
 
-      *pMsg = item.message->Acquire();
-      m_list.pop_back();
+      // the reference the queue held goes to the caller
+      *pMsg = msg;
 
       ret = MSGQ_OK;
       break;
@@ -204,14 +298,11 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     }
     else
     {
-      m_hEvent.Reset();
-      lock.Leave();
-
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
+      unsigned int left = timeout.MillisLeft();
+      if (!left)
         return MSGQ_TIMEOUT;
-
-      lock.Enter();
+      m_cond.wait(lock, left);
     }
   }
 
@@ -229,10 +320,13 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
     return 0;
 
   unsigned count = 0;
-  for(SList::iterator it = m_list.begin(); it != m_list.end();++it)
+  for (vector<CDVDMessageRing>::iterator it = m_rings.begin(); it != m_rings.end(); ++it)
   {
-    if(it->message->IsType(type))
-      count++;
+    for (unsigned int i = 0; i < it->GetCount(); i++)
+    {
+      if(it->At(i)->IsType(type))
+        count++;
+    }
   }
 
   return count;
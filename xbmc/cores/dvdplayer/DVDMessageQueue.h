@@ -23,8 +23,9 @@
 #include "DVDMessage.h"
 #include <string>
 #include <list>
+#include <vector>
 #include "threads/CriticalSection.h"
-#include "threads/Event.h"
+#include "threads/Condition.h"
 
 struct DVDMessageListItem
 {
@@ -80,6 +81,41 @@ enum MsgQueueReturnCode
 
 #define MSGQ_IS_ERROR(c)    (c < 0)
 
+/* slots reserved up front for the demux packets and for every other priority */
+#define MSGQ_PACKET_SLOTS   256
+#define MSGQ_CONTROL_SLOTS  16
+
+/**
+ * Messages of one priority in arrival order. The ring holds the reference
+ * the producer handed to Put until Get passes it on to the consumer, so no
+ * message is acquired or released while it is queued. A full ring doubles
+ * its slots instead of refusing the message, the queue is bounded by the
+ * level checks of the producer.
+ */
+class CDVDMessageRing
+{
+public:
+  CDVDMessageRing(int priority, unsigned int slots);
+
+  void         Push(CDVDMsg* msg);
+  CDVDMsg*     Pop();
+  CDVDMsg*     Front() const            { return m_slots[m_head]; }
+  CDVDMsg*     At(unsigned int i) const { return m_slots[(m_head + i) % m_slots.size()]; }
+  /* releases all messages of type, or all for CDVDMsg::NONE, keeping the order of the rest */
+  void         Flush(CDVDMsg::Message type);
+  void         Clear()                  { Flush(CDVDMsg::NONE); }
+
+  int          GetPriority() const      { return m_priority; }
+  unsigned int GetCount() const         { return m_count; }
+  unsigned int GetCapacity() const      { return m_slots.size(); }
+
+private:
+  int                   m_priority;
+  unsigned int          m_head;
+  unsigned int          m_count;
+  std::vector<CDVDMsg*> m_slots;
+};
+
 class CDVDMessageQueue
 {
 public:
@@ -123,8 +159,11 @@ public:
   bool IsDataBased() const;
 
 private:
+  CDVDMessageRing& GetRing(int priority);
+  bool IsEmpty() const;
+  void UpdateTimeBack(CDVDMsg* msg);
 
-  CEvent m_hEvent;
+  XbmcThreads::ConditionVariable m_cond;
   mutable CCriticalSection m_section;
 
   bool m_bAbortRequest;
@@ -140,7 +179,7 @@ private:
   bool m_bEmptied;
   std::string m_owner;
 
-  typedef std::list<DVDMessageListItem> SList;
-  SList m_list;
+  /* highest priority first, the packet and general message rings always exist */
+  std::vector<CDVDMessageRing> m_rings;
 };
 
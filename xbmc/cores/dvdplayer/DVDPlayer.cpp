@@ -33,6 +33,7 @@
 #include "DVDDemuxers/DVDDemuxVobsub.h"
 #include "DVDDemuxers/DVDFactoryDemuxer.h"
 #include "DVDDemuxers/DVDDemuxFFmpeg.h"
+#include "DVDDemuxers/DVDDemuxReadAhead.h"
 
 #include "DVDCodecs/DVDCodecs.h"
 #include "DVDCodecs/DVDFactoryCodec.h"
@@ -740,6 +741,9 @@ bool CDVDPlayer::OpenDemuxStream()
       return false;
     }
 
+    // demux ahead of the player so a stalling input doesn't block it
+    if(g_advancedSettings.m_videoReadAheadSize > 0 && CDVDDemuxReadAhead::Supports(m_pInputStream, m_pDemuxer))
+      m_pDemuxer = new CDVDDemuxReadAhead(m_pDemuxer, m_pInputStream, g_advancedSettings.m_videoReadAheadSize, g_advancedSettings.m_videoReadAheadTime);
   }
   catch(...)
   {
@@ -1501,8 +1505,12 @@ bool CDVDPlayer::GetCachingTimes(double& level, double& delay, double& offset)
   unsigned maxrate = status.maxrate;
   bool full        = status.full;
 
+  // the input belongs to the read ahead thread, which knows where it is
+  CDVDDemuxReadAhead* readAhead = dynamic_cast<CDVDDemuxReadAhead*>(m_pDemuxer);
+  int64_t position = readAhead ? readAhead->GetInputPosition() : m_pInputStream->Seek(0, SEEK_CUR);
+
   int64_t length  = m_pInputStream->GetLength();
-  int64_t remain  = length - m_pInputStream->Seek(0, SEEK_CUR);
+  int64_t remain  = length - position;
 
   if(cached < 0 || length <= 0 || remain < 0)
     return false;
@@ -2070,6 +2078,12 @@ void CDVDPlayer::OnExit()
 
     m_messenger.End();
 
+    // hand the recycled demux packets back to the heap
+    DemuxPacketPoolStats stats;
+    CDVDDemuxUtils::GetPoolStats(stats);
+    CLog::Log(LOGDEBUG, "CDVDPlayer::OnExit() demux packet pool: %ld of %ld packets recycled, peak %ld in use, %ld still in use, releasing %ld bytes",
+              stats.hits, stats.allocs, stats.peakInUse, stats.inUse, stats.pooledBytes);
+    CDVDDemuxUtils::ReleasePool();
   }
   catch (...)
   {
@@ -3006,6 +3020,10 @@ bool CDVDPlayer::OpenVideoStream(int iStream, int source, bool reset)
   if(pMenus && pMenus->IsInMenu())
     hint.stills = true;
 
+  // channels are watched live, and switched
+  if(dynamic_cast<CDVDInputStream::IChannel*>(m_pInputStream))
+    hint.realtime = true;
+
   if (hint.stereo_mode.empty())
     hint.stereo_mode = CStereoscopicsManager::Get().DetectStereoModeByString(m_filename);
 
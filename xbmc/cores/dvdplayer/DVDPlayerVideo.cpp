@@ -140,8 +140,6 @@ CDVDPlayerVideo::CDVDPlayerVideo( CDVDClock* pClock
   m_iVideoDelay = 0;
   m_iSubtitleDelay = 0;
   m_FlipTimeStamp = 0.0;
-  m_iLateFrames = 0;
-  m_iDroppedRequest = 0;
   m_fForcedAspectRatio = 0;
   m_iNrOfPicturesNotToSkip = 0;
   m_messageQueue.SetMaxDataSize(40 * 1024 * 1024);
@@ -233,8 +231,7 @@ void CDVDPlayerVideo::OpenStream(CDVDStreamInfo &hint, CDVDVideoCodec* codec)
                      CSettings::Get().GetInt("videoplayer.adjustrefreshrate") != ADJUST_REFRESHRATE_OFF;
   ResetFrameRateCalc();
 
-  m_iDroppedRequest = 0;
-  m_iLateFrames = 0;
+  m_dropper.Flush();
 
   if( m_fFrameRate > 100 || m_fFrameRate < 5 )
   {
@@ -294,6 +291,7 @@ void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers)
 void CDVDPlayerVideo::OnStartup()
 {
   m_iDroppedFrames = 0;
+  m_dropper.ResetStats();
 
   m_crop.x1 = m_crop.x2 = 0.0f;
   m_crop.y1 = m_crop.y2 = 0.0f;
@@ -319,7 +317,6 @@ void CDVDPlayerVideo::Process()
   double frametime = (double)DVD_TIME_BASE / m_fFrameRate;
 
   int iDropped = 0; //frames dropped in a row
-  bool bRequestDrop = false;
 
   m_videoStats.Start();
 
@@ -401,6 +398,7 @@ void CDVDPlayerVideo::Process()
       else
         CLog::Log(LOGDEBUG, "CDVDPlayerVideo - CDVDMsg::GENERAL_RESYNC(%f, 0)", pts);
 
+      m_dropper.Flush();
       pMsgGeneralResync->Release();
       continue;
     }
@@ -430,6 +428,7 @@ void CDVDPlayerVideo::Process()
         m_pVideoCodec->Reset();
       picture.iFlags &= ~DVP_FLAG_ALLOCATED;
       m_packets.clear();
+      m_dropper.Flush();
       m_started = false;
     }
     else if (pMsg->IsType(CDVDMsg::GENERAL_FLUSH)) // private message sent by (CDVDPlayerVideo::Flush())
@@ -440,6 +439,7 @@ void CDVDPlayerVideo::Process()
       m_packets.clear();
 
       m_pullupCorrection.Flush();
+      m_dropper.Flush();
       //we need to recalculate the framerate
       //TODO: this needs to be set on a streamchange instead
       ResetFrameRateCalc();
@@ -460,6 +460,7 @@ void CDVDPlayerVideo::Process()
       m_speed = static_cast<CDVDMsgInt*>(pMsg)->m_value;
       if(m_speed == DVD_PLAYSPEED_PAUSE)
         m_iNrOfPicturesNotToSkip = 0;
+      m_dropper.Flush();
       if (m_pVideoCodec)
         m_pVideoCodec->SetSpeed(m_speed);
     }
@@ -507,18 +508,22 @@ void CDVDPlayerVideo::Process()
         m_iNrOfPicturesNotToSkip = 1;
       }
 
-      if (m_messageQueue.GetDataSize() == 0
-      ||  m_speed < 0)
+      // if player want's us to drop this packet, do so nomatter what,
+      // else drop before decoding when the picture is predicted to be late.
+      // nothing is won by dropping while we wait for data, and we can't drop
+      // until we've calculated a stable framerate
+      bool bRequestDrop = bPacketDrop;
+      if (!bRequestDrop
+      &&  m_speed > 0
+      &&  m_messageQueue.GetDataSize() > 0
+      &&  m_iNrOfPicturesNotToSkip == 0
+      && (m_bAllowDrop || m_speed != DVD_PLAYSPEED_NORMAL))
       {
-        bRequestDrop = false;
-        m_iDroppedRequest = 0;
-        m_iLateFrames     = 0;
+        bRequestDrop = m_dropper.ShouldDrop(CDVDClock::GetAbsoluteClock(false));
+        if (bRequestDrop)
+          m_pullupCorrection.Flush(); //dropped frames mess up the pattern, so just flush it
       }
 
-      // if player want's us to drop this packet, do so nomatter what
-      if(bPacketDrop)
-        bRequestDrop = true;
-
       // tell codec if next frame should be dropped
       // problem here, if one packet contains more than one frame
       // both frames will be dropped in that case instead of just the first
@@ -547,8 +552,13 @@ void CDVDPlayerVideo::Process()
 
       mFilters = m_pVideoCodec->SetFilters(mFilters);
 
+      double decodeStart = CDVDClock::GetAbsoluteClock(false);
       int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
 
+      // skipping frames is cheaper, it would make the decoder look faster than it is
+      if (!bRequestDrop)
+        m_dropper.AddDecodeTime(CDVDClock::GetAbsoluteClock(false) - decodeStart);
+
       // buffer packets so we can recover should decoder flush for some reason
       if(m_pVideoCodec->GetConvergeCount() > 0)
       {
@@ -567,10 +577,9 @@ void CDVDPlayerVideo::Process()
       {
         m_iDroppedFrames++;
         iDropped++;
+        m_dropper.AddDrop(FRAMEDROP_PREDICTED);
+        m_dropper.AddSkipped(frametime * DVD_PLAYSPEED_NORMAL / m_speed);
       }
-      // reset the request, the following while loop may break before
-      // setting the flag to a new value
-      bRequestDrop = false;
 
       // loop while no error
       while (!m_bStop)
@@ -611,6 +620,9 @@ void CDVDPlayerVideo::Process()
 
           // try to retrieve the picture (should never fail!), unless there is a demuxer bug ofcours
           m_pVideoCodec->ClearPicture(&picture);
+          // only the software decoder sets the buffer, don't keep the one of
+          // a codec that was replaced since
+          picture.buffer = NULL;
           if (m_pVideoCodec->GetPicture(&picture))
           {
             sPostProcessType.clear();
@@ -712,11 +724,16 @@ void CDVDPlayerVideo::Process()
             {
               m_iDroppedFrames++;
               iDropped++;
+              if (picture.iFlags & DVP_FLAG_DROPPED)
+                m_dropper.AddDrop(FRAMEDROP_DECODER);
+              else
+                m_dropper.AddDrop(FRAMEDROP_RENDERER);
             }
             else
               iDropped = 0;
 
-            bRequestDrop = (iResult & EOS_VERYLATE) == EOS_VERYLATE;
+            if( (iResult & EOS_DROPPED) && bPacketDrop )
+              m_dropper.AddDrop(FRAMEDROP_PLAYER);
           }
           else
           {
@@ -764,6 +781,7 @@ void CDVDPlayerVideo::OnExit()
     m_pOverlayCodecCC = NULL;
   }
 
+  CLog::Log(LOGNOTICE, "CDVDPlayerVideo - frame timing, %s", m_dropper.GetStats().c_str());
   CLog::Log(LOGNOTICE, "thread end: video_thread");
 }
 
@@ -925,6 +943,7 @@ void CDVDPlayerVideo::ProcessOverlays(DVDVideoPicture* pSource, double pts)
       CDVDCodecUtils::CopyPicture(m_pTempOverlayPicture, pSource);
       memcpy(pSource->data     , m_pTempOverlayPicture->data     , sizeof(pSource->data));
       memcpy(pSource->iLineSize, m_pTempOverlayPicture->iLineSize, sizeof(pSource->iLineSize));
+      pSource->buffer = NULL; // the overlays are drawn into the copy
     }
   }
 
@@ -1083,7 +1102,8 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
                                 , pPicture->format
                                 , pPicture->extended_format
                                 , m_hints.orientation
-                                , m_pVideoCodec->GetAllowedReferences()))
+                                , m_pVideoCodec->GetAllowedReferences()
+                                , m_pVideoCodec->GetDecoderLatency()))
     {
       CLog::Log(LOGERROR, "%s - failed to configure renderer", __FUNCTION__);
       return EOS_ABORT;
@@ -1176,29 +1196,14 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
   m_FlipTimeStamp += max(0.0, iSleepTime);
   m_FlipTimeStamp += iFrameDuration;
 
-  if (iSleepTime <= 0 && m_speed)
-    m_iLateFrames++;
-  else
-    m_iLateFrames = 0;
-
-  // ask decoder to drop frames next round, as we are very late
-  if(m_iLateFrames > 10)
-  {
-    if (!(pPicture->iFlags & DVP_FLAG_NOSKIP))
-    {
-      //if we're calculating the framerate,
-      //don't drop frames until we've calculated a stable framerate
-      if (m_bAllowDrop || m_speed != DVD_PLAYSPEED_NORMAL)
-      {
-        result |= EOS_VERYLATE;
-        m_pullupCorrection.Flush(); //dropped frames mess up the pattern, so just flush it
-      }
-      m_iDroppedRequest++;
-    }
-  }
-  else
+  // tell the frame dropper how much time this picture has to spare,
+  // a dropped one leaves its time to the next
+  if (m_started && !m_stalled && m_speed)
   {
-    m_iDroppedRequest = 0;
+    if (pPicture->iFlags & DVP_FLAG_DROPPED)
+      m_dropper.AddSkipped(iFrameDuration);
+    else
+      m_dropper.AddPicture(iClockSleep, iCurrentClock, iFrameDuration);
   }
 
   if( (pPicture->iFlags & DVP_FLAG_DROPPED) )
@@ -1222,7 +1227,10 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
 
   ProcessOverlays(pPicture, pts);
 
+  double outputStart = CDVDClock::GetAbsoluteClock(false);
   int index = g_renderManager.AddVideoPicture(*pPicture);
+  if (index >= 0)
+    m_dropper.AddOutputTime(CDVDClock::GetAbsoluteClock(false) - outputStart);
 
   // video device might not be done yet
   while (index < 0 && !CThread::m_bStop &&
@@ -1427,6 +1435,7 @@ std::string CDVDPlayerVideo::GetPlayerInfo()
   s << ", vq:"   << setw(2) << min(99,GetLevel()) << "%";
   s << ", dc:"   << m_codecname;
   s << ", Mb/s:" << fixed << setprecision(2) << (double)GetVideoBitrate() / (1024.0*1024.0);
+  s << ", dt:"   << fixed << setprecision(1) << m_dropper.GetDecodeCost() / DVD_TIME_BASE * 1000.0 << "ms";
   s << ", drop:" << m_iDroppedFrames;
   s << ", skip:" << g_renderManager.GetSkippedFrames();
 
@@ -27,6 +27,7 @@
 #include "DVDClock.h"
 #include "DVDOverlayContainer.h"
 #include "DVDTSCorrection.h"
+#include "DVDFrameDropper.h"
 #ifdef HAS_VIDEO_PLAYBACK
 #include "cores/VideoRenderers/RenderManager.h"
 #endif
@@ -103,7 +104,6 @@ protected:
 
 #define EOS_ABORT 1
 #define EOS_DROPPED 2
-#define EOS_VERYLATE 4
 
   void AutoCrop(DVDVideoPicture* pPicture);
   void AutoCrop(DVDVideoPicture *pPicture, RECT &crop);
@@ -123,9 +123,7 @@ protected:
   double m_iSubtitleDelay;
   double m_FlipTimeStamp; // time stamp of last flippage. used to play at a forced framerate
 
-  int m_iLateFrames;
   int m_iDroppedFrames;
-  int m_iDroppedRequest;
 
   void   ResetFrameRateCalc();
   void   CalcFrameRate();
@@ -180,6 +178,7 @@ protected:
   DVDVideoPicture* m_pTempOverlayPicture;
 
   CPullupCorrection m_pullupCorrection;
+  CDVDFrameDropper  m_dropper;
 
   std::list<DVDMessageListItem> m_packets;
 };
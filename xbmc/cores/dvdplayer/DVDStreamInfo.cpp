@@ -41,6 +41,7 @@ void CDVDStreamInfo::Clear()
   codec = AV_CODEC_ID_NONE;
   type = STREAM_NONE;
   software = false;
+  realtime = false;
   codec_tag  = 0;
 
   if( extradata && extrasize ) free(extradata);
@@ -133,6 +134,7 @@ void CDVDStreamInfo::Assign(const CDVDStreamInfo& right, bool withextradata)
   codec = right.codec;
   type = right.type;
   codec_tag = right.codec_tag;
+  realtime = right.realtime;
 
   if( extradata && extrasize ) free(extradata);
 
@@ -48,6 +48,7 @@ public:
   AVCodecID codec;
   StreamType type;
   bool software;  //force software decoding
+  bool realtime;  //live source, decoding latency shows on channel switches
 
 
   // VIDEO
@@ -0,0 +1,253 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/DVDCodecUtils.h"
+#include "cores/VideoRenderers/BaseRenderer.h"
+#include "utils/CPUInfo.h"
+#include "utils/Stopwatch.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+struct KernelSet
+{
+  const char  *name;
+  unsigned int features;
+};
+
+const KernelSet kernelSets[] =
+{
+  { "C"   , 0                                   },
+  { "SSE2", CPU_FEATURE_SSE2                    },
+  { "AVX2", CPU_FEATURE_SSE2 | CPU_FEATURE_AVX2 }
+};
+
+bool Supported(const KernelSet &set)
+{
+  return (g_cpuInfo.GetCPUFeatures() & set.features) == set.features;
+}
+
+std::vector<uint8_t> Random(int size)
+{
+  std::vector<uint8_t> data(size);
+  for (int i = 0; i < size; ++i)
+    data[i] = rand() & 0xFF;
+  return data;
+}
+
+/* the reference YUY2 or UYVY line, computed the slow way */
+std::vector<uint8_t> Pack(bool uyvy, const uint8_t *y, const uint8_t *u, const uint8_t *v, int width)
+{
+  std::vector<uint8_t> out(width * 2);
+  for (int x = 0; x < width; ++x)
+  {
+    uint8_t c = (x & 1) ? v[x >> 1] : u[x >> 1];
+    out[x * 2 + (uyvy ? 0 : 1)] = c;
+    out[x * 2 + (uyvy ? 1 : 0)] = y[x];
+  }
+  return out;
+}
+}
+
+TEST(TestDVDCodecUtils, Kernels)
+{
+  for (unsigned int k = 0; k < sizeof(kernelSets) / sizeof(kernelSets[0]); ++k)
+  {
+    if (!Supported(kernelSets[k]))
+      continue;
+    const CDVDCodecUtils::SPictureKernels &kernels = CDVDCodecUtils::GetKernels(kernelSets[k].features);
+
+    /* odd sizes and offsets make sure the head and tail handling of the vector kernels is hit */
+    for (int width = 1; width < 300; width += 7)
+    {
+      for (int offset = 0; offset < 4; ++offset)
+      {
+        std::vector<uint8_t> y = Random(width);
+        std::vector<uint8_t> u = Random(width);
+        std::vector<uint8_t> v = Random(width);
+
+        std::vector<uint8_t> out(width * 2 + offset + 1, 0xAA);
+        kernels.copy(&out[offset], &y[0], width);
+        EXPECT_TRUE(std::equal(y.begin(), y.end(), out.begin() + offset)) << kernelSets[k].name << " copy " << width;
+        EXPECT_EQ(0xAA, out[width + offset]);
+
+        out.assign(out.size(), 0xAA);
+        kernels.stream(&out[offset], &y[0], width);
+        kernels.fence();
+        EXPECT_TRUE(std::equal(y.begin(), y.end(), out.begin() + offset)) << kernelSets[k].name << " stream " << width;
+        EXPECT_EQ(0xAA, out[width + offset]);
+
+        out.assign(out.size(), 0xAA);
+        kernels.interleave(&out[offset], &u[0], &v[0], width);
+        for (int x = 0; x < width; ++x)
+        {
+          EXPECT_EQ(u[x], out[offset + x * 2]);
+          EXPECT_EQ(v[x], out[offset + x * 2 + 1]);
+        }
+        EXPECT_EQ(0xAA, out[width * 2 + offset]) << kernelSets[k].name << " interleave " << width;
+
+        for (int uyvy = 0; uyvy < 2; ++uyvy)
+        {
+          std::vector<uint8_t> ref = Pack(uyvy != 0, &y[0], &u[0], &v[0], width);
+          out.assign(out.size(), 0xAA);
+          (uyvy ? kernels.packUYVY : kernels.packYUY2)(&out[offset], &y[0], &u[0], &v[0], width);
+          EXPECT_TRUE(std::equal(ref.begin(), ref.end(), out.begin() + offset))
+            << kernelSets[k].name << (uyvy ? " uyvy " : " yuy2 ") << width;
+          EXPECT_EQ(0xAA, out[width * 2 + offset]);
+        }
+      }
+    }
+  }
+}
+
+TEST(TestDVDCodecUtils, ConvertPictures)
+{
+  DVDVideoPicture *src = CDVDCodecUtils::AllocatePicture(70, 10);
+  ASSERT_TRUE(src != NULL);
+  for (int i = 0; i < 70 * 10 * 3 / 2; ++i)
+    src->data[0][i] = rand() & 0xFF;
+
+  DVDVideoPicture *nv12 = CDVDCodecUtils::ConvertToNV12Picture(src);
+  ASSERT_TRUE(nv12 != NULL);
+  EXPECT_EQ(0, memcmp(src->data[0], nv12->data[0], 70 * 10));
+  for (int y = 0; y < 5; ++y)
+  {
+    for (int x = 0; x < 35; ++x)
+    {
+      EXPECT_EQ(src->data[1][y * 35 + x], nv12->data[1][y * 70 + x * 2]);
+      EXPECT_EQ(src->data[2][y * 35 + x], nv12->data[1][y * 70 + x * 2 + 1]);
+    }
+  }
+  CDVDCodecUtils::FreePicture(nv12);
+
+  DVDVideoPicture *yuy2 = CDVDCodecUtils::ConvertToYUV422PackedPicture(src, RENDER_FMT_YUYV422);
+  ASSERT_TRUE(yuy2 != NULL);
+  for (int y = 0; y < 10; ++y)
+  {
+    /* both luma lines of a chroma line get the same chroma */
+    std::vector<uint8_t> ref = Pack(false, src->data[0] + y * 70, src->data[1] + (y >> 1) * 35, src->data[2] + (y >> 1) * 35, 70);
+    EXPECT_EQ(0, memcmp(&ref[0], yuy2->data[0] + y * 140, 140)) << "line " << y;
+  }
+  CDVDCodecUtils::FreePicture(yuy2);
+
+  CDVDCodecUtils::FreePicture(src);
+}
+
+TEST(TestDVDCodecUtils, CopyToImage)
+{
+  DVDVideoPicture *src = CDVDCodecUtils::AllocatePicture(1920, 1080);
+  ASSERT_TRUE(src != NULL);
+  for (int i = 0; i < 1920 * 1080 * 3 / 2; ++i)
+    src->data[0][i] = rand() & 0xFF;
+
+  /* padded strides, the copy goes line by line */
+  std::vector<uint8_t> buffer(2048 * 1080 + 1024 * 540 * 2);
+  YV12Image image;
+  memset(&image, 0, sizeof(image));
+  image.width     = 1920;
+  image.height    = 1080;
+  image.cshift_x  = 1;
+  image.cshift_y  = 1;
+  image.bpp       = 1;
+  image.plane[0]  = &buffer[0];
+  image.plane[1]  = image.plane[0] + 2048 * 1080;
+  image.plane[2]  = image.plane[1] + 1024 * 540;
+  image.stride[0] = 2048;
+  image.stride[1] = 1024;
+  image.stride[2] = 1024;
+
+  EXPECT_TRUE(CDVDCodecUtils::CopyPicture(&image, src));
+  for (int y = 0; y < 1080; ++y)
+    ASSERT_EQ(0, memcmp(src->data[0] + y * 1920, image.plane[0] + y * 2048, 1920)) << "luma line " << y;
+  for (int y = 0; y < 540; ++y)
+  {
+    ASSERT_EQ(0, memcmp(src->data[1] + y * 960, image.plane[1] + y * 1024, 960)) << "u line " << y;
+    ASSERT_EQ(0, memcmp(src->data[2] + y * 960, image.plane[2] + y * 1024, 960)) << "v line " << y;
+  }
+
+  CDVDCodecUtils::FreePicture(src);
+}
+
+/*
+  Milliseconds per frame of every kernel set this cpu supports, run with
+  --gtest_also_run_disabled_tests --gtest_filter=TestDVDCodecUtils.*
+*/
+TEST(TestDVDCodecUtils, DISABLED_Benchmark)
+{
+  const int sizes[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+  const int loops = 50;
+
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+  {
+    const int w = sizes[s][0];
+    const int h = sizes[s][1];
+    std::vector<uint8_t> src = Random(w * h * 3 / 2);
+    std::vector<uint8_t> dst(w * h * 2);
+    const uint8_t *y = &src[0];
+    const uint8_t *u = y + w * h;
+    const uint8_t *v = u + w * h / 4;
+
+    for (unsigned int k = 0; k < sizeof(kernelSets) / sizeof(kernelSets[0]); ++k)
+    {
+      if (!Supported(kernelSets[k]))
+        continue;
+      const CDVDCodecUtils::SPictureKernels &kernels = CDVDCodecUtils::GetKernels(kernelSets[k].features);
+      CStopWatch watch;
+
+      /* YV12 frame line by line, as into a renderer buffer */
+      for (int stream = 0; stream < 2; ++stream)
+      {
+        CDVDCodecUtils::CopyLineFn copy = stream ? kernels.stream : kernels.copy;
+        watch.StartZero();
+        for (int l = 0; l < loops; ++l)
+        {
+          for (int i = 0; i < h; ++i)
+            copy(&dst[i * w], y + i * w, w);
+          for (int i = 0; i < h; ++i)
+            copy(&dst[w * h + i * w / 2], u + (i >> 1) * (w / 2), w / 2);
+          kernels.fence();
+        }
+        std::cout << w << "x" << h << " " << kernelSets[k].name << (stream ? " stream: " : " copy: ")
+                  << watch.GetElapsedMilliseconds() / loops << " ms/frame" << std::endl;
+      }
+
+      watch.StartZero();
+      for (int l = 0; l < loops; ++l)
+        for (int i = 0; i < h / 2; ++i)
+          kernels.interleave(&dst[i * w], u + i * (w / 2), v + i * (w / 2), w / 2);
+      std::cout << w << "x" << h << " " << kernelSets[k].name << " nv12 chroma: "
+                << watch.GetElapsedMilliseconds() / loops << " ms/frame" << std::endl;
+
+      watch.StartZero();
+      for (int l = 0; l < loops; ++l)
+        for (int i = 0; i < h; ++i)
+          kernels.packYUY2(&dst[i * w * 2], y + i * w, u + (i >> 1) * (w / 2), v + (i >> 1) * (w / 2), w);
+      std::cout << w << "x" << h << " " << kernelSets[k].name << " yuy2: "
+                << watch.GetElapsedMilliseconds() / loops << " ms/frame" << std::endl;
+    }
+  }
+}
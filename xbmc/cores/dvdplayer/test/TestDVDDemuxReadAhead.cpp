@@ -0,0 +1,258 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxReadAhead.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "threads/Atomics.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+/* packets one second apart in chapters of ten, a stream is replaced at
+ * packet m_replaceAt and the replaced one moves to the end like on a
+ * program change */
+class CFakeDemux : public CDVDDemux
+{
+public:
+  CFakeDemux(int count, int size)
+    : m_count(count), m_size(size), m_pos(0), m_chapter(1), m_replaceAt(-1), m_stallMs(0), m_reads(0), m_retired(NULL)
+  {
+    m_stream = new CDemuxStream();
+    m_stream->iPhysicalId = 1;
+  }
+  virtual ~CFakeDemux()
+  {
+    delete m_stream;
+    delete m_retired;
+  }
+
+  virtual void Reset()     { m_pos = 0; }
+  virtual void Abort()     { m_stallMs = 0; }
+  virtual void Flush()     {}
+  virtual void SetSpeed(int iSpeed) {}
+  virtual int GetStreamLength()     { return m_count * 1000; }
+  virtual int GetChapterCount()     { return (m_count + 9) / 10; }
+  virtual int GetChapter()          { return m_chapter; }
+  virtual void GetChapterName(std::string& strChapterName) { strChapterName = m_chapter == 1 ? "first" : "later"; }
+  virtual int GetNrOfStreams()      { return m_retired ? 2 : 1; }
+  virtual std::string GetFileName() { return "fake"; }
+  virtual CDemuxStream* GetStream(int iStreamId)
+  {
+    if (iStreamId == 0)
+      return m_stream;
+    return iStreamId == 1 ? m_retired : NULL;
+  }
+  virtual void GetStreamCodecName(int iStreamId, CStdString &strName)
+  {
+    CDemuxStream* stream = GetStream(iStreamId);
+    if (stream)
+      strName = stream->iPhysicalId == 1 ? "first" : "second";
+  }
+
+  virtual DemuxPacket* Read()
+  {
+    AtomicIncrement(&m_reads);
+    if (m_stallMs)
+      XbmcThreads::ThreadSleep(m_stallMs);
+    if (m_pos >= m_count)
+      return NULL;
+    if (m_pos == m_replaceAt)
+    {
+      // like the ffmpeg demuxer, keep the replaced stream until closed
+      m_retired = m_stream;
+      m_stream = new CDemuxStream();
+      m_stream->iPhysicalId = 2;
+    }
+    m_chapter = m_pos / 10 + 1;
+    DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(m_size);
+    packet->iSize     = m_size;
+    packet->iStreamId = 0;
+    packet->dts       = DVD_SEC_TO_TIME(m_pos);
+    packet->pts       = DVD_NOPTS_VALUE;
+    m_pos++;
+    return packet;
+  }
+
+  virtual bool SeekTime(int time, bool backwords = false, double* startpts = NULL)
+  {
+    m_pos = time / 1000;
+    return true;
+  }
+
+  int m_count;
+  int m_size;
+  int m_pos;
+  int m_chapter;
+  int m_replaceAt;
+  volatile unsigned int m_stallMs;
+  volatile long m_reads;
+  CDemuxStream* m_stream;
+  CDemuxStream* m_retired;
+};
+
+/* next packet with data, skipping the empty ones handed out while waiting */
+DemuxPacket* ReadData(CDVDDemux& demux)
+{
+  for (int i = 0; i < 100; i++)
+  {
+    DemuxPacket* packet = demux.Read();
+    if (!packet || packet->iStreamId >= 0)
+      return packet;
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+  }
+  return NULL;
+}
+
+bool WaitForReads(CFakeDemux* fake, long reads)
+{
+  for (int i = 0; i < 2000 && fake->m_reads < reads; i++)
+    XbmcThreads::ThreadSleep(1);
+  // let a read past the limit show up
+  XbmcThreads::ThreadSleep(50);
+  return fake->m_reads >= reads;
+}
+}
+
+TEST(TestDVDDemuxReadAhead, OrderAndEnd)
+{
+  CFakeDemux* fake = new CFakeDemux(50, 100);
+  CDVDDemuxReadAhead demux(fake, NULL, 1024 * 1024, 100.0);
+
+  for (int i = 0; i < 50; i++)
+  {
+    DemuxPacket* packet = ReadData(demux);
+    ASSERT_TRUE(packet != NULL);
+    EXPECT_EQ(DVD_SEC_TO_TIME(i), packet->dts);
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+  }
+  EXPECT_TRUE(ReadData(demux) == NULL);
+}
+
+TEST(TestDVDDemuxReadAhead, Limits)
+{
+  // by size, 10 packets of 100 bytes
+  CFakeDemux* fake = new CFakeDemux(1000, 100);
+  CDVDDemuxReadAhead demux(fake, NULL, 1000, 100.0);
+  CDVDDemuxUtils::FreeDemuxPacket(ReadData(demux));
+  EXPECT_TRUE(WaitForReads(fake, 11));
+  EXPECT_EQ(11, fake->m_reads);
+
+  // by time, a packet per second
+  CFakeDemux* fake2 = new CFakeDemux(1000, 100);
+  CDVDDemuxReadAhead demux2(fake2, NULL, 1024 * 1024, 4.0);
+  CDVDDemuxUtils::FreeDemuxPacket(ReadData(demux2));
+  EXPECT_TRUE(WaitForReads(fake2, 6));
+  EXPECT_EQ(6, fake2->m_reads);
+}
+
+TEST(TestDVDDemuxReadAhead, SeekDropsBuffer)
+{
+  CFakeDemux* fake = new CFakeDemux(1000, 100);
+  CDVDDemuxReadAhead demux(fake, NULL, 1024 * 1024, 5.0);
+
+  DemuxPacket* packet = ReadData(demux);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_EQ(0, packet->dts);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+  WaitForReads(fake, 5);
+
+  EXPECT_TRUE(demux.SeekTime(500000));
+  packet = ReadData(demux);
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_EQ(DVD_SEC_TO_TIME(500), packet->dts);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+}
+
+TEST(TestDVDDemuxReadAhead, StreamChangeAtItsPacket)
+{
+  CFakeDemux* fake = new CFakeDemux(20, 100);
+  fake->m_replaceAt = 5;
+  CDemuxStream* first = fake->m_stream;
+  CDVDDemuxReadAhead demux(fake, NULL, 1024 * 1024, 100.0);
+
+  // the reader is past the change long before the player gets there
+  CDVDDemuxUtils::FreeDemuxPacket(ReadData(demux));
+  WaitForReads(fake, 20);
+  for (int i = 1; i < 20; i++)
+  {
+    DemuxPacket* packet = ReadData(demux);
+    ASSERT_TRUE(packet != NULL);
+    EXPECT_EQ(i < 5 ? first : fake->m_stream, demux.GetStream(packet->iStreamId)) << "packet " << i;
+    CStdString name;
+    demux.GetStreamCodecName(packet->iStreamId, name);
+    EXPECT_STREQ(i < 5 ? "first" : "second", name.c_str()) << "packet " << i;
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+  }
+}
+
+TEST(TestDVDDemuxReadAhead, ChapterAtItsPacket)
+{
+  CFakeDemux* fake = new CFakeDemux(30, 100);
+  CDVDDemuxReadAhead demux(fake, NULL, 1024 * 1024, 100.0);
+  EXPECT_EQ(3, demux.GetChapterCount());
+  EXPECT_EQ(30000, demux.GetStreamLength());
+  EXPECT_EQ("fake", demux.GetFileName());
+
+  // the reader is in the last chapter, the player still in the first
+  CDVDDemuxUtils::FreeDemuxPacket(ReadData(demux));
+  WaitForReads(fake, 30);
+  for (int i = 1; i < 30; i++)
+  {
+    DemuxPacket* packet = ReadData(demux);
+    ASSERT_TRUE(packet != NULL);
+    EXPECT_EQ(i / 10 + 1, demux.GetChapter()) << "packet " << i;
+    std::string name;
+    demux.GetChapterName(name);
+    EXPECT_EQ(i < 10 ? "first" : "later", name) << "packet " << i;
+    CDVDDemuxUtils::FreeDemuxPacket(packet);
+  }
+}
+
+TEST(TestDVDDemuxReadAhead, StallKeepsPlayerGoing)
+{
+  CFakeDemux* fake = new CFakeDemux(10, 100);
+  fake->m_stallMs = 1000;
+  CDVDDemuxReadAhead demux(fake, NULL, 1024 * 1024, 100.0);
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  DemuxPacket* packet = demux.Read();
+  ASSERT_TRUE(packet != NULL);
+  EXPECT_LT(packet->iStreamId, 0);
+  EXPECT_LT(XbmcThreads::SystemClockMillis() - start, 500U);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+  // what the player asks every loop doesn't wait for the read either
+  start = XbmcThreads::SystemClockMillis();
+  std::string name;
+  CStdString codec;
+  EXPECT_EQ(1, demux.GetChapter());
+  EXPECT_EQ(1, demux.GetChapterCount());
+  EXPECT_EQ(10000, demux.GetStreamLength());
+  demux.GetChapterName(name);
+  demux.GetStreamCodecName(0, codec);
+  EXPECT_EQ("first", name);
+  EXPECT_STREQ("first", codec.c_str());
+  EXPECT_LT(XbmcThreads::SystemClockMillis() - start, 500U);
+
+  fake->m_stallMs = 0;
+}
@@ -0,0 +1,188 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "DllAvCodec.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+#include <set>
+#include <vector>
+
+namespace
+{
+DemuxPacketPoolStats PoolStats()
+{
+  DemuxPacketPoolStats stats;
+  CDVDDemuxUtils::GetPoolStats(stats);
+  return stats;
+}
+
+/* allocates and frees packets of all classes, and frees the packets it was given */
+class CPacketChurn : public IRunnable
+{
+public:
+  CPacketChurn(const std::vector<DemuxPacket*> &packets, int rounds)
+    : m_packets(packets), m_rounds(rounds) {}
+
+  virtual void Run()
+  {
+    for (int i = 0; i < m_rounds; i++)
+    {
+      DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(1 << (8 + i % 12));
+      if (i < (int)m_packets.size())
+        CDVDDemuxUtils::FreeDemuxPacket(m_packets[i]);
+      CDVDDemuxUtils::FreeDemuxPacket(packet);
+    }
+  }
+
+private:
+  std::vector<DemuxPacket*> m_packets;
+  int m_rounds;
+};
+}
+
+TEST(TestDVDDemuxUtils, Reuse)
+{
+  CDVDDemuxUtils::ReleasePool();
+  DemuxPacketPoolStats before = PoolStats();
+
+  DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(1000);
+  ASSERT_TRUE(packet != NULL);
+  uint8_t *data = packet->pData;
+  ASSERT_TRUE(data != NULL);
+  packet->iSize = 1000;
+  packet->dts   = 0.0;
+  memset(data, 0xff, 1024 + FF_INPUT_BUFFER_PADDING_SIZE);
+  CDVDDemuxUtils::FreeDemuxPacket(packet);
+
+  DemuxPacketPoolStats pooled = PoolStats();
+  EXPECT_EQ(1, pooled.pooled);
+  EXPECT_EQ(1024, pooled.pooledBytes);
+  EXPECT_EQ(before.inUse, pooled.inUse);
+
+  // the same block comes back, cleared like a new one
+  DemuxPacket *again = CDVDDemuxUtils::AllocateDemuxPacket(900);
+  ASSERT_TRUE(again == packet);
+  EXPECT_TRUE(again->pData == data);
+  EXPECT_EQ(0, again->iSize);
+  EXPECT_EQ(-1, again->iStreamId);
+  EXPECT_EQ(DVD_NOPTS_VALUE, again->dts);
+  EXPECT_EQ(DVD_NOPTS_VALUE, again->pts);
+  for (int i = 0; i < FF_INPUT_BUFFER_PADDING_SIZE; i++)
+    EXPECT_EQ(0, again->pData[900 + i]);
+
+  DemuxPacketPoolStats reused = PoolStats();
+  EXPECT_EQ(before.allocs + 2, reused.allocs);
+  EXPECT_EQ(before.hits + 1, reused.hits);
+  EXPECT_EQ(before.inUse + 1, reused.inUse);
+  EXPECT_EQ(0, reused.pooled);
+
+  CDVDDemuxUtils::FreeDemuxPacket(again);
+  CDVDDemuxUtils::ReleasePool();
+  EXPECT_EQ(0, PoolStats().pooled);
+}
+
+TEST(TestDVDDemuxUtils, SizeClasses)
+{
+  CDVDDemuxUtils::ReleasePool();
+
+  // a packet only comes back for sizes of its class
+  DemuxPacket *small = CDVDDemuxUtils::AllocateDemuxPacket(256);
+  CDVDDemuxUtils::FreeDemuxPacket(small);
+  EXPECT_EQ(256, PoolStats().pooledBytes);
+
+  DemuxPacket *bigger = CDVDDemuxUtils::AllocateDemuxPacket(257);
+  EXPECT_TRUE(bigger != small);
+  EXPECT_EQ(1, PoolStats().pooled);
+  CDVDDemuxUtils::FreeDemuxPacket(bigger);
+  EXPECT_EQ(256 + 512, PoolStats().pooledBytes);
+
+  // empty packets share the smallest class
+  DemuxPacket *empty = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  EXPECT_TRUE(empty == small);
+  CDVDDemuxUtils::FreeDemuxPacket(empty);
+
+  // the biggest class is 2 MiB, anything above goes straight to the heap
+  DemuxPacket *largest = CDVDDemuxUtils::AllocateDemuxPacket(2 * 1024 * 1024);
+  CDVDDemuxUtils::FreeDemuxPacket(largest);
+  EXPECT_EQ(256 + 512 + 2 * 1024 * 1024, PoolStats().pooledBytes);
+
+  DemuxPacket *huge = CDVDDemuxUtils::AllocateDemuxPacket(2 * 1024 * 1024 + 1);
+  ASSERT_TRUE(huge != NULL);
+  EXPECT_TRUE(huge != largest);
+  huge->pData[2 * 1024 * 1024] = 0xff;
+  CDVDDemuxUtils::FreeDemuxPacket(huge);
+  EXPECT_EQ(3, PoolStats().pooled);
+
+  // a class holds a bounded number of free packets, the rest is freed
+  std::vector<DemuxPacket*> packets;
+  for (int i = 0; i < 100; i++)
+    packets.push_back(CDVDDemuxUtils::AllocateDemuxPacket(4096));
+  for (int i = 0; i < 100; i++)
+    CDVDDemuxUtils::FreeDemuxPacket(packets[i]);
+  EXPECT_EQ(3 + 64, PoolStats().pooled);
+
+  CDVDDemuxUtils::ReleasePool();
+  EXPECT_EQ(0, PoolStats().pooled);
+  EXPECT_EQ(0, PoolStats().pooledBytes);
+}
+
+TEST(TestDVDDemuxUtils, ConcurrentFree)
+{
+  CDVDDemuxUtils::ReleasePool();
+  DemuxPacketPoolStats before = PoolStats();
+
+  // the demuxer allocates, the player threads free
+  const int count = 20000;
+  std::vector<DemuxPacket*> packets;
+  for (int i = 0; i < count; i++)
+    packets.push_back(CDVDDemuxUtils::AllocateDemuxPacket(1 << (8 + i % 12)));
+
+  CPacketChurn churn(packets, count);
+  CThread thread(&churn, "PacketChurn");
+  thread.Create();
+  for (int i = 0; i < count; i++)
+    CDVDDemuxUtils::FreeDemuxPacket(CDVDDemuxUtils::AllocateDemuxPacket(1 << (8 + i % 12)));
+  thread.StopThread();
+
+  DemuxPacketPoolStats after = PoolStats();
+  EXPECT_EQ(before.inUse, after.inUse);
+  EXPECT_EQ(before.allocs + 3 * count, after.allocs);
+  EXPECT_GT(after.pooled, 0);
+
+  // no block was pooled twice
+  std::set<DemuxPacket*> handedOut;
+  for (int c = 0; c < 12; c++)
+  {
+    for (int i = 0; i < 64; i++)
+    {
+      DemuxPacket *packet = CDVDDemuxUtils::AllocateDemuxPacket(1 << (8 + c));
+      EXPECT_TRUE(handedOut.insert(packet).second);
+    }
+  }
+  for (std::set<DemuxPacket*>::iterator it = handedOut.begin(); it != handedOut.end(); ++it)
+    CDVDDemuxUtils::FreeDemuxPacket(*it);
+
+  CDVDDemuxUtils::ReleasePool();
+  EXPECT_EQ(before.inUse, PoolStats().inUse);
+}
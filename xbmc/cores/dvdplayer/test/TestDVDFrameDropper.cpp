@@ -0,0 +1,113 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDFrameDropper.h"
+#include "cores/dvdplayer/DVDClock.h"
+
+#include "gtest/gtest.h"
+
+#define FRAME DVD_MSEC_TO_TIME(20)
+
+TEST(TestDVDFrameDropper, History)
+{
+  CFrameTimeHistory history;
+  EXPECT_EQ(0.0, history.GetAverage());
+
+  history.Add(10.0);
+  history.Add(20.0);
+  EXPECT_DOUBLE_EQ(15.0, history.GetAverage());
+
+  // the oldest samples fall out
+  for (int i = 0; i < FRAMEDROP_HISTORY; i++)
+    history.Add(40.0);
+  EXPECT_DOUBLE_EQ(40.0, history.GetAverage());
+
+  history.Flush();
+  EXPECT_EQ(0.0, history.GetAverage());
+}
+
+TEST(TestDVDFrameDropper, KeepsUpNoDrop)
+{
+  CDVDFrameDropper dropper;
+  double now = 0.0;
+
+  // decoding takes half a frame, pictures wait two frames to be shown
+  for (int i = 0; i < 100; i++)
+  {
+    EXPECT_FALSE(dropper.ShouldDrop(now));
+    dropper.AddDecodeTime(FRAME / 2);
+    now += FRAME;
+    dropper.AddPicture(2 * FRAME, now, FRAME);
+  }
+  EXPECT_EQ(100U, dropper.GetLateness(0));
+}
+
+TEST(TestDVDFrameDropper, PredictsLate)
+{
+  CDVDFrameDropper dropper;
+
+  // nothing known, nothing dropped
+  EXPECT_FALSE(dropper.ShouldDrop(0.0));
+
+  // the last picture had a frame to spare, but decoding takes two
+  for (int i = 0; i < FRAMEDROP_HISTORY; i++)
+    dropper.AddDecodeTime(2 * FRAME);
+  dropper.AddPicture(FRAME / 2, 0.0, FRAME);
+
+  // a single late prediction is no reason to drop yet
+  EXPECT_FALSE(dropper.ShouldDrop(0.0));
+  EXPECT_FALSE(dropper.ShouldDrop(0.0));
+  EXPECT_TRUE(dropper.ShouldDrop(0.0));
+
+  // skipped frames leave their time to the next picture
+  for (int i = 0; i < 4; i++)
+    dropper.AddSkipped(FRAME);
+  EXPECT_FALSE(dropper.ShouldDrop(0.0));
+
+  // a seek forgets the timing
+  dropper.AddPicture(-10 * FRAME, 0.0, FRAME);
+  dropper.Flush();
+  for (int i = 0; i < 5; i++)
+    EXPECT_FALSE(dropper.ShouldDrop(0.0));
+}
+
+TEST(TestDVDFrameDropper, Stats)
+{
+  CDVDFrameDropper dropper;
+
+  EXPECT_EQ(0, CDVDFrameDropper::GetLatenessBucket(-FRAME));
+  EXPECT_EQ(0, CDVDFrameDropper::GetLatenessBucket(0.0));
+  EXPECT_EQ(1, CDVDFrameDropper::GetLatenessBucket(DVD_MSEC_TO_TIME(5)));
+  EXPECT_EQ(FRAMEDROP_LATENESS - 1, CDVDFrameDropper::GetLatenessBucket(DVD_MSEC_TO_TIME(1000)));
+
+  dropper.AddPicture(-DVD_MSEC_TO_TIME(15), 0.0, FRAME);
+  dropper.AddDrop(FRAMEDROP_PREDICTED);
+  dropper.AddDrop(FRAMEDROP_PREDICTED);
+  dropper.AddDrop(FRAMEDROP_RENDERER);
+  EXPECT_EQ(1U, dropper.GetLateness(2));
+  EXPECT_EQ(2U, dropper.GetDrops(FRAMEDROP_PREDICTED));
+  EXPECT_EQ(1U, dropper.GetDrops(FRAMEDROP_RENDERER));
+  EXPECT_EQ(0U, dropper.GetDrops(FRAMEDROP_PLAYER));
+  EXPECT_NE(std::string::npos, dropper.GetStats().find("predicted:2"));
+
+  dropper.ResetStats();
+  EXPECT_EQ(0U, dropper.GetLateness(2));
+  EXPECT_EQ(0U, dropper.GetDrops(FRAMEDROP_PREDICTED));
+}
@@ -0,0 +1,66 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDInputStreams/DVDInputStreamFile.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+TEST(TestDVDInputStreamFile, MapFile)
+{
+  uint8_t data[256];
+  for (unsigned int i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)i;
+
+  XFILE::CFile *file;
+  ASSERT_TRUE((file = XBMC_CREATETEMPFILE("")) != NULL);
+  EXPECT_EQ((int)sizeof(data), file->Write(data, sizeof(data)));
+  file->Flush();
+
+  CDVDInputStreamFile stream;
+  ASSERT_TRUE(stream.Open(XBMC_TEMPFILEPATH(file).c_str(), ""));
+  ASSERT_TRUE(stream.MapFile());
+
+  uint8_t buf[100];
+  EXPECT_EQ(100, stream.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(memcmp(data, buf, 100) == 0);
+  EXPECT_EQ(50, stream.Seek(-50, SEEK_CUR));
+  EXPECT_EQ(100, stream.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(memcmp(data + 50, buf, 100) == 0);
+
+  // the view ends with the file
+  EXPECT_EQ((int64_t)sizeof(data), stream.Seek(0, SEEK_END));
+  EXPECT_EQ(200, stream.Seek(200, SEEK_SET));
+  EXPECT_EQ(56, stream.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(memcmp(data + 200, buf, 56) == 0);
+
+  // what is written later is read from the file
+  EXPECT_EQ((int)sizeof(data), file->Write(data, sizeof(data)));
+  file->Flush();
+  EXPECT_EQ(100, stream.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(memcmp(data, buf, 100) == 0);
+  EXPECT_EQ(356, stream.Seek(0, SEEK_CUR));
+
+  stream.Close();
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
@@ -0,0 +1,156 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDDemuxers/DVDKeyframeIndex.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+CDVDKeyframeIndex MakeIndex(int count)
+{
+  CDVDKeyframeIndex index;
+  index.m_fileSize    = 1234567890;
+  index.m_codec       = 28;
+  index.m_timeBaseNum = 1;
+  index.m_timeBaseDen = 90000;
+  for (int i = 0; i < count; i++)
+  {
+    CDVDKeyframeIndex::Entry entry;
+    entry.pos       = i * 188 * 1000;
+    entry.timestamp = i * 90000;
+    index.m_entries.push_back(entry);
+  }
+  return index;
+}
+}
+
+TEST(TestDVDKeyframeIndex, SaveAndLoad)
+{
+  XFILE::CFile *file;
+  ASSERT_TRUE((file = XBMC_CREATETEMPFILE("")) != NULL);
+  file->Close();
+  std::string path = XBMC_TEMPFILEPATH(file);
+
+  CDVDKeyframeIndex saved = MakeIndex(100);
+  ASSERT_TRUE(saved.Save(path));
+
+  CDVDKeyframeIndex loaded;
+  ASSERT_TRUE(loaded.Load(path));
+  EXPECT_TRUE(loaded.Matches(1234567890, 28, 1, 90000));
+  ASSERT_EQ(100U, loaded.m_entries.size());
+  for (unsigned int i = 0; i < loaded.m_entries.size(); i++)
+  {
+    EXPECT_EQ(saved.m_entries[i].pos, loaded.m_entries[i].pos);
+    EXPECT_EQ(saved.m_entries[i].timestamp, loaded.m_entries[i].timestamp);
+  }
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+TEST(TestDVDKeyframeIndex, Matches)
+{
+  CDVDKeyframeIndex index = MakeIndex(1);
+  EXPECT_TRUE(index.Matches(1234567890, 28, 1, 90000));
+  EXPECT_FALSE(index.Matches(1234567891, 28, 1, 90000));
+  EXPECT_FALSE(index.Matches(1234567890, 2, 1, 90000));
+  EXPECT_FALSE(index.Matches(1234567890, 28, 1, 1000));
+}
+
+TEST(TestDVDKeyframeIndex, DamagedFile)
+{
+  XFILE::CFile *file;
+  ASSERT_TRUE((file = XBMC_CREATETEMPFILE("")) != NULL);
+  file->Close();
+  std::string path = XBMC_TEMPFILEPATH(file);
+
+  CDVDKeyframeIndex index;
+  EXPECT_FALSE(index.Load(path));
+
+  // cut short, the header promises more entries than follow
+  ASSERT_TRUE(MakeIndex(10).Save(path));
+  XFILE::CFile cut;
+  std::vector<char> data(1024);
+  ASSERT_TRUE(cut.Open(path));
+  int size = cut.Read(&data[0], data.size());
+  cut.Close();
+  ASSERT_TRUE(cut.OpenForWrite(path, true));
+  EXPECT_EQ(size - 1, cut.Write(&data[0], size - 1));
+  cut.Close();
+  EXPECT_FALSE(index.Load(path));
+  EXPECT_TRUE(index.m_entries.empty());
+
+  // not an index at all
+  ASSERT_TRUE(cut.OpenForWrite(path, true));
+  cut.Write("not an index", 12);
+  cut.Close();
+  EXPECT_FALSE(index.Load(path));
+
+  EXPECT_FALSE(index.Load(path + ".missing"));
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+TEST(TestDVDKeyframeIndex, Prune)
+{
+  std::string folder = "special://temp/keyframes/";
+  ASSERT_TRUE(XFILE::CDirectory::Create(folder));
+
+  std::vector<std::string> paths;
+  for (int i = 0; i < 4; i++)
+  {
+    paths.push_back(URIUtils::AddFileToFolder(folder, StringUtils::Format("%d.kfi", i)));
+    ASSERT_TRUE(MakeIndex(100).Save(paths.back()));
+  }
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(paths[0]));
+  int64_t size = file.GetLength();
+  file.Close();
+
+  // other files in the folder are left alone
+  std::string other = URIUtils::AddFileToFolder(folder, "other.tbn");
+  ASSERT_TRUE(file.OpenForWrite(other, true));
+  file.Write("not an index", 12);
+  file.Close();
+
+  // nothing goes while they fit
+  CDVDKeyframeIndex::Prune(folder, 4 * size);
+  int left = 0;
+  for (unsigned int i = 0; i < paths.size(); i++)
+    left += XFILE::CFile::Exists(paths[i]) ? 1 : 0;
+  EXPECT_EQ(4, left);
+
+  // then as many as needed to get below the limit
+  CDVDKeyframeIndex::Prune(folder, 2 * size + size / 2);
+  left = 0;
+  for (unsigned int i = 0; i < paths.size(); i++)
+    left += XFILE::CFile::Exists(paths[i]) ? 1 : 0;
+  EXPECT_EQ(2, left);
+  EXPECT_TRUE(XFILE::CFile::Exists(other));
+
+  for (unsigned int i = 0; i < paths.size(); i++)
+    XFILE::CFile::Delete(paths[i]);
+  XFILE::CFile::Delete(other);
+  XFILE::CDirectory::Remove(folder);
+}
@@ -0,0 +1,292 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+CDVDMsg* MakePacket(double dts, int size = 100)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(size);
+  packet->iSize = size;
+  packet->dts   = dts;
+  packet->pts   = DVD_NOPTS_VALUE;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+double GetDts(CDVDMsg* msg)
+{
+  if (!msg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return DVD_NOPTS_VALUE;
+  return ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->dts;
+}
+
+/* the list based queue before the rings, for comparison */
+class CListQueue
+{
+public:
+  CListQueue() : m_event(true), m_size(0) {}
+  ~CListQueue() { m_list.clear(); }
+
+  void Put(CDVDMsg* msg, int priority = 0)
+  {
+    CSingleLock lock(m_section);
+    std::list<DVDMessageListItem>::iterator it = m_list.begin();
+    while (it != m_list.end() && priority > it->priority)
+      ++it;
+    m_list.insert(it, DVDMessageListItem(msg, priority));
+    m_size += ((CDVDMsgDemuxerPacket*)msg)->GetPacketSize();
+    msg->Release();
+    m_event.Set();
+  }
+
+  MsgQueueReturnCode Get(CDVDMsg** msg, unsigned int timeout)
+  {
+    CSingleLock lock(m_section);
+    while (m_list.empty())
+    {
+      m_event.Reset();
+      lock.Leave();
+      if (!m_event.WaitMSec(timeout))
+        return MSGQ_TIMEOUT;
+      lock.Enter();
+    }
+    *msg = m_list.back().message->Acquire();
+    m_size -= ((CDVDMsgDemuxerPacket*)*msg)->GetPacketSize();
+    m_list.pop_back();
+    return MSGQ_OK;
+  }
+
+  int GetDataSize() const { return m_size; }
+
+private:
+  CEvent m_event;
+  CCriticalSection m_section;
+  std::list<DVDMessageListItem> m_list;
+  volatile int m_size;
+};
+
+/* stamps every packet with the host counter at the time it is queued */
+template<class Q> class CProducer : public IRunnable
+{
+public:
+  CProducer(Q& queue, unsigned int count, int limit)
+    : m_queue(queue), m_count(count), m_limit(limit) {}
+
+  virtual void Run()
+  {
+    for (unsigned int i = 0; i < m_count; i++)
+    {
+      // throttle like the demuxer does on the queue level
+      while (m_queue.GetDataSize() > m_limit)
+        XbmcThreads::ThreadSleep(0);
+      m_queue.Put(MakePacket((double)CurrentHostCounter()));
+    }
+  }
+
+private:
+  Q& m_queue;
+  unsigned int m_count;
+  int m_limit;
+};
+
+template<class Q> void RunBenchmark(Q& queue, const char* name)
+{
+  const unsigned int count = 200000;
+  CProducer<Q> producer(queue, count, 100 * 100);
+  CThread thread(&producer, "QueueProducer");
+
+  std::vector<int64_t> latency;
+  latency.reserve(count);
+  int64_t start = CurrentHostCounter();
+  thread.Create();
+
+  while (latency.size() < count)
+  {
+    CDVDMsg* msg;
+    if (queue.Get(&msg, 1000) != MSGQ_OK)
+      break;
+    latency.push_back(CurrentHostCounter() - (int64_t)GetDts(msg));
+    msg->Release();
+  }
+  double seconds = (double)(CurrentHostCounter() - start) / CurrentHostFrequency();
+  thread.StopThread();
+
+  ASSERT_EQ(count, latency.size());
+  std::sort(latency.begin(), latency.end());
+  double us = 1e6 / CurrentHostFrequency();
+  std::cout << name << ": " << (int)(count / seconds) << " msg/s"
+            << ", latency p50 " << latency[count / 2] * us
+            << " us p99 " << latency[count * 99 / 100] * us
+            << " us max " << latency.back() * us << " us" << std::endl;
+}
+}
+
+TEST(TestDVDMessageQueue, PriorityOrder)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(MakePacket(1));
+  queue.Put(MakePacket(2));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+  queue.Put(MakePacket(3));
+  queue.Put(new CDVDMsg(CDVDMsg::PLAYER_SETSPEED), 10);
+
+  CDVDMsg* msg;
+  int priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::PLAYER_SETSPEED));
+  EXPECT_EQ(10, priority);
+  msg->Release();
+
+  priority = 0;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_FLUSH));
+  EXPECT_EQ(1, priority);
+  msg->Release();
+
+  // nothing left at or above the asked priority
+  priority = 1;
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0, priority));
+
+  for (int i = 1; i <= 3; i++)
+  {
+    priority = 0;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+    EXPECT_EQ(i, GetDts(msg));
+    msg->Release();
+  }
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, GrowAndFlush)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  // more than the reserved slots, wrapped around once
+  const int count = MSGQ_PACKET_SLOTS * 3;
+  CDVDMsg* msg;
+  queue.Put(MakePacket(-1));
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  msg->Release();
+  for (int i = 0; i < count; i++)
+  {
+    queue.Put(MakePacket(i));
+    if (i % 7 == 0)
+      queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH));
+  }
+  EXPECT_EQ((unsigned)count, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(count * 100, queue.GetDataSize());
+
+  // the other messages stay in order
+  queue.Flush(CDVDMsg::DEMUXER_PACKET);
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ((unsigned)(count + 6) / 7, queue.GetPacketCount(CDVDMsg::GENERAL_FLUSH));
+
+  queue.Put(MakePacket(count));
+  for (int i = 0; i < (count + 6) / 7; i++)
+  {
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_FLUSH));
+    msg->Release();
+  }
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_EQ(count, GetDts(msg));
+  msg->Release();
+
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH));
+  queue.Flush(CDVDMsg::NONE);
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, TimeLevel)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+  queue.SetMaxDataSize(1000000);
+  queue.SetMaxTimeSize(8.0);
+
+  for (int i = 0; i < 5; i++)
+    queue.Put(MakePacket(i * DVD_TIME_BASE));
+  EXPECT_FALSE(queue.IsDataBased());
+  EXPECT_EQ(4, queue.GetTimeSize());
+  EXPECT_EQ(50, queue.GetLevel());
+
+  // the level runs from the oldest packet still queued
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  msg->Release();
+  EXPECT_EQ(3, queue.GetTimeSize());
+
+  queue.Flush();
+  EXPECT_EQ(0, queue.GetLevel());
+  queue.Put(MakePacket(10 * DVD_TIME_BASE));
+  queue.Put(MakePacket(12 * DVD_TIME_BASE));
+  EXPECT_EQ(2, queue.GetTimeSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, WakeAndAbort)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  CDVDMsg* msg;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 50));
+  EXPECT_GE(XbmcThreads::SystemClockMillis() - start, 45U);
+
+  queue.Abort();
+  EXPECT_EQ(MSGQ_ABORT, queue.Get(&msg, 1000));
+  EXPECT_TRUE(queue.ReceivedAbortRequest());
+  queue.End();
+}
+
+/*
+  Throughput and latency between one producer and one consumer thread,
+  run with --gtest_also_run_disabled_tests --gtest_filter=TestDVDMessageQueue.*
+*/
+TEST(TestDVDMessageQueue, DISABLED_Benchmark)
+{
+  CListQueue reference;
+  RunBenchmark(reference, "std::list queue");
+
+  CDVDMessageQueue queue("test");
+  queue.Init();
+  RunBenchmark(queue, "ring queue");
+  queue.End();
+}
@@ -0,0 +1,71 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDFileInfo.h"
+#include "cores/dvdplayer/DVDStreamInfo.h"
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoCodec.h"
+
+#include "gtest/gtest.h"
+
+/* mpeg2 always opens the ffmpeg decoder, whatever the hardware */
+class TestDVDThumbContext : public testing::Test
+{
+protected:
+  CDVDVideoCodec* GetCodec(int width, int height)
+  {
+    CDVDStreamInfo hint;
+    hint.type   = STREAM_VIDEO;
+    hint.codec  = AV_CODEC_ID_MPEG2VIDEO;
+    hint.width  = width;
+    hint.height = height;
+    return m_context.GetCodec(hint);
+  }
+
+  CDVDThumbContext m_context;
+};
+
+TEST_F(TestDVDThumbContext, Reuse)
+{
+  CDVDVideoCodec *codec = GetCodec(720, 576);
+  ASSERT_TRUE(codec != NULL);
+  EXPECT_FALSE(m_context.IsReused());
+
+  // a file with the same parameters gets the open decoder
+  EXPECT_EQ(codec, GetCodec(720, 576));
+  EXPECT_TRUE(m_context.IsReused());
+  EXPECT_EQ(codec, GetCodec(720, 576));
+  EXPECT_TRUE(m_context.IsReused());
+}
+
+TEST_F(TestDVDThumbContext, Reopen)
+{
+  ASSERT_TRUE(GetCodec(720, 576) != NULL);
+
+  // other parameters open a new decoder
+  ASSERT_TRUE(GetCodec(720, 480) != NULL);
+  EXPECT_FALSE(m_context.IsReused());
+  EXPECT_TRUE(GetCodec(720, 480) != NULL);
+  EXPECT_TRUE(m_context.IsReused());
+
+  // after a close, as after a failed file, so does the same one
+  m_context.Close();
+  EXPECT_TRUE(GetCodec(720, 480) != NULL);
+  EXPECT_FALSE(m_context.IsReused());
+}
@@ -0,0 +1,145 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoPicturePool.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+namespace
+{
+SPicturePoolFormat Format(int width, int height, int edge = 0, int bpp = 1)
+{
+  SPicturePoolFormat format;
+  format.width    = width;
+  format.height   = height;
+  format.edge     = edge;
+  format.bpp      = bpp;
+  format.cshift_x = 1;
+  format.cshift_y = 1;
+  return format;
+}
+}
+
+TEST(TestDVDVideoPicturePool, Layout)
+{
+  CDVDVideoPicturePool *pool = new CDVDVideoPicturePool();
+
+  const SPicturePoolFormat formats[] = { Format(1920, 1088), Format(1920, 1088, 16), Format(720, 576, 16, 2) };
+  for (unsigned int f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+  {
+    const SPicturePoolFormat &format = formats[f];
+    CDVDVideoPictureBuffer *buffer = pool->Get(format);
+    ASSERT_TRUE(buffer != NULL);
+    EXPECT_TRUE(buffer->data[3] == NULL);
+
+    uint8_t *end = NULL;
+    for (int p = 0; p < 3; ++p)
+    {
+      int sx = p ? format.cshift_x : 0;
+      int sy = p ? format.cshift_y : 0;
+      int w  = (format.width  >> sx) * format.bpp;
+      int h  =  format.height >> sy;
+      int e  =  format.edge   >> sy;
+
+      EXPECT_EQ(0, (intptr_t)buffer->data[p] % 64) << "plane " << p;
+      EXPECT_EQ(0, buffer->iLineSize[p] % 64) << "plane " << p;
+      EXPECT_GE(buffer->iLineSize[p], w + 2 * (format.edge >> sx) * format.bpp);
+
+      // the whole plane including its edge is writable without touching the next one
+      uint8_t *first = buffer->data[p] - e * buffer->iLineSize[p] - (format.edge >> sx) * format.bpp;
+      uint8_t *last  = buffer->data[p] + (h + e) * buffer->iLineSize[p];
+      if (end)
+        EXPECT_LE(end, first) << "plane " << p;
+      memset(first, p, last - first);
+      end = last;
+    }
+    EXPECT_EQ(0, buffer->data[0][0]);
+    EXPECT_EQ(1, buffer->data[1][0]);
+    EXPECT_EQ(2, buffer->data[2][0]);
+    buffer->Release();
+  }
+
+  pool->Release();
+}
+
+TEST(TestDVDVideoPicturePool, Reuse)
+{
+  CDVDVideoPicturePool *pool = new CDVDVideoPicturePool();
+  SPicturePoolFormat format = Format(320, 240);
+
+  CDVDVideoPictureBuffer *a = pool->Get(format);
+  CDVDVideoPictureBuffer *b = pool->Get(format);
+  ASSERT_TRUE(a != NULL && b != NULL);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(2, pool->GetAllocated());
+
+  // the renderer holds a, so it is not handed out again
+  a->Acquire();
+  EXPECT_EQ(1, a->Release());
+  b->Release();
+  CDVDVideoPictureBuffer *c = pool->Get(format);
+  EXPECT_EQ(b, c);
+  EXPECT_EQ(2, pool->GetAllocated());
+
+  a->Release();
+  CDVDVideoPictureBuffer *d = pool->Get(format);
+  EXPECT_EQ(a, d);
+  EXPECT_EQ(2, pool->GetAllocated());
+
+  c->Release();
+  d->Release();
+  pool->Release();
+}
+
+TEST(TestDVDVideoPicturePool, FormatChange)
+{
+  CDVDVideoPicturePool *pool = new CDVDVideoPicturePool();
+
+  CDVDVideoPictureBuffer *a = pool->Get(Format(320, 240));
+  CDVDVideoPictureBuffer *b = pool->Get(Format(320, 240));
+  ASSERT_TRUE(a != NULL && b != NULL);
+  a->Release();
+
+  // the free buffer of the old size goes, the one still out goes once it is back
+  CDVDVideoPictureBuffer *c = pool->Get(Format(640, 480));
+  ASSERT_TRUE(c != NULL);
+  EXPECT_EQ(2, pool->GetAllocated());
+  b->Release();
+  EXPECT_EQ(1, pool->GetAllocated());
+
+  c->Release();
+  EXPECT_EQ(1, pool->GetAllocated());
+  pool->Release();
+}
+
+TEST(TestDVDVideoPicturePool, OutlivesDecoder)
+{
+  CDVDVideoPicturePool *pool = new CDVDVideoPicturePool();
+  CDVDVideoPictureBuffer *buffer = pool->Get(Format(64, 64));
+  ASSERT_TRUE(buffer != NULL);
+
+  // the decoder closes while the renderer still shows the picture
+  pool->Release();
+  memset(buffer->data[0], 0x10, 64);
+  EXPECT_EQ(0x10, buffer->data[0][63]);
+  EXPECT_EQ(0, buffer->Release());
+}
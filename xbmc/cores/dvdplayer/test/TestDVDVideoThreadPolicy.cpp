@@ -0,0 +1,93 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDCodecs/Video/DVDVideoThreadPolicy.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+CDVDVideoThreadPolicy::SStream MakeStream(AVCodecID codec, int height)
+{
+  CDVDVideoThreadPolicy::SStream stream;
+  stream.codec        = codec;
+  stream.capabilities = CODEC_CAP_FRAME_THREADS | CODEC_CAP_SLICE_THREADS;
+  stream.width        = height * 16 / 9;
+  stream.height       = height;
+  stream.realtime     = false;
+  stream.software     = false;
+  stream.allowFrame   = true;
+  return stream;
+}
+}
+
+TEST(TestDVDVideoThreadPolicy, FilesGetThroughput)
+{
+  SThreadingPolicy policy = CDVDVideoThreadPolicy::Choose(MakeStream(AV_CODEC_ID_H264, 1080), 4);
+  EXPECT_EQ(THREADING_FRAME, policy.mode);
+  EXPECT_EQ(4, policy.threads);
+
+  // never more than ffmpeg's limit
+  policy = CDVDVideoThreadPolicy::Choose(MakeStream(AV_CODEC_ID_H264, 1080), 32);
+  EXPECT_EQ(8, policy.threads);
+
+  // without frame threading, slices
+  CDVDVideoThreadPolicy::SStream stream = MakeStream(AV_CODEC_ID_H264, 1080);
+  stream.allowFrame = false;
+  policy = CDVDVideoThreadPolicy::Choose(stream, 4);
+  EXPECT_EQ(THREADING_SLICE, policy.mode);
+  EXPECT_EQ(4, policy.threads);
+}
+
+TEST(TestDVDVideoThreadPolicy, LiveGetsLowLatency)
+{
+  CDVDVideoThreadPolicy::SStream stream = MakeStream(AV_CODEC_ID_H264, 1080);
+  stream.realtime = true;
+  SThreadingPolicy policy = CDVDVideoThreadPolicy::Choose(stream, 8);
+  EXPECT_EQ(THREADING_SLICE, policy.mode);
+  EXPECT_EQ(8, policy.threads);
+
+  // sd slices don't spread over many threads
+  stream = MakeStream(AV_CODEC_ID_H264, 576);
+  stream.realtime = true;
+  policy = CDVDVideoThreadPolicy::Choose(stream, 8);
+  EXPECT_EQ(THREADING_SLICE, policy.mode);
+  EXPECT_EQ(4, policy.threads);
+
+  // mpeg4 has frame threads only, live it is decoded single threaded
+  stream = MakeStream(AV_CODEC_ID_MPEG4, 576);
+  stream.capabilities = CODEC_CAP_FRAME_THREADS;
+  stream.realtime = true;
+  policy = CDVDVideoThreadPolicy::Choose(stream, 8);
+  EXPECT_EQ(THREADING_NONE, policy.mode);
+  EXPECT_EQ(1, policy.threads);
+}
+
+TEST(TestDVDVideoThreadPolicy, SingleThreaded)
+{
+  EXPECT_EQ(1, CDVDVideoThreadPolicy::Choose(MakeStream(AV_CODEC_ID_H264, 1080), 1).threads);
+  EXPECT_EQ(1, CDVDVideoThreadPolicy::Choose(MakeStream(AV_CODEC_ID_MPEG2VIDEO, 1080), 4).threads);
+
+  CDVDVideoThreadPolicy::SStream stream = MakeStream(AV_CODEC_ID_H264, 1080);
+  stream.software = true;
+  SThreadingPolicy policy = CDVDVideoThreadPolicy::Choose(stream, 4);
+  EXPECT_EQ(THREADING_NONE, policy.mode);
+  EXPECT_EQ(1, policy.threads);
+}
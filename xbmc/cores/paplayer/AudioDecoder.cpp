@@ -63,7 +63,7 @@ void CAudioDecoder::Destroy()
   m_canPlay = false;
 }
 
-bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset)
+bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset, unsigned int bufferSeconds)
 {
   Destroy();
 
@@ -99,8 +99,13 @@ bool CAudioDecoder::Create(const CFileItem &file, int64_t seekOffset)
     return false;
   }
 
-  /* allocate the pcmBuffer for 2 seconds of audio */
-  m_pcmBuffer.Create(2 * blockSize * m_codec->m_SampleRate);
+  /* allocate the pcmBuffer, a longer prefetch is bounded by MAX_BUFFER_SIZE
+   * but never gets less than the default */
+  unsigned int secondSize = blockSize * m_codec->m_SampleRate;
+  unsigned int bufferSize = std::max(bufferSeconds, (unsigned int)DEFAULT_BUFFER_SECONDS) * secondSize;
+  if (bufferSize > MAX_BUFFER_SIZE)
+    bufferSize = std::max((unsigned int)MAX_BUFFER_SIZE / blockSize * blockSize, DEFAULT_BUFFER_SECONDS * secondSize);
+  m_pcmBuffer.Create(bufferSize);
 
   // set total time from the given tag
   if (file.HasMusicInfoTag() && file.GetMusicInfoTag()->GetDuration())
@@ -152,6 +157,18 @@ unsigned int CAudioDecoder::GetDataSize()
   return std::min(m_pcmBuffer.getMaxReadSize() / (m_codec->m_BitsPerSample >> 3), (unsigned int)OUTPUT_SAMPLES);
 }
 
+double CAudioDecoder::GetBufferedTime()
+{
+  if (!m_codec || !m_codec->m_SampleRate)
+    return 0.0;
+
+  unsigned int blockSize = (m_codec->m_BitsPerSample >> 3) * m_codec->GetChannelInfo().Count();
+  if (!blockSize)
+    return 0.0;
+
+  return (double)m_pcmBuffer.getMaxReadSize() / blockSize / m_codec->m_SampleRate;
+}
+
 void *CAudioDecoder::GetData(unsigned int samples)
 {
   unsigned int size  = samples * (m_codec->m_BitsPerSample >> 3);
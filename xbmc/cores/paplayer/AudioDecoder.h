@@ -38,6 +38,9 @@ class CFileItem;
 #define OUTPUT_SAMPLES PACKET_SIZE      // max number of output samples
 #define INPUT_SAMPLES  PACKET_SIZE      // number of input samples (distributed over channels)
 
+#define DEFAULT_BUFFER_SECONDS 2                  // seconds of decoded audio the pcm buffer holds
+#define MAX_BUFFER_SIZE        (16 * 1024 * 1024) // upper bound of the pcm buffer for long prefetches
+
 #define STATUS_NO_FILE  0
 #define STATUS_QUEUING  1
 #define STATUS_QUEUED   2
@@ -56,7 +59,7 @@ public:
   CAudioDecoder();
   ~CAudioDecoder();
 
-  bool Create(const CFileItem &file, int64_t seekOffset);
+  bool Create(const CFileItem &file, int64_t seekOffset, unsigned int bufferSeconds = DEFAULT_BUFFER_SECONDS);
   void Destroy();
 
   int ReadSamples(int numsamples);
@@ -73,6 +76,7 @@ public:
   // Data management
   unsigned int GetDataSize();
   void *GetData(unsigned int samples);
+  double GetBufferedTime();  // seconds of decoded audio waiting in the pcm buffer
   ICodec *GetCodec() const { return m_codec; }
   float GetReplayGain();
 
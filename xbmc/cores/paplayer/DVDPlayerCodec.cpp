@@ -22,6 +22,7 @@
 #include "cores/AudioEngine/Utils/AEUtil.h"
 
 #include "cores/dvdplayer/DVDInputStreams/DVDFactoryInputStream.h"
+#include "cores/dvdplayer/DVDInputStreams/DVDInputStreamFile.h"
 #include "cores/dvdplayer/DVDDemuxers/DVDFactoryDemuxer.h"
 #include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
 #include "cores/dvdplayer/DVDStreamInfo.h"
@@ -96,6 +97,10 @@ bool DVDPlayerCodec::Init(const CStdString &strFile, unsigned int filecache)
     return false;
   }
 
+  // local files are handed to the demuxer straight from a mapped view
+  if (m_pInputStream->IsStreamType(DVDSTREAM_TYPE_FILE))
+    ((CDVDInputStreamFile*)m_pInputStream)->MapFile();
+
   m_pDemuxer = NULL;
 
   try
@@ -28,6 +28,7 @@
 #include "utils/log.h"
 #include "utils/MathUtils.h"
 #include "utils/JobManager.h"
+#include "threads/SystemClock.h"
 
 #include "threads/SingleLock.h"
 #include "cores/AudioEngine/AEFactory.h"
@@ -35,6 +36,7 @@
 #include "cores/AudioEngine/Interfaces/AEStream.h"
 
 #define TIME_TO_CACHE_NEXT_FILE 5000 /* 5 seconds before end of song, start caching the next song */
+#define MAX_TIME_TO_CACHE_NEXT_FILE 60000 /* upper bound for slow sources */
 #define FAST_XFADE_TIME           80 /* 80 milliseconds */
 #define MAX_SKIP_XFADE_TIME     2000 /* max 2 seconds crossfade on track skip */
 
@@ -348,7 +350,16 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     m_continueStream = false;
   }
 
-  if (!si->m_decoder.Create(file, (file.m_lStartOffset * 1000) / 75))
+  /* a queued stream decodes ahead while the current one is still playing,
+   * the first one starts as soon as it has the default buffer */
+  unsigned int bufferSeconds = DEFAULT_BUFFER_SECONDS;
+  if (job && m_currentStream)
+    bufferSeconds = g_advancedSettings.m_musicPrefetchSeconds;
+
+  si->m_prefetchStart = XbmcThreads::SystemClockMillis();
+  si->m_firstSampleMS = -1;
+
+  if (!si->m_decoder.Create(file, (file.m_lStartOffset * 1000) / 75, bufferSeconds))
   {
     CLog::Log(LOGWARNING, "PAPlayer::QueueNextFileEx - Failed to create the decoder");
 
@@ -360,10 +371,16 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     return false;
   }
 
-  /* decode until there is data-available */
+  si->m_openMS = XbmcThreads::SystemClockMillis() - si->m_prefetchStart;
+
+  /* decode until there is data-available, the decoder holds it back until
+   * its buffer is filled */
   si->m_decoder.Start();
   while(si->m_decoder.GetDataSize() == 0)
   {
+    if (si->m_firstSampleMS < 0 && si->m_decoder.GetBufferedTime() > 0.0)
+      si->m_firstSampleMS = XbmcThreads::SystemClockMillis() - si->m_prefetchStart;
+
     int status = si->m_decoder.GetStatus();
     if (status == STATUS_ENDED   ||
         status == STATUS_NO_FILE ||
@@ -384,6 +401,10 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     CThread::Sleep(1);
   }
 
+  si->m_prefetchMS = XbmcThreads::SystemClockMillis() - si->m_prefetchStart;
+  if (si->m_firstSampleMS < 0)
+    si->m_firstSampleMS = si->m_prefetchMS;
+
   /* init the streaminfo struct */
   si->m_decoder.GetDataFormat(&si->m_channelInfo, &si->m_sampleRate, &si->m_encodedSampleRate, &si->m_dataFormat);
   si->m_startOffset        = file.m_lStartOffset * 1000 / 75;
@@ -404,12 +425,24 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
   if (si->m_endOffset)
     streamTotalTime = si->m_endOffset - si->m_startOffset;
   
+  /* open, probe and decode ahead of remote songs can take a while on
+   * SMB/NFS/UPnP, give the next one time for the whole prefetch. The next
+   * song most likely comes from the same place, so it gets twice the time
+   * this one took to prefetch */
+  si->m_prepareLeadMS = TIME_TO_CACHE_NEXT_FILE + 2 * si->m_prefetchMS;
+  if (file.IsRemote())
+    si->m_prepareLeadMS = std::max(si->m_prepareLeadMS, (unsigned int)(TIME_TO_CACHE_NEXT_FILE + g_advancedSettings.m_musicPrefetchSeconds * 1000));
+  si->m_prepareLeadMS = std::min(si->m_prepareLeadMS, (unsigned int)MAX_TIME_TO_CACHE_NEXT_FILE);
+
   si->m_prepareNextAtFrame = 0;
   // cd drives don't really like it to be crossfaded or prepared
   if(!file.IsCDDA())
   {
-    if (streamTotalTime >= TIME_TO_CACHE_NEXT_FILE + m_defaultCrossfadeMS)
-      si->m_prepareNextAtFrame = (int)((streamTotalTime - TIME_TO_CACHE_NEXT_FILE - m_defaultCrossfadeMS) * si->m_sampleRate / 1000.0f);
+    unsigned int lead = si->m_prepareLeadMS;
+    if (streamTotalTime < lead + m_defaultCrossfadeMS)
+      lead = TIME_TO_CACHE_NEXT_FILE;
+    if (streamTotalTime >= lead + m_defaultCrossfadeMS)
+      si->m_prepareNextAtFrame = (int)((streamTotalTime - lead - m_defaultCrossfadeMS) * si->m_sampleRate / 1000.0f);
   }
 
   if (m_currentStream && (AE_IS_RAW(m_currentStream->m_dataFormat) || AE_IS_RAW(si->m_dataFormat)))
@@ -442,6 +475,10 @@ bool PAPlayer::QueueNextFileEx(const CFileItem &file, bool fadeIn/* = true */, b
     return false;
   }
 
+  si->m_readyAt = XbmcThreads::SystemClockMillis();
+  CLog::Log(LOGDEBUG, "PAPlayer::QueueNextFileEx - Prefetched %.1fs in %d ms, open %d ms, first sample %d ms, ready %u ms, next prepared %u ms ahead",
+            si->m_decoder.GetBufferedTime(), si->m_prefetchMS, si->m_openMS, si->m_firstSampleMS, si->m_readyAt - si->m_prefetchStart, si->m_prepareLeadMS);
+
   /* add the stream to the list */
   CExclusiveLock lock(m_streamsLock);
   m_streams.push_back(si);
@@ -719,6 +756,9 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
       si->m_stream->Resume();
     si->m_stream->FadeVolume(0.0f, 1.0f, m_upcomingCrossfadeMS);
     m_callback.OnPlayBackStarted();
+
+    CLog::Log(LOGINFO, "PAPlayer::ProcessStream - Stream started, time to first sample %d ms, ready %u ms before start with %.1fs decoded ahead",
+              si->m_firstSampleMS, XbmcThreads::SystemClockMillis() - si->m_readyAt, si->m_decoder.GetBufferedTime());
   }
 
   /* if we have not started yet and the stream has been primed */
@@ -780,9 +820,12 @@ inline bool PAPlayer::ProcessStream(StreamInfo *si, double &freeBufferTime)
         streamTotalTime = si->m_endOffset - si->m_startOffset;
 
       // calculate time when to prepare next stream
+      unsigned int lead = si->m_prepareLeadMS;
+      if (streamTotalTime < lead + m_defaultCrossfadeMS)
+        lead = TIME_TO_CACHE_NEXT_FILE;
       si->m_prepareNextAtFrame = 0;
-      if (streamTotalTime >= TIME_TO_CACHE_NEXT_FILE + m_defaultCrossfadeMS)
-        si->m_prepareNextAtFrame = (int)((streamTotalTime - TIME_TO_CACHE_NEXT_FILE - m_defaultCrossfadeMS) * si->m_sampleRate / 1000.0f);
+      if (streamTotalTime >= lead + m_defaultCrossfadeMS)
+        si->m_prepareNextAtFrame = (int)((streamTotalTime - lead - m_defaultCrossfadeMS) * si->m_sampleRate / 1000.0f);
 
       si->m_prepareTriggered = false;
       si->m_playNextAtFrame = 0;
@@ -119,6 +119,13 @@ private:
 
     bool              m_isSlaved;            /* true if the stream has been slaved to another */
     bool              m_waitOnDrain;         /* wait for stream being drained in AE */
+
+    unsigned int      m_prepareLeadMS;       /* how long before its end the next stream gets prepared */
+    unsigned int      m_prefetchStart;       /* clock when opening the stream started */
+    int               m_openMS;              /* time it took to open the decoder */
+    int               m_firstSampleMS;       /* time to the first decoded sample, -1 while there is none */
+    int               m_prefetchMS;          /* time to fill the decoded-ahead buffer */
+    unsigned int      m_readyAt;             /* clock when the stream was ready to play */
   } StreamInfo;
 
   typedef std::list<StreamInfo*> StreamList;
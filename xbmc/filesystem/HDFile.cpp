@@ -33,6 +33,7 @@
 #ifdef TARGET_POSIX
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #else
 #include <io.h>
 #include "utils/CharsetConverter.h"
@@ -52,7 +53,12 @@ using namespace XFILE;
 //*********************************************************************************************
 CHDFile::CHDFile()
     : m_hFile(INVALID_HANDLE_VALUE),
-      m_i64LastDropPos(0)
+      m_i64LastDropPos(0),
+      m_mapData(NULL),
+      m_mapSize(0)
+#ifdef TARGET_WINDOWS
+    , m_hMapping(NULL)
+#endif
 {}
 
 //*********************************************************************************************
@@ -241,6 +247,7 @@ int CHDFile::Write(const void *lpBuf, int64_t uiBufSize)
 //*********************************************************************************************
 void CHDFile::Close()
 {
+  Unmap();
   m_hFile.reset();
 }
 
@@ -340,9 +347,72 @@ int CHDFile::IoControl(EIoControl request, void* param)
     return ioctl((*m_hFile).fd, s->request, s->param);
   }
 #endif
+  if(request == IOCTRL_MMAP && param)
+    return Map(*(SMappedView*)param) ? 0 : -1;
+
   return -1;
 }
 
+//*********************************************************************************************
+bool CHDFile::Map(SMappedView &view)
+{
+  if (!m_hFile.isValid())
+    return false;
+
+  if (!m_mapData)
+  {
+    int64_t length = GetLength();
+    if (length <= 0 || (uint64_t)length > (uint64_t)(size_t)-1)
+      return false;
+
+#ifdef TARGET_WINDOWS
+    m_hMapping = CreateFileMapping((HANDLE)m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m_hMapping)
+      return false;
+
+    m_mapData = MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m_mapData)
+    {
+      CloseHandle(m_hMapping);
+      m_hMapping = NULL;
+      return false;
+    }
+#else
+    void *data = mmap(NULL, (size_t)length, PROT_READ, MAP_SHARED, (*m_hFile).fd, 0);
+    if (data == MAP_FAILED)
+    {
+      CLog::Log(LOGDEBUG, "CHDFile::Map - mmap failed with errno %d", errno);
+      return false;
+    }
+    // the view is read front to back, let the kernel read ahead
+    madvise(data, (size_t)length, MADV_SEQUENTIAL);
+    m_mapData = data;
+#endif
+    m_mapSize = length;
+  }
+
+  view.data = (const uint8_t*)m_mapData;
+  view.size = m_mapSize;
+  return true;
+}
+
+//*********************************************************************************************
+void CHDFile::Unmap()
+{
+  if (!m_mapData)
+    return;
+
+#ifdef TARGET_WINDOWS
+  UnmapViewOfFile(m_mapData);
+  CloseHandle(m_hMapping);
+  m_hMapping = NULL;
+#else
+  munmap(m_mapData, (size_t)m_mapSize);
+#endif
+  m_mapData = NULL;
+  m_mapSize = 0;
+}
+
 int CHDFile::Truncate(int64_t size)
 {
 #ifdef TARGET_WINDOWS
@@ -65,6 +65,14 @@ protected:
   int64_t m_i64FilePos;
   int64_t m_i64FileLen;
   int64_t m_i64LastDropPos;
+
+  bool Map(SMappedView &view);
+  void Unmap();
+  void*   m_mapData;
+  int64_t m_mapSize;
+#ifdef TARGET_WINDOWS
+  HANDLE  m_hMapping;
+#endif
 };
 
 }
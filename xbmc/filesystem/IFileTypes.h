@@ -37,12 +37,19 @@ struct SCacheStatus
   bool     full;     /**< is the cache full */
 };
 
+struct SMappedView
+{
+  const uint8_t* data; /**< start of the file */
+  int64_t        size; /**< bytes mapped, the whole file */
+};
+
 typedef enum {
   IOCTRL_NATIVE        = 1, /**< SNativeIoControl structure, containing what should be passed to native ioctrl */
   IOCTRL_SEEK_POSSIBLE = 2, /**< return 0 if known not to work, 1 if it should work */
   IOCTRL_CACHE_STATUS  = 3, /**< SCacheStatus structure */
   IOCTRL_CACHE_SETRATE = 4, /**< unsigned int with speed limit for caching in bytes per second */
   IOCTRL_SET_CACHE    = 8, /** <CFileCache */
+  IOCTRL_MMAP          = 9, /**< SMappedView structure, read only view of the file, valid until it is closed */
 } EIoControl;
 
 }
@@ -218,3 +218,29 @@ TEST(TestFile, SetHidden)
   EXPECT_TRUE(XFILE::CFile::Exists(XBMC_TEMPFILEPATH(file)));
   EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
 }
+
+TEST(TestFile, Mmap)
+{
+  XFILE::CFile file;
+  XFILE::SMappedView view;
+  char buf[64];
+
+  ASSERT_TRUE(file.Open(
+    XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt")));
+  ASSERT_EQ(0, file.IoControl(XFILE::IOCTRL_MMAP, &view));
+  ASSERT_TRUE(view.data != NULL);
+  EXPECT_EQ(file.GetLength(), view.size);
+
+  /* the view shows the file regardless of the read position */
+  EXPECT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(memcmp(view.data, buf, sizeof(buf)) == 0);
+  EXPECT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+  EXPECT_TRUE(memcmp(view.data + sizeof(buf), buf, sizeof(buf)) == 0);
+  file.Close();
+
+  /* the file cache can not be mapped */
+  ASSERT_TRUE(file.Open(
+    XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt"), READ_CACHED));
+  EXPECT_EQ(-1, file.IoControl(XFILE::IOCTRL_MMAP, &view));
+  file.Close();
+}
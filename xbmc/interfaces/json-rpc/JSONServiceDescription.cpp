@@ -230,7 +230,8 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
 
 // XBMC operations
   { "XBMC.GetInfoLabels",                           CXBMCOperations::GetInfoLabels },
-  { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans }
+  { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans },
+  { "XBMC.GetAudioTelemetry",                       CXBMCOperations::GetAudioTelemetry }
 };
 
 JSONSchemaTypeDefinition::JSONSchemaTypeDefinition()
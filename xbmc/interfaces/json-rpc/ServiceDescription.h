@@ -22,7 +22,7 @@
 namespace JSONRPC
 {
   const char* const JSONRPC_SERVICE_ID          = "http://xbmc.org/jsonrpc/ServiceDescription.json";
-  const char* const JSONRPC_SERVICE_VERSION     = "6.14.3";
+  const char* const JSONRPC_SERVICE_VERSION     = "6.15.0";
   const char* const JSONRPC_SERVICE_DESCRIPTION = "JSON-RPC API of XBMC";
 
   const char* const JSONRPC_SERVICE_TYPES[] = {  
@@ -521,6 +521,17 @@ namespace JSONRPC
         "\"albumartistid\": { \"$ref\": \"Array.Integer\" }"
       "}"
     "}",
+    "\"Audio.Telemetry.Stage\": {"
+      "\"type\": \"object\","
+      "\"properties\": {"
+        "\"count\": { \"type\": \"integer\", \"required\": true },"
+        "\"mean\": { \"type\": \"number\", \"required\": true, \"description\": \"Microseconds\" },"
+        "\"p50\": { \"type\": \"integer\", \"required\": true, \"description\": \"Upper bound in microseconds\" },"
+        "\"p99\": { \"type\": \"integer\", \"required\": true, \"description\": \"Upper bound in microseconds\" },"
+        "\"max\": { \"type\": \"integer\", \"required\": true, \"description\": \"Microseconds\" },"
+        "\"histogram\": { \"type\": \"array\", \"required\": true, \"items\": { \"type\": \"integer\" }, \"description\": \"Entry n counts values from 2^(n-1) to below 2^n microseconds, the last one all above\" }"
+      "}"
+    "}",
     "\"Video.Fields.Movie\": {"
       "\"extends\": \"Item.Fields.Base\","
       "\"items\": { \"type\": \"string\","
@@ -3862,6 +3873,30 @@ namespace JSONRPC
         "\"additionalProperties\": { \"type\": \"string\" }"
       "}"
     "}",
+    "\"XBMC.GetAudioTelemetry\": {"
+      "\"type\": \"method\","
+      "\"description\": \"Retrieve timing histograms and underrun counters of the audio engine and its sink\","
+      "\"transport\": \"Response\","
+      "\"permission\": \"ReadData\","
+      "\"params\": [],"
+      "\"returns\": {"
+        "\"type\": \"object\","
+        "\"properties\": {"
+          "\"stages\": { \"type\": \"object\", \"required\": true,"
+            "\"properties\": {"
+              "\"resample\": { \"$ref\": \"Audio.Telemetry.Stage\", \"required\": true },"
+              "\"mix\": { \"$ref\": \"Audio.Telemetry.Stage\", \"required\": true },"
+              "\"encode\": { \"$ref\": \"Audio.Telemetry.Stage\", \"required\": true },"
+              "\"sinkwrite\": { \"$ref\": \"Audio.Telemetry.Stage\", \"required\": true },"
+              "\"sinkdelay\": { \"$ref\": \"Audio.Telemetry.Stage\", \"required\": true }"
+            "}"
+          "},"
+          "\"underruns\": { \"type\": \"integer\", \"required\": true },"
+          "\"latebuffers\": { \"type\": \"integer\", \"required\": true },"
+          "\"sinkreopens\": { \"type\": \"integer\", \"required\": true }"
+        "}"
+      "}"
+    "}",
     "\"Favourites.GetFavourites\": {"
       "\"type\": \"method\","
       "\"description\": \"Retrieve all favourites\","
@@ -23,6 +23,8 @@
 #include "Util.h"
 #include "utils/Variant.h"
 #include "powermanagement/PowerManager.h"
+#include "cores/AudioEngine/AEFactory.h"
+#include "cores/AudioEngine/Utils/AETelemetry.h"
 
 using namespace JSONRPC;
 
@@ -92,3 +94,38 @@ JSONRPC_STATUS CXBMCOperations::GetInfoBooleans(const CStdString &method, ITrans
 
   return OK;
 }
+
+JSONRPC_STATUS CXBMCOperations::GetAudioTelemetry(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  const CAETelemetry *telemetry = CAEFactory::GetTelemetry();
+  if (!telemetry)
+    return FailedToExecute;
+
+  AETelemetrySnapshot snapshot;
+  telemetry->GetSnapshot(snapshot);
+
+  result["stages"] = CVariant(CVariant::VariantTypeObject);
+  for (int i = 0; i < AE_TELEMETRY_STAGES; i++)
+  {
+    // the engine cycle is for xbmc-aebench, it is not part of the api
+    if (i == AE_TELEMETRY_CYCLE)
+      continue;
+
+    const AETelemetryStageStats &stats = snapshot.stages[i];
+    CVariant stage(CVariant::VariantTypeObject);
+    stage["count"] = stats.count;
+    stage["mean"] = stats.mean;
+    stage["p50"] = stats.p50;
+    stage["p99"] = stats.p99;
+    stage["max"] = stats.max;
+    stage["histogram"] = CVariant(CVariant::VariantTypeArray);
+    for (int b = 0; b < AE_TELEMETRY_BUCKETS; b++)
+      stage["histogram"].push_back(stats.buckets[b]);
+    result["stages"][CAETelemetry::StageName((AETelemetryStage)i)] = stage;
+  }
+
+  for (int i = 0; i < AE_TELEMETRY_COUNTERS; i++)
+    result[CAETelemetry::CounterName((AETelemetryCounter)i)] = snapshot.counters[i];
+
+  return OK;
+}
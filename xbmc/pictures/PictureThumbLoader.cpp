@@ -31,6 +31,7 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "video/VideoThumbLoader.h"
+#include "video/ThumbExtractionService.h"
 
 using namespace XFILE;
 using namespace std;
@@ -42,6 +43,7 @@ CPictureThumbLoader::CPictureThumbLoader() : CThumbLoader(), CJobQueue(true, 1,
 
 CPictureThumbLoader::~CPictureThumbLoader()
 {
+  CThumbExtractionService::Get().CancelJobs(this);
   StopThread();
 }
 
@@ -95,7 +97,7 @@ bool CPictureThumbLoader::LoadItemCached(CFileItem* pItem)
       {
         CFileItem item(*pItem);
         CThumbExtractor* extract = new CThumbExtractor(item, pItem->GetPath(), true, thumbURL);
-        AddJob(extract);
+        CThumbExtractionService::Get().AddJob(extract, this);
         thumb.clear();
       }
     }
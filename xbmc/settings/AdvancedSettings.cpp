@@ -181,6 +181,12 @@ void CAdvancedSettings::Initialize()
 
   m_videoDefaultLatency = 0.0;
   m_videoDisableHi10pMultithreading = false;
+  m_videoReadAheadSize = 8 * 1024 * 1024;
+  m_videoReadAheadTime = 2.0f;
+  m_videoRenderBuffers = 0;
+  m_videoRenderDumpPath.clear();
+  m_videoRenderChecksums = false;
+  m_videoSoftwareRenderer = false;
 
   m_musicUseTimeSeeking = true;
   m_musicTimeSeekForward = 10;
@@ -191,6 +197,7 @@ void CAdvancedSettings::Initialize()
   m_musicPercentSeekBackward = -1;
   m_musicPercentSeekForwardBig = 10;
   m_musicPercentSeekBackwardBig = -10;
+  m_musicPrefetchSeconds = 10;
 
   m_slideshowPanAmount = 2.5f;
   m_slideshowZoomAmount = 5.0f;
@@ -495,6 +502,8 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "percentseekforwardbig", m_musicPercentSeekForwardBig, 0, 100);
     XMLUtils::GetInt(pElement, "percentseekbackwardbig", m_musicPercentSeekBackwardBig, -100, 0);
 
+    XMLUtils::GetInt(pElement, "prefetchseconds", m_musicPrefetchSeconds, 2, 30);
+
     TiXmlElement* pAudioExcludes = pElement->FirstChildElement("excludefromlisting");
     if (pAudioExcludes)
       GetCustomRegexps(pAudioExcludes, m_audioExcludeFromListingRegExps);
@@ -598,6 +607,12 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement,"enablehighqualityhwscalers", m_videoEnableHighQualityHwScalers);
     XMLUtils::GetFloat(pElement,"autoscalemaxfps",m_videoAutoScaleMaxFps, 0.0f, 1000.0f);
     XMLUtils::GetBoolean(pElement,"disablehi10pmultithreading",m_videoDisableHi10pMultithreading);
+    XMLUtils::GetInt(pElement, "readaheadsize", m_videoReadAheadSize, 0, 64 * 1024 * 1024);
+    XMLUtils::GetFloat(pElement, "readaheadtime", m_videoReadAheadTime, 0.5f, 30.0f);
+    XMLUtils::GetInt(pElement, "renderbuffers", m_videoRenderBuffers, 0, 8);
+    XMLUtils::GetPath(pElement, "renderdumppath", m_videoRenderDumpPath);
+    XMLUtils::GetBoolean(pElement, "renderchecksums", m_videoRenderChecksums);
+    XMLUtils::GetBoolean(pElement, "softwarerenderer", m_videoSoftwareRenderer);
     XMLUtils::GetBoolean(pElement, "disablebackgrounddeinterlace", m_videoDisableBackgroundDeinterlace);
     XMLUtils::GetInt(pElement, "useocclusionquery", m_videoCaptureUseOcclusionQuery, -1, 1);
     XMLUtils::GetBoolean(pElement,"vdpauInvTelecine",m_videoVDPAUtelecine);
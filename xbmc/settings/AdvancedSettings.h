@@ -171,6 +171,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_musicPercentSeekBackward;
     int m_musicPercentSeekForwardBig;
     int m_musicPercentSeekBackwardBig;
+    int m_musicPrefetchSeconds;
     int m_videoBlackBarColour;
     int m_videoIgnoreSecondsAtStart;
     float m_videoIgnorePercentAtEnd;
@@ -193,6 +194,12 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int  m_videoFpsDetect;
     int  m_videoBusyDialogDelay_ms;
     bool m_videoDisableHi10pMultithreading;
+    int   m_videoReadAheadSize;     // bytes the demux read ahead thread buffers, 0 disables it
+    float m_videoReadAheadTime;     // seconds the demux read ahead thread buffers
+    int   m_videoRenderBuffers;     // pictures the renderer queues, 0 picks them by decoder latency
+    CStdString m_videoRenderDumpPath; // the software renderer writes every frame there, empty if not
+    bool  m_videoRenderChecksums;   // the software renderer logs a checksum of every frame
+    bool  m_videoSoftwareRenderer;  // video is rendered into memory by the software renderer, e.g. without a display
     StagefrightConfig m_stagefrightConfig;
 
     CStdString m_videoDefaultPlayer;
@@ -0,0 +1,95 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "threads/Atomics.h"
+#include "threads/Helpers.h"
+
+#include <vector>
+
+namespace XbmcThreads
+{
+  /**
+   * A bounded queue for exactly one producer thread and one consumer
+   *  thread that never takes a lock. The fill count is the only shared
+   *  variable, it is updated with the (fully fenced) atomics after a
+   *  slot has been written or read, so a slot is never seen half done.
+   *
+   * Clear must only be called while neither side is touching the
+   *  queue. Reserve must only be called on an empty queue, the other
+   *  side may poll it meanwhile as an empty queue is only read through
+   *  the fill count.
+   */
+  template <class T> class SPSCQueue : public NonCopyable
+  {
+    std::vector<T> m_slots;
+    unsigned int m_read;    // consumer only
+    unsigned int m_write;   // producer only
+    volatile long m_count;
+
+  public:
+    inline SPSCQueue() : m_read(0), m_write(0), m_count(0) {}
+
+    inline void Reserve(unsigned int capacity)
+    {
+      m_slots.resize(capacity);
+      m_read = m_write = 0;
+    }
+
+    inline void Clear()
+    {
+      m_read = m_write = 0;
+      m_count = 0;
+    }
+
+    inline unsigned int Capacity() const { return m_slots.size(); }
+
+    inline long Size() { return AtomicAdd(&m_count, 0); }
+
+    inline bool Empty() { return Size() == 0; }
+
+    /**
+     * Returns the number of queued items including the new one, or 0
+     *  if the queue is full. A result of 1 means the consumer may be
+     *  waiting for it.
+     */
+    inline long Push(const T &value)
+    {
+      if ((unsigned long)Size() >= m_slots.size())
+        return 0;
+      m_slots[m_write] = value;
+      if (++m_write == m_slots.size())
+        m_write = 0;
+      return AtomicIncrement(&m_count);
+    }
+
+    inline bool Pop(T &value)
+    {
+      if (Size() == 0)
+        return false;
+      value = m_slots[m_read];
+      if (++m_read == m_slots.size())
+        m_read = 0;
+      AtomicDecrement(&m_count);
+      return true;
+    }
+  };
+}
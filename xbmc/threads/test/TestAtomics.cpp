@@ -174,3 +174,13 @@ TEST(TestAtomic, Subtract)
   EXPECT_EQ(STARTVAL - 123l, check);
 }
 
+
+TEST(TestAtomic, CasPtr)
+{
+  int a, b;
+  void* volatile check = &a;
+  EXPECT_EQ((void*)&a, casptr(&check, &b, NULL));
+  EXPECT_EQ((void*)&a, check);
+  EXPECT_EQ((void*)&a, casptr(&check, &a, &b));
+  EXPECT_EQ((void*)&b, check);
+}
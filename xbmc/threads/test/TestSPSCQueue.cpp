@@ -0,0 +1,98 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestHelpers.h"
+#include "threads/SPSCQueue.h"
+
+#define TESTNUM 100000l
+
+using namespace XbmcThreads;
+
+class DoProduce : public IRunnable
+{
+  SPSCQueue<long>& queue;
+public:
+  inline DoProduce(SPSCQueue<long>& q) : queue(q) {}
+
+  virtual void Run()
+  {
+    for (long i = 1; i <= TESTNUM; )
+    {
+      if (queue.Push(i))
+        i++;
+      else
+        SleepMillis(1);
+    }
+  }
+};
+
+TEST(TestSPSCQueue, Bounds)
+{
+  SPSCQueue<long> queue;
+  queue.Reserve(3);
+  long value = 0;
+
+  EXPECT_FALSE(queue.Pop(value));
+  EXPECT_EQ(1, queue.Push(1));
+  EXPECT_EQ(2, queue.Push(2));
+  EXPECT_EQ(3, queue.Push(3));
+  EXPECT_EQ(0, queue.Push(4));
+
+  // wrap around
+  EXPECT_TRUE(queue.Pop(value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(3, queue.Push(4));
+  for (long i = 2; i <= 4; i++)
+  {
+    EXPECT_TRUE(queue.Pop(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_TRUE(queue.Empty());
+
+  queue.Push(5);
+  queue.Clear();
+  EXPECT_FALSE(queue.Pop(value));
+}
+
+TEST(TestSPSCQueue, ProducerConsumer)
+{
+  SPSCQueue<long> queue;
+  queue.Reserve(1024);
+
+  DoProduce producer(queue);
+  thread t(producer);
+
+  // everything has to arrive exactly once and in order
+  long expected = 1;
+  long value;
+  while (expected <= TESTNUM)
+  {
+    if (queue.Pop(value))
+    {
+      ASSERT_EQ(expected, value);
+      expected++;
+    }
+    else
+      SleepMillis(1);
+  }
+
+  EXPECT_TRUE(t.timed_join(MILLIS(10000)));
+  EXPECT_TRUE(queue.Empty());
+}
@@ -0,0 +1,391 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ThumbExtractionService.h"
+#include "VideoThumbLoader.h"
+#include "URL.h"
+#include "cores/dvdplayer/DVDFileInfo.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#include "system.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#define MAX_WORKERS 8
+
+using namespace std;
+
+class CThumbExtractionWorker : public CThread
+{
+public:
+  CThumbExtractionWorker(CThumbExtractionService *owner);
+  virtual ~CThumbExtractionWorker();
+
+protected:
+  virtual void Process();
+
+  CThumbExtractionService *m_owner;
+  CDVDThumbContext          m_context;
+};
+
+CThumbExtractionWorker::CThumbExtractionWorker(CThumbExtractionService *owner)
+  : CThread("ThumbExtractor"),
+    m_owner(owner)
+{
+  Create(true); // start work immediately, and kill ourselves when we're done
+}
+
+CThumbExtractionWorker::~CThumbExtractionWorker()
+{
+  m_owner->RemoveWorker(this);
+  if (!IsAutoDelete())
+    StopThread();
+}
+
+void CThumbExtractionWorker::Process()
+{
+  SetPriority(GetMinPriority());
+  while (true)
+  {
+    // blocks until there is a job, NULL once we've been idle for a while
+    CThumbExtractor *job = m_owner->GetNextJob(this);
+    if (!job)
+      break;
+
+    bool success = false;
+    job->m_context = &m_context;
+    try
+    {
+      success = job->DoWork();
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "%s error extracting from %s", __FUNCTION__, CURL::GetRedacted(job->m_item.GetPath()).c_str());
+      m_context.Close();
+    }
+    job->m_context = NULL;
+    m_owner->OnJobComplete(job, success, m_context.IsReused());
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CThumbExtractionService& CThumbExtractionService::Get()
+{
+  static CThumbExtractionService sThumbExtractionService;
+  return sThumbExtractionService;
+}
+
+CThumbExtractionService::CThumbExtractionService()
+{
+  m_running     = true;
+  m_batchStart  = 0;
+  m_batchTime   = 0;
+  m_peakWorkers = 0;
+  m_done        = 0;
+  m_failed      = 0;
+  m_duplicates  = 0;
+  m_reused      = 0;
+}
+
+CThumbExtractionService::~CThumbExtractionService()
+{
+}
+
+unsigned int CThumbExtractionService::GetMaxWorkers(int cpus, bool remote)
+{
+  // a worker decodes on one cpu, one is left for the gui. workers reading
+  // from a share spend most of their time waiting on it
+  unsigned int workers = std::max(1, cpus - 1);
+  if (remote)
+    workers *= 2;
+  return std::min(workers, (unsigned int)MAX_WORKERS);
+}
+
+bool CThumbExtractionService::AddJob(CThumbExtractor *job, IJobCallback *callback)
+{
+  CSingleLock lock(m_section);
+
+  if (!m_running)
+  {
+    delete job;
+    return false;
+  }
+
+  // a thumb job fills the stream details as well, a details job for the same
+  // item is replaced by it. the other way round the new job is a duplicate
+  for (Queue::iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+  {
+    if (!(*it->job == job))
+      continue;
+
+    bool replace = job->m_thumb && !it->job->m_thumb;
+    if (replace)
+      std::swap(it->job, job);
+    if (callback && find(it->callbacks.begin(), it->callbacks.end(), callback) == it->callbacks.end())
+      it->callbacks.push_back(callback);
+    delete job;
+    m_duplicates++;
+    return replace;
+  }
+  for (Processing::iterator it = m_processing.begin(); it != m_processing.end(); ++it)
+  {
+    if (!(*it->job == job) || (job->m_thumb && !it->job->m_thumb))
+      continue;
+
+    if (callback && find(it->callbacks.begin(), it->callbacks.end(), callback) == it->callbacks.end())
+      it->callbacks.push_back(callback);
+    delete job;
+    m_duplicates++;
+    return false;
+  }
+
+  if (m_queue.empty() && m_processing.empty())
+  {
+    m_batchStart  = XbmcThreads::SystemClockMillis();
+    m_batchTime   = 0;
+    m_peakWorkers = m_workers.size();
+    m_done        = 0;
+    m_failed      = 0;
+    m_duplicates  = 0;
+    m_reused      = 0;
+  }
+
+  SItem item;
+  item.job    = job;
+  item.remote = URIUtils::IsRemote(job->m_item.GetPath());
+  if (callback)
+    item.callbacks.push_back(callback);
+  m_queue.push_back(item);
+
+  StartWorkers();
+  return true;
+}
+
+void CThumbExtractionService::CancelJobs(IJobCallback *callback)
+{
+  // once we hold the callback section no worker is inside a callback
+  CSingleLock callbackLock(m_callbackSection);
+  CSingleLock lock(m_section);
+
+  for (Queue::iterator it = m_queue.begin(); it != m_queue.end(); )
+  {
+    vector<IJobCallback*>::iterator i = find(it->callbacks.begin(), it->callbacks.end(), callback);
+    if (i == it->callbacks.end())
+    {
+      ++it;
+      continue;
+    }
+    it->callbacks.erase(i);
+    if (it->callbacks.empty())
+    {
+      delete it->job;
+      it = m_queue.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  for (Processing::iterator it = m_processing.begin(); it != m_processing.end(); ++it)
+    it->callbacks.erase(remove(it->callbacks.begin(), it->callbacks.end(), callback), it->callbacks.end());
+}
+
+void CThumbExtractionService::Stop()
+{
+  CSingleLock callbackLock(m_callbackSection);
+  CSingleLock lock(m_section);
+  m_running = false;
+
+  for (Queue::iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+    delete it->job;
+  m_queue.clear();
+
+  for (Processing::iterator it = m_processing.begin(); it != m_processing.end(); ++it)
+    it->callbacks.clear();
+  callbackLock.Leave();
+
+  // tell our workers to finish, the ones extracting finish their file first
+  while (m_workers.size())
+  {
+    lock.Leave();
+    m_jobEvent.Set();
+    Sleep(0); // yield after setting the event to give the workers some time to die
+    lock.Enter();
+  }
+}
+
+void CThumbExtractionService::Restart()
+{
+  CSingleLock lock(m_section);
+
+  if (m_running)
+    throw std::logic_error("CThumbExtractionService already running");
+  m_running = true;
+}
+
+CThumbExtractionService::SStats CThumbExtractionService::GetStats() const
+{
+  CSingleLock lock(m_section);
+
+  SStats stats;
+  stats.queued     = m_queue.size();
+  stats.running    = m_processing.size();
+  stats.workers    = m_workers.size();
+  stats.done       = m_done;
+  stats.failed     = m_failed;
+  stats.duplicates = m_duplicates;
+  stats.reused     = m_reused;
+
+  unsigned int elapsed = m_batchTime ? m_batchTime : XbmcThreads::SystemClockMillis() - m_batchStart;
+  stats.itemsPerSecond = m_done && elapsed ? m_done * 1000.0f / elapsed : 0.0f;
+  return stats;
+}
+
+void CThumbExtractionService::StartWorkers()
+{
+  // wake a sleeping worker. workers that just started count as sleeping, so
+  // there are more workers whenever the queue outgrows them
+  unsigned int idle = m_workers.size() - m_processing.size();
+  if (idle)
+    m_jobEvent.Set();
+
+  if (m_queue.size() > idle && m_workers.size() < GetMaxWorkers(g_cpuInfo.getCPUCount(), m_queue.back().remote))
+  {
+    m_workers.push_back(new CThumbExtractionWorker(this));
+    m_peakWorkers = std::max(m_peakWorkers, (unsigned int)m_workers.size());
+  }
+}
+
+CThumbExtractor* CThumbExtractionService::PopJob()
+{
+  // the newest job first, the loaders ask for the items on screen last
+  int cpus = g_cpuInfo.getCPUCount();
+  for (Queue::reverse_iterator it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+  {
+    if (m_processing.size() >= GetMaxWorkers(cpus, it->remote))
+      continue;
+
+    CThumbExtractor *job = it->job;
+    m_processing.push_back(*it);
+    m_queue.erase(--it.base());
+    return job;
+  }
+  return NULL;
+}
+
+CThumbExtractor* CThumbExtractionService::GetNextJob(const CThumbExtractionWorker *worker)
+{
+  CSingleLock lock(m_section);
+  while (m_running)
+  {
+    // extraction pauses along with the pausable jobs while a video plays
+    bool paused = CJobManager::GetInstance().IsPaused();
+    if (!paused)
+    {
+      CThumbExtractor *job = PopJob();
+      if (job)
+        return job;
+    }
+
+    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+    lock.Leave();
+    bool newJob = m_jobEvent.WaitMSec(paused ? 1000 : 30000);
+    lock.Enter();
+    if (!newJob && !paused)
+    {
+      // ensure no jobs have come in after the timeout and before we held the lock
+      CThumbExtractor *job = m_running ? PopJob() : NULL;
+      if (job)
+        return job;
+      break;
+    }
+  }
+  RemoveWorker(worker);
+  return NULL;
+}
+
+void CThumbExtractionService::OnJobComplete(CThumbExtractor *job, bool success, bool reused)
+{
+  CSingleLock callbackLock(m_callbackSection);
+  CSingleLock lock(m_section);
+
+  Processing::iterator i = m_processing.begin();
+  while (i != m_processing.end() && i->job != job)
+    ++i;
+  if (i == m_processing.end())
+    return;
+
+  // tell any listeners we're done with the job, then delete it
+  vector<IJobCallback*> callbacks(i->callbacks);
+  lock.Leave();
+  for (vector<IJobCallback*>::iterator it = callbacks.begin(); it != callbacks.end(); ++it)
+  {
+    try
+    {
+      (*it)->OnJobComplete(0, success, job);
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, job->GetType());
+    }
+  }
+  callbackLock.Leave();
+  lock.Enter();
+
+  i = m_processing.begin();
+  while (i != m_processing.end() && i->job != job)
+    ++i;
+  if (i != m_processing.end())
+    m_processing.erase(i);
+
+  m_done++;
+  if (!success)
+    m_failed++;
+  if (reused)
+    m_reused++;
+
+  if (m_queue.empty() && m_processing.empty())
+  {
+    m_batchTime = std::max(XbmcThreads::SystemClockMillis() - m_batchStart, 1u);
+    CLog::Log(LOGNOTICE, "CThumbExtractionService::%s - %u items in %.1f s, %.2f items/sec on up to %u workers"
+                         " (%u without results, %u duplicates dropped, %u decoders reused)"
+                       , __FUNCTION__, m_done, m_batchTime / 1000.0, m_done * 1000.0 / m_batchTime, m_peakWorkers
+                       , m_failed, m_duplicates, m_reused);
+  }
+
+  lock.Leave();
+  delete job;
+}
+
+void CThumbExtractionService::RemoveWorker(const CThumbExtractionWorker *worker)
+{
+  CSingleLock lock(m_section);
+  // remove our worker
+  vector<CThumbExtractionWorker*>::iterator i = find(m_workers.begin(), m_workers.end(), worker);
+  if (i != m_workers.end())
+    m_workers.erase(i); // workers auto-delete
+}
@@ -0,0 +1,140 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <deque>
+#include <vector>
+
+class CThumbExtractor;
+class CThumbExtractionWorker;
+class IJobCallback;
+
+/*!
+ \ingroup thumbs,jobs
+ \brief Extracts the thumbs and stream details of many videos in parallel
+
+ The CThumbExtractor jobs of all thumb loaders end up here instead of being
+ extracted one at a time per loader. Every worker keeps a CDVDThumbContext,
+ so files with the same codec parameters share an open decoder. A job for an
+ item that is already queued or being extracted is dropped, its callback is
+ told when the first one completes. The newest jobs are extracted first, like
+ the loaders did, and the workers pause along with the pausable jobs of the
+ CJobManager.
+
+ Once all jobs are done the throughput of the batch is logged.
+
+ \sa CThumbExtractor, CDVDFileInfo::ExtractThumb
+ */
+class CThumbExtractionService
+{
+public:
+  struct SStats
+  {
+    unsigned int queued;
+    unsigned int running;
+    unsigned int workers;
+    unsigned int done;       ///< jobs completed in the current batch
+    unsigned int failed;     ///< of which found nothing
+    unsigned int duplicates; ///< jobs dropped, their item was queued already
+    unsigned int reused;     ///< jobs decoded by the decoder of the job before
+    float        itemsPerSecond;
+  };
+
+  static CThumbExtractionService& Get();
+
+  /*!
+   \brief Queue a job, the service owns it from now on
+   \param job the extraction to run
+   \param callback told of the completion from a worker thread, may be NULL
+   \return false if the job was a duplicate and has been deleted, a thumb job
+           replacing a queued details job for the item is kept
+   */
+  bool AddJob(CThumbExtractor *job, IJobCallback *callback);
+
+  /*!
+   \brief Drop the queued jobs of a callback and stop it being told of the running ones
+   */
+  void CancelJobs(IJobCallback *callback);
+
+  /*!
+   \brief Drop all jobs and wait for the workers to finish, at shutdown
+   \sa Restart()
+   */
+  void Stop();
+
+  /*!
+   \brief Accept jobs again after Stop()
+   \throws std::logic_error if the service was not stopped
+   \sa Stop()
+   */
+  void Restart();
+
+  SStats GetStats() const;
+
+  /*!
+   \brief The number of jobs run at once
+   \param cpus the number of cpus
+   \param remote whether the files are read from the network
+   \return a worker per cpu but one, twice as many for files on shares
+   */
+  static unsigned int GetMaxWorkers(int cpus, bool remote);
+
+private:
+  friend class CThumbExtractionWorker;
+
+  struct SItem
+  {
+    CThumbExtractor            *job;
+    std::vector<IJobCallback*>  callbacks;
+    bool                        remote;
+  };
+  typedef std::deque<SItem>  Queue;
+  typedef std::vector<SItem> Processing;
+
+  CThumbExtractionService();
+  CThumbExtractionService(const CThumbExtractionService&);
+  CThumbExtractionService const& operator=(const CThumbExtractionService&);
+  ~CThumbExtractionService();
+
+  CThumbExtractor* GetNextJob(const CThumbExtractionWorker *worker);
+  CThumbExtractor* PopJob();
+  void OnJobComplete(CThumbExtractor *job, bool success, bool reused);
+  void RemoveWorker(const CThumbExtractionWorker *worker);
+  void StartWorkers();
+
+  mutable CCriticalSection m_section;
+  CCriticalSection m_callbackSection; ///< held while callbacks are told, taken before m_section
+  CEvent       m_jobEvent;
+  Queue        m_queue;
+  Processing   m_processing;
+  std::vector<CThumbExtractionWorker*> m_workers;
+  bool         m_running;
+
+  unsigned int m_batchStart;
+  unsigned int m_batchTime;   ///< ms the last batch took, 0 while one runs
+  unsigned int m_peakWorkers;
+  unsigned int m_done;
+  unsigned int m_failed;
+  unsigned int m_duplicates;
+  unsigned int m_reused;
+};
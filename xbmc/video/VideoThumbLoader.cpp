@@ -37,6 +37,7 @@
 #include "video/VideoDatabase.h"
 #include "cores/dvdplayer/DVDFileInfo.h"
 #include "video/VideoInfoScanner.h"
+#include "video/ThumbExtractionService.h"
 #include "music/MusicDatabase.h"
 #include "utils/StringUtils.h"
 #include "settings/AdvancedSettings.h"
@@ -51,6 +52,7 @@ CThumbExtractor::CThumbExtractor(const CFileItem& item, const CStdString& listpa
   m_target = target;
   m_thumb = thumb;
   m_item = item;
+  m_context = NULL;
 
   if (item.IsVideoDb() && item.HasVideoInfoTag())
     m_item.SetPath(item.GetVideoInfoTag()->m_strFileNameAndPath);
@@ -101,7 +103,8 @@ bool CThumbExtractor::DoWork()
     // construct the thumb cache file
     CTextureDetails details;
     details.file = CTextureCache::GetCacheFile(m_target) + ".jpg";
-    result = CDVDFileInfo::ExtractThumb(m_item.GetPath(), details, &m_item.GetVideoInfoTag()->m_streamDetails);
+    bool detailsFilled = false;
+    result = CDVDFileInfo::ExtractThumb(m_item.GetPath(), details, &m_item.GetVideoInfoTag()->m_streamDetails, m_context, &detailsFilled);
     if(result)
     {
       CTextureCache::Get().AddCachedTexture(m_target, details);
@@ -120,6 +123,11 @@ bool CThumbExtractor::DoWork()
         }
       }
     }
+
+    // the stream details were read in the same pass, keep them without a thumb too.
+    // details the item had before don't count, the file may not have opened
+    if (!result && detailsFilled)
+      result = true;
   }
   else if (!m_item.HasVideoInfoTag() || !m_item.GetVideoInfoTag()->HasStreamDetails())
   {
@@ -164,6 +172,7 @@ CVideoThumbLoader::CVideoThumbLoader() :
 
 CVideoThumbLoader::~CVideoThumbLoader()
 {
+  CThumbExtractionService::Get().CancelJobs(this);
   StopThread();
   delete m_videoDatabase;
 }
@@ -372,7 +381,7 @@ bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
           SetupRarOptions(item,path);
 
         CThumbExtractor* extract = new CThumbExtractor(item, path, true, thumbURL);
-        AddJob(extract);
+        CThumbExtractionService::Get().AddJob(extract, this);
 
         m_videoDatabase->Close();
         return true;
@@ -389,7 +398,7 @@ bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
       if (URIUtils::IsInRAR(item.GetPath()))
         SetupRarOptions(item,path);
       CThumbExtractor* extract = new CThumbExtractor(item,path,false);
-      AddJob(extract);
+      CThumbExtractionService::Get().AddJob(extract, this);
     }
   }
 
@@ -24,6 +24,7 @@
 #include "utils/JobManager.h"
 #include "FileItem.h"
 
+class CDVDThumbContext;
 class CStreamDetails;
 class CVideoDatabase;
 
@@ -31,9 +32,10 @@ class CVideoDatabase;
  \ingroup thumbs,jobs
  \brief Thumb extractor job class
 
- Used by the CVideoThumbLoader to perform asynchronous generation of thumbs
+ Used by the CVideoThumbLoader to perform asynchronous generation of thumbs,
+ run by the workers of the CThumbExtractionService
 
- \sa CVideoThumbLoader and CJob
+ \sa CVideoThumbLoader, CThumbExtractionService and CJob
  */
 class CThumbExtractor : public CJob
 {
@@ -57,6 +59,7 @@ public:
   CStdString m_listpath; ///< path used in fileitem list
   CFileItem  m_item;
   bool       m_thumb; ///< extract thumb?
+  CDVDThumbContext *m_context; ///< decoder kept open by the worker, may be NULL
 };
 
 class CVideoThumbLoader : public CThumbLoader, public CJobQueue
@@ -0,0 +1,182 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video/ThumbExtractionService.h"
+#include "video/VideoThumbLoader.h"
+#include "FileItem.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+namespace
+{
+class CCountingCallback : public IJobCallback
+{
+public:
+  CCountingCallback() : m_completed(0) {}
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job) { m_completed++; }
+  int m_completed;
+};
+
+CThumbExtractor* MakeJob(const CStdString &path, bool thumb)
+{
+  CFileItem item(path, false);
+  return new CThumbExtractor(item, path, thumb);
+}
+}
+
+/* the workers pause along with the job manager, so the jobs stay queued */
+class TestThumbExtractionService : public testing::Test
+{
+protected:
+  TestThumbExtractionService()
+  {
+    CJobManager::GetInstance().PauseJobs();
+  }
+
+  ~TestThumbExtractionService()
+  {
+    CThumbExtractionService::Get().CancelJobs(&m_first);
+    CThumbExtractionService::Get().CancelJobs(&m_second);
+    CJobManager::GetInstance().UnPauseJobs();
+  }
+
+  CCountingCallback m_first;
+  CCountingCallback m_second;
+};
+
+TEST(TestThumbExtractionServiceWorkers, GetMaxWorkers)
+{
+  EXPECT_EQ(1u, CThumbExtractionService::GetMaxWorkers(0, false));
+  EXPECT_EQ(1u, CThumbExtractionService::GetMaxWorkers(1, false));
+  EXPECT_EQ(1u, CThumbExtractionService::GetMaxWorkers(2, false));
+  EXPECT_EQ(3u, CThumbExtractionService::GetMaxWorkers(4, false));
+  EXPECT_EQ(8u, CThumbExtractionService::GetMaxWorkers(16, false));
+
+  // files on shares get twice the workers, up to the same limit
+  EXPECT_EQ(2u, CThumbExtractionService::GetMaxWorkers(1, true));
+  EXPECT_EQ(6u, CThumbExtractionService::GetMaxWorkers(4, true));
+  EXPECT_EQ(8u, CThumbExtractionService::GetMaxWorkers(16, true));
+}
+
+TEST_F(TestThumbExtractionService, Duplicates)
+{
+  CThumbExtractionService &service = CThumbExtractionService::Get();
+
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/a.avi", true), &m_first));
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/b.avi", true), &m_first));
+  CThumbExtractionService::SStats stats = service.GetStats();
+  EXPECT_EQ(2u, stats.queued);
+  EXPECT_EQ(0u, stats.duplicates);
+
+  // the same item from another loader is dropped, both are told
+  EXPECT_FALSE(service.AddJob(MakeJob("/nonexistent/a.avi", true), &m_second));
+  // a details job is covered by the queued thumb job
+  EXPECT_FALSE(service.AddJob(MakeJob("/nonexistent/a.avi", false), &m_first));
+  stats = service.GetStats();
+  EXPECT_EQ(2u, stats.queued);
+  EXPECT_EQ(2u, stats.duplicates);
+
+  // the first loader is gone, the job stays for the second
+  service.CancelJobs(&m_first);
+  EXPECT_EQ(1u, service.GetStats().queued);
+  service.CancelJobs(&m_second);
+  EXPECT_EQ(0u, service.GetStats().queued);
+
+  EXPECT_EQ(0, m_first.m_completed);
+  EXPECT_EQ(0, m_second.m_completed);
+}
+
+TEST_F(TestThumbExtractionService, ThumbReplacesDetails)
+{
+  CThumbExtractionService &service = CThumbExtractionService::Get();
+
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/a.avi", false), &m_first));
+
+  // a thumb job takes the place of the queued details job and is kept
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/a.avi", true), &m_second));
+  CThumbExtractionService::SStats stats = service.GetStats();
+  EXPECT_EQ(1u, stats.queued);
+  EXPECT_EQ(1u, stats.duplicates);
+
+  // the queued job is a thumb job now, another one is a duplicate
+  EXPECT_FALSE(service.AddJob(MakeJob("/nonexistent/a.avi", true), &m_second));
+  EXPECT_FALSE(service.AddJob(MakeJob("/nonexistent/a.avi", false), &m_second));
+  EXPECT_EQ(1u, service.GetStats().queued);
+
+  // both callbacks moved over to the kept job
+  service.CancelJobs(&m_second);
+  EXPECT_EQ(1u, service.GetStats().queued);
+  service.CancelJobs(&m_first);
+  EXPECT_EQ(0u, service.GetStats().queued);
+}
+
+TEST_F(TestThumbExtractionService, CancelJobs)
+{
+  CThumbExtractionService &service = CThumbExtractionService::Get();
+
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/a.avi", true), &m_first));
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/b.avi", true), &m_second));
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/c.avi", true), &m_first));
+  EXPECT_EQ(3u, service.GetStats().queued);
+
+  // only the jobs of the callback go
+  service.CancelJobs(&m_first);
+  EXPECT_EQ(1u, service.GetStats().queued);
+  service.CancelJobs(&m_first);
+  EXPECT_EQ(1u, service.GetStats().queued);
+
+  service.CancelJobs(&m_second);
+  EXPECT_EQ(0u, service.GetStats().queued);
+
+  EXPECT_EQ(0, m_first.m_completed);
+  EXPECT_EQ(0, m_second.m_completed);
+}
+
+TEST_F(TestThumbExtractionService, Stop)
+{
+  CThumbExtractionService &service = CThumbExtractionService::Get();
+  EXPECT_THROW(service.Restart(), std::logic_error);
+
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/a.avi", true), &m_first));
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/b.avi", false), &m_first));
+  EXPECT_LT(0u, service.GetStats().workers);
+
+  service.Stop();
+  CThumbExtractionService::SStats stats = service.GetStats();
+  EXPECT_EQ(0u, stats.queued);
+  EXPECT_EQ(0u, stats.running);
+  EXPECT_EQ(0u, stats.workers);
+
+  // jobs added after the stop are dropped
+  EXPECT_FALSE(service.AddJob(MakeJob("/nonexistent/c.avi", true), &m_first));
+  EXPECT_EQ(0u, service.GetStats().queued);
+  EXPECT_EQ(0, m_first.m_completed);
+
+  // and taken again after the restart
+  service.Restart();
+  EXPECT_TRUE(service.AddJob(MakeJob("/nonexistent/c.avi", true), &m_first));
+  EXPECT_EQ(1u, service.GetStats().queued);
+  service.CancelJobs(&m_first);
+  EXPECT_EQ(0u, service.GetStats().queued);
+}